@@ -197,6 +197,8 @@ def envoy_dependencies(skip_targets = []):
     _com_github_c_ares_c_ares()
     _com_github_circonus_labs_libcircllhist()
     _com_github_cyan4973_xxhash()
+    _com_github_facebook_zstd()
+    _org_brotli()
     _com_github_datadog_dd_opentracing_cpp()
     _com_github_mirror_tclap()
     _com_github_envoyproxy_sqlparser()
@@ -316,6 +318,30 @@ def _com_github_cyan4973_xxhash():
         actual = "@com_github_cyan4973_xxhash//:xxhash",
     )
 
+def _com_github_facebook_zstd():
+    _repository_impl(
+        name = "com_github_facebook_zstd",
+        build_file = "@envoy//bazel/external:zstd.BUILD",
+    )
+    native.bind(
+        name = "zstd",
+        actual = "@com_github_facebook_zstd//:zstd",
+    )
+
+def _org_brotli():
+    # brotli is built with the BUILD file of its own repository.
+    _repository_impl(
+        name = "org_brotli",
+    )
+    native.bind(
+        name = "brotlienc",
+        actual = "@org_brotli//:brotlienc",
+    )
+    native.bind(
+        name = "brotlidec",
+        actual = "@org_brotli//:brotlidec",
+    )
+
 def _com_github_envoyproxy_sqlparser():
     _repository_impl(
         name = "com_github_envoyproxy_sqlparser",
@@ -179,6 +179,38 @@ DEPENDENCY_REPOSITORIES_SPEC = dict(
         last_updated = "2020-03-04",
         cpe = "N/A",
     ),
+    com_github_facebook_zstd = dict(
+        project_name = "zstd",
+        project_desc = "Zstandard fast real-time compression algorithm",
+        project_url = "https://facebook.github.io/zstd",
+        version = "1.4.5",
+        sha256 = "98e91c7c6bf162bf90e4e70fdbc41a8188b9fa8de5ad840c401198014406ce9e",
+        strip_prefix = "zstd-{version}",
+        urls = ["https://github.com/facebook/zstd/releases/download/v{version}/zstd-{version}.tar.gz"],
+        use_category = ["dataplane_ext"],
+        extensions = [
+            "envoy.compression.zstd.compressor",
+            "envoy.compression.zstd.decompressor",
+        ],
+        last_updated = "2020-10-12",
+        cpe = "cpe:2.3:a:facebook:zstandard:*",
+    ),
+    org_brotli = dict(
+        project_name = "brotli",
+        project_desc = "brotli compression library",
+        project_url = "https://brotli.org",
+        version = "1.0.9",
+        sha256 = "f9e8d81d0405ba66d181529af42a3354f838c939095ff99930da6aa9cdf6fe46",
+        strip_prefix = "brotli-{version}",
+        urls = ["https://github.com/google/brotli/archive/v{version}.tar.gz"],
+        use_category = ["dataplane_ext"],
+        extensions = [
+            "envoy.compression.brotli.compressor",
+            "envoy.compression.brotli.decompressor",
+        ],
+        last_updated = "2020-10-14",
+        cpe = "cpe:2.3:a:google:brotli:*",
+    ),
     com_github_envoyproxy_sqlparser = dict(
         project_name = "C++ SQL Parser Library",
         project_desc = "Forked from Hyrise SQL Parser",
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <memory>
+
 #include "envoy/buffer/buffer.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Compression {
 namespace Compressor {
@@ -29,6 +33,46 @@ public:
 
 using CompressorPtr = std::unique_ptr<Compressor>;
 
+/**
+ * Allows compressing a stream as a sequence of blocks which are compressed independently of each
+ * other, so that they can be compressed concurrently, on other threads than the stream's thread.
+ */
+class BlockCompressor {
+public:
+  virtual ~BlockCompressor() = default;
+
+  /**
+   * A compressed block.
+   */
+  class Block {
+  public:
+    virtual ~Block() = default;
+  };
+
+  using BlockPtr = std::unique_ptr<Block>;
+
+  /**
+   * Compresses a block. May be called from any thread, concurrently with any other method.
+   * @param input supplies the data of the block.
+   * @param history supplies the data preceding the block in the stream, which the compressed block
+   *        may refer to. It is empty for the first block.
+   * @param state supplies Finish if the block is the last one of the stream, Flush otherwise.
+   * @return BlockPtr the compressed block.
+   */
+  virtual BlockPtr compressBlock(absl::string_view input, absl::string_view history,
+                                 State state) const PURE;
+
+  /**
+   * Appends a compressed block to the compressed stream. Must be called on the stream's thread,
+   * for every block of the stream in order.
+   * @param block supplies the compressed block.
+   * @param output supplies the buffer to append the compressed data to.
+   */
+  virtual void addBlock(const Block& block, Buffer::Instance& output) PURE;
+};
+
+using BlockCompressorSharedPtr = std::shared_ptr<BlockCompressor>;
+
 } // namespace Compressor
 } // namespace Compression
 } // namespace Envoy
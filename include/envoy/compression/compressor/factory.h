@@ -13,6 +13,12 @@ public:
   virtual CompressorPtr createCompressor() PURE;
   virtual const std::string& statsPrefix() const PURE;
   virtual const std::string& contentEncoding() const PURE;
+
+  /**
+   * @return BlockCompressorSharedPtr a compressor compressing a stream in independent blocks, or
+   *         nullptr if the library can't compress in blocks.
+   */
+  virtual BlockCompressorSharedPtr createBlockCompressor() { return nullptr; }
 };
 
 using CompressorFactoryPtr = std::unique_ptr<CompressorFactory>;
@@ -73,6 +73,25 @@ public:
    */
   virtual ProtobufTypes::MessagePtr decodeResource(const ProtobufWkt::Any& resource) PURE;
 
+  /**
+   * Performs the part of decodeResource() that has no side effects: unpacking the resource and
+   * checking its protoc-gen-validate constraints. This may be called concurrently from any thread.
+   * @param resource some opaque resource (ProtobufWkt::Any).
+   * @return ProtobufTypes::MessagePtr the decoded protobuf message, which must be passed to
+   *         finishResource() on the main thread before use, or nullptr if the resource can only be
+   *         decoded on the main thread with decodeResource().
+   * @throw EnvoyException if the resource does not unpack or validate.
+   */
+  virtual ProtobufTypes::MessagePtr parseResource(const ProtobufWkt::Any& resource) PURE;
+
+  /**
+   * Performs the part of decodeResource() that must run on the main thread, e.g. the deprecated
+   * and unknown field checks, on a message returned by parseResource().
+   * @param resource some resource (Protobuf::Message) returned by parseResource().
+   * @throw EnvoyException if the resource is rejected.
+   */
+  virtual void finishResource(const Protobuf::Message& resource) PURE;
+
   /**
    * @param resource some opaque resource (Protobuf::Message).
    * @return std::String the resource name in a Protobuf::Message returned by decodeResource(), e.g.
@@ -32,6 +32,22 @@ public:
                              const Http::ResponseTrailerMap& response_trailers,
                              const StreamInfo::StreamInfo& stream_info,
                              absl::string_view local_reply_body) const PURE;
+
+  /**
+   * Append a formatted substitution line to a string. This produces the same line as format(), but
+   * lets the caller reuse the string's storage across lines.
+   * @param request_headers supplies the request headers.
+   * @param response_headers supplies the response headers.
+   * @param response_trailers supplies the response trailers.
+   * @param stream_info supplies the stream info.
+   * @param local_reply_body supplies the local reply body.
+   * @param output supplies the string to append the formatted substitution line to.
+   */
+  virtual void formatTo(const Http::RequestHeaderMap& request_headers,
+                        const Http::ResponseHeaderMap& response_headers,
+                        const Http::ResponseTrailerMap& response_trailers,
+                        const StreamInfo::StreamInfo& stream_info,
+                        absl::string_view local_reply_body, std::string& output) const PURE;
 };
 
 using FormatterPtr = std::unique_ptr<Formatter>;
@@ -59,6 +75,24 @@ public:
                                              const Http::ResponseTrailerMap& response_trailers,
                                              const StreamInfo::StreamInfo& stream_info,
                                              absl::string_view local_reply_body) const PURE;
+  /**
+   * Append a value extracted from the provided headers/trailers/stream to a string. This appends
+   * the same value as format(), without going through an intermediate string where the provider
+   * can avoid it.
+   * @param request_headers supplies the request headers.
+   * @param response_headers supplies the response headers.
+   * @param response_trailers supplies the response trailers.
+   * @param stream_info supplies the stream info.
+   * @param local_reply_body supplies the local reply body.
+   * @param output supplies the string to append the value to.
+   * @return bool true if a value was appended, false if format() would return absl::nullopt, in
+   *         which case output is left unchanged.
+   */
+  virtual bool formatTo(const Http::RequestHeaderMap& request_headers,
+                        const Http::ResponseHeaderMap& response_headers,
+                        const Http::ResponseTrailerMap& response_trailers,
+                        const StreamInfo::StreamInfo& stream_info,
+                        absl::string_view local_reply_body, std::string& output) const PURE;
   /**
    * Extract a value from the provided headers/trailers/stream, preserving the value's type.
    * @param request_headers supplies the request headers.
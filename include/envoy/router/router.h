@@ -491,7 +491,7 @@ public:
 };
 
 class RateLimitPolicy;
-class Config;
+class CommonConfig;
 
 /**
  * All route specific config returned by the method at
@@ -527,9 +527,11 @@ public:
   virtual const RateLimitPolicy& rateLimitPolicy() const PURE;
 
   /**
-   * @return const Config& the RouteConfiguration that owns this virtual host.
+   * @return const CommonConfig& the RouteConfiguration level settings of the RouteConfiguration
+   *         that owns this virtual host. The same virtual host may be shared by successive
+   *         versions of a RouteConfiguration whose RouteConfiguration level settings are identical.
    */
-  virtual const Config& routeConfig() const PURE;
+  virtual const CommonConfig& routeConfig() const PURE;
 
   /**
    * @return const RouteSpecificFilterConfig* the per-filter config pre-processed object for
@@ -1086,12 +1088,42 @@ enum class RouteEvalStatus {
 using RouteCallback = std::function<RouteMatchStatus(RouteConstSharedPtr, RouteEvalStatus)>;
 
 /**
- * The router configuration.
+ * The RouteConfiguration level settings of a router configuration, i.e. everything except the
+ * virtual hosts.
  */
-class Config {
+class CommonConfig {
 public:
-  virtual ~Config() = default;
+  virtual ~CommonConfig() = default;
+
+  /**
+   * Return a list of headers that will be cleaned from any requests that are not from an internal
+   * (RFC1918) source.
+   */
+  virtual const std::list<Http::LowerCaseString>& internalOnlyHeaders() const PURE;
+
+  /**
+   * @return const std::string the RouteConfiguration name.
+   */
+  virtual const std::string& name() const PURE;
+
+  /**
+   * @return whether router configuration uses VHDS.
+   */
+  virtual bool usesVhds() const PURE;
 
+  /**
+   * @return bool whether most specific header mutations should take precedence. The default
+   * evaluation order is route level, then virtual host level and finally global connection
+   * manager level.
+   */
+  virtual bool mostSpecificHeaderMutationsWins() const PURE;
+};
+
+/**
+ * The router configuration.
+ */
+class Config : public CommonConfig {
+public:
   /**
    * Based on the incoming HTTP request headers, determine the target route (containing either a
    * route entry or a direct response entry) for the request.
@@ -1122,29 +1154,6 @@ public:
   virtual RouteConstSharedPtr route(const RouteCallback& cb, const Http::RequestHeaderMap& headers,
                                     const StreamInfo::StreamInfo& stream_info,
                                     uint64_t random_value) const PURE;
-
-  /**
-   * Return a list of headers that will be cleaned from any requests that are not from an internal
-   * (RFC1918) source.
-   */
-  virtual const std::list<Http::LowerCaseString>& internalOnlyHeaders() const PURE;
-
-  /**
-   * @return const std::string the RouteConfiguration name.
-   */
-  virtual const std::string& name() const PURE;
-
-  /**
-   * @return whether router configuration uses VHDS.
-   */
-  virtual bool usesVhds() const PURE;
-
-  /**
-   * @return bool whether most specific header mutations should take precedence. The default
-   * evaluation order is route level, then virtual host level and finally global connection
-   * manager level.
-   */
-  virtual bool mostSpecificHeaderMutationsWins() const PURE;
 };
 
 using ConfigConstSharedPtr = std::shared_ptr<const Config>;
@@ -40,6 +40,10 @@ enum class Reason {
 struct Decision {
   Reason reason;
   bool traced;
+  // Whether a trace that is not sampled may still be sampled when the request completes, through
+  // Span::setSampled() on the span started for it. Only set for drivers that support it, which
+  // record the spans of such a trace until the decision is made.
+  bool tail_sampling{false};
 };
 
 /**
@@ -189,6 +193,12 @@ public:
   virtual SpanPtr startSpan(const Config& config, Http::RequestHeaderMap& request_headers,
                             const std::string& operation_name, SystemTime start_time,
                             const Tracing::Decision tracing_decision) PURE;
+
+  /**
+   * @return whether the driver honors Decision::tail_sampling, by recording the spans of a trace
+   *         that is not sampled until Span::setSampled() is called on its root span.
+   */
+  virtual bool supportsTailSampling() const PURE;
 };
 
 using DriverPtr = std::unique_ptr<Driver>;
@@ -204,6 +214,12 @@ public:
   virtual SpanPtr startSpan(const Config& config, Http::RequestHeaderMap& request_headers,
                             const StreamInfo::StreamInfo& stream_info,
                             const Tracing::Decision tracing_decision) PURE;
+
+  /**
+   * @return whether the spans started by this tracer may be tail sampled. @see
+   *         Driver::supportsTailSampling().
+   */
+  virtual bool supportsTailSampling() const PURE;
 };
 
 using HttpTracerSharedPtr = std::shared_ptr<HttpTracer>;
@@ -4,6 +4,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
@@ -107,6 +108,30 @@ public:
   virtual bool addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
                                   const std::string& version_info) PURE;
 
+  /**
+   * Same as addOrUpdateCluster() above, but uses a config hash that was already computed by
+   * hashClusters(). This allows the hashing of large CDS updates to be done in a single batch.
+   *
+   * @param cluster supplies the cluster configuration.
+   * @param version_info supplies the xDS version of the cluster.
+   * @param config_hash supplies the hash of the cluster configuration.
+   * @return true if the action results in an add/update of a cluster.
+   */
+  virtual bool addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
+                                  const std::string& version_info, uint64_t config_hash) PURE;
+
+  /**
+   * Compute the config hashes used to detect cluster changes in addOrUpdateCluster(). Large batches
+   * are hashed in parallel on a helper thread pool; the call blocks until all hashes are ready.
+   * Only the hashing is parallel, clusters are still constructed by addOrUpdateCluster() on the
+   * calling thread.
+   *
+   * @param clusters supplies the cluster configurations to hash.
+   * @return std::vector<uint64_t> the config hash of each cluster, in the same order.
+   */
+  virtual std::vector<uint64_t>
+  hashClusters(const std::vector<const envoy::config::cluster::v3::Cluster*>& clusters) PURE;
+
   /**
    * Set a callback that will be invoked when all primary clusters have been initialized.
    */
@@ -150,7 +175,10 @@ public:
    * call (or if the caller knows that the cluster is fully static and will never be deleted). In
    * the case of dynamic clusters, subsequent event loop iterations may invalidate this pointer.
    * If information about the cluster needs to be kept, use the ThreadLocalCluster::info() method to
-   * obtain cluster information that is safe to store.
+   * obtain cluster information that is safe to store. Callers that keep the pointer until the
+   * cluster is updated or removed, as cluster update callbacks may, must register a member update
+   * callback on its priority set for as long as they keep it. Thread local clusters with member
+   * update callbacks are never evicted for being idle.
    */
   virtual ThreadLocalCluster* get(absl::string_view cluster) PURE;
 
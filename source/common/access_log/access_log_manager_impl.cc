@@ -1,16 +1,93 @@
 #include "common/access_log/access_log_manager_impl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/common/lock_guard.h"
 
-#include "absl/container/fixed_array.h"
-
 namespace Envoy {
 namespace AccessLog {
 
+namespace {
+
+// Index of the write buffer used by the calling thread. Threads are spread evenly over the buffers
+// in the order they first write to any file.
+uint32_t writeBufferIndex(uint32_t num_write_buffers) {
+  static std::atomic<uint32_t> next_thread_index{0};
+  thread_local const uint32_t thread_index = next_thread_index++;
+  return thread_index % num_write_buffers;
+}
+
+} // namespace
+
+AccessLogFlusher::~AccessLogFlusher() {
+  Thread::ThreadPtr flush_thread;
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    event_.notifyAll();
+    flush_thread = std::move(flush_thread_);
+  }
+
+  if (flush_thread != nullptr) {
+    flush_thread->join();
+  }
+}
+
+void AccessLogFlusher::schedule(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  if (flush_thread_ == nullptr) {
+    flush_thread_ = api_.threadFactory().createThread([this]() -> void { flushThreadFunc(); },
+                                                      Thread::Options{"AccessLogFlush"});
+  }
+
+  if (std::find(pending_.begin(), pending_.end(), &file) == pending_.end()) {
+    pending_.push_back(&file);
+  }
+  event_.notifyAll();
+}
+
+void AccessLogFlusher::remove(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  pending_.erase(std::remove(pending_.begin(), pending_.end(), &file), pending_.end());
+  while (flushing_ == &file) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    event_.wait(lock_);
+  }
+}
+
+void AccessLogFlusher::flushThreadFunc() {
+  while (true) {
+    AccessLogFileImpl* file;
+
+    {
+      Thread::LockGuard lock(lock_);
+      if (flushing_ != nullptr) {
+        // Wake up remove() for the file that was just flushed.
+        flushing_ = nullptr;
+        event_.notifyAll();
+      }
+
+      while (pending_.empty() && !exit_) {
+        event_.wait(lock_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      file = pending_.front();
+      pending_.pop_front();
+      flushing_ = file;
+    }
+
+    file->flushBuffered();
+  }
+}
+
 AccessLogManagerImpl::~AccessLogManagerImpl() {
   for (auto& [log_key, log_file_ptr] : access_logs_) {
     ENVOY_LOG(debug, "destroying access logger {}", log_key);
@@ -32,21 +109,21 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
 
   access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
       api_.fileSystem().createFile(file_name), dispatcher_, lock_, file_stats_,
-      file_flush_interval_msec_, api_.threadFactory());
+      file_flush_interval_msec_, flusher_);
   return access_logs_[file_name];
 }
 
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
-    : file_(std::move(file)), file_lock_(lock),
+                                     AccessLogFlusher& flusher)
+    : file_(std::move(file)), file_lock_(lock), dispatcher_(dispatcher),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        flusher_.schedule(*this);
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      flusher_(flusher), flush_interval_msec_(flush_interval_msec), stats_(stats) {
   open();
 }
 
@@ -69,20 +146,14 @@ void AccessLogFileImpl::open() {
 void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  flusher_.remove(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    Thread::LockGuard flush_lock(flush_lock_);
+    moveWriteBuffers(about_to_write_buffer_);
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
 
     const Api::IoCallBoolResult result = file_->close();
@@ -93,6 +164,7 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   Buffer::RawSliceVector slices = buffer.getRawSlices();
+  const MonotonicTime start_time = dispatcher_.timeSource().monotonicTime();
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different AccessLogFileImpl pointing to the same underlying file. This can happen either via
@@ -118,94 +190,94 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
 
   stats_.write_total_buffered_.sub(buffer.length());
   buffer.drain(buffer.length());
-}
 
-void AccessLogFileImpl::flushThreadFunc() {
+  // Histograms may only be recorded on threads registered with thread local storage, which the
+  // flush thread is not.
+  const uint64_t flush_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                         dispatcher_.timeSource().monotonicTime() - start_time)
+                                         .count();
+  Stats::Histogram& flush_duration_histogram = stats_.flush_duration_us_;
+  dispatcher_.post([&flush_duration_histogram, flush_duration_us]() -> void {
+    flush_duration_histogram.recordValue(flush_duration_us);
+  });
+}
 
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
+void AccessLogFileImpl::moveWriteBuffers(Buffer::Instance& output) {
+  uint64_t moved = 0;
+  for (WriteBuffer& write_buffer : write_buffers_) {
+    Thread::LockGuard lock(write_buffer.lock_);
+    moved += write_buffer.buffer_.length();
+    output.move(write_buffer.buffer_);
+  }
+  write_buffered_size_ -= moved;
+}
 
-    {
-      Thread::LockGuard write_lock(write_lock_);
+void AccessLogFileImpl::flushBuffered() {
+  Thread::LockGuard flush_lock(flush_lock_);
+  moveWriteBuffers(about_to_write_buffer_);
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
+  // The flush can be requested by the timer while no data is buffered.
+  if (about_to_write_buffer_.length() == 0 && !reopen_file_) {
+    return;
+  }
 
-      if (flush_thread_exit_) {
-        return;
+  // if we failed to open file before, then simply ignore
+  if (file_->isOpen()) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        const Api::IoCallBoolResult result = file_->close();
+        ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                       result.err_->getErrorDetails()));
+        open();
       }
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
-    }
-
-    // if we failed to open file before, then simply ignore
-    if (file_->isOpen()) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          const Api::IoCallBoolResult result = file_->close();
-          ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
-                                         result.err_->getErrorDetails()));
-          open();
-        }
-
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
-      }
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
   }
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+  // flush_lock_ must be held while moving the data out of write_buffers_ or else it is possible
+  // that flushBuffered() has already moved data to about_to_write_buffer_ but has not yet
+  // completed doWrite(). This would allow flush() to return before the pending data has actually
+  // been written to disk.
+  Thread::LockGuard flush_lock(flush_lock_);
+  moveWriteBuffers(about_to_write_buffer_);
+
+  if (about_to_write_buffer_.length() == 0) {
+    return;
   }
 
   doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
-
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  const uint64_t buffered_size = write_buffered_size_.fetch_add(data.length()) + data.length();
+  if (buffered_size > MAX_BUFFERED_SIZE) {
+    // The flush thread is not keeping up with the writes, most likely because the disk is stalled.
+    write_buffered_size_ -= data.length();
+    stats_.write_dropped_.inc();
+    return;
   }
 
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  {
+    WriteBuffer& write_buffer = write_buffers_[writeBufferIndex(NUM_WRITE_BUFFERS)];
+    Thread::LockGuard lock(write_buffer.lock_);
+    write_buffer.buffer_.add(data.data(), data.size());
   }
-}
 
-void AccessLogFileImpl::createFlushStructures() {
-  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
-                                               Thread::Options{"AccessLogFlush"});
-  flush_timer_->enableTimer(flush_interval_msec_);
+  if (!flush_started_.load(std::memory_order_relaxed) && !flush_started_.exchange(true)) {
+    // The first write to a file is flushed right away, and starts the periodic flushes.
+    flush_timer_->enableTimer(flush_interval_msec_);
+    flusher_.schedule(*this);
+  } else if (buffered_size > MIN_FLUSH_SIZE && buffered_size - data.length() <= MIN_FLUSH_SIZE) {
+    flusher_.schedule(*this);
+  }
 }
 
 } // namespace AccessLog
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <deque>
 #include <string>
 
 #include "envoy/access_log/access_log.h"
@@ -17,29 +20,70 @@
 
 namespace Envoy {
 
-#define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE)                                                      \
+#define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE, HISTOGRAM)                                           \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
+  COUNTER(write_dropped)                                                                           \
   COUNTER(write_failed)                                                                            \
-  GAUGE(write_total_buffered, Accumulate)
+  GAUGE(write_total_buffered, Accumulate)                                                          \
+  HISTOGRAM(flush_duration_us, Microseconds)
 
 struct AccessLogFileStats {
-  ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 namespace AccessLog {
 
+class AccessLogFileImpl;
+
+/**
+ * Flushes the buffered data of access log files to disk. A single flush thread, started on first
+ * use, serves all the files of an AccessLogManagerImpl, with the idea that flushes are cheap
+ * compared to the interval between them.
+ */
+class AccessLogFlusher {
+public:
+  explicit AccessLogFlusher(Api::Api& api) : api_(api) {}
+  ~AccessLogFlusher();
+
+  /**
+   * Ask the flush thread to flush a file. This may be called from any thread.
+   * @param file supplies the file to flush.
+   */
+  void schedule(AccessLogFileImpl& file);
+
+  /**
+   * Forget pending flushes of a file, and wait for any flush of it that is in progress to finish.
+   * @param file supplies the file, which is about to be destroyed.
+   */
+  void remove(AccessLogFileImpl& file);
+
+private:
+  void flushThreadFunc();
+
+  Api::Api& api_;
+  Thread::MutexBasicLockable lock_; // Never held while flushing a file, so writers that schedule a
+                                    // flush don't wait for the disk.
+  Thread::CondVar event_;
+  Thread::ThreadPtr flush_thread_ ABSL_GUARDED_BY(lock_);
+  std::deque<AccessLogFileImpl*> pending_ ABSL_GUARDED_BY(lock_);
+  AccessLogFileImpl* flushing_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+};
+
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
   AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
                        Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
       : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{
-                         ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
-                                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
+        lock_(lock), file_stats_{ACCESS_LOG_FILE_STATS(
+                         POOL_COUNTER_PREFIX(stats_store, "filesystem."),
+                         POOL_GAUGE_PREFIX(stats_store, "filesystem."),
+                         POOL_HISTOGRAM_PREFIX(stats_store, "filesystem."))},
+        flusher_(api) {}
   ~AccessLogManagerImpl() override;
 
   // AccessLog::AccessLogManager
@@ -52,22 +96,26 @@ private:
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
   AccessLogFileStats file_stats_;
+  // Destroyed after the files, which remove themselves from it.
+  AccessLogFlusher flusher_;
   absl::node_hash_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Writes are therefore only buffered, and the buffered data is written to disk by the flush thread
+ * of an AccessLogFlusher.
+ *
+ * Writes go to one of several buffers, picked by the writing thread, so that workers logging to
+ * the same file don't contend on a single lock. Log lines are written whole, but lines written by
+ * different threads between two flushes are not ordered by the time they were written.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
-                    std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    std::chrono::milliseconds flush_interval_msec, AccessLogFlusher& flusher);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
@@ -81,23 +129,38 @@ public:
   void reopen() override;
   void flush() override;
 
+  /**
+   * Write the buffered data to disk, reopening the file first if requested. Called on the flush
+   * thread.
+   */
+  void flushBuffered();
+
 private:
+  struct WriteBuffer {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ ABSL_GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
+  void moveWriteBuffers(Buffer::Instance& output);
   void open();
-  void createFlushStructures();
 
   // return default flags set which used by open
   static Filesystem::FlagSet defaultFlags();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // Maximum size of the data waiting to be handed to the flush thread. Writes that would exceed it
+  // are dropped rather than have workers wait for the disk.
+  static const uint64_t MAX_BUFFERED_SIZE = 1024 * 1024 * 64;
+  // Number of buffers writes are spread over.
+  static const uint32_t NUM_WRITE_BUFFERS = 32;
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) the lock_ of a WriteBuffer
   //    3) file_lock_
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
@@ -108,28 +171,24 @@ private:
                                           // concurrent access to the about_to_write_buffer_, fd_,
                                           // and all other data used during flushing and file
                                           // re-opening.
-  Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  std::array<WriteBuffer, NUM_WRITE_BUFFERS>
+      write_buffers_; // These buffers are filled by the writing threads, each of which uses one of
+                      // them. They get flushed either when their total size reaches
+                      // MIN_FLUSH_SIZE or when a timer fires.
+  std::atomic<uint64_t> write_buffered_size_{}; // Total size of write_buffers_.
+  std::atomic<bool> flush_started_{};
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl
-      flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
-                                                  // gets filled and then flushed either when max
-                                                  // size is reached or when a timer fires.
   // TODO(jmarantz): this should be ABSL_GUARDED_BY(flush_lock_) but the analysis cannot poke
   // through the std::make_unique assignment. I do not believe it's possible to annotate this
   // properly now due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
+  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only while flushing. Data is
+                                            // moved from write_buffers_ under their locks, and
+                                            // then the locks are released so that they can
                                             // continue to fill. This buffer is then used for the
                                             // final write to disk.
+  Event::Dispatcher& dispatcher_;
   Event::TimerPtr flush_timer_;
-  Thread::ThreadFactory& thread_factory_;
+  AccessLogFlusher& flusher_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
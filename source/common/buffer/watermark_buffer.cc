@@ -21,6 +21,11 @@ void WatermarkBuffer::add(const Instance& data) {
   checkHighAndOverflowWatermarks();
 }
 
+void WatermarkBuffer::addBufferFragment(BufferFragment& fragment) {
+  OwnedImpl::addBufferFragment(fragment);
+  checkHighAndOverflowWatermarks();
+}
+
 void WatermarkBuffer::prepend(absl::string_view data) {
   OwnedImpl::prepend(data);
   checkHighAndOverflowWatermarks();
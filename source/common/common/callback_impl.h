@@ -44,6 +44,11 @@ public:
     }
   }
 
+  /**
+   * @return bool whether no callbacks are registered.
+   */
+  bool empty() const { return callbacks_.empty(); }
+
 private:
   struct CallbackHolder : public CallbackHandle {
     CallbackHolder(CallbackManager& parent, Callback cb) : parent_(parent), cb_(cb) {}
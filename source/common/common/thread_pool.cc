@@ -0,0 +1,124 @@
+#include "common/common/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Thread {
+
+ThreadPool::ThreadPool(ThreadFactory& thread_factory, uint32_t num_threads,
+                       const std::string& name) {
+  ASSERT(num_threads > 0);
+  threads_.reserve(num_threads);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(
+        thread_factory.createThread([this]() -> void { threadRoutine(); }, Options{name}));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    LockGuard lock(mutex_);
+    shutdown_ = true;
+  }
+  task_added_.notifyAll();
+  for (ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+  {
+    LockGuard lock(mutex_);
+    ASSERT(!shutdown_);
+    tasks_.emplace_back(std::move(task));
+  }
+  task_added_.notifyOne();
+}
+
+void ThreadPool::threadRoutine() {
+  while (true) {
+    std::function<void()> task;
+    {
+      LockGuard lock(mutex_);
+      while (tasks_.empty() && !shutdown_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        task_added_.wait(mutex_);
+      }
+      if (tasks_.empty()) {
+        // Only reached on shutdown, once the queue has been drained.
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+  if (count == 0) {
+    return;
+  }
+
+  // State shared by the calling thread and the helpers. It lives on this stack frame, which is
+  // safe because we do not return until every helper has signalled completion.
+  struct State {
+    std::atomic<size_t> next_index_{0};
+    MutexBasicLockable mutex_;
+    CondVar helper_done_;
+    size_t helpers_running_ ABSL_GUARDED_BY(mutex_){};
+    std::exception_ptr first_exception_ ABSL_GUARDED_BY(mutex_);
+  } state;
+
+  auto run_indices = [&state, &fn, count]() -> void {
+    size_t index;
+    while ((index = state.next_index_.fetch_add(1, std::memory_order_relaxed)) < count) {
+      try {
+        fn(index);
+      } catch (...) {
+        LockGuard lock(state.mutex_);
+        if (!state.first_exception_) {
+          state.first_exception_ = std::current_exception();
+        }
+      }
+    }
+  };
+
+  // The calling thread takes a share of the work, so small batches never wait on a context switch.
+  const size_t num_helpers = std::min<size_t>(threads_.size(), count - 1);
+  {
+    LockGuard lock(state.mutex_);
+    state.helpers_running_ = num_helpers;
+  }
+  for (size_t i = 0; i < num_helpers; i++) {
+    post([&state, &run_indices]() -> void {
+      run_indices();
+      LockGuard lock(state.mutex_);
+      if (--state.helpers_running_ == 0) {
+        state.helper_done_.notifyAll();
+      }
+    });
+  }
+
+  run_indices();
+
+  std::exception_ptr exception;
+  {
+    LockGuard lock(state.mutex_);
+    while (state.helpers_running_ > 0) {
+      state.helper_done_.wait(state.mutex_);
+    }
+    exception = state.first_exception_;
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+} // namespace Thread
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/thread/thread.h"
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Thread {
+
+/**
+ * A fixed size pool of threads which run posted tasks in FIFO order. The pool is meant for CPU
+ * bound work that has no side effects on the posting thread's state (hashing, parsing, validation,
+ * compression) and would otherwise block the main or a worker thread. Tasks must not block waiting
+ * on the thread that posted them.
+ */
+class ThreadPool : NonCopyable {
+public:
+  /**
+   * @param thread_factory supplies the factory used to create the pool's threads.
+   * @param num_threads supplies the number of threads to create. Must be > 0.
+   * @param name supplies the name given to the pool's threads (truncated by some platforms).
+   */
+  ThreadPool(ThreadFactory& thread_factory, uint32_t num_threads, const std::string& name);
+
+  /**
+   * Runs all tasks that are already queued, then joins the pool's threads.
+   */
+  ~ThreadPool();
+
+  /**
+   * Queue a task to run on one of the pool's threads. The task must not throw.
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * Run fn(i) for every i in [0, count) and block until all invocations have returned. The work is
+   * split between the pool's threads and the calling thread, in no particular order, so fn must be
+   * safe to call concurrently for distinct indices. If any invocation throws, the first exception
+   * is rethrown on the calling thread once all invocations have finished.
+   */
+  void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+  /**
+   * @return uint32_t the number of threads in the pool.
+   */
+  uint32_t size() const { return threads_.size(); }
+
+private:
+  void threadRoutine();
+
+  MutexBasicLockable mutex_;
+  CondVar task_added_;
+  std::list<std::function<void()>> tasks_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<ThreadPtr> threads_;
+};
+
+using ThreadPoolPtr = std::unique_ptr<ThreadPool>;
+
+} // namespace Thread
+} // namespace Envoy
@@ -35,7 +35,7 @@ public:
       : DecodedResourceImpl(resource_decoder, inline_entry.name(),
                             Protobuf::RepeatedPtrField<std::string>(), inline_entry.resource(),
                             true, inline_entry.version()) {}
-  DecodedResourceImpl(ProtobufTypes::MessagePtr resource, const std::string& name,
+  DecodedResourceImpl(std::shared_ptr<const Protobuf::Message> resource, const std::string& name,
                       const std::vector<std::string>& aliases, const std::string& version)
       : resource_(std::move(resource)), has_resource_(true), name_(name), aliases_(aliases),
         version_(version) {}
@@ -56,7 +56,9 @@ private:
         name_(name ? *name : resource_decoder.resourceName(*resource_)),
         aliases_(repeatedPtrFieldToVector(aliases)), version_(version) {}
 
-  const ProtobufTypes::MessagePtr resource_;
+  // Shared so that an unchanged resource can be handed out again by a later response without being
+  // decoded again.
+  const std::shared_ptr<const Protobuf::Message> resource_;
   const bool has_resource_;
   const std::string name_;
   const std::vector<std::string> aliases_;
@@ -0,0 +1,101 @@
+#include "common/config/discovery_response_decoder.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "common/common/hash.h"
+
+namespace Envoy {
+namespace Config {
+
+namespace {
+
+// Responses with fewer resources to parse than this are parsed on the calling thread.
+constexpr size_t ParallelParseMinResources = 128;
+// Upper bound on the threads, including the calling thread, used to parse a response.
+constexpr uint32_t ParallelParseMaxThreads = 4;
+
+} // namespace
+
+std::vector<DecodedResourceImplPtr>
+DiscoveryResponseDecoder::decode(const std::string& type_url,
+                                 OpaqueResourceDecoder& resource_decoder,
+                                 const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                                 const std::string& version_info) {
+  const CachedResourceMap& previous = decoded_by_type_[type_url];
+
+  // Find the resources that changed since the previous response. Hashing the serialized bytes is
+  // much cheaper than parsing them.
+  std::vector<uint64_t> hashes;
+  hashes.reserve(resources.size());
+  std::vector<const CachedResource*> unchanged(resources.size(), nullptr);
+  std::vector<size_t> to_parse;
+  for (int i = 0; i < resources.size(); i++) {
+    hashes.push_back(HashUtil::xxHash64(resources[i].value()));
+    const auto it = previous.find(hashes.back());
+    if (it != previous.end() && *it->second.bytes_ == resources[i].value()) {
+      unchanged[i] = &it->second;
+    } else {
+      to_parse.push_back(i);
+    }
+  }
+  ENVOY_LOG(debug, "Decoding {} of {} resources for {}", to_parse.size(), resources.size(),
+            type_url);
+
+  std::vector<ProtobufTypes::MessagePtr> parsed(resources.size());
+  parse(resource_decoder, resources, to_parse, parsed);
+
+  std::vector<DecodedResourceImplPtr> decoded;
+  decoded.reserve(resources.size());
+  CachedResourceMap current;
+  for (int i = 0; i < resources.size(); i++) {
+    CachedResource resource;
+    if (unchanged[i] != nullptr) {
+      resource = *unchanged[i];
+    } else if (parsed[i] != nullptr) {
+      resource.name_ = resource_decoder.resourceName(*parsed[i]);
+      resource.message_ = std::move(parsed[i]);
+      resource.bytes_ = std::make_shared<const std::string>(resources[i].value());
+    } else {
+      // The decoder can't parse this resource off the main thread; it is decoded from scratch and
+      // not kept for reuse.
+      decoded.emplace_back(new DecodedResourceImpl(resource_decoder, resources[i], version_info));
+      continue;
+    }
+    resource_decoder.finishResource(*resource.message_);
+    decoded.emplace_back(
+        new DecodedResourceImpl(resource.message_, resource.name_, {}, version_info));
+    current.emplace(hashes[i], std::move(resource));
+  }
+
+  decoded_by_type_[type_url] = std::move(current);
+  return decoded;
+}
+
+void DiscoveryResponseDecoder::parse(OpaqueResourceDecoder& resource_decoder,
+                                     const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                                     const std::vector<size_t>& indices,
+                                     std::vector<ProtobufTypes::MessagePtr>& parsed) {
+  // Each invocation writes a distinct element of parsed, so no locking is needed.
+  const auto parse_one = [&resource_decoder, &resources, &indices, &parsed](size_t i) {
+    const size_t index = indices[i];
+    parsed[index] = resource_decoder.parseResource(resources[index]);
+  };
+  if (indices.size() < ParallelParseMinResources) {
+    for (size_t i = 0; i < indices.size(); i++) {
+      parse_one(i);
+    }
+    return;
+  }
+  if (parse_pool_ == nullptr) {
+    // The calling thread takes a share of the work, so it does not count towards the pool size.
+    const uint32_t hardware_threads = std::max(1U, std::thread::hardware_concurrency());
+    const uint32_t num_threads =
+        std::max(1U, std::min(hardware_threads, ParallelParseMaxThreads) - 1);
+    parse_pool_ = std::make_unique<Thread::ThreadPool>(thread_factory_, num_threads, "xds_parse");
+  }
+  parse_pool_->parallelFor(indices.size(), parse_one);
+}
+
+} // namespace Config
+} // namespace Envoy
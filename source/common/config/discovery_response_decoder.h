@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/subscription.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread_pool.h"
+#include "common/config/decoded_resource_impl.h"
+#include "common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * Decodes the resources of state-of-the-world DiscoveryResponses for a single gRPC mux.
+ *
+ * Control planes typically resend every resource of a type in each response, even though few of
+ * them have changed. A resource whose serialized bytes match a resource of the previous response
+ * of the same type reuses that response's decoded message, so it is neither parsed nor checked
+ * against its protoc-gen-validate constraints again. The remaining resources are parsed and
+ * validated on a helper thread pool when there are enough of them to be worth the hand-off. The
+ * checks that need the main thread (deprecated and unknown fields) still run for every resource.
+ */
+class DiscoveryResponseDecoder : Logger::Loggable<Logger::Id::config> {
+public:
+  explicit DiscoveryResponseDecoder(Thread::ThreadFactory& thread_factory)
+      : thread_factory_(thread_factory) {}
+
+  /**
+   * Decode the resources of a response.
+   * @param type_url supplies the type URL of the response, which all resources must match.
+   * @param resource_decoder supplies the decoder for the response's resource type.
+   * @param resources supplies the resources of the response.
+   * @param version_info supplies the version of the response.
+   * @return the decoded resources, in response order.
+   * @throw EnvoyException if any resource fails to decode. The resources of the previous response
+   *        remain available for reuse in that case.
+   */
+  std::vector<DecodedResourceImplPtr>
+  decode(const std::string& type_url, OpaqueResourceDecoder& resource_decoder,
+         const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+         const std::string& version_info);
+
+  /**
+   * Forget the resources of the previous response of a type, e.g. once nothing watches it anymore.
+   * @param type_url supplies the type URL.
+   */
+  void clear(const std::string& type_url) { decoded_by_type_.erase(type_url); }
+
+private:
+  struct CachedResource {
+    std::shared_ptr<const Protobuf::Message> message_;
+    std::string name_;
+    // The serialized bytes the message was decoded from, compared on a hash match so that a hash
+    // collision can't substitute another resource.
+    std::shared_ptr<const std::string> bytes_;
+  };
+  // Resources of the previous response of a type, keyed by a hash of their serialized bytes.
+  using CachedResourceMap = absl::flat_hash_map<uint64_t, CachedResource>;
+
+  void parse(OpaqueResourceDecoder& resource_decoder,
+             const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+             const std::vector<size_t>& indices, std::vector<ProtobufTypes::MessagePtr>& parsed);
+
+  Thread::ThreadFactory& thread_factory_;
+  // Created on the first response large enough to be parsed in parallel.
+  Thread::ThreadPoolPtr parse_pool_;
+  absl::flat_hash_map<std::string, CachedResourceMap> decoded_by_type_;
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -16,6 +16,7 @@ namespace Config {
 
 GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
                          Grpc::RawAsyncClientPtr async_client, Event::Dispatcher& dispatcher,
+                         Thread::ThreadFactory& thread_factory,
                          const Protobuf::MethodDescriptor& service_method,
                          envoy::config::core::v3::ApiVersion transport_api_version,
                          Random::RandomGenerator& random, Stats::Scope& scope,
@@ -23,7 +24,8 @@ GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
     : grpc_stream_(this, std::move(async_client), service_method, random, dispatcher, scope,
                    rate_limit_settings),
       local_info_(local_info), skip_subsequent_node_(skip_subsequent_node),
-      first_stream_request_(true), transport_api_version_(transport_api_version),
+      first_stream_request_(true), response_decoder_(thread_factory),
+      transport_api_version_(transport_api_version),
       enable_type_url_downgrade_and_upgrade_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.enable_type_url_downgrade_and_upgrade")) {
   Config::Utility::checkLocalInfo("ads", local_info);
@@ -156,6 +158,7 @@ void GrpcMuxImpl::onDiscoveryResponse(
     return;
   }
   if (api_state_[type_url].watches_.empty()) {
+    response_decoder_.clear(message->type_url());
     // update the nonce as we are processing this response.
     api_state_[type_url].request_.set_response_nonce(message->nonce());
     if (message->resources().empty()) {
@@ -185,7 +188,6 @@ void GrpcMuxImpl::onDiscoveryResponse(
     // We have to walk all watches (and need an efficient map as a result) to
     // ensure we deliver empty config updates when a resource is dropped. We make the map ordered
     // for test determinism.
-    std::vector<DecodedResourceImplPtr> resources;
     absl::btree_map<std::string, DecodedResourceRef> resource_ref_map;
     std::vector<DecodedResourceRef> all_resource_refs;
     OpaqueResourceDecoder& resource_decoder =
@@ -196,10 +198,12 @@ void GrpcMuxImpl::onDiscoveryResponse(
             fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
                         resource.type_url(), message->type_url(), message->DebugString()));
       }
-      resources.emplace_back(
-          new DecodedResourceImpl(resource_decoder, resource, message->version_info()));
-      all_resource_refs.emplace_back(*resources.back());
-      resource_ref_map.emplace(resources.back()->name(), *resources.back());
+    }
+    const std::vector<DecodedResourceImplPtr> resources = response_decoder_.decode(
+        message->type_url(), resource_decoder, message->resources(), message->version_info());
+    for (const auto& resource : resources) {
+      all_resource_refs.emplace_back(*resource);
+      resource_ref_map.emplace(resource->name(), *resource);
     }
     for (auto watch : api_state_[type_url].watches_) {
       // onConfigUpdate should be called in all cases for single watch xDS (Cluster and
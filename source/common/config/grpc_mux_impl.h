@@ -12,12 +12,14 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/grpc/status.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
+#include "envoy/thread/thread.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/cleanup.h"
 #include "common/common/logger.h"
 #include "common/common/utility.h"
 #include "common/config/api_version.h"
+#include "common/config/discovery_response_decoder.h"
 #include "common/config/grpc_stream.h"
 #include "common/config/utility.h"
 #include "common/runtime/runtime_features.h"
@@ -34,7 +36,8 @@ class GrpcMuxImpl : public GrpcMux,
                     public Logger::Loggable<Logger::Id::config> {
 public:
   GrpcMuxImpl(const LocalInfo::LocalInfo& local_info, Grpc::RawAsyncClientPtr async_client,
-              Event::Dispatcher& dispatcher, const Protobuf::MethodDescriptor& service_method,
+              Event::Dispatcher& dispatcher, Thread::ThreadFactory& thread_factory,
+              const Protobuf::MethodDescriptor& service_method,
               envoy::config::core::v3::ApiVersion transport_api_version,
               Random::RandomGenerator& random, Stats::Scope& scope,
               const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node);
@@ -141,6 +144,7 @@ private:
   const bool skip_subsequent_node_;
   bool first_stream_request_;
   absl::node_hash_map<std::string, ApiState> api_state_;
+  DiscoveryResponseDecoder response_decoder_;
   // Envoy's dependency ordering.
   std::list<std::string> subscriptions_;
 
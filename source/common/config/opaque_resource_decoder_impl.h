@@ -24,6 +24,24 @@ public:
     return typed_message;
   }
 
+  ProtobufTypes::MessagePtr parseResource(const ProtobufWkt::Any& resource) override {
+    // Resources of an earlier API version are upgraded by decodeResource(), which may warn through
+    // runtime, so they do not take the fast path. Neither do synthetic empty messages.
+    if (!resource.Is<Current>()) {
+      return nullptr;
+    }
+    auto typed_message = std::make_unique<Current>();
+    MessageUtil::anyConvert<Current>(resource, *typed_message);
+    MessageUtil::validateConstraints(*typed_message);
+    return typed_message;
+  }
+
+  void finishResource(const Protobuf::Message& resource) override {
+    if (!validation_visitor_.skipValidation()) {
+      MessageUtil::checkForUnexpectedFields(resource, validation_visitor_);
+    }
+  }
+
   std::string resourceName(const Protobuf::Message& resource) override {
     return MessageUtil::getStringField(resource, name_field_);
   }
@@ -73,7 +73,8 @@ SubscriptionPtr SubscriptionFactoryImpl::subscriptionFromConfigSource(
               Utility::factoryForGrpcApiConfigSource(cm_.grpcAsyncClientManager(),
                                                      api_config_source, scope, true)
                   ->create(),
-              dispatcher_, sotwGrpcMethod(type_url, api_config_source.transport_api_version()),
+              dispatcher_, api_.threadFactory(),
+              sotwGrpcMethod(type_url, api_config_source.transport_api_version()),
               api_config_source.transport_api_version(), api_.randomGenerator(), scope,
               Utility::parseRateLimitSettings(api_config_source),
               api_config_source.set_node_on_first_message_only()),
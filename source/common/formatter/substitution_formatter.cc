@@ -1,6 +1,8 @@
 #include "common/formatter/substitution_formatter.h"
 
+#include <algorithm>
 #include <climits>
+#include <cmath>
 #include <cstdint>
 #include <regex>
 #include <string>
@@ -21,6 +23,7 @@
 #include "common/protobuf/utility.h"
 #include "common/stream_info/utility.h"
 
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "fmt/format.h"
 
@@ -52,6 +55,102 @@ const std::regex& getNewlinePattern() { CONSTRUCT_ON_FIRST_USE(std::regex, "\n")
 template <class... Ts> struct JsonFormatMapVisitor : Ts... { using Ts::operator()...; };
 template <class... Ts> JsonFormatMapVisitor(Ts...) -> JsonFormatMapVisitor<Ts...>;
 
+// Appends a value returned by FormatterProvider::format() or FieldExtractor::extract(), for
+// providers without a more direct way to produce it.
+bool appendOptional(const absl::optional<std::string>& value, std::string& output) {
+  if (!value) {
+    return false;
+  }
+  output.append(value.value());
+  return true;
+}
+
+// Whether c is escaped in JSON strings. These are the ASCII characters the protobuf JSON printer
+// escapes, so that both ways of writing JSON log lines agree on ASCII input.
+bool needsJsonEscape(unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\' || c == '<' || c == '>' || c == 0x7f;
+}
+
+void appendJsonEscaped(absl::string_view value, std::string& output) {
+  size_t start = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    const unsigned char c = value[i];
+    if (!needsJsonEscape(c)) {
+      continue;
+    }
+    output.append(value.data() + start, i - start);
+    start = i + 1;
+    switch (c) {
+    case '"':
+      output.append("\\\"");
+      break;
+    case '\\':
+      output.append("\\\\");
+      break;
+    case '\b':
+      output.append("\\b");
+      break;
+    case '\f':
+      output.append("\\f");
+      break;
+    case '\n':
+      output.append("\\n");
+      break;
+    case '\r':
+      output.append("\\r");
+      break;
+    case '\t':
+      output.append("\\t");
+      break;
+    default:
+      absl::StrAppendFormat(&output, "\\u%04x", static_cast<uint32_t>(c));
+    }
+  }
+  output.append(value.data() + start, value.size() - start);
+}
+
+// Escapes, in place, what was appended to output since start.
+void escapeJsonFrom(size_t start, std::string& output) {
+  const absl::string_view appended = absl::string_view(output).substr(start);
+  if (std::none_of(appended.begin(), appended.end(),
+                   [](char c) { return needsJsonEscape(c); })) {
+    return;
+  }
+  const std::string raw(appended);
+  output.resize(start);
+  appendJsonEscaped(raw, output);
+}
+
+void appendJsonValue(const ProtobufWkt::Value& value, std::string& output) {
+  switch (value.kind_case()) {
+  case ProtobufWkt::Value::kNullValue:
+    output.append("null");
+    return;
+  case ProtobufWkt::Value::kBoolValue:
+    output.append(value.bool_value() ? "true" : "false");
+    return;
+  case ProtobufWkt::Value::kStringValue:
+    output.push_back('"');
+    appendJsonEscaped(value.string_value(), output);
+    output.push_back('"');
+    return;
+  case ProtobufWkt::Value::kNumberValue: {
+    // Integers, such as durations and byte counts, are printed as the protobuf JSON printer would.
+    const double number = value.number_value();
+    if (std::abs(number) < 1e15 && number == std::trunc(number) &&
+        !(number == 0 && std::signbit(number))) {
+      const fmt::format_int formatted(static_cast<int64_t>(number));
+      output.append(formatted.data(), formatted.size());
+      return;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  output.append(MessageUtil::getJsonStringFromMessage(value, false, true));
+}
+
 } // namespace
 
 const std::string SubstitutionFormatUtils::DEFAULT_FORMAT =
@@ -120,14 +219,22 @@ std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                   absl::string_view local_reply_body) const {
   std::string log_line;
   log_line.reserve(256);
+  formatTo(request_headers, response_headers, response_trailers, stream_info, local_reply_body,
+           log_line);
+  return log_line;
+}
 
+void FormatterImpl::formatTo(const Http::RequestHeaderMap& request_headers,
+                             const Http::ResponseHeaderMap& response_headers,
+                             const Http::ResponseTrailerMap& response_trailers,
+                             const StreamInfo::StreamInfo& stream_info,
+                             absl::string_view local_reply_body, std::string& output) const {
   for (const FormatterProviderPtr& provider : providers_) {
-    const auto bit = provider->format(request_headers, response_headers, response_trailers,
-                                      stream_info, local_reply_body);
-    log_line += bit.value_or(empty_value_string_);
+    if (!provider->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                            local_reply_body, output)) {
+      output.append(empty_value_string_);
+    }
   }
-
-  return log_line;
 }
 
 std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_headers,
@@ -135,11 +242,104 @@ std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_head
                                       const Http::ResponseTrailerMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info,
                                       absl::string_view local_reply_body) const {
-  const auto output_struct =
-      toStruct(request_headers, response_headers, response_trailers, stream_info, local_reply_body);
+  std::string log_line;
+  formatTo(request_headers, response_headers, response_trailers, stream_info, local_reply_body,
+           log_line);
+  return log_line;
+}
+
+void JsonFormatterImpl::formatTo(const Http::RequestHeaderMap& request_headers,
+                                 const Http::ResponseHeaderMap& response_headers,
+                                 const Http::ResponseTrailerMap& response_trailers,
+                                 const StreamInfo::StreamInfo& stream_info,
+                                 absl::string_view local_reply_body, std::string& output) const {
+  if (!direct_write_) {
+    const auto output_struct = toStruct(request_headers, response_headers, response_trailers,
+                                        stream_info, local_reply_body);
+    absl::StrAppend(&output, MessageUtil::getJsonStringFromMessage(output_struct, false, true),
+                    "\n");
+    return;
+  }
+
+  writeStruct(json_output_format_, request_headers, response_headers, response_trailers,
+              stream_info, local_reply_body, output);
+  output.push_back('\n');
+}
+
+void JsonFormatterImpl::writeStruct(const JsonFormatMapWrapper& format,
+                                    const Http::RequestHeaderMap& request_headers,
+                                    const Http::ResponseHeaderMap& response_headers,
+                                    const Http::ResponseTrailerMap& response_trailers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    absl::string_view local_reply_body, std::string& output) const {
+  output.push_back('{');
+  bool first = true;
+  for (const auto& pair : *format.value_) {
+    const size_t start = output.size();
+    if (!first) {
+      output.push_back(',');
+    }
+    output.push_back('"');
+    appendJsonEscaped(pair.first, output);
+    output.append("\":");
+    if (absl::holds_alternative<const JsonFormatMapWrapper>(pair.second)) {
+      writeStruct(absl::get<const JsonFormatMapWrapper>(pair.second), request_headers,
+                  response_headers, response_trailers, stream_info, local_reply_body, output);
+    } else if (!writeValue(absl::get<const std::vector<FormatterProviderPtr>>(pair.second),
+                           request_headers, response_headers, response_trailers, stream_info,
+                           local_reply_body, output)) {
+      output.resize(start);
+      continue;
+    }
+    first = false;
+  }
+  output.push_back('}');
+}
+
+bool JsonFormatterImpl::writeValue(const std::vector<FormatterProviderPtr>& providers,
+                                   const Http::RequestHeaderMap& request_headers,
+                                   const Http::ResponseHeaderMap& response_headers,
+                                   const Http::ResponseTrailerMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   absl::string_view local_reply_body, std::string& output) const {
+  ASSERT(!providers.empty());
+  if (providers.size() == 1 && preserve_types_) {
+    const ProtobufWkt::Value value =
+        providers.front()->formatValue(request_headers, response_headers, response_trailers,
+                                       stream_info, local_reply_body);
+    if (omit_empty_values_ && value.kind_case() == ProtobufWkt::Value::kNullValue) {
+      return false;
+    }
+    appendJsonValue(value, output);
+    return true;
+  }
 
-  const std::string log_line = MessageUtil::getJsonStringFromMessage(output_struct, false, true);
-  return absl::StrCat(log_line, "\n");
+  // Values are appended as they are produced, then escaped in place.
+  output.push_back('"');
+  const size_t start = output.size();
+  if (providers.size() == 1) {
+    if (!providers.front()->formatTo(request_headers, response_headers, response_trailers,
+                                     stream_info, local_reply_body, output)) {
+      if (omit_empty_values_) {
+        output.pop_back();
+        return false;
+      }
+      output.append(DefaultUnspecifiedValueString);
+    }
+  } else {
+    // Multiple providers forces string output.
+    const std::string& empty_value =
+        omit_empty_values_ ? EMPTY_STRING : DefaultUnspecifiedValueString;
+    for (const auto& provider : providers) {
+      if (!provider->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                              local_reply_body, output)) {
+        output.append(empty_value);
+      }
+    }
+  }
+  escapeJsonFrom(start, output);
+  output.push_back('"');
+  return true;
 }
 
 JsonFormatterImpl::JsonFormatMapWrapper
@@ -412,6 +612,9 @@ public:
   absl::optional<std::string> extract(const StreamInfo::StreamInfo& stream_info) const override {
     return field_extractor_(stream_info);
   }
+  bool extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    return appendOptional(field_extractor_(stream_info), output);
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::optionalStringValue(field_extractor_(stream_info));
   }
@@ -437,6 +640,16 @@ public:
 
     return fmt::format_int(millis.value()).str();
   }
+  bool extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const auto millis = extractMillis(stream_info);
+    if (!millis) {
+      return false;
+    }
+
+    const fmt::format_int formatted(millis.value());
+    output.append(formatted.data(), formatted.size());
+    return true;
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     const auto millis = extractMillis(stream_info);
     if (!millis) {
@@ -469,6 +682,11 @@ public:
   absl::optional<std::string> extract(const StreamInfo::StreamInfo& stream_info) const override {
     return fmt::format_int(field_extractor_(stream_info)).str();
   }
+  bool extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const fmt::format_int formatted(field_extractor_(stream_info));
+    output.append(formatted.data(), formatted.size());
+    return true;
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::numberValue(field_extractor_(stream_info));
   }
@@ -511,6 +729,19 @@ public:
 
     return toString(*address);
   }
+  bool extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
+    if (!address) {
+      return false;
+    }
+
+    if (extraction_type_ == StreamInfoFormatter::StreamInfoAddressFieldExtractionType::WithPort) {
+      output.append(address->asString());
+    } else {
+      output.append(toString(*address));
+    }
+    return true;
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
     if (!address) {
@@ -557,6 +788,9 @@ public:
 
     return value;
   }
+  bool extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    return appendOptional(extract(stream_info), output);
+  }
 
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     if (stream_info.downstreamSslConnection() == nullptr) {
@@ -816,6 +1050,13 @@ absl::optional<std::string> StreamInfoFormatter::format(const Http::RequestHeade
   return field_extractor_->extract(stream_info);
 }
 
+bool StreamInfoFormatter::formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                                   const Http::ResponseTrailerMap&,
+                                   const StreamInfo::StreamInfo& stream_info, absl::string_view,
+                                   std::string& output) const {
+  return field_extractor_->extractTo(stream_info, output);
+}
+
 ProtobufWkt::Value StreamInfoFormatter::formatValue(const Http::RequestHeaderMap&,
                                                     const Http::ResponseHeaderMap&,
                                                     const Http::ResponseTrailerMap&,
@@ -834,6 +1075,13 @@ absl::optional<std::string> PlainStringFormatter::format(const Http::RequestHead
   return str_.string_value();
 }
 
+bool PlainStringFormatter::formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                                    const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
+                                    absl::string_view, std::string& output) const {
+  output.append(str_.string_value());
+  return true;
+}
+
 ProtobufWkt::Value PlainStringFormatter::formatValue(const Http::RequestHeaderMap&,
                                                      const Http::ResponseHeaderMap&,
                                                      const Http::ResponseTrailerMap&,
@@ -849,6 +1097,16 @@ LocalReplyBodyFormatter::format(const Http::RequestHeaderMap&, const Http::Respo
   return std::string(local_reply_body);
 }
 
+bool LocalReplyBodyFormatter::formatTo(const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap&,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&,
+                                       absl::string_view local_reply_body,
+                                       std::string& output) const {
+  output.append(local_reply_body.data(), local_reply_body.size());
+  return true;
+}
+
 ProtobufWkt::Value LocalReplyBodyFormatter::formatValue(const Http::RequestHeaderMap&,
                                                         const Http::ResponseHeaderMap&,
                                                         const Http::ResponseTrailerMap&,
@@ -883,6 +1141,20 @@ absl::optional<std::string> HeaderFormatter::format(const Http::HeaderMap& heade
   return val;
 }
 
+bool HeaderFormatter::formatTo(const Http::HeaderMap& headers, std::string& output) const {
+  const Http::HeaderEntry* header = findHeader(headers);
+  if (!header) {
+    return false;
+  }
+
+  absl::string_view val = header->value().getStringView();
+  if (max_length_) {
+    val = val.substr(0, max_length_.value());
+  }
+  output.append(val.data(), val.size());
+  return true;
+}
+
 ProtobufWkt::Value HeaderFormatter::formatValue(const Http::HeaderMap& headers) const {
   const Http::HeaderEntry* header = findHeader(headers);
   if (!header) {
@@ -905,6 +1177,14 @@ absl::optional<std::string> ResponseHeaderFormatter::format(
   return HeaderFormatter::format(response_headers);
 }
 
+bool ResponseHeaderFormatter::formatTo(const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap& response_headers,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&, absl::string_view,
+                                       std::string& output) const {
+  return HeaderFormatter::formatTo(response_headers, output);
+}
+
 ProtobufWkt::Value ResponseHeaderFormatter::formatValue(
     const Http::RequestHeaderMap&, const Http::ResponseHeaderMap& response_headers,
     const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view) const {
@@ -923,6 +1203,14 @@ RequestHeaderFormatter::format(const Http::RequestHeaderMap& request_headers,
   return HeaderFormatter::format(request_headers);
 }
 
+bool RequestHeaderFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                      const Http::ResponseHeaderMap&,
+                                      const Http::ResponseTrailerMap&,
+                                      const StreamInfo::StreamInfo&, absl::string_view,
+                                      std::string& output) const {
+  return HeaderFormatter::formatTo(request_headers, output);
+}
+
 ProtobufWkt::Value
 RequestHeaderFormatter::formatValue(const Http::RequestHeaderMap& request_headers,
                                     const Http::ResponseHeaderMap&, const Http::ResponseTrailerMap&,
@@ -942,6 +1230,14 @@ ResponseTrailerFormatter::format(const Http::RequestHeaderMap&, const Http::Resp
   return HeaderFormatter::format(response_trailers);
 }
 
+bool ResponseTrailerFormatter::formatTo(const Http::RequestHeaderMap&,
+                                        const Http::ResponseHeaderMap&,
+                                        const Http::ResponseTrailerMap& response_trailers,
+                                        const StreamInfo::StreamInfo&, absl::string_view,
+                                        std::string& output) const {
+  return HeaderFormatter::formatTo(response_trailers, output);
+}
+
 ProtobufWkt::Value
 ResponseTrailerFormatter::formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                       const Http::ResponseTrailerMap& response_trailers,
@@ -971,6 +1267,16 @@ GrpcStatusFormatter::format(const Http::RequestHeaderMap&,
   return grpc_status_message;
 }
 
+bool GrpcStatusFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                   const Http::ResponseHeaderMap& response_headers,
+                                   const Http::ResponseTrailerMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   absl::string_view local_reply_body, std::string& output) const {
+  return appendOptional(format(request_headers, response_headers, response_trailers, stream_info,
+                               local_reply_body),
+                        output);
+}
+
 ProtobufWkt::Value
 GrpcStatusFormatter::formatValue(const Http::RequestHeaderMap&,
                                  const Http::ResponseHeaderMap& response_headers,
@@ -1038,6 +1344,17 @@ absl::optional<std::string> DynamicMetadataFormatter::format(
   return MetadataFormatter::formatMetadata(stream_info.dynamicMetadata());
 }
 
+bool DynamicMetadataFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                        const Http::ResponseHeaderMap& response_headers,
+                                        const Http::ResponseTrailerMap& response_trailers,
+                                        const StreamInfo::StreamInfo& stream_info,
+                                        absl::string_view local_reply_body,
+                                        std::string& output) const {
+  return appendOptional(format(request_headers, response_headers, response_trailers, stream_info,
+                               local_reply_body),
+                        output);
+}
+
 ProtobufWkt::Value DynamicMetadataFormatter::formatValue(const Http::RequestHeaderMap&,
                                                          const Http::ResponseHeaderMap&,
                                                          const Http::ResponseTrailerMap&,
@@ -1096,6 +1413,16 @@ absl::optional<std::string> FilterStateFormatter::format(const Http::RequestHead
   return value;
 }
 
+bool FilterStateFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                    const Http::ResponseHeaderMap& response_headers,
+                                    const Http::ResponseTrailerMap& response_trailers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    absl::string_view local_reply_body, std::string& output) const {
+  return appendOptional(format(request_headers, response_headers, response_trailers, stream_info,
+                               local_reply_body),
+                        output);
+}
+
 ProtobufWkt::Value FilterStateFormatter::formatValue(const Http::RequestHeaderMap&,
                                                      const Http::ResponseHeaderMap&,
                                                      const Http::ResponseTrailerMap&,
@@ -1142,6 +1469,16 @@ absl::optional<std::string> StartTimeFormatter::format(const Http::RequestHeader
   return date_formatter_.fromTime(stream_info.startTime());
 }
 
+bool StartTimeFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                  const Http::ResponseHeaderMap& response_headers,
+                                  const Http::ResponseTrailerMap& response_trailers,
+                                  const StreamInfo::StreamInfo& stream_info,
+                                  absl::string_view local_reply_body, std::string& output) const {
+  return appendOptional(format(request_headers, response_headers, response_trailers, stream_info,
+                               local_reply_body),
+                        output);
+}
+
 ProtobufWkt::Value StartTimeFormatter::formatValue(
     const Http::RequestHeaderMap& request_headers, const Http::ResponseHeaderMap& response_headers,
     const Http::ResponseTrailerMap& response_trailers, const StreamInfo::StreamInfo& stream_info,
@@ -10,6 +10,7 @@
 #include "envoy/stream_info/stream_info.h"
 
 #include "common/common/utility.h"
+#include "common/runtime/runtime_features.h"
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
@@ -101,6 +102,11 @@ public:
                      const Http::ResponseTrailerMap& response_trailers,
                      const StreamInfo::StreamInfo& stream_info,
                      absl::string_view local_reply_body) const override;
+  void formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
 
 private:
   const std::string& empty_value_string_;
@@ -112,6 +118,8 @@ public:
   JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
                     bool omit_empty_values)
       : omit_empty_values_(omit_empty_values), preserve_types_(preserve_types),
+        direct_write_(Runtime::runtimeFeatureEnabled(
+            "envoy.reloadable_features.json_formatter_direct_write")),
         json_output_format_(toFormatMap(format_mapping)) {}
 
   // Formatter::format
@@ -120,6 +128,11 @@ public:
                      const Http::ResponseTrailerMap& response_trailers,
                      const StreamInfo::StreamInfo& stream_info,
                      absl::string_view local_reply_body) const override;
+  void formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
 
 private:
   struct JsonFormatMapWrapper;
@@ -135,8 +148,24 @@ private:
 
   bool omit_empty_values_;
   bool preserve_types_;
+  // Whether log lines are written as JSON directly, rather than built as a ProtobufWkt::Struct and
+  // serialized.
+  const bool direct_write_;
   const JsonFormatMapWrapper json_output_format_;
 
+  void writeStruct(const JsonFormatMapWrapper& format,
+                   const Http::RequestHeaderMap& request_headers,
+                   const Http::ResponseHeaderMap& response_headers,
+                   const Http::ResponseTrailerMap& response_trailers,
+                   const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                   std::string& output) const;
+  // Returns false, leaving output unchanged, if the value is omitted.
+  bool writeValue(const std::vector<FormatterProviderPtr>& providers,
+                  const Http::RequestHeaderMap& request_headers,
+                  const Http::ResponseHeaderMap& response_headers,
+                  const Http::ResponseTrailerMap& response_trailers,
+                  const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                  std::string& output) const;
   ProtobufWkt::Struct toStruct(const Http::RequestHeaderMap& request_headers,
                                const Http::ResponseHeaderMap& response_headers,
                                const Http::ResponseTrailerMap& response_trailers,
@@ -157,6 +186,11 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -176,6 +210,11 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view local_reply_body) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view local_reply_body) const override;
@@ -188,6 +227,7 @@ public:
 
 protected:
   absl::optional<std::string> format(const Http::HeaderMap& headers) const;
+  bool formatTo(const Http::HeaderMap& headers, std::string& output) const;
   ProtobufWkt::Value formatValue(const Http::HeaderMap& headers) const;
 
 private:
@@ -211,6 +251,11 @@ public:
                                      const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -229,6 +274,11 @@ public:
                                      const Http::ResponseHeaderMap& response_headers,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -247,6 +297,11 @@ public:
                                      const Http::ResponseTrailerMap& response_trailers,
                                      const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -266,6 +321,11 @@ public:
                                      const Http::ResponseTrailerMap& response_trailers,
                                      const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -282,6 +342,11 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -291,6 +356,8 @@ public:
     virtual ~FieldExtractor() = default;
 
     virtual absl::optional<std::string> extract(const StreamInfo::StreamInfo&) const PURE;
+    // Appends the value extract() would return, if any, and returns whether there was one.
+    virtual bool extractTo(const StreamInfo::StreamInfo&, std::string& output) const PURE;
     virtual ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo&) const PURE;
   };
   using FieldExtractorPtr = std::unique_ptr<FieldExtractor>;
@@ -332,6 +399,11 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -349,6 +421,11 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -374,6 +451,11 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -46,6 +46,9 @@ public:
                                                         transport_api_version);
     Internal::sendMessageUntyped(stream_, std::move(request), end_stream);
   }
+  void sendMessageRaw(Buffer::InstancePtr&& request, bool end_stream) {
+    stream_->sendMessageRaw(std::move(request), end_stream);
+  }
   void closeStream() { stream_->closeStream(); }
   void resetStream() { stream_->resetStream(); }
   bool isAboveWriteBufferHighWatermark() const {
@@ -105,7 +105,8 @@ struct ConnectionManagerStats {
   COUNTER(service_forced)                                                                          \
   COUNTER(client_enabled)                                                                          \
   COUNTER(not_traceable)                                                                           \
-  COUNTER(health_check)
+  COUNTER(health_check)                                                                            \
+  COUNTER(tail_sampled)
 
 /**
  * Wrapper struct for connection manager tracing stats. @see stats_macros.h
@@ -114,6 +115,15 @@ struct ConnectionManagerTracingStats {
   CONN_MAN_TRACING_STATS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * Criteria for tracing requests that were not traced when they started, checked when they complete.
+ */
+struct TracingTailSamplingConfig {
+  absl::optional<std::chrono::milliseconds> min_duration_;
+  bool server_errors_{};
+  bool response_flags_{};
+};
+
 /**
  * Configuration for tracing which is set on the connection manager level.
  * Http Tracing can be enabled/disabled on a per connection manager basis.
@@ -127,6 +137,7 @@ struct TracingConnectionManagerConfig {
   envoy::type::v3::FractionalPercent overall_sampling_;
   bool verbose_;
   uint32_t max_path_tag_length_;
+  absl::optional<TracingTailSamplingConfig> tail_sampling_{};
 };
 
 using TracingConnectionManagerConfigPtr = std::unique_ptr<TracingConnectionManagerConfig>;
@@ -665,6 +665,10 @@ void ConnectionManagerImpl::ActiveStream::completeRequest() {
   }
 
   if (active_span_) {
+    if (state_.tail_sampling_ && shouldTailSample()) {
+      connection_manager_.config_.tracingStats().tail_sampled_.inc();
+      active_span_->setSampled(true);
+    }
     Tracing::HttpTracerUtility::finalizeDownstreamSpan(
         *active_span_, request_headers_.get(), response_headers_.get(), response_trailers_.get(),
         filter_manager_.streamInfo(), *this);
@@ -674,6 +678,21 @@ void ConnectionManagerImpl::ActiveStream::completeRequest() {
   }
 }
 
+bool ConnectionManagerImpl::ActiveStream::shouldTailSample() const {
+  const TracingTailSamplingConfig& config =
+      connection_manager_.config_.tracingConfig()->tail_sampling_.value();
+  const StreamInfo::StreamInfo& stream_info = filter_manager_.streamInfo();
+  if (config.server_errors_ && stream_info.responseCode().has_value() &&
+      CodeUtility::is5xx(stream_info.responseCode().value())) {
+    return true;
+  }
+  if (config.response_flags_ && stream_info.hasAnyResponseFlag()) {
+    return true;
+  }
+  return config.min_duration_.has_value() && stream_info.requestComplete().has_value() &&
+         stream_info.requestComplete().value() >= config.min_duration_.value();
+}
+
 void ConnectionManagerImpl::ActiveStream::resetIdleTimer() {
   if (stream_idle_timer_ != nullptr) {
     // TODO(htuch): If this shows up in performance profiles, optimize by only
@@ -1032,6 +1051,14 @@ void ConnectionManagerImpl::ActiveStream::traceRequest() {
       Tracing::HttpTracerUtility::isTracing(filter_manager_.streamInfo(), *request_headers_);
   ConnectionManagerImpl::chargeTracingStats(tracing_decision.reason,
                                             connection_manager_.config_.tracingStats());
+  // Health checks are never traced, and requests are only tail sampled by the tracers that record
+  // their spans until they complete.
+  if (!tracing_decision.traced && tracing_decision.reason != Tracing::Reason::HealthCheck &&
+      connection_manager_.config_.tracingConfig()->tail_sampling_.has_value() &&
+      connection_manager_.tracer().supportsTailSampling()) {
+    tracing_decision.tail_sampling = true;
+    state_.tail_sampling_ = true;
+  }
 
   active_span_ = connection_manager_.tracer().startSpan(
       *this, *request_headers_, filter_manager_.streamInfo(), tracing_decision);
@@ -296,7 +296,8 @@ private:
     struct State {
       State()
           : codec_saw_local_complete_(false), saw_connection_close_(false),
-            successful_upgrade_(false), is_internally_created_(false), decorated_propagate_(true) {}
+            successful_upgrade_(false), is_internally_created_(false), decorated_propagate_(true),
+            tail_sampling_(false) {}
 
       bool codec_saw_local_complete_ : 1; // This indicates that local is complete as written all
                                           // the way through to the codec.
@@ -308,8 +309,13 @@ private:
       bool is_internally_created_ : 1;
 
       bool decorated_propagate_ : 1;
+
+      // True if the request was not traced when it started, but may be when it completes.
+      bool tail_sampling_ : 1;
     };
 
+    // Whether a request that may be traced when it completes should be.
+    bool shouldTailSample() const;
     // Per-stream idle timeout callback.
     void onIdleTimeout();
     // Per-stream request timeout callback.
@@ -28,6 +28,18 @@ namespace Envoy {
 namespace Http {
 namespace Http2 {
 
+namespace {
+
+// Received DATA payloads at least this large reference the input slice they arrived in rather than
+// being copied into the stream's buffer. This bounds the memory a stream can pin beyond what it has
+// buffered to about twice its buffer, as input slices are at most 16KiB.
+constexpr size_t ZeroCopyDataMinBytes = 8 * 1024;
+
+// The number of pending send data slices examined when aligning a DATA frame to a slice boundary.
+constexpr uint64_t DataFrameAlignmentMaxSlices = 16;
+
+} // namespace
+
 // Changes or additions to details should be reflected in
 // docs/root/configuration/http/http_conn_man/response_code_details_details.rst
 class Http2ResponseCodeDetailValues {
@@ -403,7 +415,24 @@ ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t*
       }
     }
 
-    return std::min(length, pending_send_data_.length());
+    uint64_t frame_length = std::min(length, pending_send_data_.length());
+    if (parent_.zero_copy_data_ && frame_length < pending_send_data_.length()) {
+      // onDataSourceSend() moves whole slices into the connection's output without copying them,
+      // but has to copy the head of a slice the frame ends part way through. End the frame at the
+      // last slice boundary instead, unless that would make it less than half as long.
+      uint64_t slice_boundary = 0;
+      for (const Buffer::RawSlice& slice :
+           pending_send_data_.getRawSlices(DataFrameAlignmentMaxSlices)) {
+        if (slice_boundary + slice.len_ > frame_length) {
+          break;
+        }
+        slice_boundary += slice.len_;
+      }
+      if (slice_boundary > 0 && slice_boundary >= frame_length / 2) {
+        frame_length = slice_boundary;
+      }
+    }
+    return frame_length;
   }
 }
 
@@ -564,6 +593,8 @@ ConnectionImpl::ConnectionImpl(Network::Connection& connection, CodecStats& stat
       protocol_constraints_(stats, http2_options),
       skip_encoding_empty_trailers_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.http2_skip_encoding_empty_trailers")),
+      zero_copy_data_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http2_zero_copy_data")),
       dispatching_(false), raised_goaway_(false), pending_deferred_reset_(false),
       random_(random_generator) {
   if (http2_options.has_connection_keepalive()) {
@@ -641,36 +672,58 @@ Http::Status ConnectionImpl::innerDispatch(Buffer::Instance& data) {
   // Make sure that dispatching_ is set to false after dispatching, even when
   // ConnectionImpl::dispatch returns early or throws an exception (consider removing if there is a
   // single return after exception removal (#10878)).
-  Cleanup cleanup([this]() { dispatching_ = false; });
-  for (const Buffer::RawSlice& slice : data.getRawSlices()) {
-    dispatching_ = true;
-    ssize_t rc =
-        nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
-    if (!nghttp2_callback_status_.ok()) {
-      return nghttp2_callback_status_;
-    }
-    // This error is returned when nghttp2 library detected a frame flood by one of its
-    // internal mechanisms. Most flood protection is done by Envoy's codec and this error
-    // should never be returned. However it is handled here in case nghttp2 has some flood
-    // protections that Envoy's codec does not have.
-    if (rc == NGHTTP2_ERR_FLOODED) {
-      return bufferFloodError(
-          "Flooding was detected in this HTTP/2 session, and it must be closed");
+  Cleanup cleanup([this]() {
+    dispatching_ = false;
+    dispatching_slice_.reset();
+  });
+  const uint64_t dispatched_length = data.length();
+  if (zero_copy_data_) {
+    while (data.length() > 0) {
+      // Take ownership of each input slice while nghttp2 parses it, so that the DATA payloads in it
+      // can be handed to streams without a copy. See onData().
+      dispatching_slice_ = data.extractMutableFrontSlice();
+      const absl::Span<uint8_t> slice = dispatching_slice_->getMutableData();
+      RETURN_IF_ERROR(dispatchSlice(slice.data(), slice.size()));
+      dispatching_slice_.reset();
     }
-    if (rc != static_cast<ssize_t>(slice.len_)) {
-      return codecProtocolError(nghttp2_strerror(rc));
+  } else {
+    for (const Buffer::RawSlice& slice : data.getRawSlices()) {
+      RETURN_IF_ERROR(dispatchSlice(static_cast<const uint8_t*>(slice.mem_), slice.len_));
     }
-
-    dispatching_ = false;
+    data.drain(data.length());
   }
 
-  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
-  data.drain(data.length());
+  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, dispatched_length);
 
   // Decoding incoming frames can generate outbound frames so flush pending.
   return sendPendingFrames();
 }
 
+Http::Status ConnectionImpl::dispatchSlice(const uint8_t* data, size_t len) {
+  dispatching_ = true;
+  ssize_t rc = nghttp2_session_mem_recv(session_, data, len);
+  if (!nghttp2_callback_status_.ok()) {
+    return nghttp2_callback_status_;
+  }
+  // This error is returned when nghttp2 library detected a frame flood by one of its
+  // internal mechanisms. Most flood protection is done by Envoy's codec and this error
+  // should never be returned. However it is handled here in case nghttp2 has some flood
+  // protections that Envoy's codec does not have.
+  if (rc == NGHTTP2_ERR_FLOODED) {
+    return bufferFloodError("Flooding was detected in this HTTP/2 session, and it must be closed");
+  }
+  if (rc != static_cast<ssize_t>(len)) {
+    return codecProtocolError(nghttp2_strerror(rc));
+  }
+  dispatching_ = false;
+  return okStatus();
+}
+
+bool ConnectionImpl::inDispatchingSlice(const uint8_t* data, size_t len) const {
+  const absl::Span<uint8_t> slice = dispatching_slice_->getMutableData();
+  return data >= slice.data() && data + len <= slice.data() + slice.size();
+}
+
 ConnectionImpl::StreamImpl* ConnectionImpl::getStream(int32_t stream_id) {
   return static_cast<StreamImpl*>(nghttp2_session_get_stream_user_data(session_, stream_id));
 }
@@ -679,7 +732,21 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   StreamImpl* stream = getStream(stream_id);
   // If this results in buffering too much data, the watermark buffer will call
   // pendingRecvBufferHighWatermark, resulting in ++read_disable_count_
-  stream->pending_recv_data_.add(data, len);
+  if (zero_copy_data_ && len >= ZeroCopyDataMinBytes && dispatching_slice_ != nullptr &&
+      inDispatchingSlice(data, len)) {
+    // nghttp2 passes DATA payloads straight out of the input it is parsing, so reference the input
+    // slice rather than copying the payload.
+    auto* fragment = new Buffer::BufferFragmentImpl(
+        data, len,
+        [slice = dispatching_slice_](const void*, size_t,
+                                     const Buffer::BufferFragmentImpl* fragment) mutable {
+          slice.reset();
+          delete fragment;
+        });
+    stream->pending_recv_data_.addBufferFragment(*fragment);
+  } else {
+    stream->pending_recv_data_.add(data, len);
+  }
   // Update the window to the peer unless some consumer of this stream's data has hit a flow control
   // limit and disabled reads on this stream
   if (!stream->buffersOverrun()) {
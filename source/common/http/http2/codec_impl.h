@@ -514,10 +514,18 @@ protected:
   // flag.
   const bool skip_encoding_empty_trailers_;
 
+  // Whether DATA payloads are moved between the connection and stream buffers without copying them.
+  // This is controlled by the "envoy.reloadable_features.http2_zero_copy_data" runtime feature
+  // flag.
+  const bool zero_copy_data_;
+
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
   virtual Status onBeginHeaders(const nghttp2_frame* frame) PURE;
+  // Passes a slice of input to nghttp2.
+  Http::Status dispatchSlice(const uint8_t* data, size_t len);
   int onData(int32_t stream_id, const uint8_t* data, size_t len);
+  bool inDispatchingSlice(const uint8_t* data, size_t len) const;
   Status onBeforeFrameReceived(const nghttp2_frame_hd* hd);
   Status onFrameReceived(const nghttp2_frame* frame);
   int onBeforeFrameSend(const nghttp2_frame* frame);
@@ -542,6 +550,9 @@ private:
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
+  // The input slice currently being dispatched to nghttp2. Large DATA payloads received from it
+  // keep it alive instead of being copied out of it.
+  std::shared_ptr<Buffer::SliceData> dispatching_slice_;
   Event::SchedulableCallbackPtr protocol_constraint_violation_callback_;
   Random::RandomGenerator& random_;
   Event::TimerPtr keepalive_send_timer_;
@@ -279,6 +279,16 @@ public:
       checkForUnexpectedFields(message, validation_visitor);
     }
 
+    validateConstraints(message);
+  }
+
+  /**
+   * Validate only the protoc-gen-validate constraints on a given protobuf. Unlike validate(), this
+   * does not consult runtime or a validation visitor, so it may be called from any thread.
+   * @param message message to validate.
+   * @throw ProtoValidationException if the message does not satisfy its type constraints.
+   */
+  template <class MessageType> static void validateConstraints(const MessageType& message) {
     std::string err;
     if (!Validate(message, &err)) {
       ProtoExceptionUtil::throwProtoValidationException(err, API_RECOVER_ORIGINAL(message));
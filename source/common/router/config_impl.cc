@@ -1072,7 +1072,7 @@ RouteConstSharedPtr ConnectRouteEntryImpl::matches(const Http::RequestHeaderMap&
 }
 
 VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& virtual_host,
-                                 const ConfigImpl& global_route_config,
+                                 const CommonConfigImplSharedPtr& global_route_config,
                                  Server::Configuration::ServerFactoryContext& factory_context,
                                  Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validator,
                                  bool validate_clusters)
@@ -1191,7 +1191,7 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 }
 
-const Config& VirtualHostImpl::routeConfig() const { return global_route_config_; }
+const CommonConfig& VirtualHostImpl::routeConfig() const { return *global_route_config_; }
 
 const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::string& name) const {
   return per_filter_configs_.get(name);
@@ -1220,14 +1220,35 @@ const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
 }
 
 RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& route_config,
-                           const ConfigImpl& global_route_config,
+                           const CommonConfigImplSharedPtr& global_route_config,
                            Server::Configuration::ServerFactoryContext& factory_context,
-                           ProtobufMessage::ValidationVisitor& validator, bool validate_clusters)
+                           ProtobufMessage::ValidationVisitor& validator, bool validate_clusters,
+                           const RouteMatcher* previous_matcher)
     : vhost_scope_(factory_context.scope().createScope("vhost")) {
+  // Cluster validation depends on the current state of the cluster manager, so a virtual host
+  // that was built without it, or against a different set of clusters, cannot be reused.
+  if (validate_clusters) {
+    previous_matcher = nullptr;
+  }
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
-                                                          factory_context, *vhost_scope_, validator,
-                                                          validate_clusters));
+    const uint64_t virtual_host_hash = MessageUtil::hash(virtual_host_config);
+    VirtualHostSharedPtr virtual_host;
+    if (previous_matcher != nullptr) {
+      const auto previous_it = previous_matcher->virtual_hosts_by_hash_.find(virtual_host_hash);
+      if (previous_it != previous_matcher->virtual_hosts_by_hash_.end() &&
+          Protobuf::util::MessageDifferencer::Equals(previous_it->second.config_,
+                                                     virtual_host_config)) {
+        virtual_host = previous_it->second.virtual_host_;
+        reused_virtual_hosts_++;
+      }
+    }
+    if (virtual_host == nullptr) {
+      virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                       factory_context, *vhost_scope_, validator,
+                                                       validate_clusters);
+    }
+    virtual_hosts_by_hash_.emplace(virtual_host_hash,
+                                   HashedVirtualHost{virtual_host_config, virtual_host});
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const std::string domain = Http::LowerCaseString(domain_name).get();
       bool duplicate_found = false;
@@ -1380,25 +1401,61 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
   return nullptr;
 }
 
-ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
-                       Server::Configuration::ServerFactoryContext& factory_context,
-                       ProtobufMessage::ValidationVisitor& validator,
-                       bool validate_clusters_default)
-    : name_(config.name()), symbol_table_(factory_context.scope().symbolTable()),
-      uses_vhds_(config.has_vhds()),
-      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()) {
-  route_matcher_ = std::make_unique<RouteMatcher>(
-      config, *this, factory_context, validator,
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default));
+namespace {
+
+// Returns the RouteConfiguration level fields consumed by CommonConfigImpl, without the (possibly
+// very large) virtual hosts, so that they can be hashed cheaply.
+envoy::config::route::v3::RouteConfiguration
+commonConfigFields(const envoy::config::route::v3::RouteConfiguration& config) {
+  envoy::config::route::v3::RouteConfiguration common_config;
+  common_config.set_name(config.name());
+  *common_config.mutable_internal_only_headers() = config.internal_only_headers();
+  *common_config.mutable_request_headers_to_add() = config.request_headers_to_add();
+  *common_config.mutable_request_headers_to_remove() = config.request_headers_to_remove();
+  *common_config.mutable_response_headers_to_add() = config.response_headers_to_add();
+  *common_config.mutable_response_headers_to_remove() = config.response_headers_to_remove();
+  common_config.set_most_specific_header_mutations_wins(
+      config.most_specific_header_mutations_wins());
+  if (config.has_vhds()) {
+    *common_config.mutable_vhds() = config.vhds();
+  }
+  return common_config;
+}
+
+} // namespace
 
+CommonConfigImpl::CommonConfigImpl(const envoy::config::route::v3::RouteConfiguration& config)
+    : request_headers_parser_(HeaderParser::configure(config.request_headers_to_add(),
+                                                      config.request_headers_to_remove())),
+      response_headers_parser_(HeaderParser::configure(config.response_headers_to_add(),
+                                                       config.response_headers_to_remove())),
+      name_(config.name()), uses_vhds_(config.has_vhds()),
+      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()),
+      hash_(MessageUtil::hash(commonConfigFields(config))) {
   for (const std::string& header : config.internal_only_headers()) {
     internal_only_headers_.push_back(Http::LowerCaseString(header));
   }
+}
+
+ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
+                       Server::Configuration::ServerFactoryContext& factory_context,
+                       ProtobufMessage::ValidationVisitor& validator,
+                       bool validate_clusters_default, const ConfigImpl* previous_config)
+    : common_config_(std::make_shared<CommonConfigImpl>(config)) {
+  // Virtual hosts can only be shared with the previous version of the route configuration if the
+  // RouteConfiguration level settings they refer to are unchanged. In that case the previous
+  // settings object is kept so that shared and newly built virtual hosts refer to the same one.
+  const RouteMatcher* previous_matcher = nullptr;
+  if (previous_config != nullptr &&
+      previous_config->common_config_->hash() == common_config_->hash()) {
+    common_config_ = previous_config->common_config_;
+    previous_matcher = previous_config->route_matcher_.get();
+  }
 
-  request_headers_parser_ =
-      HeaderParser::configure(config.request_headers_to_add(), config.request_headers_to_remove());
-  response_headers_parser_ = HeaderParser::configure(config.response_headers_to_add(),
-                                                     config.response_headers_to_remove());
+  route_matcher_ = std::make_unique<RouteMatcher>(
+      config, common_config_, factory_context, validator,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default),
+      previous_matcher);
 }
 
 RouteConstSharedPtr ConfigImpl::route(const RouteCallback& cb,
@@ -31,6 +31,7 @@
 #include "common/router/tls_context_match_criteria_impl.h"
 #include "common/stats/symbol_table_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/types/optional.h"
 
@@ -153,14 +154,54 @@ private:
   const bool legacy_enabled_;
 };
 
-class ConfigImpl;
+/**
+ * Holds the RouteConfiguration level settings that are shared by all virtual hosts of a route
+ * configuration. Virtual hosts hold a shared reference to this object rather than to the owning
+ * ConfigImpl so that an unchanged virtual host can be reused by the next version of the same
+ * route configuration.
+ */
+class CommonConfigImpl : public CommonConfig {
+public:
+  CommonConfigImpl(const envoy::config::route::v3::RouteConfiguration& config);
+
+  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
+  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+
+  /**
+   * @return uint64_t a hash of the RouteConfiguration fields this object was built from. Two
+   *         objects with the same hash are interchangeable.
+   */
+  uint64_t hash() const { return hash_; }
+
+  // Router::CommonConfig
+  const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
+    return internal_only_headers_;
+  }
+  const std::string& name() const override { return name_; }
+  bool usesVhds() const override { return uses_vhds_; }
+  bool mostSpecificHeaderMutationsWins() const override {
+    return most_specific_header_mutations_wins_;
+  }
+
+private:
+  std::list<Http::LowerCaseString> internal_only_headers_;
+  HeaderParserPtr request_headers_parser_;
+  HeaderParserPtr response_headers_parser_;
+  const std::string name_;
+  const bool uses_vhds_;
+  const bool most_specific_header_mutations_wins_;
+  const uint64_t hash_;
+};
+
+using CommonConfigImplSharedPtr = std::shared_ptr<const CommonConfigImpl>;
+
 /**
  * Holds all routing configuration for an entire virtual host.
  */
 class VirtualHostImpl : public VirtualHost {
 public:
   VirtualHostImpl(const envoy::config::route::v3::VirtualHost& virtual_host,
-                  const ConfigImpl& global_route_config,
+                  const CommonConfigImplSharedPtr& global_route_config,
                   Server::Configuration::ServerFactoryContext& factory_context, Stats::Scope& scope,
                   ProtobufMessage::ValidationVisitor& validator, bool validate_clusters);
 
@@ -169,7 +210,7 @@ public:
                                           const StreamInfo::StreamInfo& stream_info,
                                           uint64_t random_value) const;
   const VirtualCluster* virtualClusterFromEntries(const Http::HeaderMap& headers) const;
-  const ConfigImpl& globalRouteConfig() const { return global_route_config_; }
+  const CommonConfigImpl& globalRouteConfig() const { return *global_route_config_; }
   const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; }
   const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; }
 
@@ -177,7 +218,7 @@ public:
   const CorsPolicy* corsPolicy() const override { return cors_policy_.get(); }
   Stats::StatName statName() const override { return stat_name_; }
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
-  const Config& routeConfig() const override;
+  const CommonConfig& routeConfig() const override;
   const RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override;
   bool includeAttemptCountInRequest() const override { return include_attempt_count_in_request_; }
   bool includeAttemptCountInResponse() const override { return include_attempt_count_in_response_; }
@@ -229,8 +270,7 @@ private:
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
   std::unique_ptr<const CorsPolicyImpl> cors_policy_;
-  const ConfigImpl& global_route_config_; // See note in RouteEntryImplBase::clusterEntry() on why
-                                          // raw ref to the top level config is currently safe.
+  const CommonConfigImplSharedPtr global_route_config_;
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
   PerFilterConfigs per_filter_configs_;
@@ -936,16 +976,29 @@ public:
  */
 class RouteMatcher {
 public:
+  /**
+   * @param previous_matcher if not nullptr, the matcher of a previous version of the same route
+   *        configuration. Virtual hosts whose configuration is unchanged are shared with it instead
+   *        of being rebuilt. Virtual hosts are only shared when cluster validation is disabled and
+   *        the previous matcher was built with the same global_route_config.
+   */
   RouteMatcher(const envoy::config::route::v3::RouteConfiguration& config,
-               const ConfigImpl& global_http_config,
+               const CommonConfigImplSharedPtr& global_route_config,
                Server::Configuration::ServerFactoryContext& factory_context,
-               ProtobufMessage::ValidationVisitor& validator, bool validate_clusters);
+               ProtobufMessage::ValidationVisitor& validator, bool validate_clusters,
+               const RouteMatcher* previous_matcher);
 
   RouteConstSharedPtr route(const RouteCallback& cb, const Http::RequestHeaderMap& headers,
                             const StreamInfo::StreamInfo& stream_info, uint64_t random_value) const;
 
   const VirtualHostImpl* findVirtualHost(const Http::RequestHeaderMap& headers) const;
 
+  /**
+   * @return uint32_t the number of virtual hosts that were shared with the previous matcher
+   *         rather than rebuilt.
+   */
+  uint32_t reusedVirtualHosts() const { return reused_virtual_hosts_; }
+
 private:
   using WildcardVirtualHosts =
       std::map<int64_t, absl::node_hash_map<std::string, VirtualHostSharedPtr>, std::greater<>>;
@@ -969,6 +1022,18 @@ private:
   WildcardVirtualHosts wildcard_virtual_host_prefixes_;
 
   VirtualHostSharedPtr default_virtual_host_;
+
+  // A virtual host together with the configuration it was built from. The configuration is
+  // compared on a hash match so that a hash collision can't substitute another virtual host.
+  struct HashedVirtualHost {
+    envoy::config::route::v3::VirtualHost config_;
+    VirtualHostSharedPtr virtual_host_;
+  };
+
+  // All virtual hosts keyed by the hash of their configuration. This is what a later version of
+  // the route configuration uses to find virtual hosts it can share.
+  absl::flat_hash_map<uint64_t, HashedVirtualHost> virtual_hosts_by_hash_;
+  uint32_t reused_virtual_hosts_{};
 };
 
 /**
@@ -976,17 +1041,26 @@ private:
  */
 class ConfigImpl : public Config {
 public:
+  /**
+   * @param previous_config if not nullptr, a previous version of the same route configuration.
+   *        Unchanged virtual hosts are shared with it instead of being rebuilt, see RouteMatcher.
+   */
   ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
              Server::Configuration::ServerFactoryContext& factory_context,
-             ProtobufMessage::ValidationVisitor& validator, bool validate_clusters_default);
+             ProtobufMessage::ValidationVisitor& validator, bool validate_clusters_default,
+             const ConfigImpl* previous_config = nullptr);
 
-  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
-  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+  const HeaderParser& requestHeaderParser() const { return common_config_->requestHeaderParser(); };
+  const HeaderParser& responseHeaderParser() const {
+    return common_config_->responseHeaderParser();
+  };
 
   bool virtualHostExists(const Http::RequestHeaderMap& headers) const {
     return route_matcher_->findVirtualHost(headers) != nullptr;
   }
 
+  uint32_t reusedVirtualHosts() const { return route_matcher_->reusedVirtualHosts(); }
+
   // Router::Config
   RouteConstSharedPtr route(const Http::RequestHeaderMap& headers,
                             const StreamInfo::StreamInfo& stream_info,
@@ -999,26 +1073,20 @@ public:
                             uint64_t random_value) const override;
 
   const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
-    return internal_only_headers_;
+    return common_config_->internalOnlyHeaders();
   }
 
-  const std::string& name() const override { return name_; }
+  const std::string& name() const override { return common_config_->name(); }
 
-  bool usesVhds() const override { return uses_vhds_; }
+  bool usesVhds() const override { return common_config_->usesVhds(); }
 
   bool mostSpecificHeaderMutationsWins() const override {
-    return most_specific_header_mutations_wins_;
+    return common_config_->mostSpecificHeaderMutationsWins();
   }
 
 private:
+  CommonConfigImplSharedPtr common_config_;
   std::unique_ptr<RouteMatcher> route_matcher_;
-  std::list<Http::LowerCaseString> internal_only_headers_;
-  HeaderParserPtr request_headers_parser_;
-  HeaderParserPtr response_headers_parser_;
-  const std::string name_;
-  Stats::SymbolTable& symbol_table_;
-  const bool uses_vhds_;
-  const bool most_specific_header_mutations_wins_;
 };
 
 /**
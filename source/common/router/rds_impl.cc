@@ -231,8 +231,9 @@ RdsRouteConfigProviderImpl::RdsRouteConfigProviderImpl(
       tls_(factory_context.threadLocal().allocateSlot()) {
   ConfigConstSharedPtr initial_config;
   if (config_update_info_->configInfo().has_value()) {
-    initial_config = std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(),
-                                                  factory_context_, validator_, false);
+    last_config_ = std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(),
+                                                factory_context_, validator_, false);
+    initial_config = last_config_;
   } else {
     initial_config = std::make_shared<NullConfigImpl>();
   }
@@ -255,8 +256,13 @@ Router::ConfigConstSharedPtr RdsRouteConfigProviderImpl::config() {
 }
 
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(new ConfigImpl(config_update_info_->routeConfiguration(),
-                                                 factory_context_, validator_, false));
+  auto new_config_impl =
+      std::make_shared<const ConfigImpl>(config_update_info_->routeConfiguration(),
+                                         factory_context_, validator_, false, last_config_.get());
+  ENVOY_LOG(debug, "rds: built route configuration {} reusing {} unchanged virtual hosts",
+            new_config_impl->name(), new_config_impl->reusedVirtualHosts());
+  last_config_ = new_config_impl;
+  ConfigConstSharedPtr new_config = new_config_impl;
   tls_->runOnAllThreads([new_config](ThreadLocal::ThreadLocalObjectSharedPtr previous)
                             -> ThreadLocal::ThreadLocalObjectSharedPtr {
     auto prev_config = std::dynamic_pointer_cast<ThreadLocalConfig>(previous);
@@ -270,7 +276,7 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
     return;
   }
 
-  const auto config = std::static_pointer_cast<const ConfigImpl>(new_config);
+  const auto& config = new_config_impl;
   // Notifies connections that RouteConfiguration update has been propagated.
   // Callbacks processing is performed in FIFO order. The callback is skipped if alias used in
   // the VHDS update request do not match the aliases in the update response
@@ -297,7 +303,7 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
 void RdsRouteConfigProviderImpl::validateConfig(
     const envoy::config::route::v3::RouteConfiguration& config) const {
   // TODO(lizan): consider cache the config here until onConfigUpdate.
-  ConfigImpl validation_config(config, factory_context_, validator_, false);
+  ConfigImpl validation_config(config, factory_context_, validator_, false, last_config_.get());
 }
 
 // Schedules a VHDS request on the main thread and queues up the callback to use when the VHDS
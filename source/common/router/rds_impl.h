@@ -225,6 +225,9 @@ private:
   Server::Configuration::ServerFactoryContext& factory_context_;
   ProtobufMessage::ValidationVisitor& validator_;
   ThreadLocal::SlotPtr tls_;
+  // The most recently built config. Unchanged virtual hosts are shared with it when building the
+  // next config. Only accessed on the main thread.
+  std::shared_ptr<const ConfigImpl> last_config_;
   std::list<UpdateOnDemandCallback> config_update_callbacks_;
   // A flag used to determine if this instance of RdsRouteConfigProviderImpl hasn't been
   // deallocated. Please also see a comment in requestVirtualHostsUpdate() method implementation.
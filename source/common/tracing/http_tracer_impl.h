@@ -184,6 +184,7 @@ public:
                     const Tracing::Decision) override {
     return SpanPtr{new NullSpan()};
   }
+  bool supportsTailSampling() const override { return false; }
 };
 
 class HttpTracerImpl : public HttpTracer {
@@ -194,6 +195,7 @@ public:
   SpanPtr startSpan(const Config& config, Http::RequestHeaderMap& request_headers,
                     const StreamInfo::StreamInfo& stream_info,
                     const Tracing::Decision tracing_decision) override;
+  bool supportsTailSampling() const override { return driver_->supportsTailSampling(); }
 
 private:
   DriverPtr driver_;
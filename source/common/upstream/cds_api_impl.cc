@@ -63,18 +63,30 @@ void CdsApiImpl::onConfigUpdate(const std::vector<Config::DecodedResourceRef>& a
   ENVOY_LOG(info, "cds: add {} cluster(s), remove {} cluster(s)", added_resources.size(),
             removed_resources.size());
 
+  // Hash the whole update up front so that the cluster manager can do it as a single parallel
+  // batch. The hash is what tells unchanged clusters apart, and computing it is the dominant cost
+  // of large updates in which few clusters changed.
+  std::vector<const envoy::config::cluster::v3::Cluster*> clusters;
+  clusters.reserve(added_resources.size());
+  for (const auto& resource : added_resources) {
+    clusters.push_back(
+        &dynamic_cast<const envoy::config::cluster::v3::Cluster&>(resource.get().resource()));
+  }
+  const std::vector<uint64_t> config_hashes = cm_.hashClusters(clusters);
+  ASSERT(config_hashes.size() == clusters.size());
+
   std::vector<std::string> exception_msgs;
   absl::node_hash_set<std::string> cluster_names;
   bool any_applied = false;
-  for (const auto& resource : added_resources) {
-    envoy::config::cluster::v3::Cluster cluster;
+  for (size_t i = 0; i < added_resources.size(); i++) {
+    const auto& resource = added_resources[i];
+    const envoy::config::cluster::v3::Cluster& cluster = *clusters[i];
     try {
-      cluster = dynamic_cast<const envoy::config::cluster::v3::Cluster&>(resource.get().resource());
       if (!cluster_names.insert(cluster.name()).second) {
         // NOTE: at this point, the first of these duplicates has already been successfully applied.
         throw EnvoyException(fmt::format("duplicate cluster {} found", cluster.name()));
       }
-      if (cm_.addOrUpdateCluster(cluster, resource.get().version())) {
+      if (cm_.addOrUpdateCluster(cluster, resource.get().version(), config_hashes[i])) {
         any_applied = true;
         ENVOY_LOG(info, "cds: add/update cluster '{}'", cluster.name());
       } else {
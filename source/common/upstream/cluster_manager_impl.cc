@@ -1,11 +1,13 @@
 #include "common/upstream/cluster_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "envoy/admin/v3/config_dump.pb.h"
@@ -47,6 +49,11 @@ namespace Envoy {
 namespace Upstream {
 namespace {
 
+// CDS updates with fewer clusters than this are hashed on the calling thread.
+constexpr size_t ParallelHashMinClusters = 64;
+// Upper bound on the threads, including the calling thread, used to hash a CDS update.
+constexpr uint32_t ParallelHashMaxThreads = 4;
+
 void addOptionsIfNotNull(Network::Socket::OptionsSharedPtr& options,
                          const Network::Socket::OptionsSharedPtr& to_add) {
   if (to_add != nullptr) {
@@ -248,7 +255,14 @@ ClusterManagerImpl::ClusterManagerImpl(
       time_source_(main_thread_dispatcher.timeSource()), dispatcher_(main_thread_dispatcher),
       http_context_(http_context),
       subscription_factory_(local_info, main_thread_dispatcher, *this,
-                            validation_context.dynamicValidationVisitor(), api, runtime_) {
+                            validation_context.dynamicValidationVisitor(), api, runtime_),
+      thread_factory_(api.threadFactory()),
+      lazy_thread_local_clusters_(bootstrap.cluster_manager().has_lazy_thread_local_clusters()),
+      thread_local_cluster_idle_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(
+          bootstrap.cluster_manager().lazy_thread_local_clusters(), idle_timeout, 300000)),
+      thread_local_cluster_registry_(lazy_thread_local_clusters_
+                                         ? std::make_shared<ThreadLocalClusterRegistry>()
+                                         : nullptr) {
   async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
       *this, tls, time_source_, api, grpc_context.statNames());
   const auto& cm_config = bootstrap.cluster_manager();
@@ -291,7 +305,7 @@ ClusterManagerImpl::ClusterManagerImpl(
   // Load all the primary clusters.
   for (const auto& cluster : bootstrap.static_resources().clusters()) {
     if (is_primary_cluster(cluster)) {
-      loadCluster(cluster, "", false, active_clusters_);
+      loadCluster(cluster, 0, "", false, active_clusters_);
     }
   }
 
@@ -323,7 +337,7 @@ ClusterManagerImpl::ClusterManagerImpl(
           Config::Utility::factoryForGrpcApiConfigSource(*async_client_manager_,
                                                          dyn_resources.ads_config(), stats, false)
               ->create(),
-          main_thread_dispatcher,
+          main_thread_dispatcher, thread_factory_,
           *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
               dyn_resources.ads_config().transport_api_version() ==
                       envoy::config::core::v3::ApiVersion::V3
@@ -347,7 +361,7 @@ ClusterManagerImpl::ClusterManagerImpl(
     if (cluster.type() == envoy::config::cluster::v3::Cluster::EDS &&
         cluster.eds_cluster_config().eds_config().config_source_specifier_case() !=
             envoy::config::core::v3::ConfigSource::ConfigSourceSpecifierCase::kPath) {
-      loadCluster(cluster, "", false, active_clusters_);
+      loadCluster(cluster, 0, "", false, active_clusters_);
     }
   }
 
@@ -360,6 +374,19 @@ ClusterManagerImpl::ClusterManagerImpl(
         fmt::format("local cluster '{}' must be defined", local_cluster_name_.value()));
   }
 
+  if (lazy_thread_local_clusters_) {
+    for (const auto& cluster : active_clusters_) {
+      thread_local_cluster_registry_->setSnapshot(
+          cluster.first,
+          std::make_shared<const ThreadLocalClusterSnapshot>(
+              ThreadLocalClusterSnapshot{cluster.second->cluster_->info(),
+                                         cluster.second->loadBalancerFactory(),
+                                         {},
+                                         ++thread_local_cluster_version_}),
+          true);
+    }
+  }
+
   // Once the initial set of static bootstrap clusters are created (including the local cluster),
   // we can instantiate the thread local cluster manager.
   tls_->set([this, local_cluster_name = local_cluster_name_](
@@ -566,6 +593,37 @@ void ClusterManagerImpl::applyUpdates(const Cluster& cluster, uint32_t priority,
 
 bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
                                             const std::string& version_info) {
+  return addOrUpdateCluster(cluster, version_info, MessageUtil::hash(cluster));
+}
+
+std::vector<uint64_t> ClusterManagerImpl::hashClusters(
+    const std::vector<const envoy::config::cluster::v3::Cluster*>& clusters) {
+  std::vector<uint64_t> hashes(clusters.size());
+  auto hash_one = [&clusters, &hashes](size_t i) { hashes[i] = MessageUtil::hash(*clusters[i]); };
+  // Hashing serializes the full cluster proto, which dominates the main thread time spent on a
+  // large CDS update in which most clusters are unchanged. Hashing has no side effects, so spread
+  // it over a helper pool. Small updates are not worth the hand-off.
+  if (clusters.size() < ParallelHashMinClusters) {
+    for (size_t i = 0; i < clusters.size(); i++) {
+      hash_one(i);
+    }
+    return hashes;
+  }
+  if (config_hash_pool_ == nullptr) {
+    // The calling thread takes a share of the work, so it does not count towards the pool size.
+    const uint32_t hardware_threads = std::max(1U, std::thread::hardware_concurrency());
+    const uint32_t num_threads =
+        std::max(1U, std::min(hardware_threads, ParallelHashMaxThreads) - 1);
+    config_hash_pool_ =
+        std::make_unique<Thread::ThreadPool>(thread_factory_, num_threads, "cm_config_hash");
+  }
+  config_hash_pool_->parallelFor(clusters.size(), hash_one);
+  return hashes;
+}
+
+bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
+                                            const std::string& version_info,
+                                            uint64_t config_hash) {
   // First we need to see if this new config is new or an update to an existing dynamic cluster.
   // We don't allow updates to statically configured clusters in the main configuration. We check
   // both the warming clusters and the active clusters to see if we need an update or the update
@@ -573,11 +631,10 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cl
   const std::string& cluster_name = cluster.name();
   const auto existing_active_cluster = active_clusters_.find(cluster_name);
   const auto existing_warming_cluster = warming_clusters_.find(cluster_name);
-  const uint64_t new_hash = MessageUtil::hash(cluster);
   if ((existing_active_cluster != active_clusters_.end() &&
-       existing_active_cluster->second->blockUpdate(new_hash)) ||
+       existing_active_cluster->second->blockUpdate(config_hash)) ||
       (existing_warming_cluster != warming_clusters_.end() &&
-       existing_warming_cluster->second->blockUpdate(new_hash))) {
+       existing_warming_cluster->second->blockUpdate(config_hash))) {
     return false;
   }
 
@@ -616,7 +673,8 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cl
   //       and easy to understand.
   const bool use_active_map =
       init_helper_.state() != ClusterManagerInitHelper::State::AllClustersInitialized;
-  loadCluster(cluster, version_info, true, use_active_map ? active_clusters_ : warming_clusters_);
+  loadCluster(cluster, config_hash, version_info, true,
+              use_active_map ? active_clusters_ : warming_clusters_);
 
   if (use_active_map) {
     ENVOY_LOG(debug, "add/update cluster {} during init", cluster_name);
@@ -649,21 +707,50 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cl
 }
 
 void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster) {
+  const uint64_t version = ++thread_local_cluster_version_;
+  if (lazy_thread_local_clusters_ &&
+      !thread_local_cluster_registry_->setSnapshot(
+          cluster.cluster_->info()->name(),
+          std::make_shared<const ThreadLocalClusterSnapshot>(ThreadLocalClusterSnapshot{
+              cluster.cluster_->info(), cluster.loadBalancerFactory(), {}, version}),
+          true)) {
+    // No thread holds a copy of the cluster or has callbacks to notify. Copies created later start
+    // from the snapshot.
+    return;
+  }
+
   tls_->runOnAllThreads([new_cluster = cluster.cluster_->info(),
-                         thread_aware_lb_factory = cluster.loadBalancerFactory()](
-                            ThreadLocal::ThreadLocalObjectSharedPtr object)
+                         thread_aware_lb_factory = cluster.loadBalancerFactory(),
+                         version](ThreadLocal::ThreadLocalObjectSharedPtr object)
                             -> ThreadLocal::ThreadLocalObjectSharedPtr {
     ThreadLocalClusterManagerImpl& cluster_manager =
         object->asType<ThreadLocalClusterManagerImpl>();
 
-    if (cluster_manager.thread_local_clusters_.count(new_cluster->name()) > 0) {
+    const auto existing = cluster_manager.thread_local_clusters_.find(new_cluster->name());
+    if (existing != cluster_manager.thread_local_clusters_.end()) {
+      if (existing->second->version_ >= version) {
+        // Created on demand from a snapshot that already includes this update. Callbacks have not
+        // heard about it yet since on demand creation does not notify them.
+        for (auto& cb : cluster_manager.update_callbacks_) {
+          cb->onClusterAddOrUpdate(*existing->second);
+        }
+        return object;
+      }
       ENVOY_LOG(debug, "updating TLS cluster {}", new_cluster->name());
+    } else if (cluster_manager.parent_.lazy_thread_local_clusters_ &&
+               cluster_manager.update_callbacks_.empty()) {
+      // Nothing on this thread uses the cluster yet, it will be created on first use.
+      return object;
     } else {
       ENVOY_LOG(debug, "adding TLS cluster {}", new_cluster->name());
     }
 
     auto thread_local_cluster = new ThreadLocalClusterManagerImpl::ClusterEntry(
         cluster_manager, new_cluster, thread_aware_lb_factory);
+    thread_local_cluster->version_ = version;
+    if (cluster_manager.cluster_registry_ != nullptr) {
+      cluster_manager.cluster_registry_->addCopy(new_cluster->name());
+    }
     cluster_manager.thread_local_clusters_[new_cluster->name()].reset(thread_local_cluster);
     for (auto& cb : cluster_manager.update_callbacks_) {
       cb->onClusterAddOrUpdate(*thread_local_cluster);
@@ -683,19 +770,25 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
     active_clusters_.erase(existing_active_cluster);
 
     ENVOY_LOG(info, "removing cluster {}", cluster_name);
-    tls_->runOnAllThreads([cluster_name](ThreadLocal::ThreadLocalObjectSharedPtr object)
-                              -> ThreadLocal::ThreadLocalObjectSharedPtr {
-      ThreadLocalClusterManagerImpl& cluster_manager =
-          object->asType<ThreadLocalClusterManagerImpl>();
-
-      ASSERT(cluster_manager.thread_local_clusters_.count(cluster_name) == 1);
-      ENVOY_LOG(debug, "removing TLS cluster {}", cluster_name);
-      for (auto& cb : cluster_manager.update_callbacks_) {
-        cb->onClusterRemoval(cluster_name);
-      }
-      cluster_manager.thread_local_clusters_.erase(cluster_name);
-      return object;
-    });
+    // In lazy mode, the removal only needs to reach threads that hold a copy of the cluster or have
+    // callbacks to notify.
+    if (!lazy_thread_local_clusters_ ||
+        thread_local_cluster_registry_->setSnapshot(cluster_name, nullptr, true)) {
+      tls_->runOnAllThreads([cluster_name](ThreadLocal::ThreadLocalObjectSharedPtr object)
+                                -> ThreadLocal::ThreadLocalObjectSharedPtr {
+        ThreadLocalClusterManagerImpl& cluster_manager =
+            object->asType<ThreadLocalClusterManagerImpl>();
+
+        ASSERT(cluster_manager.parent_.lazy_thread_local_clusters_ ||
+               cluster_manager.thread_local_clusters_.count(cluster_name) == 1);
+        ENVOY_LOG(debug, "removing TLS cluster {}", cluster_name);
+        for (auto& cb : cluster_manager.update_callbacks_) {
+          cb->onClusterRemoval(cluster_name);
+        }
+        cluster_manager.thread_local_clusters_.erase(cluster_name);
+        return object;
+      });
+    }
   }
 
   auto existing_warming_cluster = warming_clusters_.find(cluster_name);
@@ -717,8 +810,8 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
 }
 
 void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster& cluster,
-                                     const std::string& version_info, bool added_via_api,
-                                     ClusterMap& cluster_map) {
+                                     uint64_t config_hash, const std::string& version_info,
+                                     bool added_via_api, ClusterMap& cluster_map) {
   std::pair<ClusterSharedPtr, ThreadAwareLoadBalancerPtr> new_cluster_pair =
       factory_.clusterFromProto(cluster, *this, outlier_event_logger_, added_via_api);
   auto& new_cluster = new_cluster_pair.first;
@@ -765,7 +858,7 @@ void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster&
   }
 
   cluster_map[cluster_reference.info()->name()] = std::make_unique<ClusterData>(
-      cluster, version_info, added_via_api, std::move(new_cluster), time_source_);
+      cluster, config_hash, version_info, added_via_api, std::move(new_cluster), time_source_);
   const auto cluster_entry_it = cluster_map.find(cluster_reference.info()->name());
 
   // If an LB is thread aware, create it here. The LB is not initialized until cluster pre-init
@@ -819,18 +912,71 @@ void ClusterManagerImpl::updateClusterCounts() {
 }
 
 ThreadLocalCluster* ClusterManagerImpl::get(absl::string_view cluster) {
-  auto& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
+  return tls_->getTyped<ThreadLocalClusterManagerImpl>().getClusterEntry(cluster);
+}
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry != cluster_manager.thread_local_clusters_.end()) {
-    return entry->second.get();
-  } else {
+bool ClusterManagerImpl::ThreadLocalClusterRegistry::setSnapshot(
+    const std::string& name, ThreadLocalClusterSnapshotConstSharedPtr snapshot,
+    bool update_callbacks) {
+  absl::MutexLock lock(&mutex_);
+  const auto it = clusters_.find(name);
+  const bool has_copies = it != clusters_.end() && it->second.copies_ > 0;
+  if (snapshot != nullptr) {
+    clusters_[name].snapshot_ = std::move(snapshot);
+  } else if (has_copies) {
+    // Kept until the threads holding a copy release it.
+    it->second.snapshot_ = nullptr;
+  } else if (it != clusters_.end()) {
+    clusters_.erase(it);
+  }
+  return has_copies || (update_callbacks && update_callbacks_ > 0);
+}
+
+ClusterManagerImpl::ThreadLocalClusterSnapshotConstSharedPtr
+ClusterManagerImpl::ThreadLocalClusterRegistry::snapshot(absl::string_view name) {
+  absl::MutexLock lock(&mutex_);
+  const auto it = clusters_.find(name);
+  return it != clusters_.end() ? it->second.snapshot_ : nullptr;
+}
+
+ClusterManagerImpl::ThreadLocalClusterSnapshotConstSharedPtr
+ClusterManagerImpl::ThreadLocalClusterRegistry::acquireCopy(absl::string_view name) {
+  absl::MutexLock lock(&mutex_);
+  const auto it = clusters_.find(name);
+  if (it == clusters_.end() || it->second.snapshot_ == nullptr) {
     return nullptr;
   }
+  it->second.copies_++;
+  return it->second.snapshot_;
+}
+
+void ClusterManagerImpl::ThreadLocalClusterRegistry::addCopy(const std::string& name) {
+  absl::MutexLock lock(&mutex_);
+  clusters_[name].copies_++;
+}
+
+void ClusterManagerImpl::ThreadLocalClusterRegistry::releaseCopy(const std::string& name) {
+  absl::MutexLock lock(&mutex_);
+  const auto it = clusters_.find(name);
+  ASSERT(it != clusters_.end() && it->second.copies_ > 0);
+  if (--it->second.copies_ == 0 && it->second.snapshot_ == nullptr) {
+    clusters_.erase(it);
+  }
+}
+
+void ClusterManagerImpl::ThreadLocalClusterRegistry::addUpdateCallbacks() {
+  absl::MutexLock lock(&mutex_);
+  update_callbacks_++;
+}
+
+void ClusterManagerImpl::ThreadLocalClusterRegistry::removeUpdateCallbacks() {
+  absl::MutexLock lock(&mutex_);
+  ASSERT(update_callbacks_ > 0);
+  update_callbacks_--;
 }
 
 void ClusterManagerImpl::maybePrefetch(
-    ThreadLocalClusterManagerImpl::ClusterEntryPtr& cluster_entry,
+    ThreadLocalClusterManagerImpl::ClusterEntry& cluster_entry,
     std::function<ConnectionPool::Instance*()> pick_prefetch_pool) {
   // TODO(alyssawilk) As currently implemented, this will always just prefetch
   // one connection ahead of actually needed connections.
@@ -846,10 +992,10 @@ void ClusterManagerImpl::maybePrefetch(
   //  per-upstream prefetch.
   //
   //  Once we do this, this should loop capped number of times while shouldPrefetch is true.
-  if (cluster_entry->cluster_info_->peekaheadRatio() > 1.0) {
+  if (cluster_entry.cluster_info_->peekaheadRatio() > 1.0) {
     ConnectionPool::Instance* prefetch_pool = pick_prefetch_pool();
     if (prefetch_pool) {
-      prefetch_pool->maybePrefetch(cluster_entry->cluster_info_->peekaheadRatio());
+      prefetch_pool->maybePrefetch(cluster_entry.cluster_info_->peekaheadRatio());
     }
   }
 }
@@ -860,13 +1006,13 @@ ClusterManagerImpl::httpConnPoolForCluster(const std::string& cluster, ResourceP
                                            LoadBalancerContext* context) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry == cluster_manager.thread_local_clusters_.end()) {
+  auto* entry = cluster_manager.getClusterEntry(cluster);
+  if (entry == nullptr) {
     return nullptr;
   }
 
   // Select a host and create a connection pool for it if it does not already exist.
-  auto ret = entry->second->connPool(priority, protocol, context, false);
+  auto ret = entry->connPool(priority, protocol, context, false);
 
   // Now see if another host should be prefetched.
   // httpConnPoolForCluster is called immediately before a call for newStream. newStream doesn't
@@ -874,8 +1020,8 @@ ClusterManagerImpl::httpConnPoolForCluster(const std::string& cluster, ResourceP
   // performed here in anticipation of the new stream.
   // TODO(alyssawilk) refactor to have one function call and return a pair, so this invariant is
   // code-enforced.
-  maybePrefetch(entry->second, [&entry, &priority, &protocol, &context]() {
-    return entry->second->connPool(priority, protocol, context, true);
+  maybePrefetch(*entry, [entry, &priority, &protocol, &context]() {
+    return entry->connPool(priority, protocol, context, true);
   });
 
   return ret;
@@ -886,13 +1032,13 @@ ClusterManagerImpl::tcpConnPoolForCluster(const std::string& cluster, ResourcePr
                                           LoadBalancerContext* context) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry == cluster_manager.thread_local_clusters_.end()) {
+  auto* entry = cluster_manager.getClusterEntry(cluster);
+  if (entry == nullptr) {
     return nullptr;
   }
 
   // Select a host and create a connection pool for it if it does not already exist.
-  auto ret = entry->second->tcpConnPool(priority, context, false);
+  auto ret = entry->tcpConnPool(priority, context, false);
 
   // tcpConnPoolForCluster is called immediately before a call for newConnection. newConnection
   // doesn't have the load balancer context needed to make selection decisions so prefetching must
@@ -900,8 +1046,8 @@ ClusterManagerImpl::tcpConnPoolForCluster(const std::string& cluster, ResourcePr
   // TODO(alyssawilk) refactor to have one function call and return a pair, so this invariant is
   // code-enforced.
   // Now see if another host should be prefetched.
-  maybePrefetch(entry->second, [&entry, &priority, &context]() {
-    return entry->second->tcpConnPool(priority, context, true);
+  maybePrefetch(*entry, [entry, &priority, &context]() {
+    return entry->tcpConnPool(priority, context, true);
   });
 
   return ret;
@@ -921,16 +1067,37 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, ui
                                                       const HostVector& hosts_added,
                                                       const HostVector& hosts_removed) {
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
+  const uint64_t version = ++thread_local_cluster_version_;
+  PrioritySet::UpdateHostsParams update_params = HostSetImpl::updateHostsParams(*host_set);
+
+  if (lazy_thread_local_clusters_) {
+    const ThreadLocalClusterSnapshotConstSharedPtr current =
+        thread_local_cluster_registry_->snapshot(cluster.info()->name());
+    if (current != nullptr) {
+      auto snapshot = std::make_shared<ThreadLocalClusterSnapshot>(*current);
+      if (snapshot->host_sets_.size() <= priority) {
+        snapshot->host_sets_.resize(priority + 1);
+      }
+      snapshot->host_sets_[priority] = ThreadLocalClusterSnapshot::HostSet{
+          update_params, host_set->localityWeights(), host_set->overprovisioningFactor()};
+      snapshot->version_ = version;
+      if (!thread_local_cluster_registry_->setSnapshot(cluster.info()->name(), std::move(snapshot),
+                                                       false)) {
+        // No thread holds a copy of the cluster. Copies created later start from the snapshot.
+        return;
+      }
+    }
+  }
 
   tls_->runOnAllThreads([name = cluster.info()->name(), priority,
-                         update_params = HostSetImpl::updateHostsParams(*host_set),
+                         update_params = std::move(update_params),
                          locality_weights = host_set->localityWeights(), hosts_added, hosts_removed,
-                         overprovisioning_factor = host_set->overprovisioningFactor()](
-                            ThreadLocal::ThreadLocalObjectSharedPtr object)
+                         overprovisioning_factor = host_set->overprovisioningFactor(),
+                         version](ThreadLocal::ThreadLocalObjectSharedPtr object)
                             -> ThreadLocal::ThreadLocalObjectSharedPtr {
     object->asType<ThreadLocalClusterManagerImpl>().updateClusterMembership(
         name, priority, update_params, locality_weights, hosts_added, hosts_removed,
-        overprovisioning_factor);
+        overprovisioning_factor, version);
     return object;
   });
 }
@@ -947,17 +1114,17 @@ Host::CreateConnectionData ClusterManagerImpl::tcpConnForCluster(const std::stri
                                                                  LoadBalancerContext* context) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry == cluster_manager.thread_local_clusters_.end()) {
+  auto* entry = cluster_manager.getClusterEntry(cluster);
+  if (entry == nullptr) {
     throw EnvoyException(fmt::format("unknown cluster '{}'", cluster));
   }
 
-  HostConstSharedPtr logical_host = entry->second->lb_->chooseHost(context);
+  HostConstSharedPtr logical_host = entry->lb_->chooseHost(context);
   if (logical_host) {
     auto conn_info = logical_host->createConnection(
         cluster_manager.thread_local_dispatcher_, nullptr,
         context == nullptr ? nullptr : context->upstreamTransportSocketOptions());
-    if ((entry->second->cluster_info_->features() &
+    if ((entry->cluster_info_->features() &
          ClusterInfo::Features::CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE) &&
         conn_info.connection_ != nullptr) {
       auto& conn_map = cluster_manager.host_tcp_conn_map_[logical_host];
@@ -967,16 +1134,18 @@ Host::CreateConnectionData ClusterManagerImpl::tcpConnForCluster(const std::stri
     }
     return conn_info;
   } else {
-    entry->second->cluster_info_->stats().upstream_cx_none_healthy_.inc();
+    entry->cluster_info_->stats().upstream_cx_none_healthy_.inc();
     return {nullptr, nullptr};
   }
 }
 
 Http::AsyncClient& ClusterManagerImpl::httpAsyncClientForCluster(const std::string& cluster) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry != cluster_manager.thread_local_clusters_.end()) {
-    return entry->second->http_async_client_;
+  auto* entry = cluster_manager.getClusterEntry(cluster);
+  if (entry != nullptr) {
+    // The client may outlive this call with streams in flight, so the entry must stay around.
+    entry->pinned_ = true;
+    return entry->http_async_client_;
   } else {
     throw EnvoyException(fmt::format("unknown cluster '{}'", cluster));
   }
@@ -985,7 +1154,24 @@ Http::AsyncClient& ClusterManagerImpl::httpAsyncClientForCluster(const std::stri
 ClusterUpdateCallbacksHandlePtr
 ClusterManagerImpl::addThreadLocalClusterUpdateCallbacks(ClusterUpdateCallbacks& cb) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
-  return std::make_unique<ClusterUpdateCallbacksHandleImpl>(cb, cluster_manager.update_callbacks_);
+  return std::make_unique<ClusterUpdateCallbacksHandleImpl>(cb, cluster_manager.update_callbacks_,
+                                                            thread_local_cluster_registry_);
+}
+
+ClusterManagerImpl::ClusterUpdateCallbacksHandleImpl::ClusterUpdateCallbacksHandleImpl(
+    ClusterUpdateCallbacks& cb, std::list<ClusterUpdateCallbacks*>& parent,
+    ThreadLocalClusterRegistrySharedPtr cluster_registry)
+    : RaiiListElement<ClusterUpdateCallbacks*>(parent, &cb),
+      cluster_registry_(std::move(cluster_registry)) {
+  if (cluster_registry_ != nullptr) {
+    cluster_registry_->addUpdateCallbacks();
+  }
+}
+
+ClusterManagerImpl::ClusterUpdateCallbacksHandleImpl::~ClusterUpdateCallbacksHandleImpl() {
+  if (cluster_registry_ != nullptr) {
+    cluster_registry_->removeUpdateCallbacks();
+  }
 }
 
 ProtobufTypes::MessagePtr ClusterManagerImpl::dumpClusterConfigs() {
@@ -1022,19 +1208,33 @@ ProtobufTypes::MessagePtr ClusterManagerImpl::dumpClusterConfigs() {
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl(
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<std::string>& local_cluster_name)
-    : parent_(parent), thread_local_dispatcher_(dispatcher) {
+    : parent_(parent), thread_local_dispatcher_(dispatcher), cm_stats_(parent.cm_stats_),
+      cluster_registry_(parent.thread_local_cluster_registry_) {
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_name) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
     auto& local_cluster = parent.active_clusters_.at(local_cluster_name.value());
-    thread_local_clusters_[local_cluster_name.value()] = std::make_unique<ClusterEntry>(
-        *this, local_cluster->cluster_->info(), local_cluster->loadBalancerFactory());
+    auto& entry = thread_local_clusters_[local_cluster_name.value()];
+    entry = std::make_unique<ClusterEntry>(*this, local_cluster->cluster_->info(),
+                                           local_cluster->loadBalancerFactory());
+    // Zone aware load balancers of other clusters hold on to the local cluster's priority set.
+    entry->pinned_ = true;
+    if (cluster_registry_ != nullptr) {
+      cluster_registry_->addCopy(local_cluster_name.value());
+    }
   }
 
   local_priority_set_ = local_cluster_name
                             ? &thread_local_clusters_[local_cluster_name.value()]->priority_set_
                             : nullptr;
 
+  if (parent.lazy_thread_local_clusters_) {
+    // All other clusters are created on first use.
+    idle_sweep_timer_ = thread_local_dispatcher_.createTimer([this]() -> void { onIdleSweep(); });
+    idle_sweep_timer_->enableTimer(parent.thread_local_cluster_idle_timeout_);
+    return;
+  }
+
   for (auto& cluster : parent.active_clusters_) {
     // If local cluster name is set then we already initialized this cluster.
     if (local_cluster_name && local_cluster_name.value() == cluster.first) {
@@ -1178,22 +1378,34 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeTcpConn(
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeHosts(
     const std::string& name, const HostVector& hosts_removed) {
-  ASSERT(thread_local_clusters_.find(name) != thread_local_clusters_.end());
-  const auto& cluster_entry = thread_local_clusters_[name];
+  // In lazy mode this thread may not have a copy of the cluster. Its connection pools, if any,
+  // are still drained since they outlive evicted copies.
+  ASSERT(parent_.lazy_thread_local_clusters_ ||
+         thread_local_clusters_.find(name) != thread_local_clusters_.end());
   ENVOY_LOG(debug, "removing hosts for TLS cluster {} removed {}", name, hosts_removed.size());
 
   // We need to go through and purge any connection pools for hosts that got deleted.
   // Even if two hosts actually point to the same address this will be safe, since if a
   // host is readded it will be a different physical HostSharedPtr.
-  cluster_entry->parent_.drainConnPools(hosts_removed);
+  drainConnPools(hosts_removed);
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
     const std::string& name, uint32_t priority, PrioritySet::UpdateHostsParams update_hosts_params,
     LocalityWeightsConstSharedPtr locality_weights, const HostVector& hosts_added,
-    const HostVector& hosts_removed, uint64_t overprovisioning_factor) {
-  ASSERT(thread_local_clusters_.find(name) != thread_local_clusters_.end());
-  const auto& cluster_entry = thread_local_clusters_[name];
+    const HostVector& hosts_removed, uint64_t overprovisioning_factor, uint64_t version) {
+  const auto it = thread_local_clusters_.find(name);
+  if (it == thread_local_clusters_.end()) {
+    // The copy will be created from the latest snapshot on first use.
+    ASSERT(parent_.lazy_thread_local_clusters_);
+    return;
+  }
+  const auto& cluster_entry = it->second;
+  if (cluster_entry->version_ >= version) {
+    // Created on demand from a snapshot that already includes this update.
+    return;
+  }
+  cluster_entry->version_ = version;
   ENVOY_LOG(debug, "membership update for TLS cluster {} added {} removed {}", name,
             hosts_added.size(), hosts_removed.size());
   cluster_entry->priority_set_.updateHosts(priority, std::move(update_hosts_params),
@@ -1207,6 +1419,67 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
   }
 }
 
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::getClusterEntry(absl::string_view name) {
+  const auto it = thread_local_clusters_.find(name);
+  if (it != thread_local_clusters_.end()) {
+    it->second->used_ = true;
+    return it->second.get();
+  }
+  return parent_.lazy_thread_local_clusters_ ? createClusterEntryOnDemand(name) : nullptr;
+}
+
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::createClusterEntryOnDemand(
+    absl::string_view name) {
+  const ThreadLocalClusterSnapshotConstSharedPtr snapshot = cluster_registry_->acquireCopy(name);
+  if (snapshot == nullptr) {
+    return nullptr;
+  }
+
+  ENVOY_LOG(debug, "creating TLS cluster {} on demand", name);
+  auto entry =
+      std::make_unique<ClusterEntry>(*this, snapshot->cluster_info_, snapshot->lb_factory_);
+  for (uint32_t priority = 0; priority < snapshot->host_sets_.size(); priority++) {
+    const auto& host_set = snapshot->host_sets_[priority];
+    if (!host_set.has_value()) {
+      continue;
+    }
+    PrioritySet::UpdateHostsParams update_hosts_params = host_set->update_hosts_params_;
+    entry->priority_set_.updateHosts(priority, std::move(update_hosts_params),
+                                     host_set->locality_weights_,
+                                     *host_set->update_hosts_params_.hosts, {},
+                                     host_set->overprovisioning_factor_);
+  }
+  // Thread aware LBs only see the hosts when a worker local LB is created from the factory.
+  if (entry->lb_factory_ != nullptr) {
+    entry->lb_ = entry->lb_factory_->create();
+  }
+  entry->version_ = snapshot->version_;
+  cm_stats_.thread_local_cluster_created_on_demand_.inc();
+
+  ClusterEntry* raw_entry = entry.get();
+  thread_local_clusters_.emplace(std::string(name), std::move(entry));
+  return raw_entry;
+}
+
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onIdleSweep() {
+  for (auto it = thread_local_clusters_.begin(); it != thread_local_clusters_.end();) {
+    ClusterEntry& entry = *it->second;
+    // Anything holding on to a cluster, such as cluster update callbacks, follows its membership
+    // through a member update callback and keeps the cluster around until that is removed.
+    if (entry.pinned_ || entry.used_ || entry.priority_set_.hasMemberUpdateCbs()) {
+      entry.used_ = false;
+      ++it;
+      continue;
+    }
+    ENVOY_LOG(debug, "evicting idle TLS cluster {}", it->first);
+    cm_stats_.thread_local_cluster_evicted_.inc();
+    thread_local_clusters_.erase(it++);
+  }
+  idle_sweep_timer_->enableTimer(parent_.thread_local_cluster_idle_timeout_);
+}
+
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
     const HostSharedPtr& host) {
 
@@ -1291,7 +1564,11 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
                          parent.parent_.random_,
                          Router::ShadowWriterPtr{new Router::ShadowWriterImpl(parent.parent_)},
                          parent_.parent_.http_context_) {
+  parent_.cm_stats_.thread_local_clusters_.inc();
   priority_set_.getOrCreateHostSet(0);
+  // Cluster provided load balancers may be updated by their cluster outside of membership updates,
+  // which a copy created again from the cluster's snapshot would miss.
+  pinned_ = cluster->lbType() == LoadBalancerType::ClusterProvided;
 
   // TODO(mattklein123): Consider converting other LBs over to thread local. All of them could
   // benefit given the healthy panic, locality, and priority calculations that take place.
@@ -1346,6 +1623,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry()
   for (auto& host_set : priority_set_.hostSetsPerPriority()) {
     parent_.drainConnPools(host_set->hosts());
   }
+  parent_.cm_stats_.thread_local_clusters_.dec();
+  if (parent_.cluster_registry_ != nullptr) {
+    parent_.cluster_registry_->releaseCopy(cluster_info_->name());
+  }
 }
 
 Http::ConnectionPool::Instance*
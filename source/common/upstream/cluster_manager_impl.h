@@ -25,6 +25,7 @@
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/cleanup.h"
+#include "common/common/thread_pool.h"
 #include "common/config/grpc_mux_impl.h"
 #include "common/config/subscription_factory_impl.h"
 #include "common/http/async_client_impl.h"
@@ -32,6 +33,10 @@
 #include "common/upstream/priority_conn_pool_map.h"
 #include "common/upstream/upstream_impl.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -175,7 +180,10 @@ private:
   COUNTER(cluster_updated_via_merge)                                                               \
   COUNTER(update_merge_cancelled)                                                                  \
   COUNTER(update_out_of_merge_window)                                                              \
+  COUNTER(thread_local_cluster_created_on_demand)                                                  \
+  COUNTER(thread_local_cluster_evicted)                                                            \
   GAUGE(active_clusters, NeverImport)                                                              \
+  GAUGE(thread_local_clusters, NeverImport)                                                        \
   GAUGE(warming_clusters, NeverImport)
 
 /**
@@ -205,6 +213,10 @@ public:
   // Upstream::ClusterManager
   bool addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
                           const std::string& version_info) override;
+  bool addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
+                          const std::string& version_info, uint64_t config_hash) override;
+  std::vector<uint64_t>
+  hashClusters(const std::vector<const envoy::config::cluster::v3::Cluster*>& clusters) override;
 
   void setPrimaryClustersInitializedCb(PrimaryClustersReadyCallback callback) override {
     init_helper_.setPrimaryClustersInitializedCb(callback);
@@ -278,6 +290,9 @@ protected:
                                             const HostVector& hosts_removed);
 
 private:
+  struct ThreadLocalClusterRegistry;
+  using ThreadLocalClusterRegistrySharedPtr = std::shared_ptr<ThreadLocalClusterRegistry>;
+
   /**
    * Thread local cached cluster data. Each thread local cluster gets updates from the parent
    * central dynamic cluster (if applicable). It maintains load balancer state and any created
@@ -357,6 +372,14 @@ private:
       LoadBalancerPtr lb_;
       ClusterInfoConstSharedPtr cluster_info_;
       Http::AsyncClientImpl http_async_client_;
+      // Version of the last cluster or membership update applied to this entry. Updates posted
+      // before the snapshot this entry was created from are skipped.
+      uint64_t version_{};
+      // Set on every use and cleared by every idle sweep. Only consulted in lazy mode.
+      bool used_{true};
+      // Pinned entries are never evicted, nor are entries whose priority set has member update
+      // callbacks. @see ThreadLocalClusterManagerImpl::onIdleSweep().
+      bool pinned_{};
     };
 
     using ClusterEntryPtr = std::unique_ptr<ClusterEntry>;
@@ -374,15 +397,25 @@ private:
                                  PrioritySet::UpdateHostsParams update_hosts_params,
                                  LocalityWeightsConstSharedPtr locality_weights,
                                  const HostVector& hosts_added, const HostVector& hosts_removed,
-                                 uint64_t overprovisioning_factor);
+                                 uint64_t overprovisioning_factor, uint64_t version);
     void onHostHealthFailure(const HostSharedPtr& host);
+    // Returns the entry for a cluster, creating it from the cluster's snapshot in lazy mode.
+    ClusterEntry* getClusterEntry(absl::string_view name);
+    ClusterEntry* createClusterEntryOnDemand(absl::string_view name);
+    void onIdleSweep();
 
     ConnPoolsContainer* getHttpConnPoolsContainer(const HostConstSharedPtr& host,
                                                   bool allocate = false);
 
     ClusterManagerImpl& parent_;
     Event::Dispatcher& thread_local_dispatcher_;
+    // A copy of the parent's stats, which may be used after the parent is gone during shutdown.
+    ClusterManagerStats cm_stats_;
+    // Only set in lazy mode. Declared before the clusters, which are released to it.
+    const ThreadLocalClusterRegistrySharedPtr cluster_registry_;
     absl::flat_hash_map<std::string, ClusterEntryPtr> thread_local_clusters_;
+    // Only set in lazy mode.
+    Event::TimerPtr idle_sweep_timer_;
 
     // These maps are owned by the ThreadLocalClusterManagerImpl instead of the ClusterEntry
     // to prevent lifetime/ownership issues when a cluster is dynamically removed.
@@ -396,13 +429,14 @@ private:
   };
 
   struct ClusterData {
-    ClusterData(const envoy::config::cluster::v3::Cluster& cluster_config,
+    ClusterData(const envoy::config::cluster::v3::Cluster& cluster_config, uint64_t config_hash,
                 const std::string& version_info, bool added_via_api, ClusterSharedPtr&& cluster,
                 TimeSource& time_source)
-        : cluster_config_(cluster_config), config_hash_(MessageUtil::hash(cluster_config)),
+        : cluster_config_(cluster_config), config_hash_(config_hash),
           version_info_(version_info), added_via_api_(added_via_api), cluster_(std::move(cluster)),
           last_updated_(time_source.systemTime()) {}
 
+    // Statically defined clusters can never be updated, so their config hash is never consulted.
     bool blockUpdate(uint64_t hash) { return !added_via_api_ || config_hash_ == hash; }
 
     LoadBalancerFactorySharedPtr loadBalancerFactory() {
@@ -426,8 +460,68 @@ private:
   struct ClusterUpdateCallbacksHandleImpl : public ClusterUpdateCallbacksHandle,
                                             RaiiListElement<ClusterUpdateCallbacks*> {
     ClusterUpdateCallbacksHandleImpl(ClusterUpdateCallbacks& cb,
-                                     std::list<ClusterUpdateCallbacks*>& parent)
-        : RaiiListElement<ClusterUpdateCallbacks*>(parent, &cb) {}
+                                     std::list<ClusterUpdateCallbacks*>& parent,
+                                     ThreadLocalClusterRegistrySharedPtr cluster_registry);
+    ~ClusterUpdateCallbacksHandleImpl() override;
+
+    // Only set in lazy mode.
+    const ThreadLocalClusterRegistrySharedPtr cluster_registry_;
+  };
+
+  /**
+   * What a worker needs to create its copy of a cluster on first use, as of the latest cluster or
+   * membership update posted to the workers. Snapshots are immutable and are replaced on every
+   * update. They are only maintained when thread local clusters are lazy.
+   */
+  struct ThreadLocalClusterSnapshot {
+    struct HostSet {
+      PrioritySet::UpdateHostsParams update_hosts_params_;
+      LocalityWeightsConstSharedPtr locality_weights_;
+      uint64_t overprovisioning_factor_;
+    };
+
+    ClusterInfoConstSharedPtr cluster_info_;
+    LoadBalancerFactorySharedPtr lb_factory_;
+    // Indexed by priority. Empty for priorities that have not been updated yet.
+    std::vector<absl::optional<HostSet>> host_sets_;
+    uint64_t version_;
+  };
+  using ThreadLocalClusterSnapshotConstSharedPtr =
+      std::shared_ptr<const ThreadLocalClusterSnapshot>;
+
+  /**
+   * The latest snapshot of each cluster, and what the threads hold that needs cluster updates.
+   * Updates of a cluster are only posted to the threads if any holds a copy of it, or for cluster
+   * adds, updates and removals, has cluster update callbacks. Shared with the thread local cluster
+   * managers, which release their copies after the cluster manager is gone during shutdown. Only
+   * used when thread local clusters are lazy.
+   */
+  struct ThreadLocalClusterRegistry {
+    // Replaces the snapshot of a cluster, or drops it if null. Returns whether any thread holds a
+    // copy of the cluster or, if update_callbacks is set, has cluster update callbacks.
+    bool setSnapshot(const std::string& name, ThreadLocalClusterSnapshotConstSharedPtr snapshot,
+                     bool update_callbacks);
+    ThreadLocalClusterSnapshotConstSharedPtr snapshot(absl::string_view name);
+    // Returns the snapshot to create a copy of a cluster from and counts the copy, or null if the
+    // cluster does not exist.
+    ThreadLocalClusterSnapshotConstSharedPtr acquireCopy(absl::string_view name);
+    // Counts a copy created without acquireCopy().
+    void addCopy(const std::string& name);
+    void releaseCopy(const std::string& name);
+    void addUpdateCallbacks();
+    void removeUpdateCallbacks();
+
+    struct Entry {
+      ThreadLocalClusterSnapshotConstSharedPtr snapshot_;
+      // Number of thread local copies of the cluster.
+      uint32_t copies_{};
+    };
+
+    absl::Mutex mutex_;
+    // Clusters are kept until they are removed and no thread holds a copy.
+    absl::flat_hash_map<std::string, Entry> clusters_ ABSL_GUARDED_BY(mutex_);
+    // Number of cluster update callbacks registered across all threads.
+    uint32_t update_callbacks_ ABSL_GUARDED_BY(mutex_){};
   };
 
   using ClusterDataPtr = std::unique_ptr<ClusterData>;
@@ -477,12 +571,12 @@ private:
   void createOrUpdateThreadLocalCluster(ClusterData& cluster);
   ProtobufTypes::MessagePtr dumpClusterConfigs();
   static ClusterManagerStats generateStats(Stats::Scope& scope);
-  void loadCluster(const envoy::config::cluster::v3::Cluster& cluster,
+  void loadCluster(const envoy::config::cluster::v3::Cluster& cluster, uint64_t config_hash,
                    const std::string& version_info, bool added_via_api, ClusterMap& cluster_map);
   void onClusterInit(Cluster& cluster);
   void postThreadLocalHealthFailure(const HostSharedPtr& host);
   void updateClusterCounts();
-  void maybePrefetch(ThreadLocalClusterManagerImpl::ClusterEntryPtr& cluster_entry,
+  void maybePrefetch(ThreadLocalClusterManagerImpl::ClusterEntry& cluster_entry,
                      std::function<ConnectionPool::Instance*()> prefetch_pool);
 
   ClusterManagerFactory& factory_;
@@ -516,6 +610,16 @@ private:
   Http::Context& http_context_;
   Config::SubscriptionFactoryImpl subscription_factory_;
   ClusterSet primary_clusters_;
+  Thread::ThreadFactory& thread_factory_;
+  // Lazily created on the first CDS update large enough to be worth hashing in parallel.
+  Thread::ThreadPoolPtr config_hash_pool_;
+  // Set if workers create their copy of a cluster on first use. @see ThreadLocalClusterSnapshot.
+  const bool lazy_thread_local_clusters_;
+  const std::chrono::milliseconds thread_local_cluster_idle_timeout_;
+  // Incremented for every cluster and membership update of the thread local clusters.
+  uint64_t thread_local_cluster_version_{};
+  // Only set in lazy mode.
+  const ThreadLocalClusterRegistrySharedPtr thread_local_cluster_registry_;
 };
 
 } // namespace Upstream
@@ -456,6 +456,9 @@ public:
 
   void batchHostUpdate(BatchUpdateCb& callback) override;
 
+  // Whether anything registered a member update callback that has not been removed.
+  bool hasMemberUpdateCbs() const { return !member_update_cb_helper_.empty(); }
+
 protected:
   // Allows subclasses of PrioritySetImpl to create their own type of HostSetImpl.
   virtual HostSetImplPtr createHostSet(uint32_t priority,
@@ -5,6 +5,14 @@ namespace Extensions {
 namespace AccessLoggers {
 namespace File {
 
+namespace {
+
+// Lines are formatted into a string reused by the file access logs of each thread, unless a line
+// made it grow beyond this.
+constexpr size_t MaxRetainedLineCapacity = 16 * 1024;
+
+} // namespace
+
 FileAccessLog::FileAccessLog(const std::string& access_log_path, AccessLog::FilterPtr&& filter,
                              Formatter::FormatterPtr&& formatter,
                              AccessLog::AccessLogManager& log_manager)
@@ -16,8 +24,15 @@ void FileAccessLog::emitLog(const Http::RequestHeaderMap& request_headers,
                             const Http::ResponseHeaderMap& response_headers,
                             const Http::ResponseTrailerMap& response_trailers,
                             const StreamInfo::StreamInfo& stream_info) {
-  log_file_->write(formatter_->format(request_headers, response_headers, response_trailers,
-                                      stream_info, absl::string_view()));
+  static thread_local std::string line;
+  line.clear();
+  formatter_->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                       absl::string_view(), line);
+  // The access log file copies the line into its own buffer.
+  log_file_->write(line);
+  if (line.capacity() > MaxRetainedLineCapacity) {
+    std::string().swap(line);
+  }
 }
 
 } // namespace File
@@ -5,6 +5,8 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/assert.h"
+#include "common/config/version_converter.h"
+#include "common/grpc/common.h"
 #include "common/grpc/typed_async_client.h"
 #include "common/network/utility.h"
 #include "common/runtime/runtime_features.h"
@@ -15,6 +17,30 @@ namespace Extensions {
 namespace AccessLoggers {
 namespace GrpcCommon {
 
+namespace {
+
+// Embedded messages are length delimited fields (wire type 2). The wire format of a
+// StreamAccessLogsMessage is built from its http_logs (2) and tcp_logs (3) fields, and from the
+// log_entry field (1) of HTTPAccessLogEntries and TCPAccessLogEntries.
+constexpr uint32_t ProtobufLengthDelimitedField = 2;
+constexpr uint32_t HttpLogsTag = (2 << 3) | ProtobufLengthDelimitedField;
+constexpr uint32_t TcpLogsTag = (3 << 3) | ProtobufLengthDelimitedField;
+constexpr uint32_t LogEntryTag = (1 << 3) | ProtobufLengthDelimitedField;
+
+// Append a length delimited field to output, moving its contents out of field_data.
+void moveField(uint32_t tag, Buffer::Instance& field_data, Buffer::Instance& output) {
+  if (field_data.length() == 0) {
+    return;
+  }
+  uint8_t header[2 * Protobuf::io::CodedOutputStream::kMaxVarint32Bytes];
+  uint8_t* current = Protobuf::io::CodedOutputStream::WriteTagToArray(tag, header);
+  current = Protobuf::io::CodedOutputStream::WriteVarint32ToArray(field_data.length(), current);
+  output.add(header, current - header);
+  output.move(field_data);
+}
+
+} // namespace
+
 void GrpcAccessLoggerImpl::LocalStream::onRemoteClose(Grpc::Status::GrpcStatus,
                                                       const std::string&) {
   ASSERT(parent_.stream_ != absl::nullopt);
@@ -69,23 +95,41 @@ void GrpcAccessLoggerImpl::log(envoy::data::accesslog::v3::HTTPAccessLogEntry&&
   if (!canLogMore()) {
     return;
   }
-  approximate_message_size_bytes_ += entry.ByteSizeLong();
-  message_.mutable_http_logs()->mutable_log_entry()->Add(std::move(entry));
+  addEntry(entry, http_logs_);
   if (approximate_message_size_bytes_ >= max_buffer_size_bytes_) {
     flush();
   }
 }
 
 void GrpcAccessLoggerImpl::log(envoy::data::accesslog::v3::TCPAccessLogEntry&& entry) {
-  approximate_message_size_bytes_ += entry.ByteSizeLong();
-  message_.mutable_tcp_logs()->mutable_log_entry()->Add(std::move(entry));
+  addEntry(entry, tcp_logs_);
   if (approximate_message_size_bytes_ >= max_buffer_size_bytes_) {
     flush();
   }
 }
 
+void GrpcAccessLoggerImpl::addEntry(const Protobuf::Message& entry, Buffer::Instance& logs) {
+  // Entries are built by Envoy in the v3 API, and never carry the deprecated or original type
+  // information that VersionConverter::prepareMessageForGrpcWire() removes, so they can be
+  // serialized as is.
+  const uint32_t entry_size = entry.ByteSizeLong();
+  approximate_message_size_bytes_ += entry_size;
+  const uint32_t field_size = Protobuf::io::CodedOutputStream::VarintSize32(LogEntryTag) +
+                              Protobuf::io::CodedOutputStream::VarintSize32(entry_size) +
+                              entry_size;
+  Buffer::RawSlice iovec;
+  logs.reserve(field_size, &iovec, 1);
+  ASSERT(iovec.len_ >= field_size);
+  iovec.len_ = field_size;
+  uint8_t* current = reinterpret_cast<uint8_t*>(iovec.mem_);
+  current = Protobuf::io::CodedOutputStream::WriteTagToArray(LogEntryTag, current);
+  current = Protobuf::io::CodedOutputStream::WriteVarint32ToArray(entry_size, current);
+  entry.SerializeWithCachedSizesToArray(current);
+  logs.commit(&iovec, 1);
+}
+
 void GrpcAccessLoggerImpl::flush() {
-  if (!message_.has_http_logs() && !message_.has_tcp_logs()) {
+  if (http_logs_.length() == 0 && tcp_logs_.length() == 0) {
     // Nothing to flush.
     return;
   }
@@ -98,16 +142,24 @@ void GrpcAccessLoggerImpl::flush() {
     stream_->stream_ =
         client_->start(service_method_, *stream_, Http::AsyncClient::StreamOptions());
 
-    auto* identifier = message_.mutable_identifier();
+    envoy::service::accesslog::v3::StreamAccessLogsMessage message;
+    auto* identifier = message.mutable_identifier();
     *identifier->mutable_node() = local_info_.node();
     identifier->set_log_name(log_name_);
+    Config::VersionConverter::prepareMessageForGrpcWire(message, transport_api_version_);
+    identifier_.drain(identifier_.length());
+    identifier_.move(*Grpc::Common::serializeMessage(message));
   }
 
   if (stream_->stream_ != nullptr) {
     if (stream_->stream_->isAboveWriteBufferHighWatermark()) {
       return;
     }
-    stream_->stream_->sendMessage(message_, transport_api_version_, false);
+    Buffer::InstancePtr message = std::make_unique<Buffer::OwnedImpl>();
+    message->move(identifier_);
+    moveField(HttpLogsTag, http_logs_, *message);
+    moveField(TcpLogsTag, tcp_logs_, *message);
+    stream_->stream_->sendMessageRaw(std::move(message), false);
   } else {
     // Clear out the stream data due to stream creation failure.
     stream_.reset();
@@ -115,7 +167,9 @@ void GrpcAccessLoggerImpl::flush() {
 
   // Clear the message regardless of the success.
   approximate_message_size_bytes_ = 0;
-  message_.Clear();
+  identifier_.drain(identifier_.length());
+  http_logs_.drain(http_logs_.length());
+  tcp_logs_.drain(tcp_logs_.length());
 }
 
 GrpcAccessLoggerCacheImpl::GrpcAccessLoggerCacheImpl(Grpc::AsyncClientManager& async_client_manager,
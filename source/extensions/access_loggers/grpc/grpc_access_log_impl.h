@@ -12,6 +12,7 @@
 #include "envoy/singleton/instance.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/grpc/typed_async_client.h"
 
 #include "extensions/access_loggers/common/access_log_base.h"
@@ -113,6 +114,9 @@ private:
 
   bool canLogMore();
 
+  // Append an entry, serialized as a log_entry field, to http_logs_ or tcp_logs_.
+  void addEntry(const Protobuf::Message& entry, Buffer::Instance& logs);
+
   GrpcAccessLoggerStats stats_;
   Grpc::AsyncClient<envoy::service::accesslog::v3::StreamAccessLogsMessage,
                     envoy::service::accesslog::v3::StreamAccessLogsResponse>
@@ -122,7 +126,13 @@ private:
   const Event::TimerPtr flush_timer_;
   const uint64_t max_buffer_size_bytes_;
   uint64_t approximate_message_size_bytes_ = 0;
-  envoy::service::accesslog::v3::StreamAccessLogsMessage message_;
+  // The pending StreamAccessLogsMessage is kept in wire format rather than as a message, so that
+  // entries are serialized once, when they are logged, and flushing only concatenates bytes.
+  // identifier_ holds the identifier field for the first message of a stream. http_logs_ and
+  // tcp_logs_ hold the log_entry fields of the http_logs and tcp_logs fields.
+  Buffer::OwnedImpl identifier_;
+  Buffer::OwnedImpl http_logs_;
+  Buffer::OwnedImpl tcp_logs_;
   absl::optional<LocalStream> stream_;
   const LocalInfo::LocalInfo& local_info_;
   const Protobuf::MethodDescriptor& service_method_;
@@ -52,7 +52,7 @@ Cluster::linearizePrioritySet(const std::function<bool(const std::string&)>& ski
             next_priority_after_linearizing, Upstream::HostSetImpl::updateHostsParams(*host_set),
             host_set->localityWeights(), host_set->hosts(), {}, host_set->overprovisioningFactor());
         priority_context->priority_to_cluster_.emplace_back(
-            std::make_pair(priority_in_current_cluster, tlc));
+            std::make_pair(priority_in_current_cluster, cluster));
 
         priority_context->cluster_and_priority_to_linearized_priority_[std::make_pair(
             cluster, priority_in_current_cluster)] = next_priority_after_linearizing;
@@ -114,9 +114,8 @@ void Cluster::onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) {
 }
 
 void Cluster::onClusterRemoval(const std::string& cluster_name) {
-  //  The onClusterRemoval callback is called before the thread local cluster is removed. There
-  //  will be a dangling pointer to the thread local cluster if the deleted cluster is not skipped
-  //  when we refresh the load balancer.
+  //  The onClusterRemoval callback is called before the thread local cluster is removed. The
+  //  deleted cluster would still be picked up by the refresh if it was not skipped.
   if (std::find(clusters_.begin(), clusters_.end(), cluster_name) != clusters_.end()) {
     ENVOY_LOG(debug, "removing cluster '{}' from aggreagte cluster '{}'", cluster_name,
               info()->name());
@@ -157,7 +156,11 @@ AggregateClusterLoadBalancer::LoadBalancerImpl::chooseHost(Upstream::LoadBalance
       priority_context_.priority_to_cluster_[priority_pair.first].first);
 
   Upstream::ThreadLocalCluster* cluster =
-      priority_context_.priority_to_cluster_[priority_pair.first].second;
+      cluster_manager_.get(priority_context_.priority_to_cluster_[priority_pair.first].second);
+  if (cluster == nullptr) {
+    // The cluster was removed and the priority set has not been refreshed yet.
+    return nullptr;
+  }
   return cluster->loadBalancer().chooseHost(&aggregate_context);
 }
 
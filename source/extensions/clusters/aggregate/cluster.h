@@ -14,7 +14,9 @@ namespace Extensions {
 namespace Clusters {
 namespace Aggregate {
 
-using PriorityToClusterVector = std::vector<std::pair<uint32_t, Upstream::ThreadLocalCluster*>>;
+// Maps the linearized priority to pair(host_priority, host_cluster_name). Clusters are referred to
+// by name since thread local clusters may be evicted and created again between refreshes.
+using PriorityToClusterVector = std::vector<std::pair<uint32_t, std::string>>;
 
 // Maps pair(host_cluster_name, host_priority) to the linearized priority of the Aggregate cluster.
 using ClusterAndPriorityToLinearizedPriorityMap =
@@ -71,9 +73,11 @@ private:
 class AggregateClusterLoadBalancer : public Upstream::LoadBalancer {
 public:
   AggregateClusterLoadBalancer(
-      Upstream::ClusterStats& stats, Runtime::Loader& runtime, Random::RandomGenerator& random,
+      Upstream::ClusterManager& cluster_manager, Upstream::ClusterStats& stats,
+      Runtime::Loader& runtime, Random::RandomGenerator& random,
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
-      : stats_(stats), runtime_(runtime), random_(random), common_config_(common_config) {}
+      : cluster_manager_(cluster_manager), stats_(stats), runtime_(runtime), random_(random),
+        common_config_(common_config) {}
 
   // Upstream::LoadBalancer
   Upstream::HostConstSharedPtr chooseHost(Upstream::LoadBalancerContext* context) override;
@@ -87,12 +91,13 @@ private:
   // priority set could be empty, we cannot initialize LoadBalancerBase when priority set is empty.
   class LoadBalancerImpl : public Upstream::LoadBalancerBase {
   public:
-    LoadBalancerImpl(const PriorityContext& priority_context, Upstream::ClusterStats& stats,
+    LoadBalancerImpl(const PriorityContext& priority_context,
+                     Upstream::ClusterManager& cluster_manager, Upstream::ClusterStats& stats,
                      Runtime::Loader& runtime, Random::RandomGenerator& random,
                      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
         : Upstream::LoadBalancerBase(priority_context.priority_set_, stats, runtime, random,
                                      common_config),
-          priority_context_(priority_context) {}
+          priority_context_(priority_context), cluster_manager_(cluster_manager) {}
 
     // Upstream::LoadBalancer
     Upstream::HostConstSharedPtr chooseHost(Upstream::LoadBalancerContext* context) override;
@@ -110,11 +115,13 @@ private:
 
   private:
     const PriorityContext& priority_context_;
+    Upstream::ClusterManager& cluster_manager_;
   };
 
   using LoadBalancerImplPtr = std::unique_ptr<LoadBalancerImpl>;
 
   LoadBalancerImplPtr load_balancer_;
+  Upstream::ClusterManager& cluster_manager_;
   Upstream::ClusterStats& stats_;
   Runtime::Loader& runtime_;
   Random::RandomGenerator& random_;
@@ -124,8 +131,8 @@ private:
 public:
   void refresh(PriorityContextPtr priority_context) {
     if (!priority_context->priority_set_.hostSetsPerPriority().empty()) {
-      load_balancer_ = std::make_unique<LoadBalancerImpl>(*priority_context, stats_, runtime_,
-                                                          random_, common_config_);
+      load_balancer_ = std::make_unique<LoadBalancerImpl>(
+          *priority_context, cluster_manager_, stats_, runtime_, random_, common_config_);
     } else {
       load_balancer_ = nullptr;
     }
@@ -140,7 +147,8 @@ struct AggregateLoadBalancerFactory : public Upstream::LoadBalancerFactory {
   // Upstream::LoadBalancerFactory
   Upstream::LoadBalancerPtr create() override {
     return std::make_unique<AggregateClusterLoadBalancer>(
-        cluster_.info()->stats(), cluster_.runtime_, cluster_.random_, cluster_.info()->lbConfig());
+        cluster_.cluster_manager_, cluster_.info()->stats(), cluster_.runtime_, cluster_.random_,
+        cluster_.info()->lbConfig());
   }
 
   const Cluster& cluster_;
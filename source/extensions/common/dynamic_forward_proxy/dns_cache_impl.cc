@@ -1,5 +1,8 @@
 #include "extensions/common/dynamic_forward_proxy/dns_cache_impl.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "envoy/extensions/common/dynamic_forward_proxy/v3/dns_cache.pb.h"
 
 #include "common/config/utility.h"
@@ -31,9 +34,9 @@ DnsCacheImpl::DnsCacheImpl(
               envoy::extensions::common::dynamic_forward_proxy::v3::DnsCacheConfig>(
               config, refresh_interval_.count(), random)),
       host_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, host_ttl, 300000)),
-      max_hosts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_hosts, 1024)) {
+      max_hosts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_hosts, 1024)),
+      evict_on_overflow_(config.evict_hosts_on_overflow()) {
   tls_slot_->set([](Event::Dispatcher&) { return std::make_shared<ThreadLocalHostInfo>(); });
-  updateTlsHostsMap();
 }
 
 DnsCacheImpl::~DnsCacheImpl() {
@@ -55,23 +58,22 @@ DnsCacheStats DnsCacheImpl::generateDnsCacheStats(Stats::Scope& scope) {
 DnsCacheImpl::LoadDnsCacheEntryResult
 DnsCacheImpl::loadDnsCacheEntry(absl::string_view host, uint16_t default_port,
                                 LoadDnsCacheEntryCallbacks& callbacks) {
-  ENVOY_LOG(debug, "thread local lookup for host '{}'", host);
-  auto& tls_host_info = tls_slot_->getTyped<ThreadLocalHostInfo>();
-  auto tls_host = tls_host_info.host_map_->find(host);
-  if (tls_host != tls_host_info.host_map_->end()) {
-    ENVOY_LOG(debug, "thread local hit for host '{}'", host);
+  ENVOY_LOG(debug, "shared table lookup for host '{}'", host);
+  if (host_table_.contains(host)) {
+    ENVOY_LOG(debug, "shared table hit for host '{}'", host);
     return {LoadDnsCacheEntryStatus::InCache, nullptr};
-  } else if (tls_host_info.host_map_->size() >= max_hosts_) {
-    // Given that we do this check in thread local context, it's possible for two threads to race
-    // and potentially go slightly above the configured max hosts. This is an OK given compromise
-    // given how much simpler the implementation is.
+  } else if (!evict_on_overflow_ && host_table_.size() >= max_hosts_) {
+    // Given that the table size is read without synchronizing with the main thread, it's possible
+    // for two threads to race and potentially go slightly above the configured max hosts. This is
+    // an OK given compromise given how much simpler the implementation is.
     ENVOY_LOG(debug, "DNS cache overflow for host '{}'", host);
     stats_.host_overflow_.inc();
     return {LoadDnsCacheEntryStatus::Overflow, nullptr};
   } else {
-    ENVOY_LOG(debug, "thread local miss for host '{}', posting to main thread", host);
+    ENVOY_LOG(debug, "shared table miss for host '{}', posting to main thread", host);
     main_thread_dispatcher_.post(
         [this, host = std::string(host), default_port]() { startCacheLoad(host, default_port); });
+    auto& tls_host_info = tls_slot_->getTyped<ThreadLocalHostInfo>();
     return {LoadDnsCacheEntryStatus::Loading,
             std::make_unique<LoadDnsCacheEntryHandleImpl>(tls_host_info.pending_resolutions_, host,
                                                           callbacks)};
@@ -131,9 +133,68 @@ void DnsCacheImpl::startCacheLoad(const std::string& host, uint16_t default_port
                                                    host_attributes.is_ip_address_,
                                                    [this, host]() { onReResolve(host); }))
                             .first->second;
+  if (evict_on_overflow_ && primary_hosts_.size() > max_hosts_) {
+    evictHosts();
+  }
   startResolve(host, primary_host);
 }
 
+void DnsCacheImpl::evictHosts() {
+  // Hosts are evicted in batches down to a low watermark so that the linear scan needed to find
+  // the least recently used hosts is amortized over many insertions. Hosts whose TTL has already
+  // expired are always part of the batch, regardless of the watermark. Hosts that have not yet
+  // completed their first resolution (including the one that triggered the eviction) or that have
+  // an in-flight re-resolution are never evicted.
+  const size_t low_watermark = max_hosts_ - max_hosts_ / 10;
+  const std::chrono::steady_clock::duration now_duration =
+      main_thread_dispatcher_.timeSource().monotonicTime().time_since_epoch();
+
+  std::vector<std::string> to_evict;
+  std::vector<std::pair<std::chrono::steady_clock::duration, const std::string*>> candidates;
+  for (const auto& primary_host : primary_hosts_) {
+    if (primary_host.second->active_query_ != nullptr ||
+        !primary_host.second->host_info_->first_resolve_complete_) {
+      continue;
+    }
+    const auto last_used_time = primary_host.second->host_info_->last_used_time_.load();
+    if (now_duration - last_used_time > host_ttl_) {
+      to_evict.push_back(primary_host.first);
+    } else {
+      candidates.emplace_back(last_used_time, &primary_host.first);
+    }
+  }
+
+  const size_t remaining = primary_hosts_.size() - to_evict.size();
+  if (remaining > low_watermark) {
+    const size_t num_lru = std::min(remaining - low_watermark, candidates.size());
+    std::nth_element(candidates.begin(), candidates.begin() + num_lru, candidates.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    for (size_t i = 0; i < num_lru; i++) {
+      to_evict.push_back(*candidates[i].second);
+    }
+  }
+
+  ENVOY_LOG(debug, "evicting {} hosts from DNS cache", to_evict.size());
+  for (const auto& host : to_evict) {
+    removeHost(host);
+    stats_.host_evicted_.inc();
+  }
+}
+
+void DnsCacheImpl::removeHost(const std::string& host) {
+  const auto primary_host_it = primary_hosts_.find(host);
+  ASSERT(primary_host_it != primary_hosts_.end());
+
+  // If the host has no address then that means that the DnsCacheImpl has never
+  // runAddUpdateCallbacks for this host, and thus the callback targets are not aware of it.
+  // Therefore, runRemoveCallbacks should only be ran if the host's address != nullptr.
+  if (primary_host_it->second->host_info_->address_) {
+    runRemoveCallbacks(host);
+  }
+  host_table_.erase(host);
+  primary_hosts_.erase(primary_host_it);
+}
+
 void DnsCacheImpl::onReResolve(const std::string& host) {
   const auto primary_host_it = primary_hosts_.find(host);
   ASSERT(primary_host_it != primary_hosts_.end());
@@ -145,14 +206,7 @@ void DnsCacheImpl::onReResolve(const std::string& host) {
             primary_host_it->second->host_info_->last_used_time_.load().count());
   if (now_duration - primary_host_it->second->host_info_->last_used_time_.load() > host_ttl_) {
     ENVOY_LOG(debug, "host='{}' TTL expired, removing", host);
-    // If the host has no address then that means that the DnsCacheImpl has never
-    // runAddUpdateCallbacks for this host, and thus the callback targets are not aware of it.
-    // Therefore, runRemoveCallbacks should only be ran if the host's address != nullptr.
-    if (primary_host_it->second->host_info_->address_) {
-      runRemoveCallbacks(host);
-    }
-    primary_hosts_.erase(primary_host_it);
-    updateTlsHostsMap();
+    removeHost(host);
   } else {
     startResolve(host, *primary_host_it->second);
   }
@@ -215,8 +269,11 @@ void DnsCacheImpl::finishResolve(const std::string& host,
     stats_.host_address_changed_.inc();
   }
 
-  if (first_resolve || address_changed) {
-    updateTlsHostsMap();
+  // Once a host has completed its first resolution it becomes visible to the workers. Address
+  // changes are picked up through the shared host info and do not require republishing.
+  if (first_resolve) {
+    host_table_.insert(host, primary_host_info.host_info_);
+    notifyThreads(host);
   }
 
   // Kick off the refresh timer.
@@ -248,18 +305,12 @@ void DnsCacheImpl::runRemoveCallbacks(const std::string& host) {
   }
 }
 
-void DnsCacheImpl::updateTlsHostsMap() {
-  TlsHostMapSharedPtr new_host_map = std::make_shared<TlsHostMap>();
-  for (const auto& primary_host : primary_hosts_) {
-    // Do not include hosts that have not resolved at least once.
-    if (primary_host.second->host_info_->first_resolve_complete_) {
-      new_host_map->emplace(primary_host.first, primary_host.second->host_info_);
-    }
-  }
-
-  tls_slot_->runOnAllThreads([new_host_map](ThreadLocal::ThreadLocalObjectSharedPtr object)
+void DnsCacheImpl::notifyThreads(const std::string& host) {
+  // Only the name of the newly resolved host is sent to the workers so that the cost of adding a
+  // host does not depend on the number of hosts already in the cache.
+  tls_slot_->runOnAllThreads([host](ThreadLocal::ThreadLocalObjectSharedPtr object)
                                  -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    object->asType<ThreadLocalHostInfo>().updateHostMap(new_host_map);
+    object->asType<ThreadLocalHostInfo>().onHostMapUpdate(host);
     return object;
   });
 }
@@ -271,12 +322,11 @@ DnsCacheImpl::ThreadLocalHostInfo::~ThreadLocalHostInfo() {
   }
 }
 
-void DnsCacheImpl::ThreadLocalHostInfo::updateHostMap(const TlsHostMapSharedPtr& new_host_map) {
-  host_map_ = new_host_map;
+void DnsCacheImpl::ThreadLocalHostInfo::onHostMapUpdate(const std::string& resolved_host) {
   for (auto pending_resolution_it = pending_resolutions_.begin();
        pending_resolution_it != pending_resolutions_.end();) {
     auto& pending_resolution = **pending_resolution_it;
-    if (host_map_->count(pending_resolution.host_) != 0) {
+    if (pending_resolution.host_ == resolved_host) {
       auto& callbacks = pending_resolution.callbacks_;
       pending_resolution.cancel();
       pending_resolution_it = pending_resolutions_.erase(pending_resolution_it);
@@ -287,6 +337,29 @@ void DnsCacheImpl::ThreadLocalHostInfo::updateHostMap(const TlsHostMapSharedPtr&
   }
 }
 
+bool DnsCacheImpl::HostTable::contains(absl::string_view host) const {
+  const Shard& shard = shardFor(host);
+  absl::ReaderMutexLock lock(&shard.mutex_);
+  return shard.hosts_.contains(host);
+}
+
+void DnsCacheImpl::HostTable::insert(const std::string& host,
+                                     const DnsHostInfoImplSharedPtr& host_info) {
+  Shard& shard = shardFor(host);
+  absl::WriterMutexLock lock(&shard.mutex_);
+  if (shard.hosts_.insert_or_assign(host, host_info).second) {
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void DnsCacheImpl::HostTable::erase(const std::string& host) {
+  Shard& shard = shardFor(host);
+  absl::WriterMutexLock lock(&shard.mutex_);
+  if (shard.hosts_.erase(host) != 0) {
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
 DnsCacheImpl::PrimaryHostInfo::PrimaryHostInfo(DnsCacheImpl& parent,
                                                absl::string_view host_to_resolve, uint16_t port,
                                                bool is_ip_address, const Event::TimerCb& timer_cb)
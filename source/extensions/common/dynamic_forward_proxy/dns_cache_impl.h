@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+
 #include "envoy/common/backoff_strategy.h"
 #include "envoy/extensions/common/dynamic_forward_proxy/v3/dns_cache.pb.h"
 #include "envoy/http/filter.h"
@@ -12,6 +15,8 @@
 #include "extensions/common/dynamic_forward_proxy/dns_cache_resource_manager.h"
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -26,6 +31,7 @@ namespace DynamicForwardProxy {
   COUNTER(dns_query_failure)                                                                       \
   COUNTER(dns_query_success)                                                                       \
   COUNTER(host_added)                                                                              \
+  COUNTER(host_evicted)                                                                            \
   COUNTER(host_address_changed)                                                                    \
   COUNTER(host_overflow)                                                                           \
   COUNTER(host_removed)                                                                            \
@@ -56,8 +62,53 @@ public:
   canCreateDnsRequest(ResourceLimitOptRef pending_requests) override;
 
 private:
-  using TlsHostMap = absl::flat_hash_map<std::string, DnsHostInfoSharedPtr>;
-  using TlsHostMapSharedPtr = std::shared_ptr<TlsHostMap>;
+  struct DnsHostInfoImpl;
+  using DnsHostInfoImplSharedPtr = std::shared_ptr<DnsHostInfoImpl>;
+
+  /**
+   * A table of resolved hosts that is written only by the main thread and read directly by the
+   * workers. The table is split into a fixed number of independently locked shards so that worker
+   * lookups for different hosts rarely touch the same cache line, and so that publishing a newly
+   * resolved host does not require copying the entire table to every worker.
+   */
+  class HostTable {
+  public:
+    /**
+     * Look up a host. This does not allocate and does not touch the host info reference count.
+     * @return whether the host has been resolved at least once.
+     */
+    bool contains(absl::string_view host) const;
+
+    /**
+     * Insert or replace a host. Must only be called on the main thread.
+     */
+    void insert(const std::string& host, const DnsHostInfoImplSharedPtr& host_info);
+
+    /**
+     * Remove a host if present. Must only be called on the main thread.
+     */
+    void erase(const std::string& host);
+
+    /**
+     * @return the approximate number of hosts in the table. This is safe to call from any thread.
+     */
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr size_t NumShards = 16;
+
+    struct Shard {
+      mutable absl::Mutex mutex_;
+      absl::flat_hash_map<std::string, DnsHostInfoImplSharedPtr> hosts_ ABSL_GUARDED_BY(mutex_);
+    };
+
+    Shard& shardFor(absl::string_view host) const {
+      return shards_[absl::Hash<absl::string_view>()(host) % NumShards];
+    }
+
+    mutable std::array<Shard, NumShards> shards_;
+    std::atomic<size_t> size_{};
+  };
 
   struct LoadDnsCacheEntryHandleImpl : public LoadDnsCacheEntryHandle,
                                        RaiiListElement<LoadDnsCacheEntryHandleImpl*> {
@@ -70,12 +121,12 @@ private:
     LoadDnsCacheEntryCallbacks& callbacks_;
   };
 
-  // Per-thread DNS cache info including the currently known hosts as well as any pending callbacks.
+  // Per-thread DNS cache info including any pending callbacks. Resolved hosts themselves live in
+  // the shared HostTable.
   struct ThreadLocalHostInfo : public ThreadLocal::ThreadLocalObject {
     ~ThreadLocalHostInfo() override;
-    void updateHostMap(const TlsHostMapSharedPtr& new_host_map);
+    void onHostMapUpdate(const std::string& resolved_host);
 
-    TlsHostMapSharedPtr host_map_;
     std::list<LoadDnsCacheEntryHandleImpl*> pending_resolutions_;
   };
 
@@ -101,8 +152,6 @@ private:
     std::atomic<std::chrono::steady_clock::duration> last_used_time_;
   };
 
-  using DnsHostInfoImplSharedPtr = std::shared_ptr<DnsHostInfoImpl>;
-
   // Primary host information that accounts for TTL, re-resolution, etc.
   struct PrimaryHostInfo {
     PrimaryHostInfo(DnsCacheImpl& parent, absl::string_view host_to_resolve, uint16_t port,
@@ -133,7 +182,9 @@ private:
                      std::list<Network::DnsResponse>&& response);
   void runAddUpdateCallbacks(const std::string& host, const DnsHostInfoSharedPtr& host_info);
   void runRemoveCallbacks(const std::string& host);
-  void updateTlsHostsMap();
+  void notifyThreads(const std::string& host);
+  void removeHost(const std::string& host);
+  void evictHosts();
   void onReResolve(const std::string& host);
 
   Event::Dispatcher& main_thread_dispatcher_;
@@ -144,11 +195,13 @@ private:
   DnsCacheStats stats_;
   std::list<AddUpdateCallbacksHandleImpl*> update_callbacks_;
   absl::flat_hash_map<std::string, PrimaryHostInfoPtr> primary_hosts_;
+  HostTable host_table_;
   DnsCacheResourceManagerImpl resource_manager_;
   const std::chrono::milliseconds refresh_interval_;
   const BackOffStrategyPtr failure_backoff_strategy_;
   const std::chrono::milliseconds host_ttl_;
   const uint32_t max_hosts_;
+  const bool evict_on_overflow_;
 };
 
 } // namespace DynamicForwardProxy
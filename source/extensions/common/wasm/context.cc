@@ -115,23 +115,20 @@ WasmResult Buffer::copyTo(WasmBase* wasm, size_t start, size_t length, uint64_t
 
 WasmResult Buffer::copyFrom(size_t start, size_t length, absl::string_view data) {
   if (buffer_instance_) {
-    if (start == 0) {
-      if (length == 0) {
-        buffer_instance_->prepend(data);
-        return WasmResult::Ok;
-      } else if (length >= buffer_instance_->length()) {
-        buffer_instance_->drain(buffer_instance_->length());
-        buffer_instance_->add(data);
-        return WasmResult::Ok;
-      } else {
-        return WasmResult::BadArgument;
-      }
-    } else if (start >= buffer_instance_->length()) {
+    if (start >= buffer_instance_->length()) {
       buffer_instance_->add(data);
       return WasmResult::Ok;
-    } else {
-      return WasmResult::BadArgument;
     }
+    // Replace the range, which is truncated at the end of the buffer. The data before and after the
+    // range is moved slice by slice rather than copied, so that editing a few bytes of a large body
+    // doesn't copy the rest of it.
+    length = std::min<size_t>(length, buffer_instance_->length() - start);
+    ::Envoy::Buffer::OwnedImpl prefix;
+    prefix.move(*buffer_instance_, start);
+    buffer_instance_->drain(length);
+    buffer_instance_->prepend(data);
+    buffer_instance_->prepend(prefix);
+    return WasmResult::Ok;
   }
   if (const_buffer_instance_) { // This buffer is immutable.
     return WasmResult::BadArgument;
@@ -685,7 +682,7 @@ WasmResult Context::addHeaderMapValue(WasmHeaderMapType type, absl::string_view
     return WasmResult::BadArgument;
   }
   const Http::LowerCaseString lower_key{std::string(key)};
-  map->addCopy(lower_key, std::string(value));
+  map->addCopy(lower_key, value);
   return WasmResult::Ok;
 }
 
@@ -732,18 +729,12 @@ WasmResult Context::setHeaderMapPairs(WasmHeaderMapType type, const Pairs& pairs
   if (!map) {
     return WasmResult::BadArgument;
   }
-  std::vector<std::string> keys;
-  map->iterate([&keys](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
-    keys.push_back(std::string(header.key().getStringView()));
-    return Http::HeaderMap::Iterate::Continue;
-  });
-  for (auto& k : keys) {
-    const Http::LowerCaseString lower_key{k};
-    map->remove(lower_key);
-  }
+  // All the headers are replaced, so clear the map at once rather than removing each header by
+  // name, which would search the map for every header.
+  map->clear();
   for (auto& p : pairs) {
     const Http::LowerCaseString lower_key{std::string(p.first)};
-    map->addCopy(lower_key, std::string(p.second));
+    map->addCopy(lower_key, p.second);
   }
   return WasmResult::Ok;
 }
@@ -819,9 +810,10 @@ BufferInterface* Context::getBuffer(WasmBufferType type) {
   case WasmBufferType::HttpCallResponseBody:
     response = rootContext()->http_call_response_;
     if (response) {
-      auto& body = (*response)->body();
-      return buffer_.set(absl::string_view(static_cast<const char*>(body.linearize(body.length())),
-                                           body.length()));
+      // Bytes are copied out of the body's slices as they are requested, instead of linearizing the
+      // whole body first.
+      const ::Envoy::Buffer::Instance& body = (*response)->body();
+      return buffer_.set(&body);
     }
     return nullptr;
   case WasmBufferType::GrpcReceiveBuffer:
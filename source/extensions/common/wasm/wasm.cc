@@ -2,13 +2,18 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 
 #include "envoy/event/deferred_deletable.h"
 
+#include "common/buffer/buffer_impl.h"
+#include "common/common/hex.h"
 #include "common/common/logger.h"
+#include "common/crypto/utility.h"
 
 #include "extensions/common/wasm/wasm_extension.h"
 
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 
 #define WASM_CONTEXT(_c)                                                                           \
@@ -61,6 +66,79 @@ std::atomic<int64_t> active_wasms;
 std::mutex code_cache_mutex;
 absl::flat_hash_map<std::string, CodeCacheEntry>* code_cache = nullptr;
 
+// Remotely fetched code is kept in the code cache directory under its SHA-256. Only a well formed
+// digest, i.e. 64 lowercase hex digits, is used as a file name, so that the configured value can't
+// name a file outside of the directory.
+bool hasCodeCacheFileName(const VmConfig& vm_config) {
+  const std::string& sha256 = vm_config.code().remote().sha256();
+  return sha256.size() == 64 && std::all_of(sha256.begin(), sha256.end(), [](char c) {
+           return absl::ascii_isdigit(c) || (c >= 'a' && c <= 'f');
+         });
+}
+
+std::string codeCachePath(const VmConfig& vm_config) {
+  return absl::StrCat(vm_config.code_cache_directory(), "/", vm_config.code().remote().sha256(),
+                      ".wasm");
+}
+
+// Returns the code of the remote data source from the code cache directory, or an empty string if
+// it is missing or if it doesn't match the SHA-256 of the data source.
+std::string readCodeFromCacheDirectory(const VmConfig& vm_config, Api::Api& api) {
+  if (!hasCodeCacheFileName(vm_config)) {
+    return EMPTY_STRING;
+  }
+  const std::string path = codeCachePath(vm_config);
+  if (!api.fileSystem().fileExists(path)) {
+    return EMPTY_STRING;
+  }
+  std::string code;
+  try {
+    code = api.fileSystem().fileReadToEnd(path);
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG_TO_LOGGER(Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm), warn,
+                        "createWasm: failed to read cached code from {}: {}", path, e.what());
+    return EMPTY_STRING;
+  }
+  Buffer::OwnedImpl buffer(code);
+  if (Hex::encode(Envoy::Common::Crypto::UtilitySingleton::get().getSha256Digest(buffer)) !=
+      vm_config.code().remote().sha256()) {
+    ENVOY_LOG_TO_LOGGER(Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm), warn,
+                        "createWasm: ignoring cached code with a mismatched SHA-256 in {}", path);
+    return EMPTY_STRING;
+  }
+  return code;
+}
+
+// Writes the code to the code cache directory. The code is written to a temporary file which is
+// then renamed, so that a concurrent reader, e.g. the other Envoy during a hot restart, never sees
+// a partially written file.
+void writeCodeToCacheDirectory(const VmConfig& vm_config, absl::string_view code, Api::Api& api) {
+  if (!hasCodeCacheFileName(vm_config)) {
+    return;
+  }
+  const std::string path = codeCachePath(vm_config);
+  const std::string temporary_path = absl::StrCat(path, ".", api.randomGenerator().uuid());
+  Filesystem::FilePtr file = api.fileSystem().createFile(temporary_path);
+  bool written = file->open(1 << Filesystem::File::Operation::Write |
+                            1 << Filesystem::File::Operation::Create)
+                     .rc_;
+  while (written && !code.empty()) {
+    const Api::IoCallSizeResult result = file->write(code);
+    written = result.rc_ > 0;
+    if (written) {
+      code.remove_prefix(result.rc_);
+    }
+  }
+  if (file->isOpen()) {
+    written = file->close().rc_ && written;
+  }
+  if (!written || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    ENVOY_LOG_TO_LOGGER(Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm), warn,
+                        "createWasm: failed to write cached code to {}", path);
+    std::remove(temporary_path.c_str());
+  }
+}
+
 // Downcast WasmBase to the actual Wasm.
 inline Wasm* getWasm(WasmHandleSharedPtr& base_wasm_handle) {
   return static_cast<Wasm*>(base_wasm_handle->wasm().get());
@@ -320,6 +398,19 @@ static bool createWasmInternal(const VmConfig& vm_config, const PluginSharedPtr&
   if (vm_config.code().has_remote()) {
     auto now = dispatcher.timeSource().monotonicTime() + cache_time_offset_for_testing;
     source = vm_config.code().remote().http_uri().uri();
+    // Reading and hashing cached code from disk can be slow, so it is done before taking the lock,
+    // and only if the code isn't already in the in-memory cache.
+    std::string disk_code;
+    if (!vm_config.code_cache_directory().empty()) {
+      bool cached;
+      {
+        std::lock_guard<std::mutex> guard(code_cache_mutex);
+        cached = code_cache != nullptr && code_cache->contains(vm_config.code().remote().sha256());
+      }
+      if (!cached) {
+        disk_code = readCodeFromCacheDirectory(vm_config, api);
+      }
+    }
     std::lock_guard<std::mutex> guard(code_cache_mutex);
     if (!code_cache) {
       code_cache = new std::remove_reference<decltype(*code_cache)>::type;
@@ -361,12 +452,19 @@ static bool createWasmInternal(const VmConfig& vm_config, const PluginSharedPtr&
         wasm_extension->onEvent(WasmExtension::WasmEvent::RemoteLoadCacheHit, plugin);
       }
     } else {
-      fetch = true; // Not in cache, fetch.
       auto& e = (*code_cache)[vm_config.code().remote().sha256()];
-      e.in_progress = true;
       e.use_time = e.fetch_time = now;
+      code = std::move(disk_code);
+      if (!code.empty()) {
+        e.in_progress = false;
+        e.code = code;
+        wasm_extension->onEvent(WasmExtension::WasmEvent::RemoteLoadCacheDiskHit, plugin);
+      } else {
+        fetch = true; // Not in cache, fetch.
+        e.in_progress = true;
+        wasm_extension->onEvent(WasmExtension::WasmEvent::RemoteLoadCacheMiss, plugin);
+      }
       wasm_extension->onRemoteCacheEntriesChanged(code_cache->size());
-      wasm_extension->onEvent(WasmExtension::WasmEvent::RemoteLoadCacheMiss, plugin);
     }
   } else if (vm_config.code().has_local()) {
     code = Config::DataSource::read(vm_config.code().local(), true, api);
@@ -409,8 +507,11 @@ static bool createWasmInternal(const VmConfig& vm_config, const PluginSharedPtr&
 
   if (fetch) {
     auto holder = std::make_shared<std::unique_ptr<Event::DeferredDeletable>>();
-    auto fetch_callback = [vm_config, complete_cb, source, &dispatcher, scope, holder, plugin,
-                           wasm_extension](const std::string& code) {
+    auto fetch_callback = [vm_config, complete_cb, source, &dispatcher, &api, scope, holder,
+                           plugin, wasm_extension](const std::string& code) {
+      if (!code.empty() && !vm_config.code_cache_directory().empty()) {
+        writeCodeToCacheDirectory(vm_config, code, api);
+      }
       {
         std::lock_guard<std::mutex> guard(code_cache_mutex);
         auto& e = (*code_cache)[vm_config.code().remote().sha256()];
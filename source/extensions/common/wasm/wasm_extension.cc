@@ -73,6 +73,9 @@ void EnvoyWasm::onEvent(WasmEvent event, const PluginSharedPtr&) {
   case WasmEvent::RemoteLoadCacheHit:
     create_wasm_stats_->remote_load_cache_hits_.inc();
     break;
+  case WasmEvent::RemoteLoadCacheDiskHit:
+    create_wasm_stats_->remote_load_cache_disk_hits_.inc();
+    break;
   case WasmEvent::RemoteLoadCacheNegativeHit:
     create_wasm_stats_->remote_load_cache_negative_hits_.inc();
     break;
@@ -19,6 +19,7 @@ namespace Wasm {
 
 #define CREATE_WASM_STATS(COUNTER, GAUGE)                                                          \
   COUNTER(remote_load_cache_hits)                                                                  \
+  COUNTER(remote_load_cache_disk_hits)                                                             \
   COUNTER(remote_load_cache_negative_hits)                                                         \
   COUNTER(remote_load_cache_misses)                                                                \
   COUNTER(remote_load_fetch_successes)                                                             \
@@ -59,6 +60,7 @@ public:
   enum class WasmEvent : int {
     Ok,
     RemoteLoadCacheHit,
+    RemoteLoadCacheDiskHit,
     RemoteLoadCacheNegativeHit,
     RemoteLoadCacheMiss,
     RemoteLoadCacheFetchSuccess,
@@ -0,0 +1,32 @@
+#include "extensions/compression/brotli/common/base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Common {
+
+Base::Base(uint32_t chunk_size)
+    : chunk_size_(chunk_size), chunk_ptr_(new uint8_t[chunk_size]), next_out_(chunk_ptr_.get()),
+      avail_out_(chunk_size) {}
+
+void Base::setInput(const Buffer::RawSlice& input_slice) {
+  next_in_ = static_cast<const uint8_t*>(input_slice.mem_);
+  avail_in_ = input_slice.len_;
+}
+
+void Base::updateOutput(Buffer::Instance& output_buffer) {
+  if (avail_out_ == chunk_size_) {
+    return;
+  }
+
+  output_buffer.add(static_cast<void*>(chunk_ptr_.get()), chunk_size_ - avail_out_);
+  next_out_ = chunk_ptr_.get();
+  avail_out_ = chunk_size_;
+}
+
+} // namespace Common
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
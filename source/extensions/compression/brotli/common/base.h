@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/buffer/buffer.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Common {
+
+/**
+ * Shared code between the compressor and the decompressor: the slice of input being processed,
+ * and the chunk the output is written to before being moved to the output buffer.
+ */
+class Base {
+protected:
+  Base(uint32_t chunk_size);
+
+  void setInput(const Buffer::RawSlice& input_slice);
+  void updateOutput(Buffer::Instance& output_buffer);
+
+  const uint32_t chunk_size_;
+  const std::unique_ptr<uint8_t[]> chunk_ptr_;
+  const uint8_t* next_in_{};
+  size_t avail_in_{};
+  uint8_t* next_out_;
+  size_t avail_out_;
+};
+
+} // namespace Common
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,70 @@
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+
+BrotliCompressorImpl::BrotliCompressorImpl(uint32_t quality, uint32_t window_bits,
+                                           uint32_t input_block_bits,
+                                           bool disable_literal_context_modeling,
+                                           EncoderMode mode, bool disable_flush,
+                                           uint32_t chunk_size)
+    : Common::Base(chunk_size),
+      state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr), &BrotliEncoderDestroyInstance),
+      disable_flush_(disable_flush) {
+  RELEASE_ASSERT(state_ != nullptr, "");
+  setParameter(BROTLI_PARAM_QUALITY, quality);
+  setParameter(BROTLI_PARAM_LGWIN, window_bits);
+  if (input_block_bits > 0) {
+    setParameter(BROTLI_PARAM_LGBLOCK, input_block_bits);
+  }
+  setParameter(BROTLI_PARAM_DISABLE_LITERAL_CONTEXT_MODELING, disable_literal_context_modeling);
+  setParameter(BROTLI_PARAM_MODE, static_cast<uint32_t>(mode));
+}
+
+void BrotliCompressorImpl::setParameter(BrotliEncoderParameter parameter, uint32_t value) {
+  const BROTLI_BOOL result = BrotliEncoderSetParameter(state_.get(), parameter, value);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+}
+
+void BrotliCompressorImpl::compress(Buffer::Instance& buffer,
+                                    Envoy::Compression::Compressor::State state) {
+  for (const Buffer::RawSlice& input_slice : buffer.getRawSlices()) {
+    // As with zlib, the compressed output is appended to the buffer, and the input it was produced
+    // from is drained from the beginning of the buffer.
+    setInput(input_slice);
+    process(buffer, BROTLI_OPERATION_PROCESS);
+    buffer.drain(input_slice.len_);
+  }
+
+  setInput({nullptr, 0});
+  if (state == Envoy::Compression::Compressor::State::Finish) {
+    process(buffer, BROTLI_OPERATION_FINISH);
+  } else if (!disable_flush_) {
+    process(buffer, BROTLI_OPERATION_FLUSH);
+  }
+}
+
+void BrotliCompressorImpl::process(Buffer::Instance& output_buffer,
+                                   BrotliEncoderOperation operation) {
+  do {
+    const BROTLI_BOOL result = BrotliEncoderCompressStream(
+        state_.get(), operation, &avail_in_, &next_in_, &avail_out_, &next_out_, nullptr);
+    RELEASE_ASSERT(result == BROTLI_TRUE, "");
+    // Without flushing, the output is only moved once a whole chunk is filled, so that the output
+    // buffer isn't fragmented into small slices.
+    if (avail_out_ == 0 || operation != BROTLI_OPERATION_PROCESS) {
+      updateOutput(output_buffer);
+    }
+  } while (avail_in_ > 0 || BrotliEncoderHasMoreOutput(state_.get()));
+}
+
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/compression/compressor/compressor.h"
+
+#include "extensions/compression/brotli/common/base.h"
+
+#include "brotli/encode.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+
+/**
+ * Implementation of compressor's interface.
+ */
+class BrotliCompressorImpl : public Common::Base,
+                             public Envoy::Compression::Compressor::Compressor {
+public:
+  /**
+   * Enum values are used for setting the encoder mode, i.e. a hint about the content.
+   * GENERIC: no assumption is made about the content.
+   * TEXT: the content is UTF-8 text.
+   * FONT: the content is a WOFF 2.0 font.
+   * DEFAULT: the compressor picks the mode.
+   */
+  enum class EncoderMode : uint32_t {
+    Generic = BROTLI_MODE_GENERIC,
+    Text = BROTLI_MODE_TEXT,
+    Font = BROTLI_MODE_FONT,
+    Default = BROTLI_DEFAULT_MODE,
+  };
+
+  /**
+   * @param quality supplies the brotli quality, from 0 to 11.
+   * @param window_bits supplies the base two logarithm of the window size, from 10 to 24.
+   * @param input_block_bits supplies the base two logarithm of the input block size, from 16 to
+   * 24, or 0 to derive it from the quality.
+   * @param disable_literal_context_modeling supplies whether literal context modeling is disabled,
+   * which speeds up decompression at the expense of the compression ratio.
+   * @param mode supplies the encoder mode.
+   * @param disable_flush supplies whether the output is only emitted when the compressor's
+   * buffers are full or when the stream is finished, instead of on every call to compress().
+   * @param chunk_size supplies the amount of memory reserved for the compressor output.
+   */
+  BrotliCompressorImpl(uint32_t quality, uint32_t window_bits, uint32_t input_block_bits,
+                       bool disable_literal_context_modeling, EncoderMode mode, bool disable_flush,
+                       uint32_t chunk_size);
+
+  // Compression::Compressor::Compressor
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, BrotliEncoderOperation operation);
+  void setParameter(BrotliEncoderParameter parameter, uint32_t value);
+
+  const std::unique_ptr<BrotliEncoderState, decltype(&BrotliEncoderDestroyInstance)> state_;
+  const bool disable_flush_;
+};
+
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#include "extensions/compression/brotli/decompressor/brotli_decompressor_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Decompressor {
+
+BrotliDecompressorImpl::BrotliDecompressorImpl(Stats::Scope& scope,
+                                               const std::string& stats_prefix,
+                                               uint32_t chunk_size,
+                                               bool disable_ring_buffer_reallocation)
+    : Common::Base(chunk_size), stats_(generateStats(stats_prefix, scope)),
+      state_(BrotliDecoderCreateInstance(nullptr, nullptr, nullptr),
+             &BrotliDecoderDestroyInstance) {
+  RELEASE_ASSERT(state_ != nullptr, "");
+  const BROTLI_BOOL result =
+      BrotliDecoderSetParameter(state_.get(), BROTLI_DECODER_PARAM_DISABLE_RING_BUFFER_REALLOCATION,
+                                disable_ring_buffer_reallocation ? BROTLI_TRUE : BROTLI_FALSE);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+}
+
+void BrotliDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
+                                        Buffer::Instance& output_buffer) {
+  for (const Buffer::RawSlice& input_slice : input_buffer.getRawSlices()) {
+    if (decompression_error_) {
+      return;
+    }
+    setInput(input_slice);
+    while (process(output_buffer)) {
+    }
+  }
+
+  // Flush the output chunk, as the next call to decompress() may not fill it.
+  updateOutput(output_buffer);
+}
+
+bool BrotliDecompressorImpl::process(Buffer::Instance& output_buffer) {
+  const BrotliDecoderResult result = BrotliDecoderDecompressStream(
+      state_.get(), &avail_in_, &next_in_, &avail_out_, &next_out_, nullptr);
+  switch (result) {
+  case BROTLI_DECODER_RESULT_ERROR:
+    decompression_error_ = true;
+    ENVOY_LOG(trace, "brotli decompression error: {}",
+              BrotliDecoderErrorString(BrotliDecoderGetErrorCode(state_.get())));
+    stats_.brotli_error_.inc();
+    return false;
+  case BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT:
+  case BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT:
+    // Brotli may ask for more input while it still has output pending, if the chunk was filled
+    // exactly, so a full chunk is always moved and brotli called again.
+    if (avail_out_ == 0) {
+      updateOutput(output_buffer);
+      return true;
+    }
+    return false;
+  case BROTLI_DECODER_RESULT_SUCCESS:
+    // Anything after the end of the stream is not brotli data.
+    if (avail_in_ > 0) {
+      decompression_error_ = true;
+      ENVOY_LOG(trace, "brotli decompression error: data after the end of the stream");
+      stats_.brotli_error_.inc();
+    }
+    return false;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+} // namespace Decompressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/compression/decompressor/decompressor.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/compression/brotli/common/base.h"
+
+#include "brotli/decode.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Decompressor {
+
+/**
+ * All brotli decompressor stats. @see stats_macros.h
+ */
+#define ALL_BROTLI_DECOMPRESSOR_STATS(COUNTER) COUNTER(brotli_error)
+
+/**
+ * Struct definition for brotli decompressor stats. @see stats_macros.h
+ */
+struct BrotliDecompressorStats {
+  ALL_BROTLI_DECOMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Implementation of decompressor's interface.
+ */
+class BrotliDecompressorImpl : public Common::Base,
+                               public Envoy::Compression::Decompressor::Decompressor,
+                               public Logger::Loggable<Logger::Id::decompression> {
+public:
+  /**
+   * @param chunk_size supplies the amount of memory reserved for the decompressor output.
+   * @param disable_ring_buffer_reallocation supplies whether the ring buffer is allocated at the
+   * full window size up front, instead of being grown with the content.
+   */
+  BrotliDecompressorImpl(Stats::Scope& scope, const std::string& stats_prefix, uint32_t chunk_size,
+                         bool disable_ring_buffer_reallocation);
+
+  // Compression::Decompressor::Decompressor
+  void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
+
+  // Flag to track whether an error occurred during decompression. Once set, the rest of the input
+  // is ignored.
+  bool decompression_error_{false};
+
+private:
+  static BrotliDecompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return BrotliDecompressorStats{
+        ALL_BROTLI_DECOMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  bool process(Buffer::Instance& output_buffer);
+
+  const BrotliDecompressorStats stats_;
+  const std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> state_;
+};
+
+} // namespace Decompressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -80,9 +80,16 @@ Envoy::Compression::Compressor::CompressorPtr GzipCompressorFactory::createCompr
   return compressor;
 }
 
+Envoy::Compression::Compressor::BlockCompressorSharedPtr
+GzipCompressorFactory::createBlockCompressor() {
+  return std::make_shared<ZlibBlockCompressorImpl>(compression_level_, compression_strategy_,
+                                                   window_bits_ & ~GzipHeaderValue, memory_level_);
+}
+
 Envoy::Compression::Compressor::CompressorFactoryPtr
 GzipCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
-    const envoy::extensions::compression::gzip::compressor::v3::Gzip& proto_config) {
+    const envoy::extensions::compression::gzip::compressor::v3::Gzip& proto_config,
+    Server::Configuration::FactoryContext&) {
   return std::make_unique<GzipCompressorFactory>(proto_config);
 }
 
@@ -7,6 +7,7 @@
 #include "common/http/headers.h"
 
 #include "extensions/compression/common/compressor/factory_base.h"
+#include "extensions/compression/gzip/compressor/zlib_block_compressor_impl.h"
 #include "extensions/compression/gzip/compressor/zlib_compressor_impl.h"
 #include "extensions/filters/http/well_known_names.h"
 
@@ -35,6 +36,7 @@ public:
   const std::string& contentEncoding() const override {
     return Http::CustomHeaders::get().ContentEncodingValues.Gzip;
   }
+  Envoy::Compression::Compressor::BlockCompressorSharedPtr createBlockCompressor() override;
 
 private:
   static ZlibCompressorImpl::CompressionLevel
@@ -59,7 +61,8 @@ public:
 
 private:
   Envoy::Compression::Compressor::CompressorFactoryPtr createCompressorFactoryFromProtoTyped(
-      const envoy::extensions::compression::gzip::compressor::v3::Gzip& config) override;
+      const envoy::extensions::compression::gzip::compressor::v3::Gzip& config,
+      Server::Configuration::FactoryContext& context) override;
 };
 
 DECLARE_FACTORY(GzipCompressorLibraryFactory);
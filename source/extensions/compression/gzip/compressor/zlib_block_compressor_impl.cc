@@ -0,0 +1,106 @@
+#include "extensions/compression/gzip/compressor/zlib_block_compressor_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+#include "zlib.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Gzip {
+namespace Compressor {
+
+namespace {
+
+// A gzip header without modification time, flags, nor extra fields, and the OS set to Unix, as
+// written by zlib.
+constexpr absl::string_view GzipHeader{"\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10};
+
+// The size of the empty stored block ending the output of a sync flush, and of the bits of the
+// preceding deflate block padded to a byte boundary.
+constexpr uint64_t SyncFlushMarkerSize = 6;
+
+} // namespace
+
+ZlibBlockCompressorImpl::ZlibBlockCompressorImpl(ZlibCompressorImpl::CompressionLevel level,
+                                                 ZlibCompressorImpl::CompressionStrategy strategy,
+                                                 int64_t window_bits, uint64_t memory_level)
+    : level_(level), strategy_(strategy), window_bits_(window_bits), memory_level_(memory_level) {
+  ASSERT(window_bits_ >= 9 && window_bits_ <= 15);
+}
+
+Envoy::Compression::Compressor::BlockCompressor::BlockPtr
+ZlibBlockCompressorImpl::compressBlock(absl::string_view input, absl::string_view history,
+                                       Envoy::Compression::Compressor::State state) const {
+  auto block = std::make_unique<ZlibBlock>();
+  block->length_ = input.size();
+  block->last_ = state == Envoy::Compression::Compressor::State::Finish;
+  block->crc_ = crc32(0, reinterpret_cast<const Bytef*>(input.data()), input.size());
+
+  z_stream zstream{};
+  // Negative window bits make zlib write raw deflate data, without a header nor a trailer.
+  int result = deflateInit2(&zstream, static_cast<int64_t>(level_), Z_DEFLATED, -window_bits_,
+                            memory_level_, static_cast<uint64_t>(strategy_));
+  RELEASE_ASSERT(result == Z_OK, "");
+
+  if (!history.empty()) {
+    // Matches can't refer to data further than the window size.
+    const uint64_t dictionary_size = std::min<uint64_t>(history.size(), 1 << window_bits_);
+    result = deflateSetDictionary(
+        &zstream, reinterpret_cast<const Bytef*>(history.data() + history.size() - dictionary_size),
+        dictionary_size);
+    RELEASE_ASSERT(result == Z_OK, "");
+  }
+
+  zstream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  zstream.avail_in = input.size();
+  // A sync flush aligns the end of the block's data to a byte boundary without marking its last
+  // deflate block as final, so that the data of the next block can follow it. The last block of
+  // the stream is finished instead.
+  const int flush_state = block->last_ ? Z_FINISH : Z_SYNC_FLUSH;
+  block->data_.resize(deflateBound(&zstream, input.size()) + SyncFlushMarkerSize);
+  uint64_t output_size = 0;
+  while (true) {
+    if (output_size == block->data_.size()) {
+      block->data_.resize(2 * block->data_.size());
+    }
+    zstream.next_out = reinterpret_cast<Bytef*>(&block->data_[output_size]);
+    zstream.avail_out = block->data_.size() - output_size;
+    result = deflate(&zstream, flush_state);
+    RELEASE_ASSERT(result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR, "");
+    output_size = block->data_.size() - zstream.avail_out;
+    // The output is complete once the stream ends, or once a flush leaves room in the output.
+    if (flush_state == Z_FINISH ? result == Z_STREAM_END : zstream.avail_out != 0) {
+      break;
+    }
+  }
+  block->data_.resize(output_size);
+  deflateEnd(&zstream);
+
+  return block;
+}
+
+void ZlibBlockCompressorImpl::addBlock(const Block& block, Buffer::Instance& output) {
+  const auto& zlib_block = dynamic_cast<const ZlibBlock&>(block);
+  if (!header_added_) {
+    output.add(GzipHeader);
+    header_added_ = true;
+  }
+  output.add(zlib_block.data_);
+
+  crc_ = crc32_combine(crc_, zlib_block.crc_, zlib_block.length_);
+  length_ += zlib_block.length_;
+  if (zlib_block.last_) {
+    // The gzip trailer holds the CRC-32 of the data, and its length modulo 2^32.
+    output.writeLEInt<uint32_t>(crc_);
+    output.writeLEInt<uint32_t>(length_);
+  }
+}
+
+} // namespace Compressor
+} // namespace Gzip
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/compression/compressor/compressor.h"
+
+#include "extensions/compression/gzip/compressor/zlib_compressor_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Gzip {
+namespace Compressor {
+
+/**
+ * Implementation of the block compressor's interface producing a gzip stream, like pigz does: each
+ * block is compressed into raw deflate blocks by its own zlib stream, which is primed with the end
+ * of the preceding data and flushed to a byte boundary, so that the compressed blocks can simply be
+ * concatenated. The gzip header and trailer are added around them, and the CRC-32 of the stream is
+ * combined from the CRC-32 of each block.
+ */
+class ZlibBlockCompressorImpl : public Envoy::Compression::Compressor::BlockCompressor {
+public:
+  /**
+   * @param level @see ZlibCompressorImpl::CompressionLevel enum
+   * @param strategy @see ZlibCompressorImpl::CompressionStrategy enum
+   * @param window_bits sets the size of the history buffer, between 9 and 15, also limiting how
+   * much of the history of a block is used. @see window_bits. (zlib manual)
+   * @param memory_level sets how much memory should be allocated for the internal compression, min
+   * 1 and max 9. @see memory_level (zlib manual)
+   */
+  ZlibBlockCompressorImpl(ZlibCompressorImpl::CompressionLevel level,
+                          ZlibCompressorImpl::CompressionStrategy strategy, int64_t window_bits,
+                          uint64_t memory_level);
+
+  // Compression::Compressor::BlockCompressor
+  BlockPtr compressBlock(absl::string_view input, absl::string_view history,
+                         Envoy::Compression::Compressor::State state) const override;
+  void addBlock(const Block& block, Buffer::Instance& output) override;
+
+private:
+  struct ZlibBlock : public Block {
+    std::string data_;
+    uint32_t crc_{};
+    uint64_t length_{};
+    bool last_{};
+  };
+
+  const ZlibCompressorImpl::CompressionLevel level_;
+  const ZlibCompressorImpl::CompressionStrategy strategy_;
+  const int64_t window_bits_;
+  const uint64_t memory_level_;
+
+  bool header_added_{};
+  uint32_t crc_{};
+  uint64_t length_{};
+};
+
+} // namespace Compressor
+} // namespace Gzip
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
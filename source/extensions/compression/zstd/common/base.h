@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/buffer/buffer.h"
+
+#include "absl/strings/string_view.h"
+#include "zstd.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Common {
+
+/**
+ * Shared code between the compressor and the decompressor: the slice of input being processed,
+ * and the chunk the output is written to before being moved to the output buffer.
+ */
+class Base {
+public:
+  Base(uint32_t chunk_size);
+
+  /**
+   * @param dictionary supplies the content of a dictionary.
+   * @return the ID of the dictionary. Throws an EnvoyException if the dictionary has no ID, e.g.
+   * because it is raw content rather than a dictionary trained by zstd, as compressed frames
+   * identify the dictionary to decompress them with by its ID.
+   */
+  static uint32_t dictionaryId(absl::string_view dictionary);
+
+protected:
+  void setInput(const Buffer::RawSlice& input_slice);
+  void updateOutput(Buffer::Instance& output_buffer);
+
+  const std::unique_ptr<uint8_t[]> chunk_ptr_;
+  ZSTD_outBuffer output_;
+  ZSTD_inBuffer input_{};
+};
+
+} // namespace Common
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
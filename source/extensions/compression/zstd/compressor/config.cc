@@ -0,0 +1,59 @@
+#include "extensions/compression/zstd/compressor/config.h"
+
+#include "common/config/datasource.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+namespace {
+// Default zstd compression level, ZSTD_CLEVEL_DEFAULT.
+const uint32_t DefaultCompressionLevel = 3;
+
+// Default zstd chunk size.
+const uint32_t DefaultChunkSize = 4096;
+} // namespace
+
+ZstdCompressorFactory::ZstdCompressorFactory(
+    const envoy::extensions::compression::zstd::compressor::v3::Zstd& zstd, Api::Api& api)
+    : compression_level_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, compression_level, DefaultCompressionLevel)),
+      window_log_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, window_log, 0)),
+      enable_checksum_(zstd.enable_checksum()),
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, chunk_size, DefaultChunkSize)) {
+  if (zstd.has_dictionary()) {
+    const std::string dictionary = Config::DataSource::read(zstd.dictionary(), false, api);
+    Common::Base::dictionaryId(dictionary);
+    ZSTD_CDict* cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), compression_level_);
+    if (cdict == nullptr) {
+      throw EnvoyException("invalid zstd dictionary");
+    }
+    cdict_ = CDictSharedPtr(cdict, &ZSTD_freeCDict);
+  }
+}
+
+Envoy::Compression::Compressor::CompressorPtr ZstdCompressorFactory::createCompressor() {
+  return std::make_unique<ZstdCompressorImpl>(compression_level_, window_log_, enable_checksum_,
+                                              chunk_size_, cdict_);
+}
+
+Envoy::Compression::Compressor::CompressorFactoryPtr
+ZstdCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
+    const envoy::extensions::compression::zstd::compressor::v3::Zstd& proto_config,
+    Server::Configuration::FactoryContext& context) {
+  return std::make_unique<ZstdCompressorFactory>(proto_config, context.api());
+}
+
+/**
+ * Static registration for the zstd compressor library. @see NamedCompressorLibraryConfigFactory.
+ */
+REGISTER_FACTORY(ZstdCompressorLibraryFactory,
+                 Envoy::Compression::Compressor::NamedCompressorLibraryConfigFactory);
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,66 @@
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, uint32_t window_log,
+                                       bool enable_checksum, uint32_t chunk_size,
+                                       CDictSharedPtr cdict)
+    : Common::Base(chunk_size), cctx_(ZSTD_createCCtx(), &ZSTD_freeCCtx),
+      cdict_(std::move(cdict)) {
+  RELEASE_ASSERT(cctx_ != nullptr, "");
+  if (cdict_ != nullptr) {
+    const size_t result = ZSTD_CCtx_refCDict(cctx_.get(), cdict_.get());
+    RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+  }
+  setParameter(ZSTD_c_compressionLevel, compression_level);
+  if (window_log > 0) {
+    setParameter(ZSTD_c_windowLog, window_log);
+  }
+  setParameter(ZSTD_c_checksumFlag, enable_checksum ? 1 : 0);
+}
+
+void ZstdCompressorImpl::setParameter(ZSTD_cParameter parameter, int value) {
+  const size_t result = ZSTD_CCtx_setParameter(cctx_.get(), parameter, value);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+}
+
+void ZstdCompressorImpl::compress(Buffer::Instance& buffer,
+                                  Envoy::Compression::Compressor::State state) {
+  for (const Buffer::RawSlice& input_slice : buffer.getRawSlices()) {
+    // As with zlib, the compressed output is appended to the buffer, and the input it was produced
+    // from is drained from the beginning of the buffer.
+    setInput(input_slice);
+    process(buffer, ZSTD_e_continue);
+    buffer.drain(input_slice.len_);
+  }
+
+  setInput({nullptr, 0});
+  process(buffer,
+          state == Envoy::Compression::Compressor::State::Finish ? ZSTD_e_end : ZSTD_e_flush);
+}
+
+void ZstdCompressorImpl::process(Buffer::Instance& output_buffer, ZSTD_EndDirective mode) {
+  bool done;
+  do {
+    const size_t remaining = ZSTD_compressStream2(cctx_.get(), &output_, &input_, mode);
+    RELEASE_ASSERT(!ZSTD_isError(remaining), ZSTD_getErrorName(remaining));
+    // Without flushing, the output is only moved once a whole chunk is filled, so that the output
+    // buffer isn't fragmented into small slices.
+    if (output_.pos == output_.size || mode != ZSTD_e_continue) {
+      updateOutput(output_buffer);
+    }
+    done = mode == ZSTD_e_continue ? input_.pos == input_.size : remaining == 0;
+  } while (!done);
+}
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
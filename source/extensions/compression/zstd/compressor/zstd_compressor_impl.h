@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/compression/compressor/compressor.h"
+
+#include "extensions/compression/zstd/common/base.h"
+
+#include "zstd.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+// A dictionary prepared for compression, shared by all the compressors of a factory.
+using CDictSharedPtr = std::shared_ptr<const ZSTD_CDict>;
+
+/**
+ * Implementation of compressor's interface.
+ */
+class ZstdCompressorImpl : public Common::Base, public Envoy::Compression::Compressor::Compressor {
+public:
+  /**
+   * @param compression_level supplies the zstd compression level, from 1 to ZSTD_maxCLevel().
+   * @param window_log supplies the base two logarithm of the window size, or 0 to derive it from
+   * the compression level.
+   * @param enable_checksum supplies whether a checksum of the content is appended to frames.
+   * @param chunk_size supplies the amount of memory reserved for the compressor output.
+   * @param cdict supplies the dictionary to compress with, or nullptr.
+   */
+  ZstdCompressorImpl(uint32_t compression_level, uint32_t window_log, bool enable_checksum,
+                     uint32_t chunk_size, CDictSharedPtr cdict = nullptr);
+
+  // Compression::Compressor::Compressor
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, ZSTD_EndDirective mode);
+  void setParameter(ZSTD_cParameter parameter, int value);
+
+  const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx_;
+  const CDictSharedPtr cdict_;
+};
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,61 @@
+#include "extensions/compression/zstd/decompressor/config.h"
+
+#include "common/config/datasource.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+
+namespace {
+const uint32_t DefaultChunkSize = 4096;
+} // namespace
+
+ZstdDecompressorFactory::ZstdDecompressorFactory(
+    const envoy::extensions::compression::zstd::decompressor::v3::Zstd& zstd, Stats::Scope& scope,
+    Api::Api& api)
+    : scope_(scope),
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, chunk_size, DefaultChunkSize)),
+      max_window_log_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, max_window_log, DefaultMaxWindowLog)) {
+  if (zstd.dictionaries().empty()) {
+    return;
+  }
+  auto ddicts = std::make_shared<DDictMap>();
+  for (const auto& source : zstd.dictionaries()) {
+    const std::string dictionary = Config::DataSource::read(source, false, api);
+    const uint32_t id = Common::Base::dictionaryId(dictionary);
+    DDictPtr ddict(ZSTD_createDDict(dictionary.data(), dictionary.size()), &ZSTD_freeDDict);
+    if (ddict == nullptr) {
+      throw EnvoyException("invalid zstd dictionary");
+    }
+    if (!ddicts->emplace(id, std::move(ddict)).second) {
+      throw EnvoyException(fmt::format("duplicate zstd dictionary ID {}", id));
+    }
+  }
+  ddicts_ = std::move(ddicts);
+}
+
+Envoy::Compression::Decompressor::DecompressorPtr
+ZstdDecompressorFactory::createDecompressor(const std::string& stats_prefix) {
+  return std::make_unique<ZstdDecompressorImpl>(scope_, stats_prefix, chunk_size_, ddicts_,
+                                                max_window_log_);
+}
+
+Envoy::Compression::Decompressor::DecompressorFactoryPtr
+ZstdDecompressorLibraryFactory::createDecompressorFactoryFromProtoTyped(
+    const envoy::extensions::compression::zstd::decompressor::v3::Zstd& proto_config,
+    Server::Configuration::FactoryContext& context) {
+  return std::make_unique<ZstdDecompressorFactory>(proto_config, context.scope(), context.api());
+}
+
+/**
+ * Static registration for the zstd decompressor. @see NamedDecompressorLibraryConfigFactory.
+ */
+REGISTER_FACTORY(ZstdDecompressorLibraryFactory,
+                 Envoy::Compression::Decompressor::NamedDecompressorLibraryConfigFactory);
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,167 @@
+#include "extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+// For ZSTD_frameHeaderSize().
+#define ZSTD_STATIC_LINKING_ONLY
+#include "zstd.h"
+#include "zstd_errors.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+
+ZstdDecompressorImpl::ZstdDecompressorImpl(Stats::Scope& scope, const std::string& stats_prefix,
+                                           uint32_t chunk_size, DDictMapConstSharedPtr ddicts,
+                                           uint32_t max_window_log)
+    : Common::Base(chunk_size), stats_(generateStats(stats_prefix, scope)),
+      dctx_(ZSTD_createDCtx(), &ZSTD_freeDCtx), ddicts_(std::move(ddicts)) {
+  RELEASE_ASSERT(dctx_ != nullptr, "");
+  // The window is allocated for each stream, so its size is bounded for untrusted input.
+  const size_t result = ZSTD_DCtx_setParameter(dctx_.get(), ZSTD_d_windowLogMax, max_window_log);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+}
+
+void ZstdDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
+                                      Buffer::Instance& output_buffer) {
+  for (const Buffer::RawSlice& input_slice : input_buffer.getRawSlices()) {
+    if (decompression_error_) {
+      return;
+    }
+    setInput(input_slice);
+    while (process(output_buffer)) {
+    }
+  }
+
+  // Flush the output chunk, as the next call to decompress() may not fill it.
+  updateOutput(output_buffer);
+}
+
+bool ZstdDecompressorImpl::process(Buffer::Instance& output_buffer) {
+  if (frame_start_ && input_.pos < input_.size && !startFrame()) {
+    return false;
+  }
+
+  const size_t result = ZSTD_decompressStream(dctx_.get(), &output_, &input_);
+  if (ZSTD_isError(result)) {
+    onError(result);
+    return false;
+  }
+  // A frame is complete once ZSTD_decompressStream() returns 0.
+  frame_start_ = result == 0;
+
+  // A full chunk means zstd may have more output for the input consumed so far.
+  if (output_.pos == output_.size) {
+    updateOutput(output_buffer);
+    return true;
+  }
+  return input_.pos < input_.size;
+}
+
+bool ZstdDecompressorImpl::startFrame() {
+  const char* input = static_cast<const char*>(input_.src) + input_.pos;
+  const size_t available = input_.size - input_.pos;
+  if (frame_header_.empty()) {
+    // The header is normally in the current input, as it is at most 18 bytes.
+    const size_t header_size = ZSTD_frameHeaderSize(input, available);
+    if (!ZSTD_isError(header_size) && header_size <= available) {
+      return refDictionary(input, header_size);
+    }
+  }
+
+  // Otherwise, the dictionary ID may be in the next input, so the header is held until it is
+  // complete. Its size is known once its first bytes are.
+  size_t header_size = ZSTD_FRAMEHEADERSIZE_PREFIX(ZSTD_f_zstd1);
+  while (true) {
+    if (frame_header_.size() >= header_size) {
+      header_size = ZSTD_frameHeaderSize(frame_header_.data(), frame_header_.size());
+      if (ZSTD_isError(header_size)) {
+        onError(header_size);
+        return false;
+      }
+      if (frame_header_.size() >= header_size) {
+        break;
+      }
+    }
+    if (input_.pos == input_.size) {
+      return false;
+    }
+    const size_t size = std::min(header_size - frame_header_.size(), input_.size - input_.pos);
+    frame_header_.append(static_cast<const char*>(input_.src) + input_.pos, size);
+    input_.pos += size;
+  }
+
+  if (!refDictionary(frame_header_.data(), frame_header_.size())) {
+    return false;
+  }
+  // The header alone doesn't produce any output.
+  ZSTD_inBuffer header{frame_header_.data(), frame_header_.size(), 0};
+  const size_t result = ZSTD_decompressStream(dctx_.get(), &output_, &header);
+  frame_header_.clear();
+  if (ZSTD_isError(result)) {
+    onError(result);
+    return false;
+  }
+  ASSERT(header.pos == header.size);
+  return true;
+}
+
+bool ZstdDecompressorImpl::refDictionary(const void* frame_header, size_t size) {
+  const uint32_t id = ZSTD_getDictID_fromFrame(frame_header, size);
+  const ZSTD_DDict* ddict = nullptr;
+  if (id != 0) {
+    if (ddicts_ != nullptr) {
+      const auto it = ddicts_->find(id);
+      if (it != ddicts_->end()) {
+        ddict = it->second.get();
+      }
+    }
+    if (ddict == nullptr) {
+      ENVOY_LOG(trace, "zstd decompression error: unknown dictionary {}", id);
+      decompression_error_ = true;
+      stats_.zstd_dictionary_error_.inc();
+      return false;
+    }
+  }
+
+  const size_t result = ZSTD_DCtx_refDDict(dctx_.get(), ddict);
+  if (ZSTD_isError(result)) {
+    onError(result);
+    return false;
+  }
+  frame_start_ = false;
+  return true;
+}
+
+void ZstdDecompressorImpl::onError(size_t result) {
+  decompression_error_ = true;
+  ENVOY_LOG(trace, "zstd decompression error: {}", ZSTD_getErrorName(result));
+  switch (ZSTD_getErrorCode(result)) {
+  case ZSTD_error_dictionary_corrupted:
+  case ZSTD_error_dictionary_wrong:
+    stats_.zstd_dictionary_error_.inc();
+    break;
+  case ZSTD_error_checksum_wrong:
+    stats_.zstd_checksum_wrong_error_.inc();
+    break;
+  case ZSTD_error_memory_allocation:
+    stats_.zstd_memory_error_.inc();
+    break;
+  case ZSTD_error_frameParameter_windowTooLarge:
+    stats_.zstd_window_too_large_error_.inc();
+    break;
+  default:
+    stats_.zstd_generic_error_.inc();
+    break;
+  }
+}
+
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
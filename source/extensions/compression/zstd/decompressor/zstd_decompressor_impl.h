@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/compression/decompressor/decompressor.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/compression/zstd/common/base.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "zstd.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+
+/**
+ * All zstd decompressor stats. @see stats_macros.h
+ */
+#define ALL_ZSTD_DECOMPRESSOR_STATS(COUNTER)                                                       \
+  COUNTER(zstd_generic_error)                                                                      \
+  COUNTER(zstd_dictionary_error)                                                                   \
+  COUNTER(zstd_checksum_wrong_error)                                                               \
+  COUNTER(zstd_memory_error)                                                                       \
+  COUNTER(zstd_window_too_large_error)
+
+/**
+ * Struct definition for zstd decompressor stats. @see stats_macros.h
+ */
+struct ZstdDecompressorStats {
+  ALL_ZSTD_DECOMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+// The dictionaries prepared for decompression, by their ID, shared by all the decompressors of a
+// factory.
+using DDictPtr = std::unique_ptr<ZSTD_DDict, decltype(&ZSTD_freeDDict)>;
+using DDictMap = absl::flat_hash_map<uint32_t, DDictPtr>;
+using DDictMapConstSharedPtr = std::shared_ptr<const DDictMap>;
+
+// The largest window, 8 MiB, that encoders of the zstd HTTP content coding may use.
+constexpr uint32_t DefaultMaxWindowLog = 23;
+
+/**
+ * Implementation of decompressor's interface.
+ */
+class ZstdDecompressorImpl : public Common::Base,
+                             public Envoy::Compression::Decompressor::Decompressor,
+                             public Logger::Loggable<Logger::Id::decompression> {
+public:
+  /**
+   * @param chunk_size supplies the amount of memory reserved for the decompressor output.
+   * @param ddicts supplies the dictionaries frames may be compressed with, or nullptr.
+   * @param max_window_log supplies the base two logarithm of the largest window frames may use.
+   */
+  ZstdDecompressorImpl(Stats::Scope& scope, const std::string& stats_prefix, uint32_t chunk_size,
+                       DDictMapConstSharedPtr ddicts = nullptr,
+                       uint32_t max_window_log = DefaultMaxWindowLog);
+
+  // Compression::Decompressor::Decompressor
+  void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
+
+  // Flag to track whether an error occurred during decompression. Once set, the rest of the input
+  // is ignored.
+  bool decompression_error_{false};
+
+private:
+  static ZstdDecompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return ZstdDecompressorStats{ALL_ZSTD_DECOMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  bool startFrame();
+  bool refDictionary(const void* frame_header, size_t size);
+  bool process(Buffer::Instance& output_buffer);
+  void onError(size_t result);
+
+  const ZstdDecompressorStats stats_;
+  const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx_;
+  const DDictMapConstSharedPtr ddicts_;
+  // Whether the next input starts a new frame, which may use a different dictionary.
+  bool frame_start_{true};
+  // The start of a frame header split across inputs, held until the header is complete.
+  std::string frame_header_;
+};
+
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
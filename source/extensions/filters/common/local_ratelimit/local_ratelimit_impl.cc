@@ -1,74 +1,146 @@
 #include "extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
 
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+
+#include "absl/hash/hash.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
 namespace Common {
 namespace LocalRateLimit {
 
+namespace {
+
+// Threads are given consecutive indexes the first time they take a token from any limiter, so
+// that workers map to different shards.
+uint32_t threadIndex() {
+  static std::atomic<uint32_t> next_index;
+  static thread_local const uint32_t index = next_index++;
+  return index;
+}
+
+uint64_t makeState(uint64_t tokens, uint32_t fill) { return (tokens << 32) | fill; }
+
+} // namespace
+
 LocalRateLimiterImpl::LocalRateLimiterImpl(const std::chrono::milliseconds fill_interval,
                                            const uint32_t max_tokens,
                                            const uint32_t tokens_per_fill,
-                                           Event::Dispatcher& dispatcher)
+                                           Event::Dispatcher& dispatcher,
+                                           const uint32_t max_descriptors)
     : fill_interval_(fill_interval), max_tokens_(max_tokens), tokens_per_fill_(tokens_per_fill),
-      fill_timer_(fill_interval_ > std::chrono::milliseconds(0)
-                      ? dispatcher.createTimer([this] { onFillTimer(); })
-                      : nullptr) {
-  if (fill_timer_ && fill_interval_ < std::chrono::milliseconds(50)) {
+      time_source_(dispatcher.timeSource()), start_time_(time_source_.monotonicTime()),
+      // Every shard gets at least one token, and at least one token per fill if the bucket is
+      // filled at all.
+      shards_(std::max<uint32_t>(1, std::min({MaxShards, max_tokens,
+                                              fill_interval > std::chrono::milliseconds(0)
+                                                  ? tokens_per_fill
+                                                  : max_tokens}))),
+      descriptor_shards_(std::min(MaxShards, max_descriptors)),
+      max_descriptors_per_shard_(
+          descriptor_shards_.empty()
+              ? 0
+              : (max_descriptors + descriptor_shards_.size() - 1) / descriptor_shards_.size()) {
+  if (fill_interval_ > std::chrono::milliseconds(0) &&
+      fill_interval_ < std::chrono::milliseconds(50)) {
     throw EnvoyException("local rate limit token bucket fill timer must be >= 50ms");
   }
 
-  tokens_ = max_tokens;
-
-  if (fill_timer_) {
-    fill_timer_->enableTimer(fill_interval_);
+  const uint32_t num_shards = shards_.size();
+  for (uint32_t i = 0; i < num_shards; i++) {
+    Shard& shard = shards_[i];
+    shard.max_tokens_ = max_tokens_ / num_shards + (i < max_tokens_ % num_shards ? 1 : 0);
+    shard.tokens_per_fill_ =
+        tokens_per_fill_ / num_shards + (i < tokens_per_fill_ % num_shards ? 1 : 0);
+    shard.state_ = makeState(shard.max_tokens_, 0);
   }
 }
 
-LocalRateLimiterImpl::~LocalRateLimiterImpl() {
-  if (fill_timer_ != nullptr) {
-    fill_timer_->disableTimer();
+uint32_t LocalRateLimiterImpl::currentFill() const {
+  if (fill_interval_ == std::chrono::milliseconds(0)) {
+    return 0;
   }
+  // Wrapping around is fine, as fills are compared by their difference.
+  return static_cast<uint32_t>((time_source_.monotonicTime() - start_time_) / fill_interval_);
 }
 
-void LocalRateLimiterImpl::onFillTimer() {
+bool LocalRateLimiterImpl::consume(const Shard& shard, const uint32_t fill) const {
   // Relaxed consistency is used for all operations because we don't care about ordering, just the
   // final atomic correctness.
-  uint32_t expected_tokens = tokens_.load(std::memory_order_relaxed);
-  uint32_t new_tokens_value;
+  uint64_t expected_state = shard.state_.load(std::memory_order_relaxed);
+  uint64_t new_state;
   do {
-    // expected_tokens is either initialized above or reloaded during the CAS failure below.
-    new_tokens_value = std::min(max_tokens_, expected_tokens + tokens_per_fill_);
+    // expected_state is either initialized above or reloaded during the CAS failure below.
+    uint64_t tokens = expected_state >> 32;
+    uint32_t last_fill = static_cast<uint32_t>(expected_state);
+    // A thread that read the time before another one may still update the bucket after it, in
+    // which case the fills are already accounted for.
+    const int32_t missed_fills = static_cast<int32_t>(fill - last_fill);
+    if (missed_fills > 0) {
+      tokens = std::min<uint64_t>(shard.max_tokens_,
+                                  tokens + static_cast<uint64_t>(missed_fills) *
+                                               shard.tokens_per_fill_);
+      last_fill = fill;
+    }
+    if (tokens == 0) {
+      return false;
+    }
 
     // Testing hook.
-    synchronizer_.syncPoint("on_fill_timer_pre_cas");
+    synchronizer_.syncPoint("allowed_pre_cas");
 
-    // Loop while the weak CAS fails trying to update the tokens value.
-  } while (
-      !tokens_.compare_exchange_weak(expected_tokens, new_tokens_value, std::memory_order_relaxed));
+    new_state = makeState(tokens - 1, last_fill);
+    // Loop while the weak CAS fails trying to take a token.
+  } while (!shard.state_.compare_exchange_weak(expected_state, new_state,
+                                               std::memory_order_relaxed));
 
-  fill_timer_->enableTimer(fill_interval_);
+  // We successfully took a token.
+  return true;
 }
 
 bool LocalRateLimiterImpl::requestAllowed() const {
-  // Relaxed consistency is used for all operations because we don't care about ordering, just the
-  // final atomic correctness.
-  uint32_t expected_tokens = tokens_.load(std::memory_order_relaxed);
-  do {
-    // expected_tokens is either initialized above or reloaded during the CAS failure below.
-    if (expected_tokens == 0) {
-      return false;
+  const uint32_t fill = currentFill();
+  const uint32_t num_shards = shards_.size();
+  const uint32_t index = threadIndex() % num_shards;
+  // Shards are not refilled evenly when some workers take more tokens than others, so once the
+  // shard of this thread is empty the other shards are tried in turn.
+  for (uint32_t i = 0; i < num_shards; i++) {
+    if (consume(shards_[(index + i) % num_shards], fill)) {
+      return true;
     }
+  }
+  return false;
+}
 
-    // Testing hook.
-    synchronizer_.syncPoint("allowed_pre_cas");
-
-    // Loop while the weak CAS fails trying to subtract 1 from expected.
-  } while (!tokens_.compare_exchange_weak(expected_tokens, expected_tokens - 1,
-                                          std::memory_order_relaxed));
-
-  // We successfully decremented the counter by 1.
-  return true;
+bool LocalRateLimiterImpl::requestAllowed(absl::string_view descriptor) const {
+  ASSERT(!descriptor_shards_.empty());
+  const uint32_t fill = currentFill();
+  DescriptorShard& descriptor_shard =
+      descriptor_shards_[absl::Hash<absl::string_view>()(descriptor) % descriptor_shards_.size()];
+  absl::MutexLock lock(&descriptor_shard.mutex_);
+  std::list<DescriptorBucket>& buckets = descriptor_shard.buckets_;
+  auto it = descriptor_shard.index_.find(descriptor);
+  if (it != descriptor_shard.index_.end()) {
+    buckets.splice(buckets.begin(), buckets, it->second);
+  } else {
+    if (buckets.size() >= max_descriptors_per_shard_) {
+      descriptor_shard.index_.erase(buckets.back().descriptor_);
+      buckets.pop_back();
+    }
+    buckets.emplace_front();
+    DescriptorBucket& bucket = buckets.front();
+    bucket.descriptor_ = std::string(descriptor);
+    bucket.bucket_.max_tokens_ = max_tokens_;
+    bucket.bucket_.tokens_per_fill_ = tokens_per_fill_;
+    bucket.bucket_.state_ = makeState(max_tokens_, fill);
+    descriptor_shard.index_.emplace(bucket.descriptor_, buckets.begin());
+  }
+  return consume(buckets.front().bucket_, fill);
 }
 
 } // namespace LocalRateLimit
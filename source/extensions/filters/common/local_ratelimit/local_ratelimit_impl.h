@@ -1,34 +1,93 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <list>
+#include <string>
+#include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
-#include "envoy/event/timer.h"
 
 #include "common/common/thread_synchronizer.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
 namespace Common {
 namespace LocalRateLimit {
 
+/**
+ * A token bucket shared by all workers. The bucket is not filled by a timer: the number of fill
+ * intervals elapsed since the limiter was created is computed from monotonic time whenever a
+ * token is requested, and the fills that were missed are added then.
+ *
+ * The tokens are split across shards, each of which is a lock free bucket in its own cache line.
+ * Workers take tokens from the shard of their thread, and only take tokens from the other shards
+ * once their own is empty, so that they don't all contend on the same atomic.
+ *
+ * Optionally, requests can also be limited per descriptor, e.g. per client address, with a bucket
+ * of the same configuration for each descriptor. Those buckets are kept in a bounded table from
+ * which the least recently used ones are evicted.
+ */
 class LocalRateLimiterImpl {
 public:
+  /**
+   * @param max_descriptors supplies the maximum number of descriptor buckets, or 0 if requests
+   *        are not limited per descriptor.
+   */
   LocalRateLimiterImpl(const std::chrono::milliseconds fill_interval, const uint32_t max_tokens,
-                       const uint32_t tokens_per_fill, Event::Dispatcher& dispatcher);
-  ~LocalRateLimiterImpl();
+                       const uint32_t tokens_per_fill, Event::Dispatcher& dispatcher,
+                       const uint32_t max_descriptors = 0);
 
   bool requestAllowed() const;
 
+  /**
+   * Take a token from the bucket of a descriptor. Must only be called if max_descriptors is set.
+   * @param descriptor supplies the descriptor of the request.
+   */
+  bool requestAllowed(absl::string_view descriptor) const;
+
 private:
-  void onFillTimer();
+  static constexpr uint32_t MaxShards = 16;
+
+  // Tokens left in the upper 32 bits, and the fill interval they were last filled at in the lower
+  // 32 bits, so that both are updated by a single CAS.
+  struct alignas(64) Shard {
+    uint32_t max_tokens_{};
+    uint32_t tokens_per_fill_{};
+    mutable std::atomic<uint64_t> state_{};
+  };
+
+  struct DescriptorBucket {
+    std::string descriptor_;
+    Shard bucket_;
+  };
+
+  // A part of the descriptor buckets, in least recently used order.
+  struct DescriptorShard {
+    absl::Mutex mutex_;
+    std::list<DescriptorBucket> buckets_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, std::list<DescriptorBucket>::iterator>
+        index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  uint32_t currentFill() const;
+  bool consume(const Shard& shard, uint32_t fill) const;
 
   const std::chrono::milliseconds fill_interval_;
   const uint32_t max_tokens_;
   const uint32_t tokens_per_fill_;
-  const Event::TimerPtr fill_timer_;
-  mutable std::atomic<uint32_t> tokens_;
+  TimeSource& time_source_;
+  const MonotonicTime start_time_;
+  std::vector<Shard> shards_;
+  // Empty if requests are not limited per descriptor.
+  mutable std::vector<DescriptorShard> descriptor_shards_;
+  const uint32_t max_descriptors_per_shard_;
   mutable Thread::ThreadSynchronizer synchronizer_; // Used for testing only.
 
   friend class LocalRateLimiterImplTest;
@@ -14,8 +14,36 @@ namespace Filters {
 namespace Common {
 namespace Lua {
 
-Coroutine::Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state)
-    : coroutine_state_(new_thread_state, false) {}
+namespace {
+
+int appendBytecode(lua_State*, const void* data, size_t size, void* bytecode) {
+  static_cast<std::string*>(bytecode)->append(static_cast<const char*>(data), size);
+  return 0;
+}
+
+} // namespace
+
+Coroutine::Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state,
+                     std::vector<int>* idle_coroutines)
+    : coroutine_state_(new_thread_state, false), parent_state_(new_thread_state.second),
+      idle_coroutines_(idle_coroutines) {}
+
+Coroutine::~Coroutine() {
+  if (idle_coroutines_ == nullptr || !reusable_ || idle_coroutines_->size() >= MaxIdleCoroutines) {
+    return;
+  }
+
+  // Leave the Lua thread as lua_newthread() would create it: with an empty stack, and with the
+  // globals of the owning state in case the script replaced the environment of the thread.
+  lua_State* state = coroutine_state_.get();
+  lua_settop(state, 0);
+  lua_pushvalue(parent_state_, LUA_GLOBALSINDEX);
+  lua_xmove(parent_state_, state, 1);
+  lua_replace(state, LUA_GLOBALSINDEX);
+
+  coroutine_state_.pushStack();
+  idle_coroutines_->push_back(luaL_ref(parent_state_, LUA_REGISTRYINDEX));
+}
 
 void Coroutine::start(int function_ref, int num_args, const std::function<void()>& yield_callback) {
   ASSERT(state_ == State::NotStarted);
@@ -36,6 +64,7 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
 
   if (0 == rc) {
     state_ = State::Finished;
+    reusable_ = true;
     ENVOY_LOG(debug, "coroutine finished");
   } else if (LUA_YIELD == rc) {
     state_ = State::Yielded;
@@ -51,18 +80,26 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
 ThreadLocalState::ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls)
     : tls_slot_(tls.allocateSlot()) {
 
-  // First verify that the supplied code can be parsed.
+  // First verify that the supplied code can be parsed and run, and compile it to the bytecode that
+  // the workers load. The bytecode keeps the debug information, so errors are reported with the
+  // same chunk name and lines as the code.
   CSmartPtr<lua_State, lua_close> state(lua_open());
   RELEASE_ASSERT(state.get() != nullptr, "unable to create new Lua state object");
   luaL_openlibs(state.get());
 
-  if (0 != luaL_dostring(state.get(), code.c_str())) {
+  auto bytecode = std::make_shared<std::string>();
+  if (0 != luaL_loadstring(state.get(), code.c_str())) {
+    throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
+  }
+  int rc = lua_dump(state.get(), appendBytecode, bytecode.get());
+  RELEASE_ASSERT(rc == 0, "unable to dump Lua bytecode");
+  if (0 != lua_pcall(state.get(), 0, LUA_MULTRET, 0)) {
     throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
   }
 
   // Now initialize on all threads.
-  tls_slot_->set([code](Event::Dispatcher&) {
-    return ThreadLocal::ThreadLocalObjectSharedPtr{new LuaThreadLocal(code)};
+  tls_slot_->set([bytecode](Event::Dispatcher&) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{new LuaThreadLocal(*bytecode)};
   });
 }
 
@@ -90,14 +127,27 @@ uint64_t ThreadLocalState::registerGlobal(const std::string& global) {
 }
 
 CoroutinePtr ThreadLocalState::createCoroutine() {
-  lua_State* state = tls_slot_->getTyped<LuaThreadLocal>().state_.get();
-  return std::make_unique<Coroutine>(std::make_pair(lua_newthread(state), state));
+  LuaThreadLocal& tls = tls_slot_->getTyped<LuaThreadLocal>();
+  lua_State* state = tls.state_.get();
+  lua_State* thread;
+  if (tls.idle_coroutines_.empty()) {
+    thread = lua_newthread(state);
+  } else {
+    // Push the idle thread so that the coroutine can take its own reference to it.
+    lua_rawgeti(state, LUA_REGISTRYINDEX, tls.idle_coroutines_.back());
+    luaL_unref(state, LUA_REGISTRYINDEX, tls.idle_coroutines_.back());
+    tls.idle_coroutines_.pop_back();
+    thread = lua_tothread(state, -1);
+  }
+  return std::make_unique<Coroutine>(std::make_pair(thread, state), &tls.idle_coroutines_);
 }
 
-ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& code) : state_(lua_open()) {
+ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& bytecode)
+    : state_(lua_open()) {
   RELEASE_ASSERT(state_.get() != nullptr, "unable to create new Lua state object");
   luaL_openlibs(state_.get());
-  int rc = luaL_dostring(state_.get(), code.c_str());
+  int rc = luaL_loadbuffer(state_.get(), bytecode.data(), bytecode.size(), "") ||
+           lua_pcall(state_.get(), 0, LUA_MULTRET, 0);
   ASSERT(rc == 0);
 }
 
@@ -324,7 +324,17 @@ class Coroutine : Logger::Loggable<Logger::Id::lua> {
 public:
   enum class State { NotStarted, Yielded, Finished };
 
-  Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state);
+  /**
+   * @param new_thread_state supplies the coroutine's Lua thread and the state owning it. The
+   *        thread must be at the top of the owning state's stack.
+   * @param idle_coroutines supplies the references of the idle Lua threads of the owning state.
+   *        If set, the Lua thread is added to them when the coroutine is destroyed after running
+   *        to completion, so that it can be reused by another coroutine.
+   */
+  Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state,
+            std::vector<int>* idle_coroutines = nullptr);
+  ~Coroutine();
+
   lua_State* luaState() { return coroutine_state_.get(); }
   State state() { return state_; }
 
@@ -347,8 +357,15 @@ public:
   void resume(int num_args, const std::function<void()>& yield_callback);
 
 private:
+  // The maximum number of idle Lua threads kept per state.
+  static constexpr uint64_t MaxIdleCoroutines = 128;
+
   LuaRef<lua_State> coroutine_state_;
+  lua_State* const parent_state_;
+  std::vector<int>* const idle_coroutines_;
   State state_{State::NotStarted};
+  // Set once the function returned without error, which leaves the Lua thread ready to run another.
+  bool reusable_{};
 };
 
 using CoroutinePtr = std::unique_ptr<Coroutine>;
@@ -357,13 +374,17 @@ using CoroutinePtr = std::unique_ptr<Coroutine>;
  * This class wraps a Lua state that can be used safely across threads. The model is that every
  * worker gets its own independent state. There is no truly global state that a script can access.
  * This is something that might be provided in the future via an API (not via Lua itself).
+ *
+ * The code is compiled once, when the state is created, and each worker loads the resulting
+ * bytecode instead of parsing the code again. The Lua threads of the coroutines that ran to
+ * completion are kept by each worker and reused for the next coroutines.
  */
 class ThreadLocalState : Logger::Loggable<Logger::Id::lua> {
 public:
   ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls);
 
   /**
-   * @return CoroutinePtr a new coroutine.
+   * @return CoroutinePtr a new coroutine, possibly running on the Lua thread of a previous one.
    */
   CoroutinePtr createCoroutine();
 
@@ -410,10 +431,12 @@ public:
 
 private:
   struct LuaThreadLocal : public ThreadLocal::ThreadLocalObject {
-    LuaThreadLocal(const std::string& code);
+    LuaThreadLocal(const std::string& bytecode);
 
     CSmartPtr<lua_State, lua_close> state_;
     std::vector<int> global_slots_;
+    // Registry references of the Lua threads that can be reused by new coroutines.
+    std::vector<int> idle_coroutines_;
   };
 
   ThreadLocal::SlotPtr tls_slot_;
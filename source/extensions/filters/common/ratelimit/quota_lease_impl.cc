@@ -0,0 +1,257 @@
+#include "extensions/filters/common/ratelimit/quota_lease_impl.h"
+
+#include <algorithm>
+
+#include "common/protobuf/utility.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "extensions/filters/common/ratelimit/ratelimit_impl.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+namespace {
+
+// Identifies a set of descriptors of a domain. Every string is prefixed with its length, so that
+// values containing separators can't make two different sets share a lease.
+std::string leaseKey(const std::string& domain,
+                     const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  std::string key = absl::StrCat(domain.size(), ":", domain);
+  for (const Envoy::RateLimit::Descriptor& descriptor : descriptors) {
+    absl::StrAppend(&key, "[");
+    for (const Envoy::RateLimit::DescriptorEntry& entry : descriptor.entries_) {
+      absl::StrAppend(&key, entry.key_.size(), ":", entry.key_, entry.value_.size(), ":",
+                      entry.value_);
+    }
+    if (descriptor.limit_) {
+      absl::StrAppend(&key, "/", descriptor.limit_.value().requests_per_unit_, "/",
+                      descriptor.limit_.value().unit_);
+    }
+    absl::StrAppend(&key, "]");
+  }
+  return key;
+}
+
+} // namespace
+
+QuotaLeases::QuotaLeases(
+    const envoy::config::ratelimit::v3::RateLimitServiceConfig::QuotaLeases& config,
+    ThreadLocal::SlotAllocator& tls, Grpc::AsyncClientFactoryPtr&& async_client_factory,
+    const std::chrono::milliseconds timeout,
+    envoy::config::core::v3::ApiVersion transport_api_version)
+    : settings_{config.lease_size(),
+                std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, lease_duration, 1000)),
+                timeout,
+                Grpc::VersionedMethods(
+                    "envoy.service.ratelimit.v3.RateLimitService.ShouldRateLimit",
+                    "envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit")
+                    .getMethodDescriptorForVersion(transport_api_version),
+                transport_api_version},
+      tls_slot_(tls.allocateSlot()) {
+  std::shared_ptr<Grpc::AsyncClientFactory> factory = std::move(async_client_factory);
+  tls_slot_->set([settings = settings_, factory](Event::Dispatcher& dispatcher) {
+    return std::make_shared<LeaseCache>(settings, dispatcher, factory->create());
+  });
+}
+
+QuotaLeases::LeaseCacheWeakPtr QuotaLeases::workerLeases() {
+  return std::static_pointer_cast<LeaseCache>(tls_slot_->get());
+}
+
+QuotaLeases::Fetch::~Fetch() {
+  if (request_ != nullptr) {
+    request_->cancel();
+  }
+}
+
+void QuotaLeases::Fetch::onSuccess(
+    std::unique_ptr<envoy::service::ratelimit::v3::RateLimitResponse>&& response, Tracing::Span&) {
+  request_ = nullptr;
+  cache_.onFetchComplete(key_, response->overall_code() ==
+                                       envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT
+                                   ? LimitStatus::OverLimit
+                                   : LimitStatus::OK);
+}
+
+void QuotaLeases::Fetch::onFailure(Grpc::Status::GrpcStatus, const std::string&, Tracing::Span&) {
+  request_ = nullptr;
+  cache_.onFetchComplete(key_, LimitStatus::Error);
+}
+
+QuotaLeases::LeaseCache::LeaseCache(const Settings& settings, Event::Dispatcher& dispatcher,
+                                    Grpc::RawAsyncClientPtr&& async_client)
+    : settings_(settings), dispatcher_(dispatcher), async_client_(std::move(async_client)) {
+  cleanup_timer_ = dispatcher_.createTimer([this]() -> void {
+    removeExpiredLeases();
+    cleanup_timer_->enableTimer(settings_.lease_duration_);
+  });
+  cleanup_timer_->enableTimer(settings_.lease_duration_);
+}
+
+QuotaLeases::LeaseCache::~LeaseCache() {
+  // The fetches are cancelled with the leases before the waiters are completed, since completing
+  // a request may make another one, which finds the leases of its worker gone.
+  std::vector<RequestCallbacks*> waiters;
+  for (auto& lease : leases_) {
+    waiters.insert(waiters.end(), lease.second.waiters_.begin(), lease.second.waiters_.end());
+  }
+  leases_.clear();
+  for (RequestCallbacks* callbacks : waiters) {
+    callbacks->complete(LimitStatus::Error, nullptr, nullptr, nullptr);
+  }
+}
+
+std::string
+QuotaLeases::LeaseCache::limit(RequestCallbacks& callbacks, const std::string& domain,
+                               const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  std::string key = leaseKey(domain, descriptors);
+  auto it = leases_.find(key);
+  if (it == leases_.end()) {
+    it = leases_.try_emplace(key).first;
+    GrpcClientImpl::createRequest(it->second.request_, domain, descriptors);
+    it->second.request_.set_hits_addend(settings_.lease_size_);
+  }
+
+  // Completing a request may start another one and change leases_, so a request is completed
+  // once its lease is no longer needed.
+  Lease& lease = it->second;
+  if (lease.expiry_ <= dispatcher_.timeSource().monotonicTime()) {
+    lease.hits_ = 0;
+    lease.over_limit_ = false;
+  }
+  if (lease.over_limit_) {
+    callbacks.complete(LimitStatus::OverLimit, nullptr, nullptr, nullptr);
+  } else if (lease.hits_ > 0) {
+    lease.hits_--;
+    if (lease.hits_ <= settings_.lease_size_ / 2 && lease.fetch_ == nullptr) {
+      fetch(key, lease);
+    }
+    callbacks.complete(LimitStatus::OK, nullptr, nullptr, nullptr);
+  } else {
+    lease.waiters_.push_back(&callbacks);
+    if (lease.fetch_ == nullptr) {
+      fetch(key, lease);
+    }
+  }
+  return key;
+}
+
+void QuotaLeases::LeaseCache::cancel(const std::string& key, RequestCallbacks& callbacks) {
+  const auto it = leases_.find(key);
+  if (it == leases_.end()) {
+    return;
+  }
+  std::vector<RequestCallbacks*>& waiters = it->second.waiters_;
+  waiters.erase(std::remove(waiters.begin(), waiters.end(), &callbacks), waiters.end());
+}
+
+void QuotaLeases::LeaseCache::fetch(const std::string& key, Lease& lease) {
+  ENVOY_LOG(debug, "fetching a rate limit quota lease for {}", key);
+  lease.fetch_ = std::make_unique<Fetch>(*this, key);
+  Fetch& fetch = *lease.fetch_;
+  // Preparing the request for the wire may change it, so the lease keeps its own copy.
+  const envoy::service::ratelimit::v3::RateLimitRequest request = lease.request_;
+  Grpc::AsyncRequest* async_request = async_client_->send(
+      settings_.service_method_, request, fetch, Tracing::NullSpan::instance(),
+      Http::AsyncClient::RequestOptions().setTimeout(settings_.timeout_),
+      settings_.transport_api_version_);
+  // A request failing inline has already completed the fetch.
+  if (async_request != nullptr) {
+    fetch.request_ = async_request;
+  }
+}
+
+void QuotaLeases::LeaseCache::onFetchComplete(const std::string& key, LimitStatus status) {
+  const auto it = leases_.find(key);
+  ASSERT(it != leases_.end());
+  Lease& lease = it->second;
+  dispatcher_.deferredDelete(std::move(lease.fetch_));
+
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  if (status == LimitStatus::OK) {
+    // The new lease replaces what is left of the previous one, whose hits belong to its own
+    // window: carrying them over would grant more hits in a window than were leased for it.
+    lease.hits_ = settings_.lease_size_;
+    lease.over_limit_ = false;
+    lease.expiry_ = now + settings_.lease_duration_;
+  } else if (status == LimitStatus::OverLimit) {
+    lease.hits_ = 0;
+    lease.over_limit_ = true;
+    lease.expiry_ = now + settings_.lease_duration_;
+  }
+
+  // Waiters are decided by the outcome of the fetch, in arrival order, as long as it granted hits.
+  std::vector<RequestCallbacks*> waiters = std::move(lease.waiters_);
+  lease.waiters_.clear();
+  size_t num_completed = waiters.size();
+  if (status == LimitStatus::OK) {
+    num_completed = std::min<uint64_t>(waiters.size(), lease.hits_);
+    lease.hits_ -= num_completed;
+    lease.waiters_.assign(waiters.begin() + num_completed, waiters.end());
+    if (!lease.waiters_.empty() || lease.hits_ <= settings_.lease_size_ / 2) {
+      fetch(key, lease);
+    }
+  }
+
+  for (size_t i = 0; i < num_completed; i++) {
+    waiters[i]->complete(status, nullptr, nullptr, nullptr);
+  }
+}
+
+void QuotaLeases::LeaseCache::removeExpiredLeases() {
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  for (auto it = leases_.begin(); it != leases_.end();) {
+    const Lease& lease = it->second;
+    if (lease.expiry_ <= now && lease.fetch_ == nullptr && lease.waiters_.empty()) {
+      leases_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void LeasedClientImpl::cancel() {
+  ASSERT(callbacks_ != nullptr);
+  if (const auto worker_leases = worker_leases_.lock()) {
+    worker_leases->cancel(key_, *this);
+  }
+  callbacks_ = nullptr;
+}
+
+void LeasedClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
+                             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                             Tracing::Span&, const StreamInfo::StreamInfo&) {
+  ASSERT(callbacks_ == nullptr);
+  const auto worker_leases = worker_leases_.lock();
+  if (worker_leases == nullptr) {
+    // The configuration of the filter was removed.
+    callbacks.complete(LimitStatus::Error, nullptr, nullptr, nullptr);
+    return;
+  }
+  callbacks_ = &callbacks;
+  // The request may complete before limit() returns, in which case the key is not needed anymore.
+  std::string key = worker_leases->limit(*this, domain, descriptors);
+  if (callbacks_ != nullptr) {
+    key_ = std::move(key);
+  }
+}
+
+void LeasedClientImpl::complete(LimitStatus status, DescriptorStatusListPtr&& descriptor_statuses,
+                                Http::ResponseHeaderMapPtr&& response_headers_to_add,
+                                Http::RequestHeaderMapPtr&& request_headers_to_add) {
+  RequestCallbacks* callbacks = callbacks_;
+  callbacks_ = nullptr;
+  callbacks->complete(status, std::move(descriptor_statuses), std::move(response_headers_to_add),
+                      std::move(request_headers_to_add));
+}
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/core/v3/grpc_service.pb.h"
+#include "envoy/config/ratelimit/v3/rls.pb.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/grpc/async_client.h"
+#include "envoy/grpc/async_client_manager.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/service/ratelimit/v3/rls.pb.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/grpc/typed_async_client.h"
+
+#include "extensions/filters/common/ratelimit/ratelimit.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+/**
+ * Leases of rate limit quota of one filter configuration, which owns them on the main thread.
+ *
+ * Each worker asks the rate limit service for lease_size hits at once for a set of descriptors,
+ * using the hits_addend field of the request, and then decides the requests for that set of
+ * descriptors locally until the lease is used up or expires. A lease is renewed in the background
+ * once half of it is used, so that only the first requests for a set of descriptors, and requests
+ * arriving faster than leases are renewed, wait for the rate limit service. A refused lease makes
+ * requests over limit until it expires. Requests decided locally get neither the headers nor the
+ * descriptor statuses of the rate limit service's responses.
+ */
+class QuotaLeases : public Logger::Loggable<Logger::Id::filter> {
+public:
+  QuotaLeases(const envoy::config::ratelimit::v3::RateLimitServiceConfig::QuotaLeases& config,
+              ThreadLocal::SlotAllocator& tls, Grpc::AsyncClientFactoryPtr&& async_client_factory,
+              const std::chrono::milliseconds timeout,
+              envoy::config::core::v3::ApiVersion transport_api_version);
+
+  // Per-worker leases, keyed by domain and descriptors.
+  class LeaseCache;
+  using LeaseCacheWeakPtr = std::weak_ptr<LeaseCache>;
+
+  /**
+   * @return the leases of the calling worker. The handle doesn't own them: they are destroyed on
+   * their worker once the QuotaLeases is destroyed on the main thread.
+   */
+  LeaseCacheWeakPtr workerLeases();
+
+private:
+  struct Settings {
+    const uint32_t lease_size_;
+    const std::chrono::milliseconds lease_duration_;
+    const std::chrono::milliseconds timeout_;
+    const Protobuf::MethodDescriptor& service_method_;
+    const envoy::config::core::v3::ApiVersion transport_api_version_;
+  };
+
+  // A request for a lease.
+  class Fetch
+      : public Grpc::AsyncRequestCallbacks<envoy::service::ratelimit::v3::RateLimitResponse>,
+        public Event::DeferredDeletable {
+  public:
+    Fetch(LeaseCache& cache, const std::string& key) : cache_(cache), key_(key) {}
+    ~Fetch() override;
+
+    // Grpc::AsyncRequestCallbacks
+    void onCreateInitialMetadata(Http::RequestHeaderMap&) override {}
+    void onSuccess(std::unique_ptr<envoy::service::ratelimit::v3::RateLimitResponse>&& response,
+                   Tracing::Span& span) override;
+    void onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                   Tracing::Span& span) override;
+
+    LeaseCache& cache_;
+    const std::string key_;
+    Grpc::AsyncRequest* request_{};
+  };
+  using FetchPtr = std::unique_ptr<Fetch>;
+
+  struct Lease {
+    // The request of the lease, to renew it.
+    envoy::service::ratelimit::v3::RateLimitRequest request_;
+    // Hits left, and whether the last lease was refused.
+    uint64_t hits_{};
+    bool over_limit_{};
+    MonotonicTime expiry_{};
+    FetchPtr fetch_;
+    // Requests waiting for the fetch to complete, in arrival order.
+    std::vector<RequestCallbacks*> waiters_;
+  };
+
+public:
+  // The settings are copied, since a worker may still complete a fetch after the QuotaLeases is
+  // gone, before its cache is destroyed.
+  class LeaseCache : public ThreadLocal::ThreadLocalObject {
+  public:
+    LeaseCache(const Settings& settings, Event::Dispatcher& dispatcher,
+               Grpc::RawAsyncClientPtr&& async_client);
+    // Completes the requests still waiting for a lease with an error.
+    ~LeaseCache() override;
+
+    /**
+     * Decide a request, locally if the worker holds a lease for its descriptors.
+     * @param callbacks supplies the completion callbacks, which may be called before this returns.
+     * @param domain specifies the rate limit domain.
+     * @param descriptors specifies the descriptors of the request.
+     * @return the key identifying the request to cancel(), if it waits for a lease.
+     */
+    std::string limit(RequestCallbacks& callbacks, const std::string& domain,
+                      const std::vector<Envoy::RateLimit::Descriptor>& descriptors);
+
+    /**
+     * Stop waiting for a lease.
+     * @param key supplies the key returned by limit().
+     * @param callbacks supplies the callbacks passed to limit().
+     */
+    void cancel(const std::string& key, RequestCallbacks& callbacks);
+
+    void onFetchComplete(const std::string& key, LimitStatus status);
+
+  private:
+    void fetch(const std::string& key, Lease& lease);
+    void removeExpiredLeases();
+
+    const Settings settings_;
+    Event::Dispatcher& dispatcher_;
+    Grpc::AsyncClient<envoy::service::ratelimit::v3::RateLimitRequest,
+                      envoy::service::ratelimit::v3::RateLimitResponse>
+        async_client_;
+    Event::TimerPtr cleanup_timer_;
+    absl::flat_hash_map<std::string, Lease> leases_;
+  };
+
+private:
+  const Settings settings_;
+  ThreadLocal::SlotPtr tls_slot_;
+};
+
+using QuotaLeasesSharedPtr = std::shared_ptr<QuotaLeases>;
+
+/**
+ * A rate limit client deciding requests with quota leases. It is created on a worker, and only
+ * refers to the leases of that worker.
+ */
+class LeasedClientImpl : public Client, public RequestCallbacks {
+public:
+  explicit LeasedClientImpl(QuotaLeases& quota_leases)
+      : worker_leases_(quota_leases.workerLeases()) {}
+  ~LeasedClientImpl() override { ASSERT(!callbacks_); }
+
+  // Filters::Common::RateLimit::Client
+  void cancel() override;
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+             Tracing::Span& parent_span, const StreamInfo::StreamInfo& stream_info) override;
+
+  // Filters::Common::RateLimit::RequestCallbacks
+  void complete(LimitStatus status, DescriptorStatusListPtr&& descriptor_statuses,
+                Http::ResponseHeaderMapPtr&& response_headers_to_add,
+                Http::RequestHeaderMapPtr&& request_headers_to_add) override;
+
+private:
+  // The QuotaLeases is owned by the filter configuration, and destroyed on the main thread with it
+  // and with its thread local slot. Requests made once it is gone are errors.
+  const QuotaLeases::LeaseCacheWeakPtr worker_leases_;
+  RequestCallbacks* callbacks_{};
+  std::string key_;
+};
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
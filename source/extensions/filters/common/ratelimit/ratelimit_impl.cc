@@ -120,7 +120,11 @@ void GrpcClientImpl::onFailure(Grpc::Status::GrpcStatus status, const std::strin
 ClientPtr rateLimitClient(Server::Configuration::FactoryContext& context,
                           const envoy::config::core::v3::GrpcService& grpc_service,
                           const std::chrono::milliseconds timeout,
-                          envoy::config::core::v3::ApiVersion transport_api_version) {
+                          envoy::config::core::v3::ApiVersion transport_api_version,
+                          const QuotaLeasesSharedPtr& quota_leases) {
+  if (quota_leases != nullptr) {
+    return std::make_unique<LeasedClientImpl>(*quota_leases);
+  }
   // TODO(ramaraochavali): register client to singleton when GrpcClientImpl supports concurrent
   // requests.
   const auto async_client_factory =
@@ -130,6 +134,20 @@ ClientPtr rateLimitClient(Server::Configuration::FactoryContext& context,
       async_client_factory->create(), timeout, transport_api_version);
 }
 
+QuotaLeasesSharedPtr
+quotaLeases(Server::Configuration::FactoryContext& context,
+            const envoy::config::ratelimit::v3::RateLimitServiceConfig& rate_limit_service,
+            const std::chrono::milliseconds timeout) {
+  if (!rate_limit_service.has_quota_leases()) {
+    return nullptr;
+  }
+  return std::make_shared<QuotaLeases>(
+      rate_limit_service.quota_leases(), context.threadLocal(),
+      context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
+          rate_limit_service.grpc_service(), context.scope(), true),
+      timeout, rate_limit_service.transport_api_version());
+}
+
 } // namespace RateLimit
 } // namespace Common
 } // namespace Filters
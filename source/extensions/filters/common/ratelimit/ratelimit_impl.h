@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "envoy/config/core/v3/grpc_service.pb.h"
+#include "envoy/config/ratelimit/v3/rls.pb.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/ratelimit/ratelimit.h"
@@ -19,6 +20,7 @@
 #include "common/grpc/typed_async_client.h"
 #include "common/singleton/const_singleton.h"
 
+#include "extensions/filters/common/ratelimit/quota_lease_impl.h"
 #include "extensions/filters/common/ratelimit/ratelimit.h"
 
 namespace Envoy {
@@ -80,11 +82,23 @@ private:
 
 /**
  * Builds the rate limit client.
+ * @param quota_leases supplies the quota leases to decide requests with, if leases are configured.
  */
 ClientPtr rateLimitClient(Server::Configuration::FactoryContext& context,
                           const envoy::config::core::v3::GrpcService& grpc_service,
                           const std::chrono::milliseconds timeout,
-                          envoy::config::core::v3::ApiVersion transport_api_version);
+                          envoy::config::core::v3::ApiVersion transport_api_version,
+                          const QuotaLeasesSharedPtr& quota_leases = nullptr);
+
+/**
+ * Builds the quota leases of a filter configuration. Called on the main thread, when the filter
+ * configuration is created.
+ * @return the quota leases, or nullptr if the rate limit service configuration has none.
+ */
+QuotaLeasesSharedPtr
+quotaLeases(Server::Configuration::FactoryContext& context,
+            const envoy::config::ratelimit::v3::RateLimitServiceConfig& rate_limit_service,
+            const std::chrono::milliseconds timeout);
 
 } // namespace RateLimit
 } // namespace Common
@@ -1,15 +1,62 @@
 #include "extensions/filters/common/rbac/engine_impl.h"
 
+#include <algorithm>
+#include <map>
+
 #include "envoy/config/rbac/v3/rbac.pb.h"
 
 #include "common/http/header_map_impl.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
 namespace Common {
 namespace RBAC {
 
+namespace {
+
+bool hasMetadataMatcher(const envoy::config::rbac::v3::Permission& permission);
+bool hasMetadataMatcher(const envoy::config::rbac::v3::Principal& principal);
+
+template <class Rule> bool anyHasMetadataMatcher(const Protobuf::RepeatedPtrField<Rule>& rules) {
+  return std::any_of(rules.begin(), rules.end(),
+                     [](const Rule& rule) { return hasMetadataMatcher(rule); });
+}
+
+bool hasMetadataMatcher(const envoy::config::rbac::v3::Permission& permission) {
+  switch (permission.rule_case()) {
+  case envoy::config::rbac::v3::Permission::RuleCase::kAndRules:
+    return anyHasMetadataMatcher(permission.and_rules().rules());
+  case envoy::config::rbac::v3::Permission::RuleCase::kOrRules:
+    return anyHasMetadataMatcher(permission.or_rules().rules());
+  case envoy::config::rbac::v3::Permission::RuleCase::kNotRule:
+    return hasMetadataMatcher(permission.not_rule());
+  case envoy::config::rbac::v3::Permission::RuleCase::kMetadata:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool hasMetadataMatcher(const envoy::config::rbac::v3::Principal& principal) {
+  switch (principal.identifier_case()) {
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kAndIds:
+    return anyHasMetadataMatcher(principal.and_ids().ids());
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kOrIds:
+    return anyHasMetadataMatcher(principal.or_ids().ids());
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kNotId:
+    return hasMetadataMatcher(principal.not_id());
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kMetadata:
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
 RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     const envoy::config::rbac::v3::RBAC& rules, const EnforcementMode mode)
     : action_(rules.action()), mode_(mode) {
@@ -21,8 +68,25 @@ RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     }
   }
 
+  // Policies are evaluated in name order.
+  std::map<std::string, const envoy::config::rbac::v3::Policy*> sorted_policies;
   for (const auto& policy : rules.policies()) {
-    policies_.emplace(policy.first, std::make_unique<PolicyMatcher>(policy.second, builder_.get()));
+    sorted_policies.emplace(policy.first, &policy.second);
+  }
+
+  std::vector<const envoy::config::rbac::v3::Policy*> index_policies;
+  for (const auto& policy : sorted_policies) {
+    policies_.emplace_back(policy.first,
+                           std::make_unique<PolicyMatcher>(*policy.second, builder_.get()));
+    index_policies.push_back(policy.second);
+    if (policy.second->has_condition() || anyHasMetadataMatcher(policy.second->permissions()) ||
+        anyHasMetadataMatcher(policy.second->principals())) {
+      depends_only_on_connection_ = false;
+    }
+  }
+
+  if (policies_.size() >= MinIndexedPolicies) {
+    index_ = std::make_unique<PolicyIndex>(index_policies);
   }
 }
 
@@ -63,19 +127,26 @@ bool RoleBasedAccessControlEngineImpl::handleAction(const Network::Connection& c
 bool RoleBasedAccessControlEngineImpl::checkPolicyMatch(
     const Network::Connection& connection, const StreamInfo::StreamInfo& info,
     const Envoy::Http::RequestHeaderMap& headers, std::string* effective_policy_id) const {
-  bool matched = false;
-
-  for (const auto& policy : policies_) {
+  // Only the policies that the index didn't rule out are evaluated, in the same order as they would
+  // be without the index.
+  absl::optional<PolicyIndex::Candidates> candidates;
+  if (index_ != nullptr) {
+    candidates = index_->candidates(connection, headers, info);
+  }
+  for (size_t i = 0; i < policies_.size(); i++) {
+    if (candidates.has_value() && (candidates.value()[i / 64] & (1ULL << (i % 64))) == 0) {
+      continue;
+    }
+    const auto& policy = policies_[i];
     if (policy.second->matches(connection, headers, info)) {
-      matched = true;
       if (effective_policy_id != nullptr) {
         *effective_policy_id = policy.first;
       }
-      break;
+      return true;
     }
   }
 
-  return matched;
+  return false;
 }
 
 } // namespace RBAC
@@ -4,6 +4,7 @@
 
 #include "extensions/filters/common/rbac/engine.h"
 #include "extensions/filters/common/rbac/matchers.h"
+#include "extensions/filters/common/rbac/policy_index.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -37,7 +38,16 @@ public:
   bool handleAction(const Network::Connection& connection, StreamInfo::StreamInfo& info,
                     std::string* effective_policy_id) const override;
 
+  /**
+   * @return whether the decision only depends on the connection, and not on the metadata of its
+   *         stream info or on conditions, in which case it doesn't change over a connection once
+   *         taken.
+   */
+  bool decisionDependsOnlyOnConnection() const { return depends_only_on_connection_; }
+
 private:
+  static constexpr size_t MinIndexedPolicies = 4;
+
   // Checks whether the request matches any policies
   bool checkPolicyMatch(const Network::Connection& connection, const StreamInfo::StreamInfo& info,
                         const Envoy::Http::RequestHeaderMap& headers,
@@ -46,7 +56,11 @@ private:
   const envoy::config::rbac::v3::RBAC::Action action_;
   const EnforcementMode mode_;
 
-  std::map<std::string, std::unique_ptr<PolicyMatcher>> policies_;
+  // In name order, the first matching policy being the effective one.
+  std::vector<std::pair<std::string, std::unique_ptr<PolicyMatcher>>> policies_;
+  // Null if there are too few policies for the index to be cheaper than evaluating them all.
+  std::unique_ptr<PolicyIndex> index_;
+  bool depends_only_on_connection_{true};
 
   Protobuf::Arena constant_arena_;
   Expr::BuilderPtr builder_;
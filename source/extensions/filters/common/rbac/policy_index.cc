@@ -0,0 +1,355 @@
+#include "extensions/filters/common/rbac/policy_index.h"
+
+#include <iterator>
+#include <map>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/http/header_utility.h"
+#include "common/http/path_utility.h"
+#include "common/network/cidr_range.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+namespace {
+
+// Whether a string matcher only matches a single value, which can then be looked up.
+bool isExact(const envoy::type::matcher::v3::StringMatcher& matcher) {
+  return matcher.match_pattern_case() == envoy::type::matcher::v3::StringMatcher::kExact &&
+         !matcher.ignore_case();
+}
+
+} // namespace
+
+void PolicyIndex::Keys::merge(Keys&& other) {
+  std::move(other.cidr_ranges_.begin(), other.cidr_ranges_.end(),
+            std::back_inserter(cidr_ranges_));
+  std::move(other.header_values_.begin(), other.header_values_.end(),
+            std::back_inserter(header_values_));
+  std::move(other.header_regexes_.begin(), other.header_regexes_.end(),
+            std::back_inserter(header_regexes_));
+  std::move(other.paths_.begin(), other.paths_.end(), std::back_inserter(paths_));
+  std::move(other.server_names_.begin(), other.server_names_.end(),
+            std::back_inserter(server_names_));
+  ports_.insert(ports_.end(), other.ports_.begin(), other.ports_.end());
+}
+
+PolicyIndex::PolicyIndex(const std::vector<const envoy::config::rbac::v3::Policy*>& policies)
+    : num_policies_(policies.size()), unindexed_((policies.size() + 63) / 64) {
+  std::vector<std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>>>
+      cidr_ranges(IPMatcher::Type::DownstreamRemote + 1);
+  std::map<std::string, absl::flat_hash_map<std::string, PolicyList>> header_values;
+  std::map<std::string, std::vector<std::pair<std::string, uint32_t>>> header_regexes;
+
+  for (uint32_t i = 0; i < num_policies_; i++) {
+    const envoy::config::rbac::v3::Policy& policy = *policies[i];
+    // A policy matches if any of its principals and any of its permissions match, so the keys of
+    // either list are enough to rule it out.
+    Keys keys;
+    if (!addAnyOfKeys(policy.principals(), keys)) {
+      keys = Keys();
+      if (!addAnyOfKeys(policy.permissions(), keys)) {
+        markUnindexed(i);
+        continue;
+      }
+    }
+
+    num_indexed_++;
+    for (const auto& range : keys.cidr_ranges_) {
+      Network::Address::CidrRange cidr_range = Network::Address::CidrRange::create(range.second);
+      // An invalid range matches no address.
+      if (!cidr_range.isValid()) {
+        continue;
+      }
+      auto& ranges = cidr_ranges[range.first];
+      if (ranges.empty() || ranges.back().first != i) {
+        ranges.emplace_back(i, std::vector<Network::Address::CidrRange>());
+      }
+      ranges.back().second.push_back(std::move(cidr_range));
+    }
+    for (const auto& value : keys.header_values_) {
+      header_values[value.first][value.second].push_back(i);
+    }
+    for (const auto& regex : keys.header_regexes_) {
+      header_regexes[regex.first].emplace_back(regex.second, i);
+    }
+    for (const std::string& path : keys.paths_) {
+      paths_[path].push_back(i);
+    }
+    for (const std::string& server_name : keys.server_names_) {
+      server_names_[server_name].push_back(i);
+    }
+    for (const uint32_t port : keys.ports_) {
+      ports_[port].push_back(i);
+    }
+  }
+
+  // The index can't hold everything a configuration may contain, in which case the policies it
+  // couldn't hold are evaluated for every request.
+  tries_.resize(cidr_ranges.size());
+  for (size_t type = 0; type < cidr_ranges.size(); type++) {
+    if (cidr_ranges[type].empty()) {
+      continue;
+    }
+    try {
+      tries_[type] = std::make_unique<Network::LcTrie::LcTrie<uint32_t>>(cidr_ranges[type]);
+    } catch (const EnvoyException&) {
+      for (const auto& ranges : cidr_ranges[type]) {
+        markUnindexed(ranges.first);
+      }
+    }
+  }
+
+  for (auto& values : header_values) {
+    header_values_.push_back(
+        {Envoy::Http::LowerCaseString(values.first), std::move(values.second)});
+  }
+
+  for (const auto& regexes : header_regexes) {
+    HeaderRegexes header{Envoy::Http::LowerCaseString(regexes.first),
+                         std::make_unique<re2::RE2::Set>(re2::RE2::Quiet, re2::RE2::ANCHOR_BOTH),
+                         {}};
+    bool compiled = true;
+    for (const auto& regex : regexes.second) {
+      const int index = header.set_->Add(regex.first, nullptr);
+      if (index < 0) {
+        compiled = false;
+        break;
+      }
+      ASSERT(static_cast<size_t>(index) == header.policies_.size());
+      header.policies_.push_back(regex.second);
+    }
+    if (!compiled || !header.set_->Compile()) {
+      for (const auto& regex : regexes.second) {
+        markUnindexed(regex.second);
+      }
+      continue;
+    }
+    header_regexes_.push_back(std::move(header));
+  }
+}
+
+bool PolicyIndex::addHeaderKeys(const envoy::config::route::v3::HeaderMatcher& header,
+                                Keys& keys) {
+  if (header.invert_match()) {
+    return false;
+  }
+  const std::string name = Envoy::Http::LowerCaseString(header.name()).get();
+  switch (header.header_match_specifier_case()) {
+  case envoy::config::route::v3::HeaderMatcher::kExactMatch:
+    // An empty value matches any value.
+    if (header.exact_match().empty()) {
+      return false;
+    }
+    keys.header_values_.emplace_back(name, header.exact_match());
+    return true;
+  case envoy::config::route::v3::HeaderMatcher::kSafeRegexMatch:
+    if (!header.safe_regex_match().has_google_re2()) {
+      return false;
+    }
+    keys.header_regexes_.emplace_back(name, header.safe_regex_match().regex());
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool PolicyIndex::addPathKeys(const envoy::type::matcher::v3::PathMatcher& path, Keys& keys) {
+  if (!path.has_path() || !isExact(path.path())) {
+    return false;
+  }
+  keys.paths_.push_back(path.path().exact());
+  return true;
+}
+
+bool PolicyIndex::addKeys(const envoy::config::rbac::v3::Permission& permission, Keys& keys) {
+  switch (permission.rule_case()) {
+  case envoy::config::rbac::v3::Permission::RuleCase::kAndRules:
+    return addAllOfKeys(permission.and_rules().rules(), keys);
+  case envoy::config::rbac::v3::Permission::RuleCase::kOrRules:
+    return addAnyOfKeys(permission.or_rules().rules(), keys);
+  case envoy::config::rbac::v3::Permission::RuleCase::kHeader:
+    return addHeaderKeys(permission.header(), keys);
+  case envoy::config::rbac::v3::Permission::RuleCase::kDestinationIp:
+    keys.cidr_ranges_.emplace_back(IPMatcher::Type::DownstreamLocal, permission.destination_ip());
+    return true;
+  case envoy::config::rbac::v3::Permission::RuleCase::kDestinationPort:
+    keys.ports_.push_back(permission.destination_port());
+    return true;
+  case envoy::config::rbac::v3::Permission::RuleCase::kRequestedServerName:
+    if (!isExact(permission.requested_server_name())) {
+      return false;
+    }
+    keys.server_names_.push_back(permission.requested_server_name().exact());
+    return true;
+  case envoy::config::rbac::v3::Permission::RuleCase::kUrlPath:
+    return addPathKeys(permission.url_path(), keys);
+  default:
+    return false;
+  }
+}
+
+bool PolicyIndex::addKeys(const envoy::config::rbac::v3::Principal& principal, Keys& keys) {
+  switch (principal.identifier_case()) {
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kAndIds:
+    return addAllOfKeys(principal.and_ids().ids(), keys);
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kOrIds:
+    return addAnyOfKeys(principal.or_ids().ids(), keys);
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kSourceIp:
+    keys.cidr_ranges_.emplace_back(IPMatcher::Type::ConnectionRemote, principal.source_ip());
+    return true;
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kDirectRemoteIp:
+    keys.cidr_ranges_.emplace_back(IPMatcher::Type::DownstreamDirectRemote,
+                                   principal.direct_remote_ip());
+    return true;
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kRemoteIp:
+    keys.cidr_ranges_.emplace_back(IPMatcher::Type::DownstreamRemote, principal.remote_ip());
+    return true;
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kHeader:
+    return addHeaderKeys(principal.header(), keys);
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kUrlPath:
+    return addPathKeys(principal.url_path(), keys);
+  default:
+    return false;
+  }
+}
+
+// Rules matching if any of them matches can only be ruled out if all of them can.
+template <class Rule>
+bool PolicyIndex::addAnyOfKeys(const Protobuf::RepeatedPtrField<Rule>& rules, Keys& keys) {
+  Keys any_of_keys;
+  for (const Rule& rule : rules) {
+    if (!addKeys(rule, any_of_keys)) {
+      return false;
+    }
+  }
+  keys.merge(std::move(any_of_keys));
+  return true;
+}
+
+// Rules matching if all of them match are ruled out by any of them.
+template <class Rule>
+bool PolicyIndex::addAllOfKeys(const Protobuf::RepeatedPtrField<Rule>& rules, Keys& keys) {
+  for (const Rule& rule : rules) {
+    Keys rule_keys;
+    if (addKeys(rule, rule_keys)) {
+      keys.merge(std::move(rule_keys));
+      return true;
+    }
+  }
+  return false;
+}
+
+void PolicyIndex::setBit(uint32_t policy, Candidates& candidates) {
+  candidates[policy / 64] |= 1ULL << (policy % 64);
+}
+
+void PolicyIndex::markUnindexed(uint32_t policy) { setBit(policy, unindexed_); }
+
+void PolicyIndex::mark(const PolicyList& policies, Candidates& candidates) {
+  for (const uint32_t policy : policies) {
+    setBit(policy, candidates);
+  }
+}
+
+PolicyIndex::Candidates PolicyIndex::candidates(const Network::Connection& connection,
+                                                const Envoy::Http::RequestHeaderMap& headers,
+                                                const StreamInfo::StreamInfo& info) const {
+  Candidates candidates = unindexed_;
+  if (num_indexed_ == 0) {
+    return candidates;
+  }
+
+  for (size_t type = 0; type < tries_.size(); type++) {
+    if (tries_[type] == nullptr) {
+      continue;
+    }
+    Network::Address::InstanceConstSharedPtr address;
+    switch (type) {
+    case IPMatcher::Type::ConnectionRemote:
+      address = connection.remoteAddress();
+      break;
+    case IPMatcher::Type::DownstreamLocal:
+      address = info.downstreamLocalAddress();
+      break;
+    case IPMatcher::Type::DownstreamDirectRemote:
+      address = info.downstreamDirectRemoteAddress();
+      break;
+    case IPMatcher::Type::DownstreamRemote:
+      address = info.downstreamRemoteAddress();
+      break;
+    default:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+    if (address != nullptr && address->ip() != nullptr) {
+      mark(tries_[type]->getData(address), candidates);
+    }
+  }
+
+  for (const HeaderValues& header : header_values_) {
+    const auto value = Envoy::Http::HeaderUtility::getAllOfHeaderAsString(headers, header.name_);
+    if (!value.result().has_value()) {
+      continue;
+    }
+    const auto it = header.policies_.find(value.result().value());
+    if (it != header.policies_.end()) {
+      mark(it->second, candidates);
+    }
+  }
+
+  for (const HeaderRegexes& header : header_regexes_) {
+    const auto value = Envoy::Http::HeaderUtility::getAllOfHeaderAsString(headers, header.name_);
+    if (!value.result().has_value()) {
+      continue;
+    }
+    std::vector<int> matches;
+    re2::RE2::Set::ErrorInfo error;
+    if (!header.set_->Match(value.result().value(), &matches, &error) &&
+        error.kind != re2::RE2::Set::kNoError) {
+      // The regexes couldn't be evaluated together, so each of them is evaluated by its policy.
+      mark(header.policies_, candidates);
+      continue;
+    }
+    for (const int index : matches) {
+      setBit(header.policies_[index], candidates);
+    }
+  }
+
+  if (!paths_.empty() && headers.Path() != nullptr) {
+    const auto it =
+        paths_.find(Envoy::Http::PathUtil::removeQueryAndFragment(headers.getPathValue()));
+    if (it != paths_.end()) {
+      mark(it->second, candidates);
+    }
+  }
+
+  if (!server_names_.empty()) {
+    const auto it = server_names_.find(connection.requestedServerName());
+    if (it != server_names_.end()) {
+      mark(it->second, candidates);
+    }
+  }
+
+  if (!ports_.empty()) {
+    const Network::Address::Ip* ip = info.downstreamLocalAddress()->ip();
+    if (ip != nullptr) {
+      const auto it = ports_.find(ip->port());
+      if (it != ports_.end()) {
+        mark(it->second, candidates);
+      }
+    }
+  }
+
+  return candidates;
+}
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
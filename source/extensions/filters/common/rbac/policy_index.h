@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/rbac/v3/rbac.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/network/connection.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "common/network/lc_trie.h"
+
+#include "extensions/filters/common/rbac/matchers.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "re2/set.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+/**
+ * An index of the policies of an RBAC engine, which finds the few policies that may match a
+ * request with a handful of lookups, instead of evaluating every policy.
+ *
+ * A policy is indexed by a condition that it can't match without, taken from its principals or
+ * from its permissions: source, destination and remote CIDR ranges are merged into one LC trie
+ * per address, exact header, path, server name and port matches into hash tables, and header
+ * regexes into one RE2::Set per header. Policies for which no such condition is found, e.g. a
+ * policy matching any principal and any permission, are candidates for every request.
+ *
+ * The candidates still have to be evaluated: the index only rules out policies that can't match.
+ */
+class PolicyIndex {
+public:
+  // A bitmap of policies, by their position in the policies the index was built from.
+  using Candidates = absl::InlinedVector<uint64_t, 4>;
+
+  PolicyIndex(const std::vector<const envoy::config::rbac::v3::Policy*>& policies);
+
+  /**
+   * @return the policies that may match a request. The other policies don't match it.
+   */
+  Candidates candidates(const Network::Connection& connection,
+                        const Envoy::Http::RequestHeaderMap& headers,
+                        const StreamInfo::StreamInfo& info) const;
+
+private:
+  // The conditions of one policy that it can't match without any of.
+  struct Keys {
+    void merge(Keys&& other);
+
+    std::vector<std::pair<IPMatcher::Type, envoy::config::core::v3::CidrRange>> cidr_ranges_;
+    std::vector<std::pair<std::string, std::string>> header_values_;
+    std::vector<std::pair<std::string, std::string>> header_regexes_;
+    std::vector<std::string> paths_;
+    std::vector<std::string> server_names_;
+    std::vector<uint32_t> ports_;
+  };
+
+  using PolicyList = std::vector<uint32_t>;
+
+  struct HeaderValues {
+    Envoy::Http::LowerCaseString name_;
+    absl::flat_hash_map<std::string, PolicyList> policies_;
+  };
+
+  struct HeaderRegexes {
+    Envoy::Http::LowerCaseString name_;
+    std::unique_ptr<re2::RE2::Set> set_;
+    // The policy of each regex of the set, by the index RE2::Set gave it.
+    PolicyList policies_;
+  };
+
+  static bool addHeaderKeys(const envoy::config::route::v3::HeaderMatcher& header, Keys& keys);
+  static bool addPathKeys(const envoy::type::matcher::v3::PathMatcher& path, Keys& keys);
+  static bool addKeys(const envoy::config::rbac::v3::Permission& permission, Keys& keys);
+  static bool addKeys(const envoy::config::rbac::v3::Principal& principal, Keys& keys);
+  template <class Rule>
+  static bool addAnyOfKeys(const Protobuf::RepeatedPtrField<Rule>& rules, Keys& keys);
+  template <class Rule>
+  static bool addAllOfKeys(const Protobuf::RepeatedPtrField<Rule>& rules, Keys& keys);
+
+  static void setBit(uint32_t policy, Candidates& candidates);
+  void markUnindexed(uint32_t policy);
+  static void mark(const PolicyList& policies, Candidates& candidates);
+
+  const uint32_t num_policies_;
+  uint32_t num_indexed_{};
+  Candidates unindexed_;
+  // One trie per kind of address, by IPMatcher::Type.
+  std::vector<std::unique_ptr<Network::LcTrie::LcTrie<uint32_t>>> tries_;
+  std::vector<HeaderValues> header_values_;
+  std::vector<HeaderRegexes> header_regexes_;
+  absl::flat_hash_map<std::string, PolicyList> paths_;
+  absl::flat_hash_map<std::string, PolicyList> server_names_;
+  absl::flat_hash_map<uint32_t, PolicyList> ports_;
+};
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -23,6 +23,18 @@ namespace HttpFilters {
 namespace AdaptiveConcurrency {
 namespace Controller {
 
+namespace {
+
+// Threads are given consecutive indexes the first time they record a latency sample with any
+// controller, so that workers map to different sample shards.
+uint32_t threadIndex() {
+  static std::atomic<uint32_t> next_index;
+  static thread_local const uint32_t index = next_index++;
+  return index;
+}
+
+} // namespace
+
 GradientControllerConfig::GradientControllerConfig(
     const envoy::extensions::filters::http::adaptive_concurrency::v3::GradientControllerConfig&
         proto_config,
@@ -52,7 +64,8 @@ GradientController::GradientController(GradientControllerConfig config,
       stats_(generateStats(scope_, stats_prefix)), random_(random), time_source_(time_source),
       deferred_limit_value_(0), num_rq_outstanding_(0),
       concurrency_limit_(config_.minConcurrency()),
-      latency_sample_hist_(hist_fast_alloc(), hist_free) {
+      latency_sample_hist_(hist_fast_alloc(), hist_free), sample_shards_(MaxSampleShards),
+      min_rtt_sample_count_(0) {
   min_rtt_calc_timer_ = dispatcher_.createTimer([this]() -> void { enterMinRTTSamplingWindow(); });
 
   sample_reset_timer_ = dispatcher_.createTimer([this]() -> void {
@@ -95,6 +108,10 @@ void GradientController::enterMinRTTSamplingWindow() {
 
   stats_.min_rtt_calculation_active_.set(1);
 
+  // The count must be reset before entering the window, so that workers don't count their samples
+  // on top of the count of the previous window.
+  min_rtt_sample_count_.store(0);
+
   // Set the minRTT flag to indicate we're gathering samples to update the value. This will
   // prevent the sample window from resetting until enough requests are gathered to complete the
   // recalculation.
@@ -104,15 +121,29 @@ void GradientController::enterMinRTTSamplingWindow() {
   // Throw away any latency samples from before the recalculation window as it may not represent
   // the minRTT.
   hist_clear(latency_sample_hist_.get());
+  clearSampleShards();
 
   min_rtt_epoch_ = time_source_.monotonicTime();
 }
 
 void GradientController::updateMinRTT() {
-  ASSERT(inMinRTTSamplingWindow());
-
   {
     absl::MutexLock ml(&sample_mutation_mtx_);
+    // Several workers may count samples past the required count before the first of them leaves
+    // the window, in which case only the first one updates the minRTT.
+    if (!inMinRTTSamplingWindow()) {
+      return;
+    }
+
+    mergeSampleShards();
+    // A sample counted just as the window was entered may have been recorded before it, and cleared
+    // with the samples of the previous window. The window stays open until enough samples are
+    // merged, and the count resumes from the merged samples.
+    const uint64_t sample_count = hist_sample_count(latency_sample_hist_.get());
+    if (sample_count < config_.minRTTAggregateRequestCount()) {
+      min_rtt_sample_count_.store(sample_count);
+      return;
+    }
     min_rtt_ = processLatencySamplesAndClear();
     stats_.min_rtt_msecs_.set(
         std::chrono::duration_cast<std::chrono::milliseconds>(min_rtt_).count());
@@ -140,6 +171,7 @@ void GradientController::resetSampleWindow() {
   // The sampling window must not be reset while sampling for the new minRTT value.
   ASSERT(!inMinRTTSamplingWindow());
 
+  mergeSampleShards();
   if (hist_sample_count(latency_sample_hist_.get()) == 0) {
     return;
   }
@@ -150,6 +182,22 @@ void GradientController::resetSampleWindow() {
   updateConcurrencyLimit(calculateNewLimit());
 }
 
+void GradientController::mergeSampleShards() {
+  for (SampleShard& shard : sample_shards_) {
+    absl::MutexLock ml(&shard.mutex_);
+    histogram_t* shard_hist = shard.hist_.get();
+    hist_accumulate(latency_sample_hist_.get(), &shard_hist, 1);
+    hist_clear(shard_hist);
+  }
+}
+
+void GradientController::clearSampleShards() {
+  for (SampleShard& shard : sample_shards_) {
+    absl::MutexLock ml(&shard.mutex_);
+    hist_clear(shard.hist_.get());
+  }
+}
+
 std::chrono::microseconds GradientController::processLatencySamplesAndClear() {
   const std::array<double, 1> quantile{config_.sampleAggregatePercentile()};
   std::array<double, 1> calculated_quantile;
@@ -181,19 +229,17 @@ uint32_t GradientController::calculateNewLimit() {
 }
 
 RequestForwardingAction GradientController::forwardingDecision() {
-  // Note that a race condition exists here which would allow more outstanding requests than the
-  // concurrency limit bounded by the number of worker threads. After loading num_rq_outstanding_
-  // and before loading concurrency_limit_, another thread could potentially swoop in and modify
-  // num_rq_outstanding_, causing us to move forward with stale values and increment
-  // num_rq_outstanding_.
-  //
-  // TODO (tonya11en): Reconsider using a CAS loop here.
-  if (num_rq_outstanding_.load() < concurrencyLimit()) {
-    ++num_rq_outstanding_;
-    return RequestForwardingAction::Forward;
-  }
-  stats_.rq_blocked_.inc();
-  return RequestForwardingAction::Block;
+  // The request is only counted as outstanding if the count is still below the limit when it is
+  // incremented, so that concurrent decisions can't admit more requests than the limit.
+  const uint32_t limit = concurrencyLimit();
+  uint32_t outstanding = num_rq_outstanding_.load();
+  do {
+    if (outstanding >= limit) {
+      stats_.rq_blocked_.inc();
+      return RequestForwardingAction::Block;
+    }
+  } while (!num_rq_outstanding_.compare_exchange_weak(outstanding, outstanding + 1));
+  return RequestForwardingAction::Forward;
 }
 
 void GradientController::recordLatencySample(MonotonicTime rq_send_time) {
@@ -208,14 +254,14 @@ void GradientController::recordLatencySample(MonotonicTime rq_send_time) {
   const std::chrono::microseconds rq_latency =
       std::chrono::duration_cast<std::chrono::microseconds>(time_source_.monotonicTime() -
                                                             rq_send_time);
-  uint32_t sample_count;
   {
-    absl::MutexLock ml(&sample_mutation_mtx_);
-    hist_insert(latency_sample_hist_.get(), rq_latency.count(), 1);
-    sample_count = hist_sample_count(latency_sample_hist_.get());
+    SampleShard& shard = sample_shards_[threadIndex() % sample_shards_.size()];
+    absl::MutexLock ml(&shard.mutex_);
+    hist_insert(shard.hist_.get(), rq_latency.count(), 1);
   }
 
-  if (inMinRTTSamplingWindow() && sample_count >= config_.minRTTAggregateRequestCount()) {
+  if (inMinRTTSamplingWindow() &&
+      ++min_rtt_sample_count_ >= config_.minRTTAggregateRequestCount()) {
     // This sample has pushed the request count over the request count requirement for the minRTT
     // recalculation. It must now be finished.
     updateMinRTT();
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <vector>
 
 #include "envoy/common/random_generator.h"
@@ -186,12 +188,10 @@ using GradientControllerConfigSharedPtr = std::shared_ptr<GradientControllerConf
  * When the gradient controller is instantiated, it starts inside of a minRTT calculation window
  * (indicated by inMinRTTSamplingWindow() returning true) and the concurrency limit is pinned to the
  * configured min_concurrency. This window lasts until the configured number of requests is
- * received, the minRTT value is updated, and the minRTT value is set by a single worker thread. To
- * prevent sampleRTT calculations from triggering during this window, the update window mutex is
- * held. Since it's necessary for a worker thread to know which update window update window mutex is
- * held for, they check the state of inMinRTTSamplingWindow() after each sample. When the minRTT
- * calculation is complete, a timer is set to trigger the next minRTT sampling window by the worker
- * thread who updates the minRTT value.
+ * received, the minRTT value is updated, and the minRTT value is set by a single worker thread.
+ * Workers count the samples taken during this window, and the worker whose sample completes the
+ * count updates the minRTT value. When the minRTT calculation is complete, a timer is set to
+ * trigger the next minRTT sampling window by the worker thread who updates the minRTT value.
  *
  * If the controller is not in a minRTT sampling window, it's possible that the controller is in a
  * sampleRTT calculation window. In this, all of the latency samples are consolidated into a
@@ -203,10 +203,18 @@ using GradientControllerConfigSharedPtr = std::shared_ptr<GradientControllerConf
  *
  * Locking:
  * ========
+ * Latency samples are recorded into one of several sample shards, each with its own histogram and
+ * mutex in its own cache line. Workers always record into the shard of their thread, so the shard
+ * mutexes are only contended when there are more workers than shards. The shards are merged into
+ * the controller's histogram when either calculation needs the samples.
+ *
  * There are 2 mutually exclusive calculation windows, so the sample mutation mutex is held to
  * prevent the overlap of these windows. It is necessary for a worker thread to know specifically if
  * the controller is inside of a minRTT recalculation window during the recording of a latency
  * sample, so this extra bit of information is stored in inMinRTTSamplingWindow().
+ *
+ * The forwarding decision takes no lock: the count of outstanding requests is only incremented by
+ * a compare-and-swap while it is below the concurrency limit.
  */
 class GradientController : public ConcurrencyController {
 public:
@@ -221,12 +229,25 @@ public:
   uint32_t concurrencyLimit() const override { return concurrency_limit_.load(); }
 
 private:
+  static constexpr uint32_t MaxSampleShards = 64;
+
+  // The latency samples recorded by the workers whose threads map to the shard since the shard was
+  // last merged into the controller's histogram.
+  struct alignas(64) SampleShard {
+    SampleShard() : hist_(hist_fast_alloc(), hist_free) {}
+
+    absl::Mutex mutex_;
+    std::unique_ptr<histogram_t, decltype(&hist_free)> hist_ ABSL_GUARDED_BY(mutex_);
+  };
+
   static GradientControllerStats generateStats(Stats::Scope& scope,
                                                const std::string& stats_prefix);
   void updateMinRTT();
   std::chrono::microseconds processLatencySamplesAndClear()
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(sample_mutation_mtx_);
   uint32_t calculateNewLimit() ABSL_EXCLUSIVE_LOCKS_REQUIRED(sample_mutation_mtx_);
+  void mergeSampleShards() ABSL_EXCLUSIVE_LOCKS_REQUIRED(sample_mutation_mtx_);
+  void clearSampleShards();
   void enterMinRTTSamplingWindow();
   bool inMinRTTSamplingWindow() const { return deferred_limit_value_.load() > 0; }
   void resetSampleWindow() ABSL_EXCLUSIVE_LOCKS_REQUIRED(sample_mutation_mtx_);
@@ -272,6 +293,14 @@ private:
   std::unique_ptr<histogram_t, decltype(&hist_free)>
       latency_sample_hist_ ABSL_GUARDED_BY(sample_mutation_mtx_);
 
+  // Buffers the latency samples recorded by the workers until they are merged into
+  // latency_sample_hist_.
+  std::vector<SampleShard> sample_shards_;
+
+  // Counts the latency samples recorded since the start of the minRTT sampling window. Samples are
+  // only counted while in the window.
+  std::atomic<uint32_t> min_rtt_sample_count_;
+
   // Tracks the number of consecutive times that the concurrency limit is set to the minimum. This
   // is used to determine whether the controller should trigger an additional minRTT measurement
   // after remaining at the minimum limit for too long.
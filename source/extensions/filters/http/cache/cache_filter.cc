@@ -34,7 +34,7 @@ CacheFilter::CacheFilter(
     const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config, const std::string&,
     Stats::Scope&, TimeSource& time_source, HttpCache& http_cache)
     : time_source_(time_source), cache_(http_cache),
-      vary_allow_list_(config.allowed_vary_headers()) {}
+      vary_allow_list_(config.allowed_vary_headers(), config.content_encodings()) {}
 
 void CacheFilter::onDestroy() {
   filter_state_ = FilterState::Destroyed;
@@ -1,18 +1,23 @@
 #include "extensions/filters/http/cache/cache_headers_utils.h"
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <string>
 
 #include "envoy/http/header_map.h"
 
+#include "common/common/utility.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/header_utility.h"
 
 #include "extensions/filters/http/cache/inline_headers_handles.h"
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
 
@@ -231,7 +236,9 @@ CacheHeadersUtils::parseCommaDelimitedList(const Http::HeaderEntry* entry) {
 }
 
 VaryHeader::VaryHeader(
-    const Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher>& allow_list) {
+    const Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher>& allow_list,
+    const Protobuf::RepeatedPtrField<std::string>& content_encodings)
+    : content_encodings_(content_encodings.begin(), content_encodings.end()) {
 
   for (const auto& rule : allow_list) {
     allow_list_.emplace_back(std::make_unique<Matchers::StringMatcherImpl>(rule));
@@ -324,6 +331,11 @@ VaryHeader::possibleVariedHeaders(const Http::RequestHeaderMap& request_headers)
   for (const absl::string_view& header : header_names) {
     std::vector<absl::string_view> values;
     Http::HeaderUtility::getAllOfHeader(request_headers, header, values);
+    if (!content_encodings_.empty() && header == Http::CustomHeaders::get().AcceptEncoding.get()) {
+      possible_headers->addCopy(Http::CustomHeaders::get().AcceptEncoding,
+                                normalizeAcceptEncoding(values));
+      continue;
+    }
     for (const absl::string_view& value : values) {
       possible_headers->addCopy(Http::LowerCaseString(std::string{header}), value);
     }
@@ -332,6 +344,71 @@ VaryHeader::possibleVariedHeaders(const Http::RequestHeaderMap& request_headers)
   return possible_headers;
 }
 
+std::string
+VaryHeader::normalizeAcceptEncoding(const std::vector<absl::string_view>& values) const {
+  // The highest q-value of each coding, and the position of its first occurrence with that value.
+  absl::flat_hash_map<absl::string_view, std::pair<float, uint32_t>> accepted;
+  // The codings refused with "q=0", which the compressor filter never uses.
+  absl::flat_hash_set<absl::string_view> refused;
+  uint32_t position = 0;
+  for (const absl::string_view value : values) {
+    for (const absl::string_view token : StringUtil::splitToken(value, ",", false)) {
+      const absl::string_view coding = StringUtil::trim(StringUtil::cropRight(token, ";"));
+      float q_value = 1;
+      const absl::string_view params = StringUtil::cropLeft(token, ";");
+      if (params != token) {
+        const absl::string_view q = StringUtil::cropLeft(params, "=");
+        if (q != params &&
+            absl::EqualsIgnoreCase("q", StringUtil::trim(StringUtil::cropRight(params, "="))) &&
+            !absl::SimpleAtof(StringUtil::trim(q), &q_value)) {
+          // Codings with an invalid q-value are ignored, as by the compressor filter.
+          continue;
+        }
+      }
+      if (q_value <= 0) {
+        refused.insert(coding);
+      }
+      const uint32_t token_position = position++;
+      auto result = accepted.emplace(coding, std::make_pair(q_value, token_position));
+      if (!result.second && q_value > result.first->second.first) {
+        result.first->second = {q_value, token_position};
+      }
+    }
+  }
+
+  // The accepted codings, with their q-value and their position, or the position of the wildcard
+  // they are accepted by. Codings accepted by the wildcard are ranked in the configured order.
+  struct Coding {
+    absl::string_view name_;
+    float q_value_;
+    uint32_t position_;
+  };
+  std::vector<Coding> codings;
+  const absl::string_view identity = Http::CustomHeaders::get().AcceptEncodingValues.Identity;
+  const auto wildcard = accepted.find(Http::CustomHeaders::get().AcceptEncodingValues.Wildcard);
+  for (size_t i = 0; i <= content_encodings_.size(); ++i) {
+    // "identity" is only used by the compressor filter if the request accepts it explicitly.
+    const absl::string_view name = i < content_encodings_.size() ? content_encodings_[i] : identity;
+    if (refused.contains(name)) {
+      continue;
+    }
+    auto it = accepted.find(name);
+    if (it == accepted.end() && name != identity) {
+      it = wildcard;
+    }
+    if (it != accepted.end() && it->second.first > 0) {
+      codings.push_back({name, it->second.first, it->second.second});
+    }
+  }
+  std::stable_sort(codings.begin(), codings.end(), [](const Coding& a, const Coding& b) {
+    return a.q_value_ != b.q_value_ ? a.q_value_ > b.q_value_ : a.position_ < b.position_;
+  });
+
+  return absl::StrJoin(codings, ",", [](std::string* out, const Coding& coding) {
+    absl::StrAppend(out, coding.name_);
+  });
+}
+
 } // namespace Cache
 } // namespace HttpFilters
 } // namespace Extensions
@@ -129,20 +129,30 @@ public:
   static std::string createVaryKey(const Http::HeaderEntry* vary_header,
                                    const Http::RequestHeaderMap& entry_headers);
 
-  // Parses the allow list from the Cache Config into the object's private allow_list_.
-  VaryHeader(const Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher>& allow_list);
+  // Parses the allow list from the Cache Config into the object's private allow_list_, and the
+  // content encodings used to normalize the accept-encoding header, if any.
+  VaryHeader(const Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher>& allow_list,
+             const Protobuf::RepeatedPtrField<std::string>& content_encodings = {});
 
   // Checks if the headers contain an allowed value in the Vary header.
   bool isAllowed(const Http::ResponseHeaderMap& headers) const;
 
   // Returns a header map containing the subset of the original headers that can be varied from the
-  // request.
+  // request. If content encodings are configured, the accept-encoding header is normalized.
   Http::RequestHeaderMapPtr
   possibleVariedHeaders(const Http::RequestHeaderMap& request_headers) const;
 
+  // Reduces the values of an accept-encoding header to the configured content encodings and
+  // "identity" that they accept, ordered by q-value and then by position, as the compressor filter
+  // ranks them. Requests that would be served the same encoding then have the same vary key.
+  std::string normalizeAcceptEncoding(const std::vector<absl::string_view>& values) const;
+
 private:
   // Stores the matching rules that define whether a header is allowed to be varied.
   std::vector<Matchers::StringMatcherPtr> allow_list_;
+  // The content encodings that responses may be compressed with, in order of preference between
+  // equally accepted encodings.
+  const std::vector<std::string> content_encodings_;
 };
 
 } // namespace Cache
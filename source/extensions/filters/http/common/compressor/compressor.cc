@@ -1,5 +1,7 @@
 #include "extensions/filters/http/common/compressor/compressor.h"
 
+#include <algorithm>
+
 #include "common/buffer/buffer_impl.h"
 #include "common/http/header_map_impl.h"
 
@@ -25,6 +27,15 @@ Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::Respons
 // Default minimum length of an upstream response that allows compression.
 const uint64_t DefaultMinimumContentLength = 30;
 
+// Default minimum length of an upstream response compressed in parallel.
+const uint64_t DefaultParallelMinimumContentLength = 1024 * 1024;
+
+// Default size of the blocks of a body compressed in parallel.
+const uint32_t DefaultParallelBlockSize = 128 * 1024;
+
+// Default maximum number of blocks of a response pending on the parallel compression pool.
+const uint32_t DefaultMaxPendingBlocks = 4;
+
 // Default content types will be used if any is provided by the user.
 const std::vector<std::string>& defaultContentEncoding() {
   CONSTRUCT_ON_FIRST_USE(
@@ -45,6 +56,28 @@ const std::string& compressorRegistryKey() { CONSTRUCT_ON_FIRST_USE(std::string,
 
 } // namespace
 
+ParallelCompressionConfig::ParallelCompressionConfig(
+    const envoy::extensions::filters::http::compressor::v3::Compressor::ParallelCompression&
+        config,
+    Thread::ThreadFactory& thread_factory, Event::Dispatcher& main_thread_dispatcher)
+    : min_content_length_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, min_content_length,
+                                                          DefaultParallelMinimumContentLength)),
+      block_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, block_size, DefaultParallelBlockSize)),
+      max_pending_blocks_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pending_blocks, DefaultMaxPendingBlocks)),
+      main_thread_dispatcher_(main_thread_dispatcher),
+      pool_(std::make_unique<Thread::ThreadPool>(thread_factory, config.threads(), "compressor")) {}
+
+ParallelCompressionConfig::~ParallelCompressionConfig() {
+  // The config is destroyed with the last filter using it, which may be on a worker when a listener
+  // is removed while its streams are active. Destroying the pool compresses its queued blocks and
+  // joins its threads, which is left to the main thread.
+  if (!main_thread_dispatcher_.isThreadSafe()) {
+    main_thread_dispatcher_.post(
+        [pool = std::shared_ptr<Thread::ThreadPool>(std::move(pool_))]() {});
+  }
+}
+
 CompressorFilterConfig::CompressorFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::Compressor& compressor,
     const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
@@ -119,12 +152,21 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
   if (!end_stream && isEnabledAndContentLengthBigEnough && isAcceptEncodingAllowed(headers) &&
       isCompressible && isTransferEncodingAllowed(headers)) {
     skip_compression_ = false;
+    const bool compress_in_parallel = isParallelCompressionAllowed(headers);
     sanitizeEtagHeader(headers);
     headers.removeContentLength();
     headers.setInline(content_encoding_handle.handle(), config_->contentEncoding());
     config_->stats().compressed_.inc();
     // Finally instantiate the compressor.
-    compressor_ = config_->makeCompressor();
+    if (compress_in_parallel) {
+      block_compressor_ = config_->makeBlockCompressor();
+    }
+    if (block_compressor_ != nullptr) {
+      config_->stats().compressed_in_parallel_.inc();
+      pending_blocks_ = std::make_shared<PendingBlocks>(PendingBlocks{this});
+    } else {
+      compressor_ = config_->makeCompressor();
+    }
   } else {
     config_->stats().not_compressed_.inc();
   }
@@ -142,6 +184,11 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
 Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
   if (!skip_compression_) {
     config_->stats().total_uncompressed_bytes_.add(data.length());
+    if (block_compressor_ != nullptr) {
+      pending_input_.move(data);
+      postBlocks(end_stream);
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
     compressor_->compress(data, end_stream ? Envoy::Compression::Compressor::State::Finish
                                            : Envoy::Compression::Compressor::State::Flush);
     config_->stats().total_compressed_bytes_.add(data.length());
@@ -151,6 +198,12 @@ Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool
 
 Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTrailerMap&) {
   if (!skip_compression_) {
+    if (block_compressor_ != nullptr) {
+      // The trailers are sent after the last block.
+      has_trailers_ = true;
+      postBlocks(true);
+      return Http::FilterTrailersStatus::StopIteration;
+    }
     Buffer::OwnedImpl empty_buffer;
     compressor_->compress(empty_buffer, Envoy::Compression::Compressor::State::Finish);
     config_->stats().total_compressed_bytes_.add(empty_buffer.length());
@@ -159,6 +212,78 @@ Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTraile
   return Http::FilterTrailersStatus::Continue;
 }
 
+void CompressorFilter::onDestroy() {
+  if (pending_blocks_ != nullptr) {
+    pending_blocks_->filter_ = nullptr;
+  }
+}
+
+void CompressorFilter::postBlocks(bool end_stream) {
+  ParallelCompressionConfig& parallel_compression = *config_->parallelCompression();
+  while (pending_input_.length() >= parallel_compression.blockSize() ||
+         (end_stream && !last_block_posted_)) {
+    const uint64_t length =
+        std::min<uint64_t>(pending_input_.length(), parallel_compression.blockSize());
+    auto input = std::make_shared<std::string>(length, '\0');
+    pending_input_.copyOut(0, length, &(*input)[0]);
+    pending_input_.drain(length);
+    last_block_posted_ = end_stream && pending_input_.length() == 0;
+
+    const Envoy::Compression::Compressor::State state =
+        last_block_posted_ ? Envoy::Compression::Compressor::State::Finish
+                           : Envoy::Compression::Compressor::State::Flush;
+    parallel_compression.pool().post([block_compressor = block_compressor_, input,
+                                      history = last_input_, state, index = posted_blocks_,
+                                      pending_blocks = pending_blocks_,
+                                      &dispatcher = encoder_callbacks_->dispatcher()]() {
+      BlockSharedPtr block = block_compressor->compressBlock(
+          *input, history != nullptr ? absl::string_view(*history) : absl::string_view(), state);
+      dispatcher.post([pending_blocks, index, block]() {
+        if (pending_blocks->filter_ != nullptr) {
+          pending_blocks->filter_->onBlockCompressed(index, block);
+        }
+      });
+    });
+    last_input_ = std::move(input);
+    ++posted_blocks_;
+  }
+
+  // Ask the upstream to pause until the pool catches up.
+  if (!above_high_watermark_ &&
+      posted_blocks_ - sent_blocks_ >= parallel_compression.maxPendingBlocks()) {
+    above_high_watermark_ = true;
+    encoder_callbacks_->onEncoderFilterAboveWriteBufferHighWatermark();
+  }
+}
+
+void CompressorFilter::onBlockCompressed(uint64_t index, BlockSharedPtr block) {
+  compressed_blocks_.emplace(index, std::move(block));
+  Buffer::OwnedImpl output;
+  const uint64_t sent_blocks = sent_blocks_;
+  for (auto it = compressed_blocks_.begin();
+       it != compressed_blocks_.end() && it->first == sent_blocks_;
+       it = compressed_blocks_.erase(it)) {
+    block_compressor_->addBlock(*it->second, output);
+    ++sent_blocks_;
+  }
+  if (sent_blocks_ == sent_blocks) {
+    return;
+  }
+
+  config_->stats().total_compressed_bytes_.add(output.length());
+  if (above_high_watermark_ &&
+      posted_blocks_ - sent_blocks_ <= config_->parallelCompression()->maxPendingBlocks() / 2) {
+    above_high_watermark_ = false;
+    encoder_callbacks_->onEncoderFilterBelowWriteBufferLowWatermark();
+  }
+
+  const bool end_stream = last_block_posted_ && sent_blocks_ == posted_blocks_;
+  encoder_callbacks_->injectEncodedDataToFilterChain(output, end_stream && !has_trailers_);
+  if (end_stream && has_trailers_) {
+    encoder_callbacks_->continueEncoding();
+  }
+}
+
 bool CompressorFilter::hasCacheControlNoTransform(Http::ResponseHeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.getInline(cache_control_handle.handle());
   if (cache_control) {
@@ -397,6 +522,15 @@ bool CompressorFilter::isMinimumContentLength(Http::ResponseHeaderMap& headers)
                                    Http::Headers::get().TransferEncodingValues.Chunked);
 }
 
+bool CompressorFilter::isParallelCompressionAllowed(Http::ResponseHeaderMap& headers) const {
+  const ParallelCompressionConfig* parallel_compression = config_->parallelCompression();
+  const Http::HeaderEntry* content_length = headers.ContentLength();
+  uint64_t length;
+  return parallel_compression != nullptr && content_length != nullptr &&
+         absl::SimpleAtoi(content_length->value().getStringView(), &length) &&
+         length >= parallel_compression->minContentLength();
+}
+
 bool CompressorFilter::isTransferEncodingAllowed(Http::ResponseHeaderMap& headers) const {
   const Http::HeaderEntry* transfer_encoding = headers.TransferEncoding();
   if (transfer_encoding != nullptr) {
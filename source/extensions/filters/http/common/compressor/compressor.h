@@ -1,11 +1,17 @@
 #pragma once
 
+#include <map>
+
 #include "envoy/compression/compressor/compressor.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stream_info/filter_state.h"
+#include "envoy/thread/thread.h"
 
+#include "common/buffer/buffer_impl.h"
+#include "common/common/thread_pool.h"
 #include "common/protobuf/protobuf.h"
 #include "common/runtime/runtime_protos.h"
 
@@ -32,9 +38,13 @@ namespace Compressors {
  *
  * "header_gzip" is specific to the gzip filter and is deprecated since it duplicates
  * "header_compressor_used".
+ *
+ * "compressed_in_parallel" is the number of the compressed responses whose body was compressed in
+ * blocks on the parallel compression pool.
  */
 #define ALL_COMPRESSOR_STATS(COUNTER)                                                              \
   COUNTER(compressed)                                                                              \
+  COUNTER(compressed_in_parallel)                                                                  \
   COUNTER(not_compressed)                                                                          \
   COUNTER(no_accept_header)                                                                        \
   COUNTER(header_identity)                                                                         \
@@ -55,6 +65,34 @@ struct CompressorStats {
   ALL_COMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * Settings to compress large response bodies in blocks on a pool of helper threads.
+ */
+class ParallelCompressionConfig {
+public:
+  /**
+   * @param main_thread_dispatcher supplies the dispatcher of the main thread, on which the pool is
+   *        destroyed.
+   */
+  ParallelCompressionConfig(
+      const envoy::extensions::filters::http::compressor::v3::Compressor::ParallelCompression&
+          config,
+      Thread::ThreadFactory& thread_factory, Event::Dispatcher& main_thread_dispatcher);
+  ~ParallelCompressionConfig();
+
+  Thread::ThreadPool& pool() { return *pool_; }
+  uint64_t minContentLength() const { return min_content_length_; }
+  uint32_t blockSize() const { return block_size_; }
+  uint32_t maxPendingBlocks() const { return max_pending_blocks_; }
+
+private:
+  const uint64_t min_content_length_;
+  const uint32_t block_size_;
+  const uint32_t max_pending_blocks_;
+  Event::Dispatcher& main_thread_dispatcher_;
+  std::unique_ptr<Thread::ThreadPool> pool_;
+};
+
 // TODO(rojkov): merge this class with Compressor::CompressorFilterConfig when the filter
 // `envoy.filters.http.gzip` is fully deprecated and dropped.
 class CompressorFilterConfig {
@@ -64,6 +102,12 @@ public:
 
   virtual Envoy::Compression::Compressor::CompressorPtr makeCompressor() PURE;
 
+  // Returns nullptr if bodies are never compressed in parallel.
+  virtual Envoy::Compression::Compressor::BlockCompressorSharedPtr makeBlockCompressor() {
+    return nullptr;
+  }
+  virtual ParallelCompressionConfig* parallelCompression() { return nullptr; }
+
   bool enabled() const { return enabled_.enabled(); }
   const CompressorStats& stats() { return stats_; }
   const StringUtil::CaseUnorderedSet& contentTypeValues() const { return content_type_values_; }
@@ -117,14 +161,33 @@ public:
   Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
   Http::FilterTrailersStatus encodeTrailers(Http::ResponseTrailerMap&) override;
 
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
 private:
+  using BlockSharedPtr =
+      std::shared_ptr<const Envoy::Compression::Compressor::BlockCompressor::Block>;
+
+  // The blocks of a response being compressed on the parallel compression pool. They are ignored
+  // once compressed if the filter was destroyed meanwhile.
+  struct PendingBlocks {
+    CompressorFilter* filter_;
+  };
+
   bool hasCacheControlNoTransform(Http::ResponseHeaderMap& headers) const;
   bool isAcceptEncodingAllowed(const Http::ResponseHeaderMap& headers) const;
   bool isContentTypeAllowed(Http::ResponseHeaderMap& headers) const;
   bool isEtagAllowed(Http::ResponseHeaderMap& headers) const;
   bool isMinimumContentLength(Http::ResponseHeaderMap& headers) const;
+  bool isParallelCompressionAllowed(Http::ResponseHeaderMap& headers) const;
   bool isTransferEncodingAllowed(Http::ResponseHeaderMap& headers) const;
 
+  // Hands the complete blocks of the pending body, or all of it at the end of the stream, to the
+  // parallel compression pool.
+  void postBlocks(bool end_stream);
+  // Sends the blocks compressed in order, once the blocks preceding them are compressed.
+  void onBlockCompressed(uint64_t index, BlockSharedPtr block);
+
   void sanitizeEtagHeader(Http::ResponseHeaderMap& headers);
   void insertVaryHeader(Http::ResponseHeaderMap& headers);
 
@@ -148,6 +211,21 @@ private:
   Envoy::Compression::Compressor::CompressorPtr compressor_;
   const CompressorFilterConfigSharedPtr config_;
   std::unique_ptr<std::string> accept_encoding_;
+
+  // Set instead of compressor_ when the body is compressed in parallel.
+  Envoy::Compression::Compressor::BlockCompressorSharedPtr block_compressor_;
+  std::shared_ptr<PendingBlocks> pending_blocks_;
+  // The body not handed to the pool yet, which is shorter than a block until the end of stream.
+  Buffer::OwnedImpl pending_input_;
+  // The data of the last block handed to the pool, which the next block may refer to.
+  std::shared_ptr<const std::string> last_input_;
+  // The blocks compressed before the blocks preceding them, by index.
+  std::map<uint64_t, BlockSharedPtr> compressed_blocks_;
+  uint64_t posted_blocks_{};
+  uint64_t sent_blocks_{};
+  bool last_block_posted_{};
+  bool has_trailers_{};
+  bool above_high_watermark_{};
 };
 
 } // namespace Compressors
@@ -1,5 +1,9 @@
 #include "extensions/filters/http/compressor/compressor_filter.h"
 
+#include "envoy/common/exception.h"
+
+#include "fmt/format.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -8,18 +12,34 @@ namespace Compressor {
 CompressorFilterConfig::CompressorFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::Compressor& generic_compressor,
     const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-    Compression::Compressor::CompressorFactoryPtr compressor_factory)
+    Compression::Compressor::CompressorFactoryPtr compressor_factory,
+    Thread::ThreadFactory& thread_factory, Event::Dispatcher& main_thread_dispatcher)
     : Common::Compressors::CompressorFilterConfig(
           generic_compressor,
           stats_prefix + "compressor." + generic_compressor.compressor_library().name() + "." +
               compressor_factory->statsPrefix(),
           scope, runtime, compressor_factory->contentEncoding()),
-      compressor_factory_(std::move(compressor_factory)) {}
+      compressor_factory_(std::move(compressor_factory)) {
+  if (generic_compressor.has_parallel_compression()) {
+    if (compressor_factory_->createBlockCompressor() == nullptr) {
+      throw EnvoyException(
+          fmt::format("Compressor library '{}' can't compress in parallel",
+                      generic_compressor.compressor_library().name()));
+    }
+    parallel_compression_ = std::make_unique<Common::Compressors::ParallelCompressionConfig>(
+        generic_compressor.parallel_compression(), thread_factory, main_thread_dispatcher);
+  }
+}
 
 Envoy::Compression::Compressor::CompressorPtr CompressorFilterConfig::makeCompressor() {
   return compressor_factory_->createCompressor();
 }
 
+Envoy::Compression::Compressor::BlockCompressorSharedPtr
+CompressorFilterConfig::makeBlockCompressor() {
+  return parallel_compression_ != nullptr ? compressor_factory_->createBlockCompressor() : nullptr;
+}
+
 } // namespace Compressor
 } // namespace HttpFilters
 } // namespace Extensions
@@ -2,6 +2,7 @@
 
 #include "envoy/compression/compressor/factory.h"
 #include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
+#include "envoy/thread/thread.h"
 
 #include "extensions/filters/http/common/compressor/compressor.h"
 
@@ -21,12 +22,18 @@ public:
   CompressorFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::Compressor& genereic_compressor,
       const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory);
+      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory,
+      Thread::ThreadFactory& thread_factory, Event::Dispatcher& main_thread_dispatcher);
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor() override;
+  Envoy::Compression::Compressor::BlockCompressorSharedPtr makeBlockCompressor() override;
+  Common::Compressors::ParallelCompressionConfig* parallelCompression() override {
+    return parallel_compression_.get();
+  }
 
 private:
   const Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+  std::unique_ptr<Common::Compressors::ParallelCompressionConfig> parallel_compression_;
 };
 
 } // namespace Compressor
@@ -0,0 +1,209 @@
+#include "extensions/filters/http/ext_authz/decision_cache.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/http/path_utility.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+namespace {
+
+// Enough shards for the workers of a large host to rarely contend for the same lock.
+constexpr uint32_t MaxShards = 16;
+constexpr uint32_t DefaultMaxEntries = 10000;
+
+std::vector<Http::LowerCaseString>
+headerNames(const Protobuf::RepeatedPtrField<std::string>& names) {
+  std::vector<Http::LowerCaseString> headers;
+  headers.reserve(names.size());
+  for (const auto& name : names) {
+    headers.emplace_back(name);
+  }
+  return headers;
+}
+
+// Appends a component of the key prefixed with its length, so that the components of different
+// keys can't be confused. A missing component is marked with a length of "!".
+void appendComponent(std::string& key, absl::optional<absl::string_view> component) {
+  if (!component.has_value()) {
+    key.append("!;");
+    return;
+  }
+  absl::StrAppend(&key, component->size(), ":", *component, ";");
+}
+
+uint32_t maxEntries(const envoy::extensions::filters::http::ext_authz::v3::DecisionCache& config) {
+  return PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DefaultMaxEntries);
+}
+
+} // namespace
+
+DecisionCache::DecisionCache(
+    const envoy::extensions::filters::http::ext_authz::v3::DecisionCache& config)
+    : headers_(headerNames(config.headers())), path_segments_(config.path_segments()),
+      ttl_(PROTOBUF_GET_MS_REQUIRED(config, ttl)), ttl_metadata_field_(config.ttl_metadata_field()),
+      max_entries_per_shard_(std::max<uint32_t>(maxEntries(config) / MaxShards, 1)),
+      shards_(std::min<uint32_t>(maxEntries(config), MaxShards)) {
+  for (const auto& metadata_key : config.metadata()) {
+    metadata_.emplace_back(metadata_key);
+  }
+}
+
+std::string DecisionCache::key(const Http::RequestHeaderMap& headers,
+                               const envoy::config::core::v3::Metadata& metadata) const {
+  std::string key;
+  for (const auto& name : headers_) {
+    // Every value of a repeated header is part of the key, as the authorization service sees them
+    // too. The values are prefixed with their count, marked with "*".
+    const auto values = headers.getAll(name);
+    if (values.empty()) {
+      appendComponent(key, absl::nullopt);
+      continue;
+    }
+    absl::StrAppend(&key, values.size(), "*");
+    for (size_t i = 0; i < values.size(); ++i) {
+      appendComponent(key, values[i]->value().getStringView());
+    }
+  }
+
+  if (path_segments_ > 0) {
+    absl::optional<absl::string_view> path;
+    if (headers.Path() != nullptr) {
+      path = Http::PathUtil::removeQueryAndFragment(headers.getPathValue());
+      // Keep the path up to the slash following the last segment of the key.
+      size_t end = 0;
+      for (uint32_t i = 0; i < path_segments_ && end != absl::string_view::npos; ++i) {
+        end = path->find('/', end + 1);
+      }
+      path = path->substr(0, end);
+    }
+    appendComponent(key, path);
+  }
+
+  for (const auto& metadata_key : metadata_) {
+    const ProtobufWkt::Value& value = Config::Metadata::metadataValue(&metadata, metadata_key);
+    if (value.kind_case() == ProtobufWkt::Value::KIND_NOT_SET) {
+      appendComponent(key, absl::nullopt);
+    } else {
+      appendComponent(key, value.SerializeAsString());
+    }
+  }
+  return key;
+}
+
+DecisionCache::Shard& DecisionCache::shard(absl::string_view key) {
+  return shards_[absl::Hash<absl::string_view>()(key) % shards_.size()];
+}
+
+std::chrono::milliseconds
+DecisionCache::ttl(const Filters::Common::ExtAuthz::Response& response) const {
+  if (!ttl_metadata_field_.empty()) {
+    const auto& fields = response.dynamic_metadata.fields();
+    const auto it = fields.find(ttl_metadata_field_);
+    if (it != fields.end() && it->second.kind_case() == ProtobufWkt::Value::kNumberValue) {
+      return std::chrono::milliseconds(
+          static_cast<int64_t>(std::max(it->second.number_value(), 0.0) * 1000));
+    }
+  }
+  return ttl_;
+}
+
+DecisionCache::LookupStatus DecisionCache::lookup(const std::string& key, MonotonicTime now,
+                                                  Decision& decision,
+                                                  const WaiterSharedPtr& waiter,
+                                                  Event::Dispatcher& dispatcher) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  const auto it = shard.index_.find(key);
+  if (it != shard.index_.end()) {
+    const auto entry = it->second;
+    if (entry->expiry_ > now) {
+      shard.entries_.splice(shard.entries_.begin(), shard.entries_, entry);
+      decision = entry->decision_;
+      return LookupStatus::Hit;
+    }
+    shard.index_.erase(it);
+    shard.entries_.erase(entry);
+  }
+
+  const auto pending = shard.pending_.find(key);
+  if (pending != shard.pending_.end()) {
+    pending->second.push_back({waiter, &dispatcher});
+    return LookupStatus::Pending;
+  }
+  shard.pending_.emplace(key, std::vector<PendingWaiter>());
+  return LookupStatus::Miss;
+}
+
+void DecisionCache::insert(const std::string& key, MonotonicTime now,
+                           const Filters::Common::ExtAuthz::Response& response) {
+  const std::chrono::milliseconds ttl = this->ttl(response);
+  if (response.status == Filters::Common::ExtAuthz::CheckStatus::Error || ttl.count() <= 0) {
+    complete(key, nullptr, now);
+    return;
+  }
+  complete(key, std::make_shared<const Filters::Common::ExtAuthz::Response>(response), now + ttl);
+}
+
+void DecisionCache::cancel(const std::string& key) { complete(key, nullptr, MonotonicTime()); }
+
+void DecisionCache::complete(const std::string& key, const Decision& decision,
+                             MonotonicTime expiry) {
+  Shard& shard = this->shard(key);
+  std::vector<PendingWaiter> waiters;
+  {
+    absl::MutexLock lock(&shard.mutex_);
+    const auto pending = shard.pending_.find(key);
+    if (pending != shard.pending_.end()) {
+      waiters = std::move(pending->second);
+      shard.pending_.erase(pending);
+    }
+
+    if (decision != nullptr) {
+      const auto it = shard.index_.find(key);
+      if (it != shard.index_.end()) {
+        const auto entry = it->second;
+        shard.index_.erase(it);
+        shard.entries_.erase(entry);
+      }
+      shard.entries_.push_front({key, decision, expiry});
+      shard.index_.emplace(shard.entries_.front().key_, shard.entries_.begin());
+      if (shard.entries_.size() > max_entries_per_shard_) {
+        shard.index_.erase(shard.entries_.back().key_);
+        shard.entries_.pop_back();
+      }
+    }
+  }
+
+  // The waiters are called on their own workers, outside of the lock.
+  for (auto& pending_waiter : waiters) {
+    pending_waiter.dispatcher_->post([weak_waiter = std::move(pending_waiter.waiter_), decision]() {
+      if (const WaiterSharedPtr waiter = weak_waiter.lock()) {
+        waiter->onDecision(decision);
+      }
+    });
+  }
+}
+
+size_t DecisionCache::size() {
+  size_t size = 0;
+  for (auto& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex_);
+    size += shard.entries_.size();
+  }
+  return size;
+}
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/config/core/v3/base.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/filters/http/ext_authz/v3/ext_authz.pb.h"
+#include "envoy/http/header_map.h"
+
+#include "common/config/metadata.h"
+
+#include "extensions/filters/common/ext_authz/ext_authz.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+/**
+ * A bounded cache of the decisions of the authorization service, shared by all the workers and
+ * indexed by a key built from the configured request attributes. The cache is split in shards,
+ * each with its own lock and least recently used list, so that workers looking up different keys
+ * rarely contend. Concurrent misses for the same key are coalesced: the first request calls the
+ * authorization service, and the following ones wait for its decision.
+ */
+class DecisionCache {
+public:
+  using Decision = std::shared_ptr<const Filters::Common::ExtAuthz::Response>;
+
+  /**
+   * Callbacks of a request waiting for the decision of another request with the same key.
+   */
+  class Waiter {
+  public:
+    virtual ~Waiter() = default;
+
+    /**
+     * Called on the dispatcher of the waiting request, unless the waiter was destroyed.
+     * @param decision supplies the decision, or nullptr if the other request didn't get a decision
+     *        that can be cached, in which case the waiting request must call the authorization
+     *        service itself.
+     */
+    virtual void onDecision(const Decision& decision) PURE;
+  };
+  using WaiterSharedPtr = std::shared_ptr<Waiter>;
+
+  enum class LookupStatus {
+    // The decision is cached.
+    Hit,
+    // The decision isn't cached, and the caller must call the authorization service and then
+    // complete the miss with insert() or cancel().
+    Miss,
+    // The authorization service is already being called for the key, and the waiter is called
+    // with the decision.
+    Pending
+  };
+
+  DecisionCache(const envoy::extensions::filters::http::ext_authz::v3::DecisionCache& config);
+
+  /**
+   * @return the cache key of a request.
+   */
+  std::string key(const Http::RequestHeaderMap& headers,
+                  const envoy::config::core::v3::Metadata& metadata) const;
+
+  /**
+   * @param key supplies the cache key of the request.
+   * @param now supplies the current time.
+   * @param decision receives the cached decision on a hit.
+   * @param waiter supplies the callbacks called with the decision if the status is Pending. Only
+   *        a weak reference is kept, so that destroying the waiter cancels the wait.
+   * @param dispatcher supplies the dispatcher of the request, on which the waiter is called.
+   * @return the status of the lookup.
+   */
+  LookupStatus lookup(const std::string& key, MonotonicTime now, Decision& decision,
+                      const WaiterSharedPtr& waiter, Event::Dispatcher& dispatcher);
+
+  /**
+   * Completes a miss with the response of the authorization service, caching it unless it is an
+   * error or its TTL is 0, and passes the cached decision to the requests waiting for it.
+   */
+  void insert(const std::string& key, MonotonicTime now,
+              const Filters::Common::ExtAuthz::Response& response);
+
+  /**
+   * Completes a miss without a response, e.g. because the request was reset. The requests waiting
+   * for it call the authorization service themselves.
+   */
+  void cancel(const std::string& key);
+
+  /**
+   * @return the number of cached decisions.
+   */
+  size_t size();
+
+private:
+  struct Entry {
+    std::string key_;
+    Decision decision_;
+    MonotonicTime expiry_;
+  };
+
+  struct PendingWaiter {
+    std::weak_ptr<Waiter> waiter_;
+    Event::Dispatcher* dispatcher_;
+  };
+
+  struct alignas(64) Shard {
+    absl::Mutex mutex_;
+    // In least recently used order, the most recently used entry first.
+    std::list<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator>
+        index_ ABSL_GUARDED_BY(mutex_);
+    // The keys for which the authorization service is being called, with the requests waiting
+    // for their decision.
+    absl::flat_hash_map<std::string, std::vector<PendingWaiter>> pending_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  Shard& shard(absl::string_view key);
+  std::chrono::milliseconds ttl(const Filters::Common::ExtAuthz::Response& response) const;
+  void complete(const std::string& key, const Decision& decision, MonotonicTime expiry);
+
+  const std::vector<Http::LowerCaseString> headers_;
+  const uint32_t path_segments_;
+  std::vector<Config::MetadataKey> metadata_;
+  const std::chrono::milliseconds ttl_;
+  const std::string ttl_metadata_field_;
+  const uint32_t max_entries_per_shard_;
+  std::vector<Shard> shards_;
+};
+
+using DecisionCachePtr = std::unique_ptr<DecisionCache>;
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
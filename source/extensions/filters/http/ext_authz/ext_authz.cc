@@ -39,6 +39,60 @@ void Filter::initiateCall(const Http::RequestHeaderMap& headers,
     return;
   }
 
+  DecisionCache* decision_cache = config_->decisionCache();
+  if (decision_cache == nullptr) {
+    check(headers, route);
+    return;
+  }
+
+  cache_key_ = decision_cache->key(headers, callbacks_->streamInfo().dynamicMetadata());
+  DecisionCache::Decision decision;
+  cache_waiter_ = std::make_shared<CacheWaiter>(*this);
+  switch (decision_cache->lookup(cache_key_, callbacks_->dispatcher().timeSource().monotonicTime(),
+                                 decision, cache_waiter_, callbacks_->dispatcher())) {
+  case DecisionCache::LookupStatus::Hit:
+    ENVOY_STREAM_LOG(trace, "ext_authz filter found a cached decision", *callbacks_);
+    stats_.decision_cache_hit_.inc();
+    cache_waiter_.reset();
+    state_ = State::Calling;
+    filter_return_ = FilterReturn::StopDecoding;
+    cluster_ = callbacks_->clusterInfo();
+    initiating_call_ = true;
+    onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(*decision));
+    initiating_call_ = false;
+    break;
+  case DecisionCache::LookupStatus::Pending:
+    ENVOY_STREAM_LOG(trace, "ext_authz filter waiting for the decision of another request",
+                     *callbacks_);
+    stats_.decision_cache_coalesced_.inc();
+    state_ = State::Calling;
+    filter_return_ = FilterReturn::StopDecoding;
+    cluster_ = callbacks_->clusterInfo();
+    break;
+  case DecisionCache::LookupStatus::Miss:
+    stats_.decision_cache_miss_.inc();
+    cache_waiter_.reset();
+    cache_miss_ = true;
+    check(headers, route);
+    break;
+  }
+}
+
+void Filter::onCachedDecision(const DecisionCache::Decision& decision) {
+  cache_waiter_.reset();
+  if (state_ != State::Calling) {
+    return;
+  }
+  if (decision == nullptr) {
+    // The other request didn't get a decision that can be cached.
+    check(*request_headers_, callbacks_->route());
+    return;
+  }
+  onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(*decision));
+}
+
+void Filter::check(const Http::RequestHeaderMap& headers,
+                   const Router::RouteConstSharedPtr& route) {
   auto&& maybe_merged_per_route_config =
       Http::Utility::getMergedPerFilterConfig<FilterConfigPerRoute>(
           HttpFilterNames::get().ExtAuthorization, route,
@@ -160,12 +214,25 @@ void Filter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callb
 void Filter::onDestroy() {
   if (state_ == State::Calling) {
     state_ = State::Complete;
+    if (cache_waiter_ != nullptr) {
+      // Waiting for the decision of another request rather than calling the service.
+      cache_waiter_.reset();
+      return;
+    }
     client_->cancel();
+    if (cache_miss_) {
+      config_->decisionCache()->cancel(cache_key_);
+    }
   }
 }
 
 void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
   state_ = State::Complete;
+  if (cache_miss_) {
+    cache_miss_ = false;
+    config_->decisionCache()->insert(
+        cache_key_, callbacks_->dispatcher().timeSource().monotonicTime(), *response);
+  }
   using Filters::Common::ExtAuthz::CheckStatus;
   Stats::StatName empty_stat_name;
 
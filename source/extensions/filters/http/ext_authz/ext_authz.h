@@ -23,6 +23,7 @@
 #include "extensions/filters/common/ext_authz/ext_authz.h"
 #include "extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "extensions/filters/common/ext_authz/ext_authz_http_impl.h"
+#include "extensions/filters/http/ext_authz/decision_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -39,7 +40,10 @@ namespace ExtAuthz {
   COUNTER(error)                                                                                   \
   COUNTER(timeout)                                                                                 \
   COUNTER(disabled)                                                                                \
-  COUNTER(failure_mode_allowed)
+  COUNTER(failure_mode_allowed)                                                                    \
+  COUNTER(decision_cache_hit)                                                                      \
+  COUNTER(decision_cache_miss)                                                                     \
+  COUNTER(decision_cache_coalesced)
 
 /**
  * Wrapper struct for ext_authz filter stats. @see stats_macros.h
@@ -79,6 +83,9 @@ public:
         metadata_context_namespaces_(config.metadata_context_namespaces().begin(),
                                      config.metadata_context_namespaces().end()),
         include_peer_certificate_(config.include_peer_certificate()),
+        decision_cache_(config.has_decision_cache()
+                            ? std::make_unique<DecisionCache>(config.decision_cache())
+                            : nullptr),
         stats_(generateStats(stats_prefix, config.stat_prefix(), scope)),
         ext_authz_ok_(pool_.add(createPoolStatName(config.stat_prefix(), "ok"))),
         ext_authz_denied_(pool_.add(createPoolStatName(config.stat_prefix(), "denied"))),
@@ -128,6 +135,9 @@ public:
 
   bool includePeerCertificate() const { return include_peer_certificate_; }
 
+  // Returns nullptr if the decisions aren't cached.
+  DecisionCache* decisionCache() { return decision_cache_.get(); }
+
 private:
   static Http::Code toErrorCode(uint64_t status) {
     const auto code = static_cast<Http::Code>(status);
@@ -174,6 +184,9 @@ private:
 
   const bool include_peer_certificate_;
 
+  // Shared by the filters of all the workers.
+  const DecisionCachePtr decision_cache_;
+
   // The stats for the filter.
   ExtAuthzFilterStats stats_;
 
@@ -255,6 +268,8 @@ private:
   void addResponseHeaders(Http::HeaderMap& header_map, const Http::HeaderVector& headers);
   void initiateCall(const Http::RequestHeaderMap& headers,
                     const Router::RouteConstSharedPtr& route);
+  void check(const Http::RequestHeaderMap& headers, const Router::RouteConstSharedPtr& route);
+  void onCachedDecision(const DecisionCache::Decision& decision);
   void continueDecoding();
   bool isBufferFull() const;
 
@@ -275,6 +290,21 @@ private:
   // the filter chain should stop. Otherwise the filter chain can continue to the next filter.
   enum class FilterReturn { ContinueDecoding, StopDecoding };
 
+  // Waits for the decision of another request with the same cache key. It is owned by the filter,
+  // so that the decision is dropped if the filter is destroyed first.
+  class CacheWaiter : public DecisionCache::Waiter {
+  public:
+    CacheWaiter(Filter& filter) : filter_(filter) {}
+
+    // DecisionCache::Waiter
+    void onDecision(const DecisionCache::Decision& decision) override {
+      filter_.onCachedDecision(decision);
+    }
+
+  private:
+    Filter& filter_;
+  };
+
   Http::HeaderMapPtr getHeaderMap(const Filters::Common::ExtAuthz::ResponsePtr& response);
   FilterConfigSharedPtr config_;
   Filters::Common::ExtAuthz::ClientPtr client_;
@@ -291,6 +321,12 @@ private:
   bool buffer_data_{};
   bool skip_check_{false};
   envoy::service::auth::v3::CheckRequest check_request_{};
+
+  // The cache key of the request, if the decisions are cached.
+  std::string cache_key_;
+  // Whether this request missed the cache, and must complete the miss once it gets its decision.
+  bool cache_miss_{};
+  std::shared_ptr<CacheWaiter> cache_waiter_;
 };
 
 } // namespace ExtAuthz
@@ -1,5 +1,7 @@
 #include "extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
 
+#include <array>
+#include <limits>
 #include <memory>
 #include <unordered_set>
 
@@ -11,6 +13,7 @@
 #include "common/common/enum_to_int.h"
 #include "common/common/utility.h"
 #include "common/grpc/common.h"
+#include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 #include "common/protobuf/protobuf.h"
@@ -18,6 +21,7 @@
 
 #include "extensions/filters/http/grpc_json_transcoder/http_body_utils.h"
 
+#include "absl/strings/numbers.h"
 #include "google/api/annotations.pb.h"
 #include "google/api/http.pb.h"
 #include "google/api/httpbody.pb.h"
@@ -57,6 +61,8 @@ struct RcDetailsValues {
   // The gRPC json transcoder filter failed to transcode when processing the request body.
   // This will generally be accompanied by details about the transcoder failure.
   const std::string GrpcTranscodeFailed = "grpc_json_transcode_failure";
+  // The request body held by the gRPC json transcoder filter exceeded its configured maximum size.
+  const std::string GrpcTranscodeBodyTooLarge = "grpc_json_transcode_request_body_too_large";
 };
 using RcDetails = ConstSingleton<RcDetailsValues>;
 
@@ -198,6 +204,9 @@ JsonTranscoderConfig::JsonTranscoderConfig(
 
   match_incoming_request_route_ = proto_config.match_incoming_request_route();
   ignore_unknown_query_parameters_ = proto_config.ignore_unknown_query_parameters();
+  if (proto_config.has_max_request_body_size()) {
+    max_request_body_size_ = proto_config.max_request_body_size().value();
+  }
 }
 
 void JsonTranscoderConfig::addFileDescriptor(const Protobuf::FileDescriptorProto& file) {
@@ -255,6 +264,9 @@ Status JsonTranscoderConfig::createMethodInfo(const Protobuf::MethodDescriptor*
                                               MethodInfoSharedPtr& method_info) {
   method_info = std::make_shared<MethodInfo>();
   method_info->descriptor_ = descriptor;
+  method_info->request_type_ = type_helper_->Info()->GetTypeByTypeUrl(
+      Grpc::Common::typeUrl(descriptor->input_type()->full_name()));
+  method_info->response_type_url_ = Grpc::Common::typeUrl(descriptor->output_type()->full_name());
 
   Status status =
       resolveField(descriptor->input_type(), http_rule.body(),
@@ -345,11 +357,9 @@ ProtobufUtil::Status JsonTranscoderConfig::createTranscoder(
         method_info->descriptor_->client_streaming(), true);
   }
 
-  const auto response_type_url =
-      Grpc::Common::typeUrl(method_info->descriptor_->output_type()->full_name());
   ResponseToJsonTranslatorPtr response_translator{new ResponseToJsonTranslator(
-      type_helper_->Resolver(), response_type_url, method_info->descriptor_->server_streaming(),
-      &response_input, print_options_)};
+      type_helper_->Resolver(), method_info->response_type_url_,
+      method_info->descriptor_->server_streaming(), &response_input, print_options_)};
 
   transcoder = std::make_unique<TranscoderImpl>(std::move(request_translator),
                                                 std::move(json_request_translator),
@@ -360,10 +370,9 @@ ProtobufUtil::Status JsonTranscoderConfig::createTranscoder(
 ProtobufUtil::Status
 JsonTranscoderConfig::methodToRequestInfo(const MethodInfoSharedPtr& method_info,
                                           google::grpc::transcoding::RequestInfo* info) {
-  const std::string& request_type_full_name = method_info->descriptor_->input_type()->full_name();
-  auto request_type_url = Grpc::Common::typeUrl(request_type_full_name);
-  info->message_type = type_helper_->Info()->GetTypeByTypeUrl(request_type_url);
+  info->message_type = method_info->request_type_;
   if (info->message_type == nullptr) {
+    const std::string& request_type_full_name = method_info->descriptor_->input_type()->full_name();
     ENVOY_LOG(debug, "Cannot resolve input-type: {}", request_type_full_name);
     return ProtobufUtil::Status(Code::NOT_FOUND,
                                 "Could not resolve type: " + request_type_full_name);
@@ -398,7 +407,6 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::RequestHeade
       absl::string_view content_type = headers.getContentTypeValue();
       content_type_.assign(content_type.begin(), content_type.end());
     }
-
     bool done = !readToBuffer(*transcoder_->RequestOutput(), initial_request_data_);
     if (!done) {
       ENVOY_LOG(
@@ -413,6 +421,17 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::RequestHeade
     if (checkIfTranscoderFailed(RcDetails::get().GrpcTranscodeFailed)) {
       return Http::FilterHeadersStatus::StopIteration;
     }
+
+    // The envelope of the message can be written before the body arrives if its length is known.
+    uint64_t content_length;
+    if (!end_stream && !method_->descriptor_->client_streaming() &&
+        headers.ContentLength() != nullptr &&
+        absl::SimpleAtoi(headers.getContentLengthValue(), &content_length)) {
+      if (checkRequestBodySize(content_length)) {
+        return Http::FilterHeadersStatus::StopIteration;
+      }
+      maybeStreamHttpBodyRequest(content_length);
+    }
   }
 
   headers.removeContentLength();
@@ -454,9 +473,16 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
     return Http::FilterDataStatus::Continue;
   }
 
-  if (method_->request_type_is_http_body_) {
+  if (stream_http_body_request_) {
+    if (!streamHttpBodyRequestData(data, end_stream)) {
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
+    return Http::FilterDataStatus::Continue;
+  } else if (method_->request_type_is_http_body_) {
     request_data_.move(data);
-    // TODO(euroelessar): Upper bound message size for streaming case.
+    if (checkRequestBodySize(request_data_.length())) {
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
     if (end_stream || method_->descriptor_->client_streaming()) {
       maybeSendHttpBodyRequestMessage();
     } else {
@@ -464,13 +490,21 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
       return Http::FilterDataStatus::StopIterationAndBuffer;
     }
   } else {
+    pending_request_bytes_ += data.length();
     request_in_.move(data);
 
     if (end_stream) {
       request_in_.finish();
     }
 
+    // The messages are output as soon as they are complete, and the part of the JSON request
+    // belonging to the message being transcoded is held until then.
     readToBuffer(*transcoder_->RequestOutput(), data);
+    if (data.length() > 0) {
+      pending_request_bytes_ = 0;
+    } else if (checkRequestBodySize(pending_request_bytes_)) {
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
   }
 
   if (checkIfTranscoderFailed(RcDetails::get().GrpcTranscodeFailed)) {
@@ -486,7 +520,13 @@ Http::FilterTrailersStatus JsonTranscoderFilter::decodeTrailers(Http::RequestTra
     return Http::FilterTrailersStatus::Continue;
   }
 
-  if (method_->request_type_is_http_body_) {
+  if (stream_http_body_request_) {
+    Buffer::OwnedImpl data;
+    // The body may have been empty, in which case the message is sent now.
+    if (streamHttpBodyRequestData(data, true) && data.length() > 0) {
+      decoder_callbacks_->addDecodedData(data, true);
+    }
+  } else if (method_->request_type_is_http_body_) {
     maybeSendHttpBodyRequestMessage();
   } else {
     request_in_.finish();
@@ -701,6 +741,70 @@ void JsonTranscoderFilter::maybeSendHttpBodyRequestMessage() {
   first_request_sent_ = true;
 }
 
+void JsonTranscoderFilter::maybeStreamHttpBodyRequest(uint64_t content_length) {
+  Buffer::OwnedImpl message_prefix;
+  message_prefix.add(initial_request_data_);
+  HttpBodyUtils::appendHttpBodyEnvelope(message_prefix, method_->request_body_field_path,
+                                        content_type_, content_length);
+  // The length of a gRPC message is 32 bits. Larger bodies are buffered, and rejected by the
+  // buffer limit.
+  if (message_prefix.length() + content_length > std::numeric_limits<uint32_t>::max()) {
+    ENVOY_LOG(debug, "HttpBody request of {} bytes is too large for a gRPC message",
+              content_length);
+    return;
+  }
+
+  initial_request_data_.drain(initial_request_data_.length());
+  initial_request_data_.move(message_prefix);
+  content_type_.clear();
+  http_body_request_bytes_left_ = content_length;
+  stream_http_body_request_ = true;
+}
+
+bool JsonTranscoderFilter::streamHttpBodyRequestData(Buffer::Instance& data, bool end_stream) {
+  if (data.length() > http_body_request_bytes_left_ ||
+      (end_stream && data.length() < http_body_request_bytes_left_)) {
+    // The length of the message was already sent upstream.
+    ENVOY_LOG(debug, "HttpBody request body doesn't match its content-length");
+    data.drain(data.length());
+    error_ = true;
+    decoder_callbacks_->resetStream();
+    return false;
+  }
+  http_body_request_bytes_left_ -= data.length();
+
+  if (!first_request_sent_) {
+    // The prefix of the message, up to its body, was written by maybeStreamHttpBodyRequest().
+    Buffer::OwnedImpl message_prefix;
+    message_prefix.move(initial_request_data_);
+    const uint64_t body_length = data.length() + http_body_request_bytes_left_;
+
+    std::array<uint8_t, Grpc::GRPC_FRAME_HEADER_SIZE> frame_header;
+    Grpc::Encoder().newFrame(Grpc::GRPC_FH_DEFAULT, message_prefix.length() + body_length,
+                             frame_header);
+    message_prefix.prepend(absl::string_view(reinterpret_cast<const char*>(frame_header.data()),
+                                             frame_header.size()));
+    data.prepend(message_prefix);
+    first_request_sent_ = true;
+  }
+  return true;
+}
+
+bool JsonTranscoderFilter::checkRequestBodySize(uint64_t size) {
+  const auto& max_request_body_size = config_.maxRequestBodySize();
+  if (!max_request_body_size.has_value() || size <= max_request_body_size.value()) {
+    return false;
+  }
+  ENVOY_LOG(debug, "Request body of {} bytes is larger than the maximum of {} bytes", size,
+            max_request_body_size.value());
+  error_ = true;
+  decoder_callbacks_->sendLocalReply(Http::Code::PayloadTooLarge,
+                                     Http::CodeUtility::toString(Http::Code::PayloadTooLarge),
+                                     nullptr, absl::nullopt,
+                                     RcDetails::get().GrpcTranscodeBodyTooLarge);
+  return true;
+}
+
 bool JsonTranscoderFilter::buildResponseFromHttpBodyOutput(
     Http::ResponseHeaderMap& response_headers, Buffer::Instance& data) {
   std::vector<Grpc::Frame> frames;
@@ -42,6 +42,9 @@ struct VariableBinding {
 
 struct MethodInfo {
   const Protobuf::MethodDescriptor* descriptor_ = nullptr;
+  // Resolved once when the method is registered, rather than for each request.
+  const Protobuf::Type* request_type_ = nullptr;
+  std::string response_type_url_;
   std::vector<const Protobuf::Field*> request_body_field_path;
   std::vector<const Protobuf::Field*> response_body_field_path;
   bool request_type_is_http_body_ = false;
@@ -102,6 +105,11 @@ public:
    */
   bool convertGrpcStatus() const;
 
+  /**
+   * Maximum size of the request body held by the filter while transcoding it, if limited.
+   */
+  const absl::optional<uint32_t>& maxRequestBodySize() const { return max_request_body_size_; }
+
 private:
   /**
    * Convert method descriptor to RequestInfo that needed for transcoding library
@@ -128,6 +136,7 @@ private:
   bool match_incoming_request_route_{false};
   bool ignore_unknown_query_parameters_{false};
   bool convert_grpc_status_{false};
+  absl::optional<uint32_t> max_request_body_size_;
 };
 
 using JsonTranscoderConfigSharedPtr = std::shared_ptr<JsonTranscoderConfig>;
@@ -166,6 +175,9 @@ private:
   bool checkIfTranscoderFailed(const std::string& details);
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
   void maybeSendHttpBodyRequestMessage();
+  void maybeStreamHttpBodyRequest(uint64_t content_length);
+  bool streamHttpBodyRequestData(Buffer::Instance& data, bool end_stream);
+  bool checkRequestBodySize(uint64_t size);
   /**
    * Builds response from HttpBody protobuf.
    * Returns true if at least one gRPC frame has processed.
@@ -187,10 +199,17 @@ private:
   Http::ResponseHeaderMap* response_headers_{nullptr};
   Grpc::Decoder decoder_;
 
-  // Data of the initial request message, initialized from query arguments, path, etc.
+  // Data of the initial request message, initialized from query arguments, path, etc. When the
+  // HttpBody request message is streamed, the message up to its body.
   Buffer::OwnedImpl initial_request_data_;
   Buffer::OwnedImpl request_data_;
   bool first_request_sent_{false};
+  // Whether the HttpBody request message is forwarded as the body arrives, which is possible when
+  // its length is known from the content-length header.
+  bool stream_http_body_request_{false};
+  uint64_t http_body_request_bytes_left_{0};
+  // Size of the JSON request data read by the transcoder since it last output a message.
+  uint64_t pending_request_bytes_{0};
   std::string content_type_;
 
   bool error_{false};
@@ -10,6 +10,7 @@
 #include "common/protobuf/protobuf.h"
 #include "common/tracing/http_tracer_impl.h"
 
+#include "absl/strings/match.h"
 #include "jwt_verify_lib/jwt.h"
 #include "jwt_verify_lib/verify.h"
 
@@ -22,6 +23,21 @@ namespace HttpFilters {
 namespace JwtAuthn {
 namespace {
 
+// Whether a JWT is signed with an asymmetric algorithm, whose verification is expensive enough to
+// be moved off the worker.
+bool isAsymmetric(const std::string& alg) {
+  return absl::StartsWith(alg, "RS") || absl::StartsWith(alg, "PS") ||
+         absl::StartsWith(alg, "ES");
+}
+
+class AuthenticatorImpl;
+
+// A verification running on the verify pool. The authenticator is reset when it is destroyed, in
+// which case the verification is ignored once complete.
+struct PendingVerification {
+  AuthenticatorImpl* authenticator_;
+};
+
 /**
  * Object to implement Authenticator interface.
  */
@@ -33,11 +49,16 @@ public:
                     const absl::optional<std::string>& provider, bool allow_failed,
                     bool allow_missing, JwksCache& jwks_cache,
                     Upstream::ClusterManager& cluster_manager,
-                    CreateJwksFetcherCb create_jwks_fetcher_cb, TimeSource& time_source)
+                    CreateJwksFetcherCb create_jwks_fetcher_cb, TimeSource& time_source,
+                    const JwtAuthnFilterStats& stats, Event::Dispatcher& dispatcher,
+                    Thread::ThreadPool* verify_pool)
       : jwks_cache_(jwks_cache), cm_(cluster_manager),
         create_jwks_fetcher_cb_(create_jwks_fetcher_cb), check_audience_(check_audience),
         provider_(provider), is_allow_failed_(allow_failed), is_allow_missing_(allow_missing),
-        time_source_(time_source) {}
+        time_source_(time_source), stats_(stats), dispatcher_(dispatcher),
+        verify_pool_(verify_pool) {}
+
+  ~AuthenticatorImpl() override { cancelVerification(); }
 
   // Following functions are for JwksFetcher::JwksReceiver interface
   void onJwksSuccess(google::jwt_verify::JwksPtr&& jwks) override;
@@ -57,6 +78,20 @@ private:
   // Verify with a specific public key.
   void verifyKey();
 
+  // Called once the signature of the JWT was verified with jwks.
+  void onVerifyComplete(const Status& status,
+                        const std::shared_ptr<const ::google::jwt_verify::Jwks>& jwks,
+                        std::chrono::microseconds latency);
+
+  // Handles a JWT whose signature is valid.
+  void onJwtVerified();
+
+  // Looks up the current token in the cache of verified tokens of jwks_data_.
+  void lookupJwtCache(uint64_t unix_timestamp);
+
+  // Ignores the outcome of a verification running on the verify pool.
+  void cancelVerification();
+
   // Calls the callback with status.
   void doneWithStatus(const Status& status);
 
@@ -79,7 +114,11 @@ private:
   std::vector<JwtLocationConstPtr> tokens_;
   JwtLocationConstPtr curr_token_;
   // The JWT object.
-  std::unique_ptr<::google::jwt_verify::Jwt> jwt_;
+  std::shared_ptr<const ::google::jwt_verify::Jwt> jwt_;
+  // Whether the JWT was found in the cache of verified tokens.
+  bool jwt_verified_{};
+  // The verification running on the verify pool, if any.
+  std::shared_ptr<PendingVerification> pending_verification_;
   // The JWKS data object
   JwksCache::JwksData* jwks_data_{};
 
@@ -98,6 +137,9 @@ private:
   const bool is_allow_failed_;
   const bool is_allow_missing_;
   TimeSource& time_source_;
+  const JwtAuthnFilterStats& stats_;
+  Event::Dispatcher& dispatcher_;
+  Thread::ThreadPool* const verify_pool_;
 };
 
 std::string AuthenticatorImpl::name() const {
@@ -139,12 +181,32 @@ void AuthenticatorImpl::startVerify() {
   curr_token_ = std::move(tokens_.back());
   tokens_.pop_back();
 
-  jwt_ = std::make_unique<::google::jwt_verify::Jwt>();
-  ENVOY_LOG(debug, "{}: Parse Jwt {}", name(), curr_token_->token());
-  const Status status = jwt_->parseFromString(curr_token_->token());
-  if (status != Status::Ok) {
-    doneWithStatus(status);
-    return;
+  // TODO(qiwzhang): Cross-platform-wise the below unix_timestamp code is wrong as the
+  // epoch is not guaranteed to be defined as the unix epoch. We should use
+  // the abseil time functionality instead or use the jwt_verify_lib to check
+  // the validity of a JWT.
+  const uint64_t unix_timestamp =
+      std::chrono::duration_cast<std::chrono::seconds>(timeSource().systemTime().time_since_epoch())
+          .count();
+
+  jwt_ = nullptr;
+  jwt_verified_ = false;
+  // When the provider is known, a cached token doesn't even need to be parsed again.
+  if (provider_) {
+    jwks_data_ = jwks_cache_.findByProvider(provider_.value());
+    ASSERT(jwks_data_ != nullptr);
+    lookupJwtCache(unix_timestamp);
+  }
+
+  if (jwt_ == nullptr) {
+    auto jwt = std::make_shared<::google::jwt_verify::Jwt>();
+    ENVOY_LOG(debug, "{}: Parse Jwt {}", name(), curr_token_->token());
+    const Status status = jwt->parseFromString(curr_token_->token());
+    if (status != Status::Ok) {
+      doneWithStatus(status);
+      return;
+    }
+    jwt_ = std::move(jwt);
   }
 
   ENVOY_LOG(debug, "{}: Verifying JWT token of issuer {}", name(), jwt_->iss_);
@@ -163,14 +225,7 @@ void AuthenticatorImpl::startVerify() {
     }
   }
 
-  // TODO(qiwzhang): Cross-platform-wise the below unix_timestamp code is wrong as the
-  // epoch is not guaranteed to be defined as the unix epoch. We should use
-  // the abseil time functionality instead or use the jwt_verify_lib to check
-  // the validity of a JWT.
   // Check "exp" claim.
-  const uint64_t unix_timestamp =
-      std::chrono::duration_cast<std::chrono::seconds>(timeSource().systemTime().time_since_epoch())
-          .count();
   // If the nbf claim does *not* appear in the JWT, then the nbf field is defaulted
   // to 0.
   if (jwt_->nbf_ > unix_timestamp) {
@@ -189,6 +244,9 @@ void AuthenticatorImpl::startVerify() {
                          : jwks_cache_.findByIssuer(jwt_->iss_);
   // isIssuerSpecified() check already make sure the issuer is in the cache.
   ASSERT(jwks_data_ != nullptr);
+  if (!provider_) {
+    lookupJwtCache(unix_timestamp);
+  }
 
   // Check if audience is allowed
   bool is_allowed = check_audience_ ? check_audience_->areAudiencesAllowed(jwt_->audiences_)
@@ -229,6 +287,8 @@ void AuthenticatorImpl::startVerify() {
 }
 
 void AuthenticatorImpl::onJwksSuccess(google::jwt_verify::JwksPtr&& jwks) {
+  // Tokens cached with the previous keys are no longer verified.
+  jwt_verified_ = false;
   const Status status = jwks_data_->setRemoteJwks(std::move(jwks))->getStatus();
   if (status != Status::Ok) {
     doneWithStatus(status);
@@ -243,16 +303,83 @@ void AuthenticatorImpl::onDestroy() {
   if (fetcher_) {
     fetcher_->cancel();
   }
+  cancelVerification();
+}
+
+void AuthenticatorImpl::lookupJwtCache(uint64_t unix_timestamp) {
+  JwtCache& jwt_cache = jwks_data_->getJwtCache();
+  if (!jwt_cache.enabled()) {
+    return;
+  }
+  auto jwt = jwt_cache.lookup(curr_token_->token(), unix_timestamp);
+  if (jwt == nullptr) {
+    stats_.jwt_cache_miss_.inc();
+    return;
+  }
+  stats_.jwt_cache_hit_.inc();
+  jwt_ = std::move(jwt);
+  jwt_verified_ = true;
+}
+
+void AuthenticatorImpl::cancelVerification() {
+  if (pending_verification_ != nullptr) {
+    pending_verification_->authenticator_ = nullptr;
+    pending_verification_ = nullptr;
+  }
 }
 
 // Verify with a specific public key.
 void AuthenticatorImpl::verifyKey() {
-  const Status status = ::google::jwt_verify::verifyJwt(*jwt_, *jwks_data_->getJwksObj());
+  if (jwt_verified_) {
+    onJwtVerified();
+    return;
+  }
+
+  const std::shared_ptr<const ::google::jwt_verify::Jwks> jwks = jwks_data_->getJwksObj();
+  if (verify_pool_ == nullptr || !isAsymmetric(jwt_->alg_)) {
+    const MonotonicTime start = time_source_.monotonicTime();
+    const Status status = ::google::jwt_verify::verifyJwt(*jwt_, *jwks);
+    onVerifyComplete(status, jwks,
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                         time_source_.monotonicTime() - start));
+    return;
+  }
+
+  ENVOY_LOG(debug, "{}: Verifying JWT signature on the verify pool", name());
+  pending_verification_ = std::make_shared<PendingVerification>(PendingVerification{this});
+  verify_pool_->post([pending_verification = pending_verification_, jwt = jwt_, jwks,
+                      &dispatcher = dispatcher_, &time_source = time_source_]() {
+    const MonotonicTime start = time_source.monotonicTime();
+    const Status status = ::google::jwt_verify::verifyJwt(*jwt, *jwks);
+    const auto latency =
+        std::chrono::duration_cast<std::chrono::microseconds>(time_source.monotonicTime() - start);
+    dispatcher.post([pending_verification, status, jwks, latency]() {
+      if (pending_verification->authenticator_ != nullptr) {
+        pending_verification->authenticator_->onVerifyComplete(status, jwks, latency);
+      }
+    });
+  });
+}
+
+void AuthenticatorImpl::onVerifyComplete(
+    const Status& status, const std::shared_ptr<const ::google::jwt_verify::Jwks>& jwks,
+    std::chrono::microseconds latency) {
+  pending_verification_ = nullptr;
+  stats_.jwt_verify_latency_.recordValue(latency.count());
   if (status != Status::Ok) {
     doneWithStatus(status);
     return;
   }
 
+  // The keys may have been refreshed while the signature was verified off the worker, in which
+  // case the token is not cached with the new ones.
+  if (jwks == jwks_data_->getJwksObj()) {
+    jwks_data_->getJwtCache().insert(curr_token_->token(), jwt_);
+  }
+  onJwtVerified();
+}
+
+void AuthenticatorImpl::onJwtVerified() {
   // Forward the payload
   const auto& provider = jwks_data_->getJwtProvider();
   if (!provider.forward_payload_header().empty()) {
@@ -305,10 +432,12 @@ AuthenticatorPtr Authenticator::create(const CheckAudience* check_audience,
                                        bool allow_failed, bool allow_missing, JwksCache& jwks_cache,
                                        Upstream::ClusterManager& cluster_manager,
                                        CreateJwksFetcherCb create_jwks_fetcher_cb,
-                                       TimeSource& time_source) {
+                                       TimeSource& time_source, const JwtAuthnFilterStats& stats,
+                                       Event::Dispatcher& dispatcher,
+                                       Thread::ThreadPool* verify_pool) {
   return std::make_unique<AuthenticatorImpl>(check_audience, provider, allow_failed, allow_missing,
                                              jwks_cache, cluster_manager, create_jwks_fetcher_cb,
-                                             time_source);
+                                             time_source, stats, dispatcher, verify_pool);
 }
 
 } // namespace JwtAuthn
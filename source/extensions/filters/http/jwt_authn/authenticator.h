@@ -1,10 +1,14 @@
 #pragma once
 
+#include "envoy/event/dispatcher.h"
 #include "envoy/server/filter_config.h"
 
+#include "common/common/thread_pool.h"
+
 #include "extensions/filters/http/common/jwks_fetcher.h"
 #include "extensions/filters/http/jwt_authn/extractor.h"
 #include "extensions/filters/http/jwt_authn/jwks_cache.h"
+#include "extensions/filters/http/jwt_authn/stats.h"
 
 #include "jwt_verify_lib/check_audience.h"
 #include "jwt_verify_lib/status.h"
@@ -42,13 +46,15 @@ public:
   // Called when the object is about to be destroyed.
   virtual void onDestroy() PURE;
 
-  // Authenticator factory function.
+  // Authenticator factory function. If verify_pool is not null, asymmetric signatures are verified
+  // on it, and verification completes on dispatcher.
   static AuthenticatorPtr create(const ::google::jwt_verify::CheckAudience* check_audience,
                                  const absl::optional<std::string>& provider, bool allow_failed,
                                  bool allow_missing, JwksCache& jwks_cache,
                                  Upstream::ClusterManager& cluster_manager,
                                  CreateJwksFetcherCb create_jwks_fetcher_cb,
-                                 TimeSource& time_source);
+                                 TimeSource& time_source, const JwtAuthnFilterStats& stats,
+                                 Event::Dispatcher& dispatcher, Thread::ThreadPool* verify_pool);
 };
 
 /**
@@ -12,10 +12,12 @@ void FilterConfigImpl::init() {
   // That may be shorter of the tls callback if the listener is torn shortly after it is created.
   // We use a shared pointer to make sure this object outlives the tls callbacks.
   auto shared_this = shared_from_this();
-  tls_->set([shared_this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<ThreadLocalCache>(shared_this->proto_config_, shared_this->time_source_,
-                                              shared_this->api_);
-  });
+  tls_->set(
+      [shared_this](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+        return std::make_shared<ThreadLocalCache>(shared_this->proto_config_,
+                                                  shared_this->time_source_, shared_this->api_,
+                                                  dispatcher);
+      });
 
   for (const auto& rule : proto_config_.rules()) {
     rule_pairs_.emplace_back(Matcher::create(rule),
@@ -1,14 +1,17 @@
 #pragma once
 
 #include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/extensions/filters/http/jwt_authn/v3/config.pb.h"
 #include "envoy/router/string_accessor.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/stats/scope.h"
-#include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/common/thread_pool.h"
+
 #include "extensions/filters/http/jwt_authn/matcher.h"
+#include "extensions/filters/http/jwt_authn/stats.h"
 #include "extensions/filters/http/jwt_authn/verifier.h"
 
 #include "absl/container/flat_hash_map.h"
@@ -27,31 +30,21 @@ class ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
 public:
   // Load the config from envoy config.
   ThreadLocalCache(const envoy::extensions::filters::http::jwt_authn::v3::JwtAuthentication& config,
-                   TimeSource& time_source, Api::Api& api) {
+                   TimeSource& time_source, Api::Api& api, Event::Dispatcher& dispatcher)
+      : dispatcher_(dispatcher) {
     jwks_cache_ = JwksCache::create(config, time_source, api);
   }
 
   // Get the JwksCache object.
   JwksCache& getJwksCache() { return *jwks_cache_; }
 
+  // Get the dispatcher of the thread.
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+
 private:
   // The JwksCache object.
   JwksCachePtr jwks_cache_;
-};
-
-/**
- * All stats for the Jwt Authn filter. @see stats_macros.h
- */
-#define ALL_JWT_AUTHN_FILTER_STATS(COUNTER)                                                        \
-  COUNTER(allowed)                                                                                 \
-  COUNTER(cors_preflight_bypassed)                                                                 \
-  COUNTER(denied)
-
-/**
- * Wrapper struct for jwt_authn filter stats. @see stats_macros.h
- */
-struct JwtAuthnFilterStats {
-  ALL_JWT_AUTHN_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+  Event::Dispatcher& dispatcher_;
 };
 
 /**
@@ -129,7 +122,8 @@ public:
                           bool allow_missing) const override {
     return Authenticator::create(check_audience, provider, allow_failed, allow_missing,
                                  getCache().getJwksCache(), cm(), Common::JwksFetcher::create,
-                                 timeSource());
+                                 timeSource(), stats_, getCache().dispatcher(),
+                                 verify_pool_.get());
   }
 
 private:
@@ -138,13 +132,19 @@ private:
       : proto_config_(std::move(proto_config)),
         stats_(generateStats(stats_prefix, context.scope())),
         tls_(context.threadLocal().allocateSlot()), cm_(context.clusterManager()),
-        time_source_(context.dispatcher().timeSource()), api_(context.api()) {}
+        time_source_(context.dispatcher().timeSource()), api_(context.api()) {
+    if (proto_config_.verification_threads() > 0) {
+      verify_pool_ = std::make_unique<Thread::ThreadPool>(
+          api_.threadFactory(), proto_config_.verification_threads(), "jwt_verify");
+    }
+  }
 
   void init();
 
   JwtAuthnFilterStats generateStats(const std::string& prefix, Stats::Scope& scope) {
     const std::string final_prefix = prefix + "jwt_authn.";
-    return {ALL_JWT_AUTHN_FILTER_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
+    return {ALL_JWT_AUTHN_FILTER_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                       POOL_HISTOGRAM_PREFIX(scope, final_prefix))};
   }
 
   struct MatcherVerifierPair {
@@ -170,6 +170,8 @@ private:
   absl::flat_hash_map<std::string, VerifierConstPtr> filter_state_verifiers_;
   TimeSource& time_source_;
   Api::Api& api_;
+  // The pool verifying asymmetric signatures, if verification_threads is set.
+  Thread::ThreadPoolPtr verify_pool_;
 };
 
 } // namespace JwtAuthn
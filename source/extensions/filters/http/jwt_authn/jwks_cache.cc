@@ -26,10 +26,22 @@ namespace {
 // Default cache expiration time in 5 minutes.
 constexpr int PubkeyCacheExpirationSec = 600;
 
+// Default number of verified tokens cached by each worker for a provider.
+constexpr uint32_t DefaultJwtCacheSize = 100;
+
+uint32_t jwtCacheSize(const JwtProvider& jwt_provider) {
+  if (!jwt_provider.has_jwt_cache_config()) {
+    return 0;
+  }
+  const uint32_t size = jwt_provider.jwt_cache_config().jwt_cache_size();
+  return size > 0 ? size : DefaultJwtCacheSize;
+}
+
 class JwksDataImpl : public JwksCache::JwksData, public Logger::Loggable<Logger::Id::jwt> {
 public:
   JwksDataImpl(const JwtProvider& jwt_provider, TimeSource& time_source, Api::Api& api)
-      : jwt_provider_(jwt_provider), time_source_(time_source) {
+      : jwt_provider_(jwt_provider), time_source_(time_source),
+        jwt_cache_(std::make_unique<JwtCache>(jwtCacheSize(jwt_provider))) {
     std::vector<std::string> audiences;
     for (const auto& aud : jwt_provider_.audiences()) {
       audiences.push_back(aud);
@@ -44,7 +56,7 @@ public:
       if (ptr->getStatus() != Status::Ok) {
         ENVOY_LOG(warn, "Invalid inline jwks for issuer: {}, jwks: {}", jwt_provider_.issuer(),
                   inline_jwks);
-        jwks_obj_.reset(nullptr);
+        jwks_obj_.reset();
       }
     }
   }
@@ -55,14 +67,17 @@ public:
     return audiences_->areAudiencesAllowed(jwt_audiences);
   }
 
-  const Jwks* getJwksObj() const override { return jwks_obj_.get(); }
+  const std::shared_ptr<const Jwks>& getJwksObj() const override { return jwks_obj_; }
 
   bool isExpired() const override { return time_source_.monotonicTime() >= expiration_time_; }
 
   const ::google::jwt_verify::Jwks* setRemoteJwks(::google::jwt_verify::JwksPtr&& jwks) override {
+    jwt_cache_->clear();
     return setKey(std::move(jwks), getRemoteJwksExpirationTime());
   }
 
+  JwtCache& getJwtCache() override { return *jwt_cache_; }
+
 private:
   // Get the expiration time for a remote Jwks
   std::chrono::steady_clock::time_point getRemoteJwksExpirationTime() const {
@@ -88,10 +103,13 @@ private:
   // Check audience object
   ::google::jwt_verify::CheckAudiencePtr audiences_;
   // The generated jwks object.
-  ::google::jwt_verify::JwksPtr jwks_obj_;
+  std::shared_ptr<const Jwks> jwks_obj_;
   TimeSource& time_source_;
   // The pubkey expiration time.
   MonotonicTime expiration_time_;
+  // The tokens verified with jwks_obj_. Owned by pointer, as JwksDataImpl is moved into the map
+  // of its JwksCacheImpl.
+  JwtCachePtr jwt_cache_;
 };
 
 class JwksCacheImpl : public JwksCache {
@@ -5,6 +5,8 @@
 #include "envoy/common/time.h"
 #include "envoy/extensions/filters/http/jwt_authn/v3/config.pb.h"
 
+#include "extensions/filters/http/jwt_authn/jwt_cache.h"
+
 #include "jwt_verify_lib/jwks.h"
 
 namespace Envoy {
@@ -49,15 +51,19 @@ public:
     virtual const envoy::extensions::filters::http::jwt_authn::v3::JwtProvider&
     getJwtProvider() const PURE;
 
-    // Get the Jwks object.
-    virtual const ::google::jwt_verify::Jwks* getJwksObj() const PURE;
+    // Get the Jwks object. It is shared so that it can outlive a JWKS refresh while a token is
+    // being verified with it off the worker thread.
+    virtual const std::shared_ptr<const ::google::jwt_verify::Jwks>& getJwksObj() const PURE;
 
     // Return true if jwks object is expired.
     virtual bool isExpired() const PURE;
 
-    // Set a remote Jwks.
+    // Set a remote Jwks. The tokens verified with the previous one are removed from the cache.
     virtual const ::google::jwt_verify::Jwks*
     setRemoteJwks(::google::jwt_verify::JwksPtr&& jwks) PURE;
+
+    // Get the cache of the tokens verified with the Jwks.
+    virtual JwtCache& getJwtCache() PURE;
   };
 
   // Lookup issuer cache map. The cache only stores Jwks specified in the config.
@@ -0,0 +1,46 @@
+#include "extensions/filters/http/jwt_authn/jwt_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+std::shared_ptr<const ::google::jwt_verify::Jwt> JwtCache::lookup(absl::string_view token,
+                                                                  uint64_t unix_timestamp) {
+  const auto it = index_.find(token);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  const std::list<Entry>::iterator entry = it->second;
+  // If the exp claim does *not* appear in the JWT then the exp field is defaulted to 0.
+  if (entry->jwt_->exp_ > 0 && entry->jwt_->exp_ < unix_timestamp) {
+    index_.erase(it);
+    entries_.erase(entry);
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  return entry->jwt_;
+}
+
+void JwtCache::insert(absl::string_view token,
+                      std::shared_ptr<const ::google::jwt_verify::Jwt> jwt) {
+  if (max_size_ == 0 || index_.contains(token)) {
+    return;
+  }
+  if (entries_.size() >= max_size_) {
+    index_.erase(entries_.back().token_);
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{std::string(token), std::move(jwt)});
+  index_.emplace(entries_.front().token_, entries_.begin());
+}
+
+void JwtCache::clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "jwt_verify_lib/jwt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+class JwtCache;
+using JwtCachePtr = std::unique_ptr<JwtCache>;
+
+/**
+ * A bounded cache of the JWTs verified with the keys of a provider, indexed by their token. When
+ * full, the least recently used token is evicted. The cache is not thread safe, each worker has
+ * its own.
+ */
+class JwtCache {
+public:
+  /**
+   * @param max_size supplies the maximum number of tokens cached, 0 disabling the cache.
+   */
+  JwtCache(uint32_t max_size) : max_size_(max_size) {}
+
+  /**
+   * @param token supplies the token.
+   * @param unix_timestamp supplies the current time, in seconds since the epoch.
+   * @return the verified JWT of the token, or nullptr if it's not cached. A token that expired is
+   *         removed from the cache.
+   */
+  std::shared_ptr<const ::google::jwt_verify::Jwt> lookup(absl::string_view token,
+                                                          uint64_t unix_timestamp);
+
+  /**
+   * Caches a verified JWT.
+   * @param token supplies the token the JWT was parsed from.
+   * @param jwt supplies the JWT.
+   */
+  void insert(absl::string_view token, std::shared_ptr<const ::google::jwt_verify::Jwt> jwt);
+
+  /**
+   * Removes all tokens, e.g. because they were verified with keys that were replaced since.
+   */
+  void clear();
+
+  bool enabled() const { return max_size_ > 0; }
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    std::string token_;
+    std::shared_ptr<const ::google::jwt_verify::Jwt> jwt_;
+  };
+
+  const uint32_t max_size_;
+  // In least recently used order, the most recently used entry first.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator> index_;
+};
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "envoy/http/codes.h"
+#include "envoy/network/address.h"
 
 #include "common/http/utility.h"
 
@@ -18,11 +19,16 @@ FilterConfig::FilterConfig(
     const bool per_route)
     : status_(toErrorCode(config.status().code())),
       stats_(generateStats(config.stat_prefix(), scope)),
+      limit_per_remote_address_(config.descriptor_buckets().remote_address()),
+      descriptor_header_(config.descriptor_buckets().request_header()),
       rate_limiter_(Filters::Common::LocalRateLimit::LocalRateLimiterImpl(
           std::chrono::milliseconds(
               PROTOBUF_GET_MS_OR_DEFAULT(config.token_bucket(), fill_interval, 0)),
           config.token_bucket().max_tokens(),
-          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.token_bucket(), tokens_per_fill, 1), dispatcher)),
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.token_bucket(), tokens_per_fill, 1), dispatcher,
+          config.has_descriptor_buckets()
+              ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.descriptor_buckets(), max_buckets, 10000)
+              : 0)),
       runtime_(runtime),
       filter_enabled_(
           config.has_filter_enabled()
@@ -46,7 +52,22 @@ FilterConfig::FilterConfig(
   }
 }
 
-bool FilterConfig::requestAllowed() const { return rate_limiter_.requestAllowed(); }
+bool FilterConfig::requestAllowed(const Http::RequestHeaderMap& headers,
+                                  const StreamInfo::StreamInfo& stream_info) const {
+  if (limit_per_remote_address_) {
+    const Network::Address::InstanceConstSharedPtr& address =
+        stream_info.downstreamRemoteAddress();
+    return rate_limiter_.requestAllowed(address->type() == Network::Address::Type::Ip
+                                            ? address->ip()->addressAsString()
+                                            : address->asString());
+  }
+  if (!descriptor_header_.get().empty()) {
+    const Http::HeaderEntry* entry = headers.get(descriptor_header_);
+    return rate_limiter_.requestAllowed(entry != nullptr ? entry->value().getStringView()
+                                                         : absl::string_view());
+  }
+  return rate_limiter_.requestAllowed();
+}
 
 LocalRateLimitStats FilterConfig::generateStats(const std::string& prefix, Stats::Scope& scope) {
   const std::string final_prefix = prefix + ".http_local_rate_limit";
@@ -61,7 +82,7 @@ bool FilterConfig::enforced() const {
   return filter_enforced_.has_value() ? filter_enforced_->enabled() : false;
 }
 
-Http::FilterHeadersStatus Filter::decodeHeaders(Http::RequestHeaderMap&, bool) {
+Http::FilterHeadersStatus Filter::decodeHeaders(Http::RequestHeaderMap& headers, bool) {
   const auto* config = getConfig();
 
   if (!config->enabled()) {
@@ -70,7 +91,7 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::RequestHeaderMap&, bool) {
 
   config->stats().enabled_.inc();
 
-  if (config->requestAllowed()) {
+  if (config->requestAllowed(headers, decoder_callbacks_->streamInfo())) {
     config->stats().ok_.inc();
     return Http::FilterHeadersStatus::Continue;
   }
@@ -50,7 +50,8 @@ public:
                bool per_route = false);
   ~FilterConfig() override = default;
   Runtime::Loader& runtime() { return runtime_; }
-  bool requestAllowed() const;
+  bool requestAllowed(const Http::RequestHeaderMap& headers,
+                      const StreamInfo::StreamInfo& stream_info) const;
   bool enabled() const;
   bool enforced() const;
   LocalRateLimitStats& stats() const { return stats_; }
@@ -72,6 +73,8 @@ private:
 
   const Http::Code status_;
   mutable LocalRateLimitStats stats_;
+  const bool limit_per_remote_address_;
+  const Http::LowerCaseString descriptor_header_;
   Filters::Common::LocalRateLimit::LocalRateLimiterImpl rate_limiter_;
   Runtime::Loader& runtime_;
   const absl::optional<Envoy::Runtime::FractionalPercent> filter_enabled_;
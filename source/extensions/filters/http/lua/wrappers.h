@@ -9,6 +9,7 @@
 #include "extensions/filters/common/lua/lua.h"
 #include "extensions/filters/common/lua/wrappers.h"
 
+#include "absl/container/inlined_vector.h"
 #include "openssl/evp.h"
 
 namespace Envoy {
@@ -31,7 +32,9 @@ public:
 
 private:
   HeaderMapWrapper& parent_;
-  std::vector<const Http::HeaderEntry*> entries_;
+  // The iterator is allocated by Lua, so keeping the entries of typical header maps inline means
+  // that iterating over them does not allocate anything else.
+  absl::InlinedVector<const Http::HeaderEntry*, 32> entries_;
   uint64_t current_{};
 };
 
@@ -26,13 +26,16 @@ Http::FilterFactoryCb RateLimitFilterConfig::createFilterFactoryFromProtoTyped(
                                                        context.httpContext()));
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
+  Filters::Common::RateLimit::QuotaLeasesSharedPtr quota_leases =
+      Filters::Common::RateLimit::quotaLeases(context, proto_config.rate_limit_service(), timeout);
 
-  return [proto_config, &context, timeout,
-          filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+  return [proto_config, &context, timeout, filter_config,
+          quota_leases](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<Filter>(
-        filter_config, Filters::Common::RateLimit::rateLimitClient(
-                           context, proto_config.rate_limit_service().grpc_service(), timeout,
-                           proto_config.rate_limit_service().transport_api_version())));
+        filter_config,
+        Filters::Common::RateLimit::rateLimitClient(
+            context, proto_config.rate_limit_service().grpc_service(), timeout,
+            proto_config.rate_limit_service().transport_api_version(), quota_leases)));
   };
 }
 
@@ -404,10 +404,22 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
     const uint32_t max_path_tag_length = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
         tracing_config, max_path_tag_length, Tracing::DefaultMaxPathTagLength);
 
+    absl::optional<Http::TracingTailSamplingConfig> tail_sampling;
+    if (tracing_config.has_tail_sampling()) {
+      const auto& tail_sampling_config = tracing_config.tail_sampling();
+      tail_sampling.emplace();
+      if (tail_sampling_config.has_min_duration()) {
+        tail_sampling->min_duration_ =
+            std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(tail_sampling_config, min_duration));
+      }
+      tail_sampling->server_errors_ = tail_sampling_config.server_errors();
+      tail_sampling->response_flags_ = tail_sampling_config.response_flags();
+    }
+
     tracing_config_ =
         std::make_unique<Http::TracingConnectionManagerConfig>(Http::TracingConnectionManagerConfig{
             tracing_operation_name, custom_tags, client_sampling, random_sampling, overall_sampling,
-            tracing_config.verbose(), max_path_tag_length});
+            tracing_config.verbose(), max_path_tag_length, tail_sampling});
   }
 
   for (const auto& access_log : config.access_log()) {
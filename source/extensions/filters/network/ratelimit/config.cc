@@ -28,15 +28,17 @@ Network::FilterFactoryCb RateLimitConfigFactory::createFilterFactoryFromProtoTyp
   ConfigSharedPtr filter_config(new Config(proto_config, context.scope(), context.runtime()));
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
+  Filters::Common::RateLimit::QuotaLeasesSharedPtr quota_leases =
+      Filters::Common::RateLimit::quotaLeases(context, proto_config.rate_limit_service(), timeout);
 
-  return [proto_config, &context, timeout,
-          filter_config](Network::FilterManager& filter_manager) -> void {
+  return [proto_config, &context, timeout, filter_config,
+          quota_leases](Network::FilterManager& filter_manager) -> void {
     filter_manager.addReadFilter(std::make_shared<Filter>(
         filter_config,
 
         Filters::Common::RateLimit::rateLimitClient(
             context, proto_config.rate_limit_service().grpc_service(), timeout,
-            proto_config.rate_limit_service().transport_api_version())));
+            proto_config.rate_limit_service().transport_api_version(), quota_leases)));
   };
 }
 
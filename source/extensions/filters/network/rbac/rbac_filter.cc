@@ -93,9 +93,22 @@ Result RoleBasedAccessControlFilter::checkEngine(Filters::Common::RBAC::Enforcem
   const auto engine = config_->engine(mode);
   std::string effective_policy_id;
   if (engine != nullptr) {
-    // Check authorization decision and do Action operations
-    bool allowed = engine->handleAction(
-        callbacks_->connection(), callbacks_->connection().streamInfo(), &effective_policy_id);
+    // Check authorization decision and do Action operations, unless the engine already decided
+    // for this connection and its decision can't have changed since.
+    absl::optional<Decision>& decision =
+        mode == Filters::Common::RBAC::EnforcementMode::Enforced ? engine_decision_
+                                                                 : shadow_engine_decision_;
+    bool allowed;
+    if (decision.has_value()) {
+      allowed = decision->allowed_;
+      effective_policy_id = decision->effective_policy_id_;
+    } else {
+      allowed = engine->handleAction(callbacks_->connection(),
+                                     callbacks_->connection().streamInfo(), &effective_policy_id);
+      if (engine->decisionDependsOnlyOnConnection()) {
+        decision = Decision{allowed, effective_policy_id};
+      }
+    }
     const std::string log_policy_id = effective_policy_id.empty() ? "none" : effective_policy_id;
     if (allowed) {
       if (mode == Filters::Common::RBAC::EnforcementMode::Shadow) {
@@ -10,6 +10,8 @@
 #include "extensions/filters/common/rbac/engine_impl.h"
 #include "extensions/filters/common/rbac/utility.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -74,10 +76,18 @@ public:
   void setDynamicMetadata(std::string shadow_engine_result, std::string shadow_policy_id);
 
 private:
+  // The decision of an engine, kept in continuous mode when it can't change over the connection.
+  struct Decision {
+    bool allowed_;
+    std::string effective_policy_id_;
+  };
+
   RoleBasedAccessControlFilterConfigSharedPtr config_;
   Network::ReadFilterCallbacks* callbacks_{};
   EngineResult engine_result_{Unknown};
   EngineResult shadow_engine_result_{Unknown};
+  absl::optional<Decision> engine_decision_;
+  absl::optional<Decision> shadow_engine_decision_;
 
   Result checkEngine(Filters::Common::RBAC::EnforcementMode mode);
 };
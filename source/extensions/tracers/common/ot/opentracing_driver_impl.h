@@ -63,6 +63,7 @@ public:
   Tracing::SpanPtr startSpan(const Tracing::Config& config, Http::RequestHeaderMap& request_headers,
                              const std::string& operation_name, SystemTime start_time,
                              const Tracing::Decision tracing_decision) override;
+  bool supportsTailSampling() const override { return false; }
 
   virtual opentracing::Tracer& tracer() PURE;
 
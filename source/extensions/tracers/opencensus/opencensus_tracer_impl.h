@@ -26,6 +26,8 @@ public:
   Tracing::SpanPtr startSpan(const Tracing::Config& config, Http::RequestHeaderMap& request_headers,
                              const std::string& operation_name, SystemTime start_time,
                              const Tracing::Decision tracing_decision) override;
+  // OpenCensus decides whether to sample a trace when its root span starts.
+  bool supportsTailSampling() const override { return false; }
 
 private:
   void applyTraceConfig(const opencensus::proto::trace::v1::TraceConfig& config);
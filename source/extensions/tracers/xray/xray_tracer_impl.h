@@ -22,6 +22,7 @@ public:
   Tracing::SpanPtr startSpan(const Tracing::Config& config, Http::RequestHeaderMap& request_headers,
                              const std::string& operation_name, Envoy::SystemTime start_time,
                              const Tracing::Decision tracing_decision) override;
+  bool supportsTailSampling() const override { return false; }
 
 private:
   struct TlsTracer : ThreadLocal::ThreadLocalObject {
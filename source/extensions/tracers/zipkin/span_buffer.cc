@@ -2,20 +2,130 @@
 
 #include "envoy/config/trace/v3/zipkin.pb.h"
 
-#include "common/protobuf/utility.h"
+#include "common/buffer/buffer_impl.h"
 
 #include "extensions/tracers/zipkin/util.h"
 #include "extensions/tracers/zipkin/zipkin_core_constants.h"
 #include "extensions/tracers/zipkin/zipkin_json_field_names.h"
 
-#include "absl/strings/str_join.h"
-#include "absl/strings/str_replace.h"
+#include "absl/strings/str_cat.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
 
+namespace {
+
+// Appends a string to a JSON document as a JSON string.
+void appendJsonString(Buffer::Instance& output, absl::string_view value) {
+  output.add("\"", 1);
+  size_t unescaped_start = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    const unsigned char c = value[i];
+    if (c != '"' && c != '\\' && c >= 0x20) {
+      continue;
+    }
+    output.add(value.data() + unescaped_start, i - unescaped_start);
+    unescaped_start = i + 1;
+    switch (c) {
+    case '"':
+      output.add("\\\"", 2);
+      break;
+    case '\\':
+      output.add("\\\\", 2);
+      break;
+    case '\n':
+      output.add("\\n", 2);
+      break;
+    case '\r':
+      output.add("\\r", 2);
+      break;
+    case '\t':
+      output.add("\\t", 2);
+      break;
+    default:
+      output.add(absl::StrCat("\\u00", absl::Hex(c, absl::kZeroPad2)));
+    }
+  }
+  output.add(value.data() + unescaped_start, value.size() - unescaped_start);
+  output.add("\"", 1);
+}
+
+// Appends the key of a JSON object member, preceded by a comma unless it is the object's first
+// member. Keys are the constants of zipkin_json_field_names.h, which need no escaping.
+void appendJsonKey(Buffer::Instance& output, absl::string_view key, bool& first) {
+  output.add(first ? "\"" : ",\"");
+  first = false;
+  output.add(key);
+  output.add("\":", 2);
+}
+
+// Appends an integer to a JSON document. Zipkin expects timestamps and durations as int64, which
+// can't be represented exactly by the doubles ProtobufWkt::Struct stores numbers as.
+void appendJsonNumber(Buffer::Instance& output, uint64_t value) {
+  const absl::AlphaNum number(value);
+  output.add(number.Piece());
+}
+
+// Protobuf wire format of zipkin::proto3, see
+// https://github.com/openzipkin/zipkin-api/blob/v0.2.2/zipkin.proto.
+constexpr uint32_t ProtobufVarintField = 0;
+constexpr uint32_t ProtobufFixed64Field = 1;
+constexpr uint32_t ProtobufLengthDelimitedField = 2;
+
+constexpr uint32_t ListOfSpansSpans = 1;
+
+constexpr uint32_t SpanTraceId = 1;
+constexpr uint32_t SpanParentId = 2;
+constexpr uint32_t SpanId = 3;
+constexpr uint32_t SpanKind = 4;
+constexpr uint32_t SpanName = 5;
+constexpr uint32_t SpanTimestamp = 6;
+constexpr uint32_t SpanDuration = 7;
+constexpr uint32_t SpanLocalEndpoint = 8;
+constexpr uint32_t SpanTags = 11;
+constexpr uint32_t SpanShared = 13;
+
+constexpr uint64_t SpanKindClient = 1;
+constexpr uint64_t SpanKindServer = 2;
+
+constexpr uint32_t EndpointServiceName = 1;
+constexpr uint32_t EndpointIpv4 = 2;
+constexpr uint32_t EndpointIpv6 = 3;
+constexpr uint32_t EndpointPort = 4;
+
+constexpr uint32_t MapEntryKey = 1;
+constexpr uint32_t MapEntryValue = 2;
+
+void appendVarint(std::string& output, uint64_t value) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+void appendVarintField(std::string& output, uint32_t field, uint64_t value) {
+  appendVarint(output, (field << 3) | ProtobufVarintField);
+  appendVarint(output, value);
+}
+
+void appendFixed64Field(std::string& output, uint32_t field, uint64_t value) {
+  appendVarint(output, (field << 3) | ProtobufFixed64Field);
+  for (uint32_t i = 0; i < sizeof(uint64_t); i++) {
+    output.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void appendLengthDelimitedField(std::string& output, uint32_t field, absl::string_view value) {
+  appendVarint(output, (field << 3) | ProtobufLengthDelimitedField);
+  appendVarint(output, value.size());
+  output.append(value.data(), value.size());
+}
+
+} // namespace
+
 SpanBuffer::SpanBuffer(
     const envoy::config::trace::v3::ZipkinConfig::CollectorEndpointVersion& version,
     const bool shared_span_context)
@@ -60,218 +170,204 @@ SerializerPtr SpanBuffer::makeSerializer(
   }
 }
 
-std::string JsonV1Serializer::serialize(const std::vector<Span>& zipkin_spans) {
-  const std::string serialized_elements =
-      absl::StrJoin(zipkin_spans, ",", [](std::string* element, const Span& zipkin_span) {
-        absl::StrAppend(element, zipkin_span.toJson());
-      });
-  return absl::StrCat("[", serialized_elements, "]");
+std::string SpanBuffer::serialize() const {
+  Buffer::OwnedImpl output;
+  serialize(output);
+  return output.toString();
+}
+
+void JsonV1Serializer::serialize(const std::vector<Span>& zipkin_spans, Buffer::Instance& output) {
+  output.add("[", 1);
+  for (size_t i = 0; i < zipkin_spans.size(); i++) {
+    if (i > 0) {
+      output.add(",", 1);
+    }
+    output.add(zipkin_spans[i].toJson());
+  }
+  output.add("]", 1);
 }
 
 JsonV2Serializer::JsonV2Serializer(const bool shared_span_context)
     : shared_span_context_{shared_span_context} {}
 
-std::string JsonV2Serializer::serialize(const std::vector<Span>& zipkin_spans) {
-  Util::Replacements replacements;
-  const std::string serialized_elements = absl::StrJoin(
-      zipkin_spans, ",", [this, &replacements](std::string* out, const Span& zipkin_span) {
-        const auto& replacement_values = replacements;
-        absl::StrAppend(
-            out, absl::StrJoin(
-                     toListOfSpans(zipkin_span, replacements), ",",
-                     [&replacement_values](std::string* element, const ProtobufWkt::Struct& span) {
-                       const std::string json = MessageUtil::getJsonStringFromMessage(
-                           span, /* pretty_print */ false,
-                           /* always_print_primitive_fields */ true);
-
-                       // The Zipkin API V2 specification mandates to store timestamp value as int64
-                       // https://github.com/openzipkin/zipkin-api/blob/228fabe660f1b5d1e28eac9df41f7d1deed4a1c2/zipkin2-api.yaml#L447-L463
-                       // (often translated as uint64 in some of the official implementations:
-                       // https://github.com/openzipkin/zipkin-go/blob/62dc8b26c05e0e8b88eb7536eff92498e65bbfc3/model/span.go#L114,
-                       // and see the discussion here:
-                       // https://github.com/openzipkin/zipkin-go/pull/161#issuecomment-598558072).
-                       // However, when the timestamp is stored as number value in a protobuf
-                       // struct, it is stored as a double. Because of how protobuf serializes
-                       // doubles, there is a possibility that the value will be rendered as a
-                       // number with scientific notation as reported in:
-                       // https://github.com/envoyproxy/envoy/issues/9341#issuecomment-566912973. To
-                       // deal with that issue, here we do a workaround by storing the timestamp as
-                       // string and keeping track of that with the corresponding integer
-                       // replacements, and do the replacement here so we can meet the Zipkin API V2
-                       // requirements.
-                       //
-                       // TODO(dio): The right fix for this is to introduce additional knob when
-                       // serializing double in protobuf DoubleToBuffer function, and make it
-                       // available to be controlled at caller site.
-                       // https://github.com/envoyproxy/envoy/issues/10411).
-                       absl::StrAppend(element, absl::StrReplaceAll(json, replacement_values));
-                     }));
-      });
-  return absl::StrCat("[", serialized_elements, "]");
-}
-
-const std::vector<ProtobufWkt::Struct>
-JsonV2Serializer::toListOfSpans(const Span& zipkin_span, Util::Replacements& replacements) const {
-  std::vector<ProtobufWkt::Struct> spans;
-  spans.reserve(zipkin_span.annotations().size());
-  for (const auto& annotation : zipkin_span.annotations()) {
-    ProtobufWkt::Struct span;
-    auto* fields = span.mutable_fields();
-
-    if (annotation.value() == CLIENT_SEND) {
-      (*fields)[SPAN_KIND] = ValueUtil::stringValue(KIND_CLIENT);
-    } else if (annotation.value() == SERVER_RECV) {
-      if (shared_span_context_ && zipkin_span.annotations().size() > 1) {
-        (*fields)[SPAN_SHARED] = ValueUtil::boolValue(true);
+void JsonV2Serializer::serialize(const std::vector<Span>& zipkin_spans, Buffer::Instance& output) {
+  output.add("[", 1);
+  bool first = true;
+  for (const Span& zipkin_span : zipkin_spans) {
+    // Each client or server annotation of a Zipkin v1 span is a Zipkin v2 span.
+    for (const auto& annotation : zipkin_span.annotations()) {
+      if (annotation.value() != CLIENT_SEND && annotation.value() != SERVER_RECV) {
+        continue;
       }
-      (*fields)[SPAN_KIND] = ValueUtil::stringValue(KIND_SERVER);
-    } else {
-      continue;
-    }
-
-    if (annotation.isSetEndpoint()) {
-      // Usually we store number to a ProtobufWkt::Struct object via ValueUtil::numberValue.
-      // However, due to the possibility of rendering that to a number with scientific notation, we
-      // chose to store it as a string and keeping track the corresponding replacement. For example,
-      // we have 1584324295476870 if we stored it as a double value, MessageToJsonString gives
-      // us 1.58432429547687e+15. Instead we store it as the string of 1584324295476870 (when it is
-      // serialized: "1584324295476870"), and replace it post MessageToJsonString serialization with
-      // integer (1584324295476870 without `"`), see: JsonV2Serializer::serialize.
-      (*fields)[SPAN_TIMESTAMP] =
-          Util::uint64Value(annotation.timestamp(), SPAN_TIMESTAMP, replacements);
-      (*fields)[SPAN_LOCAL_ENDPOINT] =
-          ValueUtil::structValue(toProtoEndpoint(annotation.endpoint()));
+      output.add(first ? "{" : ",{");
+      first = false;
+      serializeSpan(zipkin_span, annotation, output);
+      output.add("}", 1);
     }
+  }
+  output.add("]", 1);
+}
 
-    (*fields)[SPAN_TRACE_ID] = ValueUtil::stringValue(zipkin_span.traceIdAsHexString());
-    if (zipkin_span.isSetParentId()) {
-      (*fields)[SPAN_PARENT_ID] = ValueUtil::stringValue(zipkin_span.parentIdAsHexString());
+void JsonV2Serializer::serializeSpan(const Span& zipkin_span, const Annotation& annotation,
+                                     Buffer::Instance& output) const {
+  bool first = true;
+  appendJsonKey(output, SPAN_TRACE_ID, first);
+  appendJsonString(output, zipkin_span.traceIdAsHexString());
+  if (zipkin_span.isSetParentId()) {
+    appendJsonKey(output, SPAN_PARENT_ID, first);
+    appendJsonString(output, zipkin_span.parentIdAsHexString());
+  }
+  appendJsonKey(output, SPAN_ID, first);
+  appendJsonString(output, zipkin_span.idAsHexString());
+
+  appendJsonKey(output, SPAN_KIND, first);
+  if (annotation.value() == CLIENT_SEND) {
+    appendJsonString(output, KIND_CLIENT);
+  } else {
+    appendJsonString(output, KIND_SERVER);
+    if (shared_span_context_ && zipkin_span.annotations().size() > 1) {
+      appendJsonKey(output, SPAN_SHARED, first);
+      output.add("true", 4);
     }
+  }
 
-    (*fields)[SPAN_ID] = ValueUtil::stringValue(zipkin_span.idAsHexString());
+  const auto& span_name = zipkin_span.name();
+  if (!span_name.empty()) {
+    appendJsonKey(output, SPAN_NAME, first);
+    appendJsonString(output, span_name);
+  }
 
-    const auto& span_name = zipkin_span.name();
-    if (!span_name.empty()) {
-      (*fields)[SPAN_NAME] = ValueUtil::stringValue(span_name);
-    }
+  if (annotation.isSetEndpoint()) {
+    appendJsonKey(output, SPAN_TIMESTAMP, first);
+    appendJsonNumber(output, annotation.timestamp());
+    appendJsonKey(output, SPAN_LOCAL_ENDPOINT, first);
+    serializeEndpoint(annotation.endpoint(), output);
+  }
 
-    if (zipkin_span.isSetDuration()) {
-      // Since SPAN_DURATION has the same data type with SPAN_TIMESTAMP, we use Util::uint64Value to
-      // store it.
-      (*fields)[SPAN_DURATION] =
-          Util::uint64Value(zipkin_span.duration(), SPAN_DURATION, replacements);
-    }
+  if (zipkin_span.isSetDuration()) {
+    appendJsonKey(output, SPAN_DURATION, first);
+    appendJsonNumber(output, zipkin_span.duration());
+  }
 
-    const auto& binary_annotations = zipkin_span.binaryAnnotations();
-    if (!binary_annotations.empty()) {
-      ProtobufWkt::Struct tags;
-      auto* tag_fields = tags.mutable_fields();
-      for (const auto& binary_annotation : binary_annotations) {
-        (*tag_fields)[binary_annotation.key()] = ValueUtil::stringValue(binary_annotation.value());
+  const auto& binary_annotations = zipkin_span.binaryAnnotations();
+  if (!binary_annotations.empty()) {
+    appendJsonKey(output, SPAN_TAGS, first);
+    output.add("{", 1);
+    bool first_tag = true;
+    for (const auto& binary_annotation : binary_annotations) {
+      if (!first_tag) {
+        output.add(",", 1);
       }
-      (*fields)[SPAN_TAGS] = ValueUtil::structValue(tags);
+      first_tag = false;
+      appendJsonString(output, binary_annotation.key());
+      output.add(":", 1);
+      appendJsonString(output, binary_annotation.value());
     }
-
-    spans.push_back(std::move(span));
+    output.add("}", 1);
   }
-  return spans;
 }
 
-const ProtobufWkt::Struct JsonV2Serializer::toProtoEndpoint(const Endpoint& zipkin_endpoint) const {
-  ProtobufWkt::Struct endpoint;
-  auto* fields = endpoint.mutable_fields();
-
+void JsonV2Serializer::serializeEndpoint(const Endpoint& zipkin_endpoint,
+                                         Buffer::Instance& output) const {
+  output.add("{", 1);
+  bool first = true;
   Network::Address::InstanceConstSharedPtr address = zipkin_endpoint.address();
   if (address) {
-    if (address->ip()->version() == Network::Address::IpVersion::v4) {
-      (*fields)[ENDPOINT_IPV4] = ValueUtil::stringValue(address->ip()->addressAsString());
-    } else {
-      (*fields)[ENDPOINT_IPV6] = ValueUtil::stringValue(address->ip()->addressAsString());
-    }
-    (*fields)[ENDPOINT_PORT] = ValueUtil::numberValue(address->ip()->port());
+    appendJsonKey(output,
+                  address->ip()->version() == Network::Address::IpVersion::v4 ? ENDPOINT_IPV4
+                                                                               : ENDPOINT_IPV6,
+                  first);
+    appendJsonString(output, address->ip()->addressAsString());
+    appendJsonKey(output, ENDPOINT_PORT, first);
+    appendJsonNumber(output, address->ip()->port());
   }
 
   const std::string& service_name = zipkin_endpoint.serviceName();
   if (!service_name.empty()) {
-    (*fields)[ENDPOINT_SERVICE_NAME] = ValueUtil::stringValue(service_name);
+    appendJsonKey(output, ENDPOINT_SERVICE_NAME, first);
+    appendJsonString(output, service_name);
   }
-
-  return endpoint;
+  output.add("}", 1);
 }
 
 ProtobufSerializer::ProtobufSerializer(const bool shared_span_context)
     : shared_span_context_{shared_span_context} {}
 
-std::string ProtobufSerializer::serialize(const std::vector<Span>& zipkin_spans) {
-  zipkin::proto3::ListOfSpans spans;
+void ProtobufSerializer::serialize(const std::vector<Span>& zipkin_spans,
+                                   Buffer::Instance& output) {
+  std::string field_header;
   for (const Span& zipkin_span : zipkin_spans) {
-    spans.MergeFrom(toListOfSpans(zipkin_span));
+    // Each client or server annotation of a Zipkin v1 span is a Zipkin v2 span.
+    for (const auto& annotation : zipkin_span.annotations()) {
+      if (annotation.value() != CLIENT_SEND && annotation.value() != SERVER_RECV) {
+        continue;
+      }
+      serializeSpan(zipkin_span, annotation);
+      field_header.clear();
+      appendVarint(field_header, (ListOfSpansSpans << 3) | ProtobufLengthDelimitedField);
+      appendVarint(field_header, span_.size());
+      output.add(field_header);
+      output.add(span_);
+    }
   }
-  std::string serialized;
-  spans.SerializeToString(&serialized);
-  return serialized;
 }
 
-const zipkin::proto3::ListOfSpans ProtobufSerializer::toListOfSpans(const Span& zipkin_span) const {
-  zipkin::proto3::ListOfSpans spans;
-  for (const auto& annotation : zipkin_span.annotations()) {
-    zipkin::proto3::Span span;
-    if (annotation.value() == CLIENT_SEND) {
-      span.set_kind(zipkin::proto3::Span::CLIENT);
-    } else if (annotation.value() == SERVER_RECV) {
-      span.set_shared(shared_span_context_ && zipkin_span.annotations().size() > 1);
-      span.set_kind(zipkin::proto3::Span::SERVER);
-    } else {
-      continue;
-    }
-
-    if (annotation.isSetEndpoint()) {
-      span.set_timestamp(annotation.timestamp());
-      span.mutable_local_endpoint()->MergeFrom(toProtoEndpoint(annotation.endpoint()));
-    }
-
-    span.set_trace_id(zipkin_span.traceIdAsByteString());
-    if (zipkin_span.isSetParentId()) {
-      span.set_parent_id(zipkin_span.parentIdAsByteString());
-    }
-
-    span.set_id(zipkin_span.idAsByteString());
-    span.set_name(zipkin_span.name());
-
-    if (zipkin_span.isSetDuration()) {
-      span.set_duration(zipkin_span.duration());
-    }
-
-    auto& tags = *span.mutable_tags();
-    for (const auto& binary_annotation : zipkin_span.binaryAnnotations()) {
-      tags[binary_annotation.key()] = binary_annotation.value();
-    }
-
-    auto* mutable_span = spans.add_spans();
-    mutable_span->MergeFrom(span);
+void ProtobufSerializer::serializeSpan(const Span& zipkin_span, const Annotation& annotation) {
+  // Fields are written in field number order and, as proto3 does, only when they are not set to
+  // their default value.
+  span_.clear();
+  appendLengthDelimitedField(span_, SpanTraceId, zipkin_span.traceIdAsByteString());
+  if (zipkin_span.isSetParentId()) {
+    appendLengthDelimitedField(span_, SpanParentId, zipkin_span.parentIdAsByteString());
+  }
+  appendLengthDelimitedField(span_, SpanId, zipkin_span.idAsByteString());
+  appendVarintField(span_, SpanKind,
+                    annotation.value() == CLIENT_SEND ? SpanKindClient : SpanKindServer);
+  if (!zipkin_span.name().empty()) {
+    appendLengthDelimitedField(span_, SpanName, zipkin_span.name());
+  }
+  if (annotation.isSetEndpoint() && annotation.timestamp() != 0) {
+    appendFixed64Field(span_, SpanTimestamp, annotation.timestamp());
+  }
+  if (zipkin_span.isSetDuration() && zipkin_span.duration() != 0) {
+    appendVarintField(span_, SpanDuration, zipkin_span.duration());
+  }
+  if (annotation.isSetEndpoint()) {
+    serializeEndpoint(annotation.endpoint());
+    appendLengthDelimitedField(span_, SpanLocalEndpoint, endpoint_);
+  }
+  for (const auto& binary_annotation : zipkin_span.binaryAnnotations()) {
+    tag_.clear();
+    appendLengthDelimitedField(tag_, MapEntryKey, binary_annotation.key());
+    appendLengthDelimitedField(tag_, MapEntryValue, binary_annotation.value());
+    appendLengthDelimitedField(span_, SpanTags, tag_);
+  }
+  if (annotation.value() == SERVER_RECV && shared_span_context_ &&
+      zipkin_span.annotations().size() > 1) {
+    appendVarintField(span_, SpanShared, 1);
   }
-  return spans;
 }
 
-const zipkin::proto3::Endpoint
-ProtobufSerializer::toProtoEndpoint(const Endpoint& zipkin_endpoint) const {
-  zipkin::proto3::Endpoint endpoint;
+void ProtobufSerializer::serializeEndpoint(const Endpoint& zipkin_endpoint) {
+  endpoint_.clear();
+  const std::string& service_name = zipkin_endpoint.serviceName();
+  if (!service_name.empty()) {
+    appendLengthDelimitedField(endpoint_, EndpointServiceName, service_name);
+  }
+
   Network::Address::InstanceConstSharedPtr address = zipkin_endpoint.address();
   if (address) {
     if (address->ip()->version() == Network::Address::IpVersion::v4) {
-      endpoint.set_ipv4(Util::toByteString(address->ip()->ipv4()->address()));
+      appendLengthDelimitedField(endpoint_, EndpointIpv4,
+                                 Util::toByteString(address->ip()->ipv4()->address()));
     } else {
-      endpoint.set_ipv6(Util::toByteString(address->ip()->ipv6()->address()));
+      appendLengthDelimitedField(endpoint_, EndpointIpv6,
+                                 Util::toByteString(address->ip()->ipv6()->address()));
+    }
+    if (address->ip()->port() != 0) {
+      appendVarintField(endpoint_, EndpointPort, address->ip()->port());
     }
-    endpoint.set_port(address->ip()->port());
-  }
-
-  const std::string& service_name = zipkin_endpoint.serviceName();
-  if (!service_name.empty()) {
-    endpoint.set_service_name(service_name);
   }
-
-  return endpoint;
 }
 
 } // namespace Zipkin
@@ -1,14 +1,11 @@
 #pragma once
 
+#include "envoy/buffer/buffer.h"
 #include "envoy/config/trace/v3/zipkin.pb.h"
 
-#include "common/protobuf/protobuf.h"
-
 #include "extensions/tracers/zipkin/tracer_interface.h"
 #include "extensions/tracers/zipkin/zipkin_core_types.h"
 
-#include "zipkin.pb.h"
-
 namespace Envoy {
 namespace Extensions {
 namespace Tracers {
@@ -72,14 +69,22 @@ public:
   uint64_t pendingSpans() { return span_buffer_.size(); }
 
   /**
-   * Serializes std::vector<Span> span_buffer_ to std::string as payload for the reporter when the
-   * reporter does spans flushing. This function does only serialization and does not clear
-   * span_buffer_.
+   * Serializes std::vector<Span> span_buffer_ into the given buffer as payload for the reporter
+   * when the reporter does spans flushing. This function does only serialization and does not
+   * clear span_buffer_.
+   *
+   * @param output the buffer the serialized pending Zipkin spans are appended to.
+   */
+  void serialize(Buffer::Instance& output) const { serializer_->serialize(span_buffer_, output); }
+
+  /**
+   * Serializes std::vector<Span> span_buffer_ to std::string. This function does only
+   * serialization and does not clear span_buffer_.
    *
    * @return std::string the contents of the buffer, a collection of serialized pending Zipkin
    * spans.
    */
-  std::string serialize() const { return serializer_->serialize(span_buffer_); }
+  std::string serialize() const;
 
 private:
   SerializerPtr
@@ -103,14 +108,13 @@ public:
 
   /**
    * Serialize list of Zipkin spans into Zipkin v1 JSON array.
-   * @return std::string serialized pending spans as Zipkin v1 JSON array.
    */
-  std::string serialize(const std::vector<Span>& pending_spans) override;
+  void serialize(const std::vector<Span>& pending_spans, Buffer::Instance& output) override;
 };
 
 /**
  * JsonV2Serializer implements Zipkin::Serializer that serializes list of Zipkin spans into JSON
- * Zipkin v2 array.
+ * Zipkin v2 array. The JSON is written directly into the output buffer.
  */
 class JsonV2Serializer : public Serializer {
 public:
@@ -118,21 +122,21 @@ public:
 
   /**
    * Serialize list of Zipkin spans into Zipkin v2 JSON array.
-   * @return std::string serialized pending spans as Zipkin v2 JSON array.
    */
-  std::string serialize(const std::vector<Span>& pending_spans) override;
+  void serialize(const std::vector<Span>& pending_spans, Buffer::Instance& output) override;
 
 private:
-  const std::vector<ProtobufWkt::Struct> toListOfSpans(const Span& zipkin_span,
-                                                       Util::Replacements& replacements) const;
-  const ProtobufWkt::Struct toProtoEndpoint(const Endpoint& zipkin_endpoint) const;
+  void serializeSpan(const Span& zipkin_span, const Annotation& annotation,
+                     Buffer::Instance& output) const;
+  void serializeEndpoint(const Endpoint& zipkin_endpoint, Buffer::Instance& output) const;
 
   const bool shared_span_context_;
 };
 
 /**
- * ProtobufSerializer implements Zipkin::Serializer that serializes list of Zipkin spans into
- * stringified (SerializeToString) protobuf message.
+ * ProtobufSerializer implements Zipkin::Serializer that serializes list of Zipkin spans into a
+ * zipkin::proto3::ListOfSpans in protobuf wire format. The wire format is written directly,
+ * without building the message.
  */
 class ProtobufSerializer : public Serializer {
 public:
@@ -140,15 +144,19 @@ public:
 
   /**
    * Serialize list of Zipkin spans into Zipkin v2 zipkin::proto3::ListOfSpans.
-   * @return std::string serialized pending spans as Zipkin zipkin::proto3::ListOfSpans.
    */
-  std::string serialize(const std::vector<Span>& pending_spans) override;
+  void serialize(const std::vector<Span>& pending_spans, Buffer::Instance& output) override;
 
 private:
-  const zipkin::proto3::ListOfSpans toListOfSpans(const Span& zipkin_span) const;
-  const zipkin::proto3::Endpoint toProtoEndpoint(const Endpoint& zipkin_endpoint) const;
+  void serializeSpan(const Span& zipkin_span, const Annotation& annotation);
+  void serializeEndpoint(const Endpoint& zipkin_endpoint);
 
   const bool shared_span_context_;
+  // Scratch space for the length-delimited fields, reused across spans. A serializer is only used
+  // by the reporter of a single worker.
+  std::string span_;
+  std::string endpoint_;
+  std::string tag_;
 };
 
 } // namespace Zipkin
@@ -128,11 +128,63 @@ SpanPtr Tracer::startSpan(const Tracing::Config& config, const std::string& span
 void Tracer::reportSpan(Span&& span) {
   if (reporter_ && span.sampled()) {
     reporter_->reportSpan(std::move(span));
+  } else if (reporter_ && span.tailSampling()) {
+    holdSpan(std::move(span));
   }
 }
 
 void Tracer::setReporter(ReporterPtr reporter) { reporter_ = std::move(reporter); }
 
+void Tracer::enableTailSampling(Runtime::Loader& runtime, ZipkinTracerStats& stats) {
+  runtime_ = &runtime;
+  stats_ = &stats;
+}
+
+void Tracer::startTailSampledTrace(uint64_t trace_id) {
+  if (stats_ != nullptr) {
+    held_traces_[trace_id].open_requests_++;
+  }
+}
+
+void Tracer::finishTailSampledTrace(uint64_t trace_id, bool sampled) {
+  const auto it = held_traces_.find(trace_id);
+  if (it == held_traces_.end()) {
+    return;
+  }
+
+  HeldTrace& trace = it->second;
+  if (sampled && reporter_) {
+    stats_->spans_tail_sampled_.add(trace.spans_.size());
+    for (Span& span : trace.spans_) {
+      span.setSampled(true);
+      reporter_->reportSpan(std::move(span));
+    }
+  }
+  num_held_spans_ -= trace.spans_.size();
+  trace.spans_.clear();
+
+  if (--trace.open_requests_ == 0) {
+    held_traces_.erase(it);
+  }
+}
+
+void Tracer::holdSpan(Span&& span) {
+  const auto it = held_traces_.find(span.traceId());
+  if (it == held_traces_.end()) {
+    // All the requests of the trace completed without sampling it.
+    return;
+  }
+
+  if (num_held_spans_ >=
+      runtime_->snapshot().getInteger("tracing.zipkin.max_tail_sampling_spans",
+                                      DEFAULT_MAX_TAIL_SAMPLING_SPANS)) {
+    stats_->spans_tail_dropped_.inc();
+    return;
+  }
+  it->second.spans_.push_back(std::move(span));
+  num_held_spans_++;
+}
+
 } // namespace Zipkin
 } // namespace Tracers
 } // namespace Extensions
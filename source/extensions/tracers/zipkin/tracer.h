@@ -3,6 +3,8 @@
 #include "envoy/common/pure.h"
 #include "envoy/common/random_generator.h"
 #include "envoy/common/time.h"
+#include "envoy/runtime/runtime.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/tracing/http_tracer.h"
 
 #include "extensions/tracers/zipkin/span_context.h"
@@ -10,11 +12,27 @@
 #include "extensions/tracers/zipkin/zipkin_core_constants.h"
 #include "extensions/tracers/zipkin/zipkin_core_types.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
 
+#define ZIPKIN_TRACER_STATS(COUNTER)                                                               \
+  COUNTER(spans_sent)                                                                              \
+  COUNTER(spans_tail_sampled)                                                                      \
+  COUNTER(spans_tail_dropped)                                                                      \
+  COUNTER(timer_flushed)                                                                           \
+  COUNTER(reports_skipped_no_cluster)                                                              \
+  COUNTER(reports_sent)                                                                            \
+  COUNTER(reports_dropped)                                                                         \
+  COUNTER(reports_failed)
+
+struct ZipkinTracerStats {
+  ZIPKIN_TRACER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 /**
  * Abstract class that delegates to users of the Tracer class the responsibility
  * of "reporting" a Zipkin span that has ended its life cycle. "Reporting" can mean that the
@@ -102,7 +120,41 @@ public:
    */
   void setReporter(ReporterPtr reporter);
 
+  /**
+   * Have this Tracer hold the spans that are not sampled, but may be when the request that started
+   * their trace completes, instead of dropping them.
+   *
+   * @param runtime The runtime used to look up the maximum number of held spans.
+   * @param stats The stats for held spans.
+   */
+  void enableTailSampling(Runtime::Loader& runtime, ZipkinTracerStats& stats);
+
+  /**
+   * Starts holding the spans of a trace. Called when the span started for a request whose trace
+   * may be sampled when the request completes is created.
+   *
+   * @param trace_id The low 64 bits of the trace id.
+   */
+  void startTailSampledTrace(uint64_t trace_id);
+
+  /**
+   * Reports or drops the spans held for a trace. Called when the span started for a request whose
+   * trace may be sampled when the request completes is finished.
+   *
+   * @param trace_id The low 64 bits of the trace id.
+   * @param sampled Whether the trace was sampled when the request completed.
+   */
+  void finishTailSampledTrace(uint64_t trace_id, bool sampled);
+
 private:
+  struct HeldTrace {
+    std::vector<Span> spans_;
+    // Requests of the trace that are still in progress on this thread.
+    uint32_t open_requests_{};
+  };
+
+  void holdSpan(Span&& span);
+
   const std::string service_name_;
   Network::Address::InstanceConstSharedPtr address_;
   ReporterPtr reporter_;
@@ -110,6 +162,13 @@ private:
   const bool trace_id_128bit_;
   const bool shared_span_context_;
   TimeSource& time_source_;
+  Runtime::Loader* runtime_{};
+  ZipkinTracerStats* stats_{};
+  // Spans of traces that may still be sampled, by trace id. Spans are only held while at least one
+  // request of their trace is in progress, and the first of these requests to complete decides for
+  // the spans held so far.
+  absl::flat_hash_map<uint64_t, HeldTrace> held_traces_;
+  uint64_t num_held_spans_{};
 };
 
 using TracerPtr = std::unique_ptr<Tracer>;
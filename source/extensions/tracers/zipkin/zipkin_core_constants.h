@@ -39,6 +39,7 @@ constexpr char NOT_SAMPLED[] = "0";
 
 constexpr char DEFAULT_COLLECTOR_ENDPOINT[] = "/api/v1/spans";
 constexpr bool DEFAULT_SHARED_SPAN_CONTEXT = true;
+constexpr uint64_t DEFAULT_MAX_TAIL_SAMPLING_SPANS = 5000;
 
 } // namespace
 
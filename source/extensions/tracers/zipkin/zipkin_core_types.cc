@@ -126,6 +126,7 @@ Span::Span(const Span& span) : time_source_(span.time_source_) {
   }
   debug_ = span.debug();
   sampled_ = span.sampled();
+  tail_sampling_ = span.tailSampling();
   annotations_ = span.annotations();
   binary_annotations_ = span.binaryAnnotations();
   if (span.isSetTimestamp()) {
@@ -326,8 +326,8 @@ public:
    * Default constructor. Creates an empty span.
    */
   explicit Span(TimeSource& time_source)
-      : trace_id_(0), id_(0), debug_(false), sampled_(false), monotonic_start_time_(0),
-        tracer_(nullptr), time_source_(time_source) {}
+      : trace_id_(0), id_(0), debug_(false), sampled_(false), tail_sampling_(false),
+        monotonic_start_time_(0), tracer_(nullptr), time_source_(time_source) {}
 
   /**
    * Sets the span's trace id attribute.
@@ -359,6 +359,12 @@ public:
    */
   void setSampled(bool val) { sampled_ = val; }
 
+  /**
+   * Set whether the span, when it is not sampled, is held by the tracer until the sampling
+   * decision for its trace is made when the request that started it completes.
+   */
+  void setTailSampling(bool val) { tail_sampling_ = val; }
+
   /**
    * @return a vector with all annotations added to the span.
    */
@@ -502,6 +508,11 @@ public:
    */
   bool sampled() const { return sampled_; }
 
+  /**
+   * @return whether or not the span is held by the tracer when it is not sampled.
+   */
+  bool tailSampling() const { return tail_sampling_; }
+
   /**
    * @return the span's timestamp (clock time for user presentation: microseconds since epoch).
    */
@@ -607,6 +618,7 @@ private:
   absl::optional<uint64_t> parent_id_;
   bool debug_;
   bool sampled_;
+  bool tail_sampling_;
   std::vector<Annotation> annotations_;
   std::vector<BinaryAnnotation> binary_annotations_;
   absl::optional<int64_t> timestamp_;
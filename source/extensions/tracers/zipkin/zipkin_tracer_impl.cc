@@ -21,7 +21,26 @@ namespace Zipkin {
 
 ZipkinSpan::ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer) : span_(span), tracer_(tracer) {}
 
-void ZipkinSpan::finishSpan() { span_.finish(); }
+ZipkinSpan::ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer, bool tail_sampling_root)
+    : span_(span), tracer_(tracer), tail_sampling_root_(tail_sampling_root) {}
+
+ZipkinSpan::~ZipkinSpan() {
+  if (tail_sampling_root_) {
+    // The span was never finished, so neither was its request.
+    tracer_.finishTailSampledTrace(span_.traceId(), false);
+  }
+}
+
+void ZipkinSpan::finishSpan() {
+  // Finishing the span moves it to the tracer.
+  const uint64_t trace_id = span_.traceId();
+  const bool sampled = span_.sampled();
+  span_.finish();
+  if (tail_sampling_root_) {
+    tail_sampling_root_ = false;
+    tracer_.finishTailSampledTrace(trace_id, sampled);
+  }
+}
 
 void ZipkinSpan::setOperation(absl::string_view operation) {
   span_.setName(std::string(operation));
@@ -61,8 +80,9 @@ void ZipkinSpan::setSampled(bool sampled) { span_.setSampled(sampled); }
 Tracing::SpanPtr ZipkinSpan::spawnChild(const Tracing::Config& config, const std::string& name,
                                         SystemTime start_time) {
   SpanContext previous_context(span_);
-  return std::make_unique<ZipkinSpan>(
-      *tracer_.startSpan(config, name, start_time, previous_context), tracer_);
+  SpanPtr child = tracer_.startSpan(config, name, start_time, previous_context);
+  child->setTailSampling(span_.tailSampling());
+  return std::make_unique<ZipkinSpan>(*child, tracer_);
 }
 
 Driver::TlsTracer::TlsTracer(TracerPtr&& tracer, Driver& driver)
@@ -100,6 +120,7 @@ Driver::Driver(const envoy::config::trace::v3::ZipkinConfig& zipkin_config,
                                  trace_id_128bit, shared_span_context, time_source_);
     tracer->setReporter(
         ReporterImpl::NewInstance(std::ref(*this), std::ref(dispatcher), collector));
+    tracer->enableTailSampling(runtime_, tracer_stats_);
     return std::make_shared<TlsTracer>(std::move(tracer), *this);
   });
 }
@@ -128,6 +149,12 @@ Tracing::SpanPtr Driver::startSpan(const Tracing::Config& config,
     return std::make_unique<Tracing::NullSpan>();
   }
 
+  if (tracing_decision.tail_sampling && !new_zipkin_span->sampled()) {
+    new_zipkin_span->setTailSampling(true);
+    tracer.startTailSampledTrace(new_zipkin_span->traceId());
+    return std::make_unique<ZipkinSpan>(*new_zipkin_span, tracer, true);
+  }
+
   // Return the active Zipkin span.
   return std::make_unique<ZipkinSpan>(*new_zipkin_span, tracer);
 }
@@ -176,7 +203,6 @@ void ReporterImpl::enableTimer() {
 void ReporterImpl::flushSpans() {
   if (span_buffer_->pendingSpans()) {
     driver_.tracerStats().spans_sent_.add(span_buffer_->pendingSpans());
-    const std::string request_body = span_buffer_->serialize();
     Http::RequestMessagePtr message = std::make_unique<Http::RequestMessageImpl>();
     message->headers().setReferenceMethod(Http::Headers::get().MethodValues.Post);
     message->headers().setPath(collector_.endpoint_);
@@ -186,7 +212,7 @@ void ReporterImpl::flushSpans() {
             ? Http::Headers::get().ContentTypeValues.Protobuf
             : Http::Headers::get().ContentTypeValues.Json);
 
-    message->body().add(request_body);
+    span_buffer_->serialize(message->body());
 
     const uint64_t timeout =
         driver_.runtime().snapshot().getInteger("tracing.zipkin.request_timeout", 5000U);
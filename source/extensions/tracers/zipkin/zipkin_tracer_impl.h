@@ -22,18 +22,6 @@ namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
 
-#define ZIPKIN_TRACER_STATS(COUNTER)                                                               \
-  COUNTER(spans_sent)                                                                              \
-  COUNTER(timer_flushed)                                                                           \
-  COUNTER(reports_skipped_no_cluster)                                                              \
-  COUNTER(reports_sent)                                                                            \
-  COUNTER(reports_dropped)                                                                         \
-  COUNTER(reports_failed)
-
-struct ZipkinTracerStats {
-  ZIPKIN_TRACER_STATS(GENERATE_COUNTER_STRUCT)
-};
-
 /**
  * Class for Zipkin spans, wrapping a Zipkin::Span object.
  */
@@ -46,6 +34,18 @@ public:
    */
   ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer);
 
+  /**
+   * Constructor. Wraps the Zipkin::Span object started for a request whose trace may be sampled
+   * when the request completes.
+   *
+   * @param span to be wrapped.
+   * @param tail_sampling_root whether finishing this span makes the sampling decision for the spans
+   * of its trace held by the tracer.
+   */
+  ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer, bool tail_sampling_root);
+
+  ~ZipkinSpan() override;
+
   /**
    * Calls Zipkin::Span::finishSpan() to perform all actions needed to finalize the span.
    * This function is called by Tracing::HttpTracerUtility::finalizeSpan().
@@ -88,6 +88,7 @@ public:
 private:
   Zipkin::Span span_;
   Zipkin::Tracer& tracer_;
+  bool tail_sampling_root_{};
 };
 
 using ZipkinSpanPtr = std::unique_ptr<ZipkinSpan>;
@@ -120,6 +121,8 @@ public:
   Tracing::SpanPtr startSpan(const Tracing::Config&, Http::RequestHeaderMap& request_headers,
                              const std::string&, SystemTime start_time,
                              const Tracing::Decision tracing_decision) override;
+  // Spans of tail sampled traces are held by the Tracer until their root span finishes.
+  bool supportsTailSampling() const override { return true; }
 
   // Getters to return the ZipkinDriver's key members.
   Upstream::ClusterManager& clusterManager() { return cm_; }
@@ -88,6 +88,29 @@ typed_config:
             output_);
 }
 
+// Lines are formatted into a reused string, which doesn't carry anything over to the next line,
+// including after a line too long for the string to be kept.
+TEST_F(AccessLogImplTest, ConsecutiveLines) {
+  const std::string yaml = R"EOF(
+name: accesslog
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.access_loggers.file.v3.FileAccessLog
+  path: /dev/null
+  log_format:
+    text_format: "%REQ(USER-AGENT)%\n"
+  )EOF";
+
+  InstanceSharedPtr log = AccessLogFactory::fromProto(parseAccessLogFromV3Yaml(yaml), context_);
+
+  const std::vector<std::string> user_agents{"first", std::string(32 * 1024, 'a'), "third"};
+  for (const std::string& user_agent : user_agents) {
+    EXPECT_CALL(*file_, write(_));
+    request_headers_.setCopy(Http::Headers::get().UserAgent, user_agent);
+    log->log(&request_headers_, &response_headers_, &response_trailers_, stream_info_);
+    EXPECT_EQ(user_agent + "\n", output_.value());
+  }
+}
+
 TEST_F(AccessLogImplTest, DownstreamDisconnect) {
   const std::string yaml = R"EOF(
 name: accesslog
@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/access_log/access_log_manager_impl.h"
 #include "common/filesystem/file_shared_impl.h"
@@ -11,6 +14,8 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -158,9 +163,8 @@ TEST_F(AccessLogManagerImplTest, FlushToLogFileOnDemand) {
 
   EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
 
-  // The first write to a given file will start the flush thread. Because AccessManagerImpl::write
-  // holds the write_lock_ when the thread is started, the thread will flush on its first loop, once
-  // it obtains the write_lock_. Perform a write to get all that out of the way.
+  // The first write to a given file starts the flush timer and is flushed right away. Perform a
+  // write to get all that out of the way.
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
         return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
@@ -443,6 +447,70 @@ TEST_F(AccessLogManagerImplTest, BigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+// Writes are dropped rather than buffered without bound when the flush thread can't keep up.
+TEST_F(AccessLogManagerImplTest, WriteDroppedWhenTooMuchBuffered) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*file_, write_(_)).Times(0);
+  log_file->write(std::string(1024 * 1024 * 64 + 1, 'a'));
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_dropped").value());
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_buffered").value());
+  EXPECT_EQ(0UL,
+            store_.gauge("filesystem.write_total_buffered", Stats::Gauge::ImportMode::Accumulate)
+                .value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Lines written concurrently by several threads end up whole in the file.
+TEST_F(AccessLogManagerImplTest, WritesFromMultipleThreads) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  Thread::MutexBasicLockable written_lock;
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        Thread::LockGuard lock(written_lock);
+        written.append(data.data(), data.size());
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  const uint32_t num_threads = 4;
+  const uint32_t num_lines = 1000;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.push_back(thread_factory_.createThread([&log_file, i]() {
+      for (uint32_t j = 0; j < num_lines; j++) {
+        log_file->write(absl::StrCat("thread ", i, " line ", j, "\n"));
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  log_file->flush();
+
+  std::vector<std::string> lines;
+  {
+    Thread::LockGuard lock(written_lock);
+    lines = absl::StrSplit(written, '\n', absl::SkipEmpty());
+  }
+  std::sort(lines.begin(), lines.end());
+  std::vector<std::string> expected_lines;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    for (uint32_t j = 0; j < num_lines; j++) {
+      expected_lines.push_back(absl::StrCat("thread ", i, " line ", j));
+    }
+  }
+  std::sort(expected_lines.begin(), expected_lines.end());
+  EXPECT_EQ(expected_lines, lines);
+  EXPECT_EQ(num_threads * num_lines, store_.counter("filesystem.write_buffered").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
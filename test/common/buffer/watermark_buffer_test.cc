@@ -69,6 +69,20 @@ TEST_F(WatermarkBufferTest, AddBuffer) {
   EXPECT_EQ(11, buffer_.length());
 }
 
+TEST_F(WatermarkBufferTest, AddBufferFragment) {
+  const std::string data(11, 'a');
+  bool fragment_done = false;
+  BufferFragmentImpl fragment(data.data(), data.size(),
+                              [&fragment_done](const void*, size_t, const BufferFragmentImpl*) {
+                                fragment_done = true;
+                              });
+  buffer_.addBufferFragment(fragment);
+  EXPECT_EQ(1, times_high_watermark_called_);
+  EXPECT_EQ(11, buffer_.length());
+  buffer_.drain(11);
+  EXPECT_TRUE(fragment_done);
+}
+
 TEST_F(WatermarkBufferTest, Prepend) {
   std::string suffix = "World!", prefix = "Hello, ";
 
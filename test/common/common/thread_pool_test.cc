@@ -0,0 +1,79 @@
+#include <atomic>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/thread_pool.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/blocking_counter.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Thread {
+namespace {
+
+class ThreadPoolTest : public testing::Test {
+protected:
+  ThreadFactory& thread_factory_{threadFactoryForTest()};
+};
+
+TEST_F(ThreadPoolTest, PostRunsAllTasks) {
+  ThreadPool pool(thread_factory_, 4, "test_pool");
+  EXPECT_EQ(4, pool.size());
+
+  std::atomic<uint32_t> runs{0};
+  absl::BlockingCounter done(100);
+  for (uint32_t i = 0; i < 100; i++) {
+    pool.post([&runs, &done]() {
+      runs++;
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  EXPECT_EQ(100, runs);
+}
+
+// Tasks already queued when the pool is destroyed still run.
+TEST_F(ThreadPoolTest, DestructionDrainsQueue) {
+  std::atomic<uint32_t> runs{0};
+  {
+    ThreadPool pool(thread_factory_, 1, "test_pool");
+    for (uint32_t i = 0; i < 10; i++) {
+      pool.post([&runs]() { runs++; });
+    }
+  }
+  EXPECT_EQ(10, runs);
+}
+
+TEST_F(ThreadPoolTest, ParallelForVisitsEachIndexOnce) {
+  ThreadPool pool(thread_factory_, 3, "test_pool");
+  for (size_t count : {0, 1, 2, 1000}) {
+    std::vector<std::atomic<uint32_t>> visits(count);
+    pool.parallelFor(count, [&visits](size_t i) { visits[i]++; });
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(1, visits[i]) << "count=" << count << " index=" << i;
+    }
+  }
+}
+
+// An exception thrown by one invocation is rethrown on the caller after the others have run.
+TEST_F(ThreadPoolTest, ParallelForRethrows) {
+  ThreadPool pool(thread_factory_, 2, "test_pool");
+  std::atomic<uint32_t> runs{0};
+  EXPECT_THROW_WITH_MESSAGE(pool.parallelFor(50,
+                                             [&runs](size_t i) {
+                                               runs++;
+                                               if (i == 7) {
+                                                 throw EnvoyException("index 7");
+                                               }
+                                             }),
+                            EnvoyException, "index 7");
+  EXPECT_EQ(50, runs);
+}
+
+} // namespace
+} // namespace Thread
+} // namespace Envoy
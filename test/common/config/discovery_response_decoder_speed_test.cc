@@ -0,0 +1,101 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
+
+#include "common/config/decoded_resource_impl.h"
+#include "common/config/discovery_response_decoder.h"
+#include "common/config/opaque_resource_decoder_impl.h"
+#include "common/protobuf/message_validator_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+using ::benchmark::State;
+using Envoy::benchmark::skipExpensiveBenchmarks;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+const std::string TypeUrl = "type.googleapis.com/envoy.config.endpoint.v3.ClusterLoadAssignment";
+
+// A DiscoveryResponse in the shape of a large mesh's EDS snapshot: many ClusterLoadAssignments with
+// a handful of endpoints each.
+Protobuf::RepeatedPtrField<ProtobufWkt::Any> makeResources(uint32_t num_resources) {
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+  resources.Reserve(num_resources);
+  for (uint32_t i = 0; i < num_resources; i++) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+    load_assignment.set_cluster_name(absl::StrCat("cluster_", i));
+    auto* endpoints = load_assignment.add_endpoints();
+    endpoints->mutable_locality()->set_zone(absl::StrCat("zone_", i % 3));
+    for (uint32_t j = 0; j < 4; j++) {
+      auto* socket_address = endpoints->add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address(absl::StrCat("10.", i / 256 % 256, ".", i % 256, ".", j));
+      socket_address->set_port_value(8000 + j);
+    }
+    resources.Add()->PackFrom(load_assignment);
+  }
+  return resources;
+}
+
+OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>& resourceDecoder() {
+  static auto* resource_decoder =
+      new OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>(
+          ProtobufMessage::getStrictValidationVisitor(), "cluster_name");
+  return *resource_decoder;
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
+
+// Decoding every resource of a response on the calling thread, one at a time.
+static void bmDecodeSerially(State& state) {
+  const uint32_t num_resources = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const auto resources = Envoy::Config::makeResources(num_resources);
+  for (auto _ : state) {
+    std::vector<Envoy::Config::DecodedResourceImplPtr> decoded;
+    for (const auto& resource : resources) {
+      decoded.emplace_back(new Envoy::Config::DecodedResourceImpl(
+          Envoy::Config::resourceDecoder(), resource, "version"));
+    }
+    ::benchmark::DoNotOptimize(decoded);
+  }
+}
+BENCHMARK(bmDecodeSerially)->Arg(1000)->Arg(50000)->Unit(::benchmark::kMillisecond);
+
+// Decoding a response in which every resource changed since the previous one.
+static void bmDecodeChanged(State& state) {
+  const uint32_t num_resources = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const auto resources = Envoy::Config::makeResources(num_resources);
+  Envoy::Config::DiscoveryResponseDecoder decoder(Envoy::Thread::threadFactoryForTest());
+  for (auto _ : state) {
+    decoder.clear(Envoy::Config::TypeUrl);
+    ::benchmark::DoNotOptimize(
+        decoder.decode(Envoy::Config::TypeUrl, Envoy::Config::resourceDecoder(), resources, "v"));
+  }
+}
+BENCHMARK(bmDecodeChanged)->Arg(1000)->Arg(50000)->Unit(::benchmark::kMillisecond);
+
+// Decoding a response in which no resource changed since the previous one, the common case for a
+// state-of-the-world control plane.
+static void bmDecodeUnchanged(State& state) {
+  const uint32_t num_resources = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const auto resources = Envoy::Config::makeResources(num_resources);
+  Envoy::Config::DiscoveryResponseDecoder decoder(Envoy::Thread::threadFactoryForTest());
+  decoder.decode(Envoy::Config::TypeUrl, Envoy::Config::resourceDecoder(), resources, "v");
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(
+        decoder.decode(Envoy::Config::TypeUrl, Envoy::Config::resourceDecoder(), resources, "v"));
+  }
+}
+BENCHMARK(bmDecodeUnchanged)->Arg(1000)->Arg(50000)->Unit(::benchmark::kMillisecond);
@@ -0,0 +1,152 @@
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
+
+#include "common/config/discovery_response_decoder.h"
+#include "common/config/opaque_resource_decoder_impl.h"
+#include "common/protobuf/message_validator_impl.h"
+
+#include "test/mocks/config/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+const std::string TypeUrl = "type.googleapis.com/envoy.config.endpoint.v3.ClusterLoadAssignment";
+
+class DiscoveryResponseDecoderTest : public testing::Test {
+public:
+  DiscoveryResponseDecoderTest()
+      : real_decoder_(ProtobufMessage::getStrictValidationVisitor(), "cluster_name"),
+        decoder_(Thread::threadFactoryForTest()) {
+    ON_CALL(resource_decoder_, decodeResource(_))
+        .WillByDefault(Invoke(
+            [this](const ProtobufWkt::Any& resource) -> ProtobufTypes::MessagePtr {
+              return real_decoder_.decodeResource(resource);
+            }));
+    ON_CALL(resource_decoder_, parseResource(_))
+        .WillByDefault(Invoke(
+            [this](const ProtobufWkt::Any& resource) -> ProtobufTypes::MessagePtr {
+              return real_decoder_.parseResource(resource);
+            }));
+    ON_CALL(resource_decoder_, finishResource(_))
+        .WillByDefault(Invoke([this](const Protobuf::Message& resource) {
+          real_decoder_.finishResource(resource);
+        }));
+    ON_CALL(resource_decoder_, resourceName(_))
+        .WillByDefault(Invoke([this](const Protobuf::Message& resource) {
+          return real_decoder_.resourceName(resource);
+        }));
+  }
+
+  static Protobuf::RepeatedPtrField<ProtobufWkt::Any>
+  response(const std::vector<std::string>& cluster_names) {
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+    for (const std::string& cluster_name : cluster_names) {
+      envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+      load_assignment.set_cluster_name(cluster_name);
+      resources.Add()->PackFrom(load_assignment);
+    }
+    return resources;
+  }
+
+  static std::vector<std::string> names(const std::vector<DecodedResourceImplPtr>& resources) {
+    std::vector<std::string> names;
+    for (const auto& resource : resources) {
+      names.push_back(resource->name());
+    }
+    return names;
+  }
+
+  OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment> real_decoder_;
+  NiceMock<MockOpaqueResourceDecoder> resource_decoder_;
+  DiscoveryResponseDecoder decoder_;
+};
+
+// Resources whose bytes are unchanged since the previous response reuse its decoded messages.
+TEST_F(DiscoveryResponseDecoderTest, UnchangedResourcesAreNotParsedAgain) {
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(3);
+  EXPECT_CALL(resource_decoder_, finishResource(_)).Times(3);
+  const auto first = decoder_.decode(TypeUrl, resource_decoder_, response({"a", "b", "c"}), "1");
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), names(first));
+  EXPECT_EQ("1", first[0]->version());
+
+  // Only the new resource is parsed, but every resource still goes through the main thread checks.
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(1);
+  EXPECT_CALL(resource_decoder_, finishResource(_)).Times(3);
+  const auto second = decoder_.decode(TypeUrl, resource_decoder_, response({"c", "a", "d"}), "2");
+  EXPECT_EQ((std::vector<std::string>{"c", "a", "d"}), names(second));
+  EXPECT_EQ("2", second[0]->version());
+  EXPECT_EQ(&first[2]->resource(), &second[0]->resource());
+  EXPECT_EQ(&first[0]->resource(), &second[1]->resource());
+
+  // Resources that were absent from the previous response are forgotten.
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(1);
+  decoder_.decode(TypeUrl, resource_decoder_, response({"b"}), "3");
+}
+
+// Resources are only reused within the same type.
+TEST_F(DiscoveryResponseDecoderTest, PerTypeAndClear) {
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(1);
+  decoder_.decode(TypeUrl, resource_decoder_, response({"a"}), "1");
+
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(1);
+  decoder_.decode("other_type_url", resource_decoder_, response({"a"}), "1");
+
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(0);
+  decoder_.decode(TypeUrl, resource_decoder_, response({"a"}), "2");
+
+  decoder_.clear(TypeUrl);
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(1);
+  decoder_.decode(TypeUrl, resource_decoder_, response({"a"}), "3");
+}
+
+// Resources the decoder can't parse off the main thread are decoded from scratch every time.
+TEST_F(DiscoveryResponseDecoderTest, MainThreadOnlyResources) {
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(2).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(resource_decoder_, decodeResource(_)).Times(2);
+  EXPECT_CALL(resource_decoder_, finishResource(_)).Times(0);
+  EXPECT_EQ((std::vector<std::string>{"a"}),
+            names(decoder_.decode(TypeUrl, resource_decoder_, response({"a"}), "1")));
+  EXPECT_EQ((std::vector<std::string>{"a"}),
+            names(decoder_.decode(TypeUrl, resource_decoder_, response({"a"}), "2")));
+}
+
+// A rejected response leaves the resources of the previous one available for reuse.
+TEST_F(DiscoveryResponseDecoderTest, InvalidResource) {
+  decoder_.decode(TypeUrl, resource_decoder_, response({"a", "b"}), "1");
+
+  EXPECT_THROW(decoder_.decode(TypeUrl, resource_decoder_, response({"a", ""}), "2"),
+               ProtoValidationException);
+
+  EXPECT_CALL(resource_decoder_, parseResource(_)).Times(0);
+  decoder_.decode(TypeUrl, resource_decoder_, response({"a", "b"}), "3");
+}
+
+// Large responses are parsed on the helper pool, and the result keeps response order.
+TEST_F(DiscoveryResponseDecoderTest, LargeResponse) {
+  std::vector<std::string> cluster_names;
+  for (uint32_t i = 0; i < 1000; i++) {
+    cluster_names.push_back(absl::StrCat("cluster_", i));
+  }
+  EXPECT_EQ(cluster_names,
+            names(decoder_.decode(TypeUrl, resource_decoder_, response(cluster_names), "1")));
+
+  // An invalid resource anywhere in the response is reported.
+  cluster_names[500] = "";
+  EXPECT_THROW(decoder_.decode(TypeUrl, resource_decoder_, response(cluster_names), "2"),
+               ProtoValidationException);
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
@@ -26,6 +26,7 @@
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/test_time.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -60,6 +61,7 @@ public:
   void setup() {
     grpc_mux_ = std::make_unique<GrpcMuxImpl>(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+        Thread::threadFactoryForTest(),
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
         envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true);
@@ -68,6 +70,7 @@ public:
   void setup(const RateLimitSettings& custom_rate_limit_settings) {
     grpc_mux_ = std::make_unique<GrpcMuxImpl>(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+        Thread::threadFactoryForTest(),
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
         envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, custom_rate_limit_settings,
@@ -703,6 +706,7 @@ TEST_F(GrpcMuxImplTest, BadLocalInfoEmptyClusterName) {
   EXPECT_THROW_WITH_MESSAGE(
       GrpcMuxImpl(
           local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+          Thread::threadFactoryForTest(),
           *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
               "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
           envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true),
@@ -716,6 +720,7 @@ TEST_F(GrpcMuxImplTest, BadLocalInfoEmptyNodeName) {
   EXPECT_THROW_WITH_MESSAGE(
       GrpcMuxImpl(
           local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+          Thread::threadFactoryForTest(),
           *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
               "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
           envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true),
@@ -21,6 +21,7 @@
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
 #include "test/test_common/resources.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -52,8 +53,9 @@ public:
 
     mux_ = std::make_shared<Config::GrpcMuxImpl>(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
-        *method_descriptor_, envoy::config::core::v3::ApiVersion::AUTO, random_, stats_store_,
-        rate_limit_settings_, true);
+        Thread::threadFactoryForTest(), *method_descriptor_,
+        envoy::config::core::v3::ApiVersion::AUTO, random_, stats_store_, rate_limit_settings_,
+        true);
     subscription_ = std::make_unique<GrpcSubscriptionImpl>(
         mux_, callbacks_, resource_decoder_, stats_, Config::TypeUrl::get().ClusterLoadAssignment,
         dispatcher_, init_fetch_timeout, false);
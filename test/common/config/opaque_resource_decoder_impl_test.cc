@@ -101,6 +101,48 @@ TEST_F(OpaqueResourceDecoderImplTest, Success) {
   EXPECT_EQ("foo", result.second);
 }
 
+// parseResource() followed by finishResource() decodes like decodeResource().
+TEST_F(OpaqueResourceDecoderImplTest, ParseAndFinish) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment cluster_resource;
+  cluster_resource.set_cluster_name("foo");
+  ProtobufWkt::Any opaque_resource;
+  opaque_resource.PackFrom(cluster_resource);
+  const auto parsed_resource = resource_decoder_.parseResource(opaque_resource);
+  ASSERT_NE(nullptr, parsed_resource);
+  resource_decoder_.finishResource(*parsed_resource);
+  EXPECT_THAT(*parsed_resource, ProtoEq(cluster_resource));
+  EXPECT_EQ("foo", resource_decoder_.resourceName(*parsed_resource));
+}
+
+// Resources of another type, including earlier API versions which must be upgraded on the main
+// thread, and empty resources are left to decodeResource().
+TEST_F(OpaqueResourceDecoderImplTest, ParseOtherType) {
+  ProtobufWkt::Any opaque_resource;
+  EXPECT_EQ(nullptr, resource_decoder_.parseResource(opaque_resource));
+  opaque_resource.set_type_url("type.googleapis.com/envoy.api.v2.ClusterLoadAssignment");
+  EXPECT_EQ(nullptr, resource_decoder_.parseResource(opaque_resource));
+}
+
+// parseResource() checks protoc-gen-validate constraints.
+TEST_F(OpaqueResourceDecoderImplTest, ParseValidateFail) {
+  ProtobufWkt::Any opaque_resource;
+  opaque_resource.PackFrom(envoy::config::endpoint::v3::ClusterLoadAssignment());
+  EXPECT_THROW(resource_decoder_.parseResource(opaque_resource), ProtoValidationException);
+}
+
+// finishResource() performs the unknown field checks.
+TEST_F(OpaqueResourceDecoderImplTest, FinishUnknownFields) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment strange_resource;
+  strange_resource.set_cluster_name("fare");
+  strange_resource.GetReflection()->MutableUnknownFields(&strange_resource)->AddFixed32(1000, 1);
+  ProtobufWkt::Any opaque_resource;
+  opaque_resource.PackFrom(strange_resource);
+  const auto parsed_resource = resource_decoder_.parseResource(opaque_resource);
+  ASSERT_NE(nullptr, parsed_resource);
+  EXPECT_THROW_WITH_REGEX(resource_decoder_.finishResource(*parsed_resource), EnvoyException,
+                          "has unknown fields");
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
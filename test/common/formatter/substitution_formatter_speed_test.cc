@@ -1,8 +1,10 @@
 #include "common/formatter/substitution_formatter.h"
 #include "common/network/address_impl.h"
 
+#include "test/common/stats/stat_test_utility.h"
 #include "test/common/stream_info/test_util.h"
 #include "test/mocks/http/mocks.h"
+#include "test/test_common/test_runtime.h"
 
 #include "benchmark/benchmark.h"
 
@@ -10,6 +12,12 @@ namespace Envoy {
 
 namespace {
 
+static const char* LogFormat =
+    "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% %START_TIME(%Y/%m/%dT%H:%M:%S%z %s)% "
+    "%REQ(:METHOD)% "
+    "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)% %PROTOCOL% "
+    "s%RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQ(REFERER)% \"%REQ(USER-AGENT)%\" - - -\n";
+
 std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> makeJsonFormatter(bool typed) {
   ProtobufWkt::Struct JsonLogFormat;
   const std::string format_yaml = R"EOF(
@@ -35,17 +43,38 @@ std::unique_ptr<Envoy::TestStreamInfo> makeStreamInfo() {
   return stream_info;
 }
 
+// Reports the heap bytes a formatted line holds on to, on average, as the allocated_bytes_per_line
+// counter. format_line formats a line and returns the bytes allocated while the line is still
+// alive; allocations freed before then are not counted. This is 0 when the allocator doesn't report
+// memory usage.
+template <class FormatLine>
+void reportAllocatedBytesPerLine(benchmark::State& state, FormatLine format_line) {
+  constexpr int NumLines = 100;
+  int64_t allocated_bytes = 0;
+  for (int i = 0; i < NumLines; i++) {
+    allocated_bytes += format_line();
+  }
+  state.counters["allocated_bytes_per_line"] = static_cast<double>(allocated_bytes) / NumLines;
+}
+
+// Formats a line with format(), and returns the bytes allocated while it is alive.
+int64_t allocatedBytesOfFormat(const Envoy::Formatter::Formatter& formatter,
+                               const StreamInfo::StreamInfo& stream_info) {
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  Stats::TestUtil::MemoryTest memory_test;
+  const std::string line =
+      formatter.format(request_headers, response_headers, response_trailers, stream_info, "");
+  benchmark::DoNotOptimize(line.data());
+  return static_cast<int64_t>(memory_test.consumedBytes());
+}
+
 } // namespace
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_AccessLogFormatter(benchmark::State& state) {
   std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
-  static const char* LogFormat =
-      "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% %START_TIME(%Y/%m/%dT%H:%M:%S%z %s)% "
-      "%REQ(:METHOD)% "
-      "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)% %PROTOCOL% "
-      "s%RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQ(REFERER)% \"%REQ(USER-AGENT)%\" - - -\n";
-
   std::unique_ptr<Envoy::Formatter::FormatterImpl> formatter =
       std::make_unique<Envoy::Formatter::FormatterImpl>(LogFormat, false);
 
@@ -60,9 +89,42 @@ static void BM_AccessLogFormatter(benchmark::State& state) {
             .length();
   }
   benchmark::DoNotOptimize(output_bytes);
+  reportAllocatedBytesPerLine(
+      state, [&]() { return allocatedBytesOfFormat(*formatter, *stream_info); });
 }
 BENCHMARK(BM_AccessLogFormatter);
 
+// Appending log lines to a reused string, which avoids the intermediate string of each field and
+// the allocation of each line.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_AccessLogFormatterFormatTo(benchmark::State& state) {
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
+  std::unique_ptr<Envoy::Formatter::FormatterImpl> formatter =
+      std::make_unique<Envoy::Formatter::FormatterImpl>(LogFormat, false);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  std::string log_line;
+  for (auto _ : state) {
+    log_line.clear();
+    formatter->formatTo(request_headers, response_headers, response_trailers, *stream_info, body,
+                        log_line);
+    output_bytes += log_line.length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+  reportAllocatedBytesPerLine(state, [&]() -> int64_t {
+    Stats::TestUtil::MemoryTest memory_test;
+    log_line.clear();
+    formatter->formatTo(request_headers, response_headers, response_trailers, *stream_info, body,
+                        log_line);
+    return static_cast<int64_t>(memory_test.consumedBytes());
+  });
+}
+BENCHMARK(BM_AccessLogFormatterFormatTo);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_JsonAccessLogFormatter(benchmark::State& state) {
   std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
@@ -80,9 +142,38 @@ static void BM_JsonAccessLogFormatter(benchmark::State& state) {
             .length();
   }
   benchmark::DoNotOptimize(output_bytes);
+  reportAllocatedBytesPerLine(
+      state, [&]() { return allocatedBytesOfFormat(*json_formatter, *stream_info); });
 }
 BENCHMARK(BM_JsonAccessLogFormatter);
 
+// JSON log lines built as a ProtobufWkt::Struct and serialized, as they were before being written
+// directly.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_SerializedJsonAccessLogFormatter(benchmark::State& state) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.json_formatter_direct_write", "false"}});
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
+  std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> json_formatter = makeJsonFormatter(false);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) {
+    output_bytes +=
+        json_formatter
+            ->format(request_headers, response_headers, response_trailers, *stream_info, body)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+  reportAllocatedBytesPerLine(
+      state, [&]() { return allocatedBytesOfFormat(*json_formatter, *stream_info); });
+}
+BENCHMARK(BM_SerializedJsonAccessLogFormatter);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
   std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
@@ -101,6 +192,8 @@ static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
             .length();
   }
   benchmark::DoNotOptimize(output_bytes);
+  reportAllocatedBytesPerLine(
+      state, [&]() { return allocatedBytesOfFormat(*typed_json_formatter, *stream_info); });
 }
 BENCHMARK(BM_TypedJsonAccessLogFormatter);
 
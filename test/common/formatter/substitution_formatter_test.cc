@@ -19,6 +19,7 @@
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stream_info/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
@@ -2283,6 +2284,107 @@ TEST(SubstitutionFormatterTest, CompositeFormatterEmpty) {
   }
 }
 
+// formatTo() appends what format() returns, and nothing when format() has no value.
+TEST(SubstitutionFormatterTest, FormatToMatchesFormat) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  stream_info.end_time_ = std::chrono::milliseconds(25);
+  stream_info.protocol_ = Http::Protocol::Http2;
+  stream_info.addBytesSent(1234);
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"},
+                                                 {"x-long", "0123456789"}};
+  Http::TestResponseHeaderMapImpl response_headers{{"grpc-status", "14"}};
+  Http::TestResponseTrailerMapImpl response_trailers{{"x-trailer", "trailer"}};
+  const std::string body = "body";
+
+  const std::vector<std::string> formats = {
+      "plain",
+      "%REQ(:METHOD)%",
+      "%REQ(X-MISSING?X-LONG):4%",
+      "%REQ(X-MISSING)%",
+      "%RESP(GRPC-STATUS)%",
+      "%TRAILER(X-TRAILER)%",
+      "%LOCAL_REPLY_BODY%",
+      "%GRPC_STATUS%",
+      "%START_TIME(%s)%",
+      "%DURATION%",
+      "%REQUEST_DURATION%",
+      "%RESPONSE_CODE%",
+      "%BYTES_SENT%",
+      "%PROTOCOL%",
+      "%RESPONSE_FLAGS%",
+      "%UPSTREAM_HOST%",
+      "%DOWNSTREAM_REMOTE_ADDRESS%",
+      "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%",
+      "%DOWNSTREAM_LOCAL_PORT%",
+      "%DOWNSTREAM_PEER_SUBJECT%",
+      "%DYNAMIC_METADATA(com.test)%",
+      "%FILTER_STATE(testing)%",
+  };
+  for (const std::string& format : formats) {
+    SCOPED_TRACE(format);
+    const std::vector<FormatterProviderPtr> providers = SubstitutionFormatParser::parse(format);
+    ASSERT_EQ(1U, providers.size());
+    const absl::optional<std::string> value = providers[0]->format(
+        request_headers, response_headers, response_trailers, stream_info, body);
+
+    std::string output = "prefix:";
+    EXPECT_EQ(value.has_value(), providers[0]->formatTo(request_headers, response_headers,
+                                                        response_trailers, stream_info, body,
+                                                        output));
+    EXPECT_EQ(absl::StrCat("prefix:", value.value_or("")), output);
+  }
+}
+
+// JSON log lines written directly have the same content as those serialized from a Struct.
+TEST(SubstitutionFormatterTest, JsonFormatterDirectWrite) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  stream_info.protocol_ = Http::Protocol::Http11;
+  Http::TestRequestHeaderMapImpl request_headers{{"x-escaped", "\"a\\b\"\n\x01"},
+                                                 {"user-agent", "agent"}};
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    escaped: '%REQ(X-ESCAPED)%'
+    missing: '%REQ(X-MISSING)%'
+    code: '%RESPONSE_CODE%'
+    duration: '%REQUEST_DURATION%'
+    mixed: '%REQ(USER-AGENT)% %REQ(X-MISSING)%'
+    nested:
+      protocol: '%PROTOCOL%'
+  )EOF",
+                            key_mapping);
+
+  const auto format = [&](bool preserve_types, bool omit_empty_values) {
+    JsonFormatterImpl formatter(key_mapping, preserve_types, omit_empty_values);
+    return formatter.format(request_headers, response_headers, response_trailers, stream_info,
+                            body);
+  };
+  for (const bool preserve_types : {false, true}) {
+    for (const bool omit_empty_values : {false, true}) {
+      SCOPED_TRACE(absl::StrCat(preserve_types, omit_empty_values));
+      const std::string direct = format(preserve_types, omit_empty_values);
+      std::string serialized;
+      {
+        TestScopedRuntime scoped_runtime;
+        Runtime::LoaderSingleton::getExisting()->mergeValues(
+            {{"envoy.reloadable_features.json_formatter_direct_write", "false"}});
+        serialized = format(preserve_types, omit_empty_values);
+      }
+      EXPECT_TRUE(TestUtility::jsonStringEqual(direct, serialized)) << direct << serialized;
+      EXPECT_EQ('\n', direct.back());
+    }
+  }
+
+  EXPECT_EQ("{\"code\":200,\"escaped\":\"\\\"a\\\\b\\\"\\n\\u0001\",\"mixed\":\"agent \","
+            "\"nested\":{\"protocol\":\"HTTP/1.1\"}}\n",
+            format(true, true));
+}
+
 TEST(SubstitutionFormatterTest, ParserFailures) {
   SubstitutionFormatParser parser;
 
@@ -1879,6 +1879,138 @@ TEST_F(HttpConnectionManagerImplTest, TestAccessLogSsl) {
   conn_manager_->onData(fake_input, false);
 }
 
+// A request that is not traced is still sampled if it fails, when tail sampling is configured.
+TEST_F(HttpConnectionManagerImplTest, TailSampleServerError) {
+  setup(false, "");
+
+  envoy::type::v3::FractionalPercent percent;
+  percent.set_numerator(100);
+  tracing_config_ = std::make_unique<TracingConnectionManagerConfig>(
+      TracingConnectionManagerConfig{Tracing::OperationName::Ingress,
+                                     {},
+                                     percent,
+                                     percent,
+                                     percent,
+                                     false,
+                                     256,
+                                     TracingTailSamplingConfig{absl::nullopt, true, false}});
+  EXPECT_CALL(
+      runtime_.snapshot_,
+      featureEnabled("tracing.global_enabled", An<const envoy::type::v3::FractionalPercent&>(), _))
+      .WillOnce(Return(false));
+  ON_CALL(*tracer_, supportsTailSampling()).WillByDefault(Return(true));
+
+  auto* span = new NiceMock<Tracing::MockSpan>();
+  EXPECT_CALL(*tracer_, startSpan_(_, _, _, _))
+      .WillOnce(Invoke([&](const Tracing::Config&, const HeaderMap&, const StreamInfo::StreamInfo&,
+                           const Tracing::Decision decision) -> Tracing::Span* {
+        EXPECT_FALSE(decision.traced);
+        EXPECT_TRUE(decision.tail_sampling);
+        return span;
+      }));
+  {
+    InSequence s;
+    EXPECT_CALL(*span, setSampled(true));
+    EXPECT_CALL(*span, finishSpan());
+  }
+
+  std::shared_ptr<MockStreamDecoderFilter> filter(new NiceMock<MockStreamDecoderFilter>());
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(filter);
+      }));
+
+  EXPECT_CALL(*codec_, dispatch(_))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> Http::Status {
+        decoder_ = &conn_manager_->newStream(response_encoder_);
+
+        RequestHeaderMapPtr headers{
+            new TestRequestHeaderMapImpl{{":method", "GET"},
+                                         {":authority", "host"},
+                                         {":path", "/"},
+                                         {"x-request-id", "125a4afb-6f55-44ba-ad80-413f09f48a28"}}};
+        decoder_->decodeHeaders(std::move(headers), true);
+
+        filter->callbacks_->streamInfo().setResponseCodeDetails("");
+        ResponseHeaderMapPtr response_headers{new TestResponseHeaderMapImpl{{":status", "503"}}};
+        filter->callbacks_->encodeHeaders(std::move(response_headers), true, "details");
+
+        data.drain(4);
+        return Http::okStatus();
+      }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_EQ(1UL, tracing_stats_.not_traceable_.value());
+  EXPECT_EQ(1UL, tracing_stats_.tail_sampled_.value());
+}
+
+// A request that is not traced isn't tail sampled by a tracer that doesn't support it, e.g. one
+// that doesn't record the spans of traces that aren't sampled.
+TEST_F(HttpConnectionManagerImplTest, TailSampleUnsupportedByTracer) {
+  setup(false, "");
+
+  envoy::type::v3::FractionalPercent percent;
+  percent.set_numerator(100);
+  tracing_config_ = std::make_unique<TracingConnectionManagerConfig>(
+      TracingConnectionManagerConfig{Tracing::OperationName::Ingress,
+                                     {},
+                                     percent,
+                                     percent,
+                                     percent,
+                                     false,
+                                     256,
+                                     TracingTailSamplingConfig{absl::nullopt, true, false}});
+  EXPECT_CALL(
+      runtime_.snapshot_,
+      featureEnabled("tracing.global_enabled", An<const envoy::type::v3::FractionalPercent&>(), _))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*tracer_, supportsTailSampling()).WillOnce(Return(false));
+
+  auto* span = new NiceMock<Tracing::MockSpan>();
+  EXPECT_CALL(*tracer_, startSpan_(_, _, _, _))
+      .WillOnce(Invoke([&](const Tracing::Config&, const HeaderMap&, const StreamInfo::StreamInfo&,
+                           const Tracing::Decision decision) -> Tracing::Span* {
+        EXPECT_FALSE(decision.traced);
+        EXPECT_FALSE(decision.tail_sampling);
+        return span;
+      }));
+  EXPECT_CALL(*span, setSampled(_)).Times(0);
+  EXPECT_CALL(*span, finishSpan());
+
+  std::shared_ptr<MockStreamDecoderFilter> filter(new NiceMock<MockStreamDecoderFilter>());
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(filter);
+      }));
+
+  EXPECT_CALL(*codec_, dispatch(_))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> Http::Status {
+        decoder_ = &conn_manager_->newStream(response_encoder_);
+
+        RequestHeaderMapPtr headers{
+            new TestRequestHeaderMapImpl{{":method", "GET"},
+                                         {":authority", "host"},
+                                         {":path", "/"},
+                                         {"x-request-id", "125a4afb-6f55-44ba-ad80-413f09f48a28"}}};
+        decoder_->decodeHeaders(std::move(headers), true);
+
+        filter->callbacks_->streamInfo().setResponseCodeDetails("");
+        ResponseHeaderMapPtr response_headers{new TestResponseHeaderMapImpl{{":status", "503"}}};
+        filter->callbacks_->encodeHeaders(std::move(response_headers), true, "details");
+
+        data.drain(4);
+        return Http::okStatus();
+      }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_EQ(1UL, tracing_stats_.not_traceable_.value());
+  EXPECT_EQ(0UL, tracing_stats_.tail_sampled_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, DoNotStartSpanIfTracingIsNotEnabled) {
   setup(false, "");
 
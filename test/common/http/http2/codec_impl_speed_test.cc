@@ -0,0 +1,160 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/core/v3/protocol.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/random_generator.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/http/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using ::benchmark::State;
+using Envoy::benchmark::skipExpensiveBenchmarks;
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// Delivers the bytes one codec writes to the other codec, buffering the writes made while the other
+// codec is itself dispatching.
+class Pipe {
+public:
+  void write(Buffer::Instance& data, Connection& codec) {
+    buffer_.move(data);
+    if (dispatching_) {
+      return;
+    }
+    dispatching_ = true;
+    while (buffer_.length() > 0) {
+      const Status status = codec.dispatch(buffer_);
+      RELEASE_ASSERT(status.ok(), std::string(status.message()));
+    }
+    dispatching_ = false;
+  }
+
+private:
+  Buffer::OwnedImpl buffer_;
+  bool dispatching_{};
+};
+
+// A client and a server codec connected back to back, used to download response bodies.
+class Http2CodecSpeedTest {
+public:
+  Http2CodecSpeedTest()
+      : client_stats_(CodecStats::atomicGet(client_stats_ptr_, store_)),
+        server_stats_(CodecStats::atomicGet(server_stats_ptr_, store_)) {
+    // Large windows, so that the benchmark measures the DATA path rather than WINDOW_UPDATEs.
+    envoy::config::core::v3::Http2ProtocolOptions options;
+    options.mutable_initial_stream_window_size()->set_value(16 * 1024 * 1024);
+    options.mutable_initial_connection_window_size()->set_value(16 * 1024 * 1024);
+    options = ::Envoy::Http2::Utility::initializeAndValidateOptions(options);
+
+    client_ = std::make_unique<ClientConnectionImpl>(
+        client_connection_, client_callbacks_, client_stats_, random_, options,
+        Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+        ProdNghttp2SessionFactory::get());
+    server_ = std::make_unique<ServerConnectionImpl>(
+        server_connection_, server_callbacks_, server_stats_, random_, options,
+        Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+        envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(
+            Invoke([this](Buffer::Instance& data, bool) { to_server_.write(data, *server_); }));
+    ON_CALL(server_connection_, write(_, _))
+        .WillByDefault(
+            Invoke([this](Buffer::Instance& data, bool) { to_client_.write(data, *client_); }));
+    ON_CALL(server_callbacks_, newStream(_, _))
+        .WillByDefault(Invoke([this](ResponseEncoder& encoder, bool) -> RequestDecoder& {
+          response_encoder_ = &encoder;
+          return request_decoder_;
+        }));
+    ON_CALL(response_decoder_, decodeData(_, _))
+        .WillByDefault(
+            Invoke([this](Buffer::Instance& data, bool) { received_bytes_ += data.length(); }));
+  }
+
+  // Downloads a response body of body_size bytes, which the server holds in slices of slice_size
+  // bytes.
+  void download(uint64_t body_size, uint64_t slice_size) {
+    static const std::string payload(MaxSliceSize, 'a');
+    RELEASE_ASSERT(slice_size <= MaxSliceSize, "");
+    Buffer::OwnedImpl body;
+    for (uint64_t offset = 0; offset < body_size; offset += slice_size) {
+      const uint64_t size = std::min(slice_size, body_size - offset);
+      body.addBufferFragment(*new Buffer::BufferFragmentImpl(
+          payload.data(), size,
+          [](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+            delete fragment;
+          }));
+    }
+
+    received_bytes_ = 0;
+    RequestEncoder& request_encoder = client_->newStream(response_decoder_);
+    TestRequestHeaderMapImpl request_headers{
+        {":method", "GET"}, {":path", "/"}, {":scheme", "http"}, {":authority", "host"}};
+    request_encoder.encodeHeaders(request_headers, true);
+    TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+    response_encoder_->encodeHeaders(response_headers, false);
+    response_encoder_->encodeData(body, true);
+    RELEASE_ASSERT(received_bytes_ == body_size, "");
+  }
+
+private:
+  static constexpr uint64_t MaxSliceSize = 64 * 1024;
+
+  Stats::IsolatedStoreImpl store_;
+  CodecStats::AtomicPtr client_stats_ptr_;
+  CodecStats::AtomicPtr server_stats_ptr_;
+  CodecStats& client_stats_;
+  CodecStats& server_stats_;
+  Random::RandomGeneratorImpl random_;
+  NiceMock<Network::MockConnection> client_connection_;
+  NiceMock<Network::MockConnection> server_connection_;
+  NiceMock<MockConnectionCallbacks> client_callbacks_;
+  NiceMock<MockServerConnectionCallbacks> server_callbacks_;
+  NiceMock<MockRequestDecoder> request_decoder_;
+  NiceMock<MockResponseDecoder> response_decoder_;
+  std::unique_ptr<ClientConnectionImpl> client_;
+  std::unique_ptr<ServerConnectionImpl> server_;
+  Pipe to_client_;
+  Pipe to_server_;
+  ResponseEncoder* response_encoder_{};
+  uint64_t received_bytes_{};
+};
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
+
+// Response body throughput through a client and a server codec. Frames that don't line up with the
+// slices of the body being sent, and DATA payloads spanning input slices, are where copies happen.
+// Args: body size, size of the slices holding the body.
+static void bmDownload(State& state) {
+  const uint64_t body_size = skipExpensiveBenchmarks() ? 1024 : state.range(0);
+  Envoy::Http::Http2::Http2CodecSpeedTest speed_test;
+  for (auto _ : state) {
+    speed_test.download(body_size, state.range(1));
+  }
+  state.SetBytesProcessed(state.iterations() * body_size);
+}
+BENCHMARK(bmDownload)
+    ->Args({1 << 20, 16384})
+    ->Args({1 << 20, 10000})
+    ->Args({1 << 20, 65536})
+    ->Args({16 << 20, 10000})
+    ->Unit(::benchmark::kMicrosecond);
@@ -77,6 +77,9 @@ public:
     Http::Status dispatch(const Buffer::Instance& data, Connection& connection) {
       Http::Status status = Http::okStatus();
       buffer_.add(data);
+      if (linearize_ && buffer_.length() > 0) {
+        buffer_.linearize(buffer_.length());
+      }
       if (!dispatching_) {
         while (buffer_.length() > 0) {
           dispatching_ = true;
@@ -92,6 +95,9 @@ public:
     }
 
     bool dispatching_{};
+    // Whether to dispatch the data written at once in a single slice, as if it was read into a
+    // large slice from a socket, rather than in the slices it was copied into.
+    bool linearize_{};
     Buffer::OwnedImpl buffer_;
   };
 
@@ -279,6 +285,74 @@ public:
       : Http2CodecImplTestFixture(::testing::get<0>(GetParam()), ::testing::get<1>(GetParam())) {}
 
 protected:
+  // Sends large request and response bodies, made of odd sized slices, and checks that they arrive
+  // intact, and whether their DATA payloads reference the input they were received in.
+  void largeBodies(bool zero_copy_data) {
+    client_wrapper_.linearize_ = true;
+    server_wrapper_.linearize_ = true;
+    initialize();
+
+    std::string body;
+    for (uint32_t i = 0; i < 256 * 1024; i++) {
+      body.push_back('a' + i % 23);
+    }
+    const auto fill = [&body](Buffer::OwnedImpl& buffer) {
+      for (size_t offset = 0; offset < body.size(); offset += 5003) {
+        buffer.appendSliceForTest(body.substr(offset, 5003));
+      }
+    };
+    // Slices referencing the input are exactly as large as the payload they hold, unlike the
+    // slices payloads are copied into.
+    const auto count_input_slices = [](Buffer::Instance& data) -> uint64_t {
+      uint64_t count = 0;
+      for (const auto& slice : dynamic_cast<Buffer::OwnedImpl&>(data).describeSlicesForTest()) {
+        if (slice.data >= 8 * 1024 && slice.capacity == slice.data && slice.reservable == 0) {
+          count++;
+        }
+      }
+      return count;
+    };
+
+    std::string received_request_body;
+    uint64_t request_input_slices = 0;
+    TestRequestHeaderMapImpl request_headers;
+    HttpTestUtility::addDefaultHeaders(request_headers, "POST");
+    EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+    request_encoder_->encodeHeaders(request_headers, false);
+    EXPECT_CALL(request_decoder_, decodeData(_, _))
+        .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) {
+          received_request_body.append(data.toString());
+          request_input_slices += count_input_slices(data);
+        }));
+    Buffer::OwnedImpl request_body;
+    fill(request_body);
+    request_encoder_->encodeData(request_body, true);
+    EXPECT_EQ(body, received_request_body);
+
+    std::string received_response_body;
+    uint64_t response_input_slices = 0;
+    TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+    EXPECT_CALL(response_decoder_, decodeHeaders_(_, false));
+    response_encoder_->encodeHeaders(response_headers, false);
+    EXPECT_CALL(response_decoder_, decodeData(_, _))
+        .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) {
+          received_response_body.append(data.toString());
+          response_input_slices += count_input_slices(data);
+        }));
+    Buffer::OwnedImpl response_body;
+    fill(response_body);
+    response_encoder_->encodeData(response_body, true);
+    EXPECT_EQ(body, received_response_body);
+
+    if (zero_copy_data) {
+      EXPECT_GT(request_input_slices, 0);
+      EXPECT_GT(response_input_slices, 0);
+    } else {
+      EXPECT_EQ(0, request_input_slices);
+      EXPECT_EQ(0, response_input_slices);
+    }
+  }
+
   void priorityFlood() {
     initialize();
 
@@ -786,6 +860,15 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeClientBody) {
   response_encoder_->encodeTrailers(TestResponseTrailerMapImpl{{"trailing", "header"}});
 }
 
+TEST_P(Http2CodecImplTest, LargeBodies) { largeBodies(true); }
+
+TEST_P(Http2CodecImplTest, LargeBodiesWithoutZeroCopyData) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.http2_zero_copy_data", "false"}});
+  largeBodies(false);
+}
+
 TEST_P(Http2CodecImplTest, SmallMetadataVecTest) {
   allow_metadata_ = true;
   initialize();
@@ -4,6 +4,7 @@
 #include "common/common/assert.h"
 #include "common/router/config_impl.h"
 
+#include "test/benchmark/main.h"
 #include "test/mocks/server/instance.h"
 #include "test/mocks/stream_info/mocks.h"
 #include "test/test_common/test_runtime.h"
@@ -144,6 +145,67 @@ BENCHMARK(bmRouteTableSizeWithPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1,
 BENCHMARK(bmRouteTableSizeWithExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithRegexMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 
+/**
+ * Generates a route config with `num_vhosts` virtual hosts of `routes_per_vhost` regex routes each.
+ */
+static RouteConfiguration genLargeRouteConfig(int num_vhosts, int routes_per_vhost) {
+  RouteConfiguration route_config;
+  route_config.set_name("large");
+  for (int i = 0; i < num_vhosts; ++i) {
+    VirtualHost* v_host = route_config.add_virtual_hosts();
+    v_host->set_name(absl::StrCat("vhost_", i));
+    v_host->add_domains(absl::StrCat("www.", i, ".com"));
+    for (int j = 0; j < routes_per_vhost; ++j) {
+      Route* route = v_host->add_routes();
+      route->mutable_direct_response()->set_status(200);
+      envoy::type::matcher::v3::RegexMatcher* regex =
+          route->mutable_match()->mutable_safe_regex();
+      regex->mutable_google_re2();
+      regex->set_regex(absl::StrCat("^/shelves/[^\\\\/]+/route_", j, "$"));
+    }
+  }
+  return route_config;
+}
+
+/**
+ * Measure the latency of applying a route config update that changes a single virtual host, as
+ * a function of the total number of virtual hosts. state.range(1) selects whether the previous
+ * config is passed in so that unchanged virtual hosts are shared (1) or not (0).
+ */
+static void bmRouteConfigUpdate(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  TestScopedRuntime scoped_runtime;
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+  const bool share_virtual_hosts = state.range(1) != 0;
+
+  RouteConfiguration route_config = genLargeRouteConfig(state.range(0), 10);
+  auto config = std::make_unique<ConfigImpl>(
+      route_config, factory_context, ProtobufMessage::getNullValidationVisitor(), false);
+
+  uint32_t version = 0;
+  for (auto _ : state) { // NOLINT
+    state.PauseTiming();
+    route_config.mutable_virtual_hosts(0)->mutable_routes(0)->mutable_direct_response()->set_status(
+        200 + (++version % 100));
+    state.ResumeTiming();
+
+    config = std::make_unique<ConfigImpl>(route_config, factory_context,
+                                          ProtobufMessage::getNullValidationVisitor(), false,
+                                          share_virtual_hosts ? config.get() : nullptr);
+  }
+}
+
+BENCHMARK(bmRouteConfigUpdate)
+    ->RangeMultiplier(8)
+    ->Ranges({{1, 4096}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace
 } // namespace Router
 } // namespace Envoy
@@ -6235,6 +6235,68 @@ virtual_hosts:
   EXPECT_EQ("foo", route_entry->virtualHost().routeConfig().name());
 }
 
+// Unchanged virtual hosts are shared with a previous version of the same route configuration.
+TEST_F(RouteConfigurationV2, SharesUnchangedVirtualHosts) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: foo
+    domains: [foo.com]
+    routes:
+      - match: { prefix: "/"}
+        route: { cluster: foo }
+  - name: bar
+    domains: [bar.com]
+    routes:
+      - match: { prefix: "/"}
+        route: { cluster: bar }
+  )EOF";
+  auto route_config = parseRouteConfigurationFromYaml(yaml);
+  auto config1 = std::make_unique<ConfigImpl>(
+      route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(), false);
+  EXPECT_EQ(0, config1->reusedVirtualHosts());
+  const auto* foo_vhost1 =
+      &config1->route(genHeaders("foo.com", "/", "GET"), 0)->routeEntry()->virtualHost();
+
+  // Only the "bar" virtual host changes.
+  route_config.mutable_virtual_hosts(1)->mutable_routes(0)->mutable_route()->set_cluster("baz");
+  auto config2 = std::make_unique<ConfigImpl>(
+      route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(), false,
+      config1.get());
+  EXPECT_EQ(1, config2->reusedVirtualHosts());
+  EXPECT_EQ(foo_vhost1,
+            &config2->route(genHeaders("foo.com", "/", "GET"), 0)->routeEntry()->virtualHost());
+  EXPECT_EQ("baz",
+            config2->route(genHeaders("bar.com", "/", "GET"), 0)->routeEntry()->clusterName());
+
+  // Shared virtual hosts outlive the config that created them.
+  config1.reset();
+  const auto route = config2->route(genHeaders("foo.com", "/", "GET"), 0);
+  EXPECT_EQ("foo", route->routeEntry()->clusterName());
+  EXPECT_EQ("foo", route->routeEntry()->virtualHost().routeConfig().name());
+
+  // A change to the RouteConfiguration level settings invalidates all virtual hosts.
+  route_config.add_internal_only_headers("x-internal");
+  ConfigImpl config3(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                     false, config2.get());
+  EXPECT_EQ(0, config3.reusedVirtualHosts());
+  EXPECT_EQ(1, config3.route(genHeaders("foo.com", "/", "GET"), 0)
+                   ->routeEntry()
+                   ->virtualHost()
+                   .routeConfig()
+                   .internalOnlyHeaders()
+                   .size());
+
+  // Virtual hosts are never shared when clusters are validated.
+  ConfigImpl config4(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                     false, &config3);
+  EXPECT_EQ(2, config4.reusedVirtualHosts());
+  route_config.mutable_validate_clusters()->set_value(true);
+  ConfigImpl config5(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                     false, &config4);
+  EXPECT_EQ(0, config5.reusedVirtualHosts());
+}
+
 TEST_F(RouteConfigurationV2, RouteTracingConfig) {
   const std::string yaml = R"EOF(
 virtual_hosts:
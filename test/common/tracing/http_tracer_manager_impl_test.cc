@@ -26,6 +26,7 @@ public:
                     const Tracing::Decision) override {
     return nullptr;
   }
+  bool supportsTailSampling() const override { return false; }
 };
 
 class SampleTracerFactory : public Server::Configuration::TracerFactory {
@@ -24,6 +24,7 @@
 using testing::_;
 using testing::InSequence;
 using testing::Return;
+using testing::SizeIs;
 using testing::StrEq;
 using testing::Throw;
 
@@ -46,11 +47,12 @@ protected:
   }
 
   void expectAdd(const std::string& cluster_name, const std::string& version = std::string("")) {
-    EXPECT_CALL(cm_, addOrUpdateCluster(WithName(cluster_name), version)).WillOnce(Return(true));
+    EXPECT_CALL(cm_, addOrUpdateCluster(WithName(cluster_name), version, _))
+        .WillOnce(Return(true));
   }
 
   void expectAddToThrow(const std::string& cluster_name, const std::string& exception_msg) {
-    EXPECT_CALL(cm_, addOrUpdateCluster(WithName(cluster_name), _))
+    EXPECT_CALL(cm_, addOrUpdateCluster(WithName(cluster_name), _, _))
         .WillOnce(Throw(EnvoyException(exception_msg)));
   }
 
@@ -134,6 +136,27 @@ TEST_F(CdsApiImplTest, ValidateDuplicateClusters) {
                             "duplicate_cluster found");
 }
 
+// Validate that the whole update is hashed in one batch and each hash is passed to the cluster
+// manager along with its cluster.
+TEST_F(CdsApiImplTest, ConfigUpdateHashesClustersInBatch) {
+  InSequence s;
+
+  setup();
+
+  envoy::config::cluster::v3::Cluster cluster_1;
+  cluster_1.set_name("cluster_1");
+  envoy::config::cluster::v3::Cluster cluster_2;
+  cluster_2.set_name("cluster_2");
+  const auto decoded_resources = TestUtility::decodeResources({cluster_1, cluster_2});
+
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(ClusterManager::ClusterInfoMap{}));
+  EXPECT_CALL(cm_, hashClusters(SizeIs(2))).WillOnce(Return(std::vector<uint64_t>{11, 22}));
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster_1"), "", 11)).WillOnce(Return(true));
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster_2"), "", 22)).WillOnce(Return(true));
+  EXPECT_CALL(initialized_, ready());
+  cds_callbacks_->onConfigUpdate(decoded_resources.refvec_, "");
+}
+
 TEST_F(CdsApiImplTest, EmptyConfigUpdate) {
   InSequence s;
 
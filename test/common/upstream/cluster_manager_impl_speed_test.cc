@@ -0,0 +1,129 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+#include "envoy/config/cluster/v3/cluster.pb.h"
+
+#include "common/grpc/context_impl.h"
+#include "common/http/context_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/common/upstream/test_cluster_manager.h"
+#include "test/common/upstream/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using ::benchmark::State;
+using Envoy::benchmark::skipExpensiveBenchmarks;
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+class ClusterManagerSpeedTest {
+public:
+  explicit ClusterManagerSpeedTest(uint32_t num_clusters)
+      : http_context_(factory_.stats_.symbolTable()),
+        grpc_context_(factory_.stats_.symbolTable()) {
+    cluster_manager_ = std::make_unique<TestClusterManagerImpl>(
+        bootstrap_, factory_, factory_.stats_, factory_.tls_, factory_.runtime_,
+        factory_.local_info_, log_manager_, factory_.dispatcher_, admin_, validation_context_,
+        *factory_.api_, http_context_, grpc_context_);
+
+    // A CDS response in the shape of a large mesh: many small static clusters whose configs are
+    // dominated by endpoints and per-cluster settings that all need to be hashed.
+    clusters_.reserve(num_clusters);
+    for (uint32_t i = 0; i < num_clusters; i++) {
+      envoy::config::cluster::v3::Cluster cluster = defaultStaticCluster(absl::StrCat("c", i));
+      cluster.mutable_connect_timeout()->set_seconds(i % 10 + 1);
+      cluster.mutable_circuit_breakers()->add_thresholds()->mutable_max_connections()->set_value(
+          1024 + i);
+      auto* endpoints = cluster.mutable_load_assignment()->mutable_endpoints(0);
+      for (uint32_t j = 0; j < 8; j++) {
+        auto* socket_address = endpoints->add_lb_endpoints()
+                                   ->mutable_endpoint()
+                                   ->mutable_address()
+                                   ->mutable_socket_address();
+        socket_address->set_address(absl::StrCat("10.", i / 256 % 256, ".", i % 256, ".", j));
+        socket_address->set_port_value(8000 + j);
+      }
+      clusters_.push_back(std::move(cluster));
+    }
+  }
+
+  // Adds or updates every cluster, one addOrUpdateCluster() call at a time.
+  void applySerially() {
+    for (const auto& cluster : clusters_) {
+      cluster_manager_->addOrUpdateCluster(cluster, "");
+    }
+  }
+
+  // Adds or updates every cluster after hashing the whole batch, like CdsApiImpl does.
+  void applyBatched() {
+    std::vector<const envoy::config::cluster::v3::Cluster*> clusters;
+    clusters.reserve(clusters_.size());
+    for (const auto& cluster : clusters_) {
+      clusters.push_back(&cluster);
+    }
+    const std::vector<uint64_t> hashes = cluster_manager_->hashClusters(clusters);
+    for (size_t i = 0; i < clusters_.size(); i++) {
+      cluster_manager_->addOrUpdateCluster(clusters_[i], "", hashes[i]);
+    }
+  }
+
+  void apply(bool batched) { batched ? applyBatched() : applySerially(); }
+
+private:
+  NiceMock<TestClusterManagerFactory> factory_;
+  NiceMock<ProtobufMessage::MockValidationContext> validation_context_;
+  NiceMock<AccessLog::MockAccessLogManager> log_manager_;
+  NiceMock<Server::MockAdmin> admin_;
+  Http::ContextImpl http_context_;
+  Grpc::ContextImpl grpc_context_;
+  envoy::config::bootstrap::v3::Bootstrap bootstrap_;
+  std::unique_ptr<TestClusterManagerImpl> cluster_manager_;
+  std::vector<envoy::config::cluster::v3::Cluster> clusters_;
+};
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
+
+// Time to load every cluster of a first CDS response into an empty cluster manager. Clusters are
+// constructed on the calling thread either way, only their config hashing differs, so this mostly
+// shows that construction dominates an initial load.
+// Args: number of clusters, whether the response is hashed as a single batch.
+static void bmInitialClusterLoad(State& state) {
+  const uint32_t num_clusters = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto speed_test = std::make_unique<Envoy::Upstream::ClusterManagerSpeedTest>(num_clusters);
+    state.ResumeTiming();
+
+    speed_test->apply(state.range(1));
+
+    state.PauseTiming();
+    speed_test.reset();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(bmInitialClusterLoad)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 8192}, {0, 1}})
+    ->Unit(::benchmark::kMillisecond);
+
+// Time to process a repeated CDS response in which no cluster changed. This is the common case for
+// large meshes and is dominated by the config hashing used for change detection.
+// Args: number of clusters, whether the response is hashed as a single batch.
+static void bmUnchangedClusterUpdate(State& state) {
+  const uint32_t num_clusters = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  Envoy::Upstream::ClusterManagerSpeedTest speed_test(num_clusters);
+  speed_test.apply(state.range(1));
+  for (auto _ : state) {
+    speed_test.apply(state.range(1));
+  }
+}
+BENCHMARK(bmUnchangedClusterUpdate)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 8192}, {0, 1}})
+    ->Unit(::benchmark::kMillisecond);
@@ -331,6 +331,219 @@ TEST_F(ClusterManagerImplTest, LocalClusterDefined) {
   factory_.tls_.shutdownThread();
 }
 
+// Validate that in lazy mode thread local clusters are created on first use from the latest
+// membership, and evicted after going unused for the idle timeout.
+TEST_F(ClusterManagerImplTest, LazyThreadLocalClusters) {
+  const std::string yaml = R"EOF(
+cluster_manager:
+  lazy_thread_local_clusters:
+    idle_timeout: 10s
+static_resources:
+  clusters:
+  - name: cluster_1
+    connect_timeout: 0.250s
+    type: static
+    lb_policy: round_robin
+    load_assignment:
+      cluster_name: cluster_1
+      endpoints:
+      - lb_endpoints:
+        - endpoint:
+            address:
+              socket_address:
+                address: 127.0.0.1
+                port_value: 11001
+  )EOF";
+
+  auto* idle_timer = new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  create(parseBootstrapFromV3Yaml(yaml));
+  EXPECT_TRUE(idle_timer->enabled());
+
+  auto thread_local_clusters = [this]() {
+    return factory_.stats_
+        .gauge("cluster_manager.thread_local_clusters", Stats::Gauge::ImportMode::NeverImport)
+        .value();
+  };
+  auto& created = factory_.stats_.counter("cluster_manager.thread_local_cluster_created_on_demand");
+  auto& evicted = factory_.stats_.counter("cluster_manager.thread_local_cluster_evicted");
+
+  // Nothing has used the cluster yet.
+  EXPECT_EQ(0, thread_local_clusters());
+
+  ThreadLocalCluster* cluster = cluster_manager_->get("cluster_1");
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(1, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_EQ(1, thread_local_clusters());
+  EXPECT_EQ(1, created.value());
+  EXPECT_EQ(cluster, cluster_manager_->get("cluster_1"));
+  EXPECT_EQ(1, created.value());
+  EXPECT_EQ(nullptr, cluster_manager_->get("unknown_cluster"));
+
+  // The first sweep only clears the used mark, the second evicts the unused cluster.
+  idle_timer->invokeCallback();
+  EXPECT_EQ(1, thread_local_clusters());
+  idle_timer->invokeCallback();
+  EXPECT_EQ(0, thread_local_clusters());
+  EXPECT_EQ(1, evicted.value());
+  EXPECT_TRUE(idle_timer->enabled());
+
+  // The cluster is created again on next use.
+  cluster = cluster_manager_->get("cluster_1");
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(1, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_EQ(2, created.value());
+
+  // Clusters whose async client was handed out are never evicted.
+  cluster_manager_->httpAsyncClientForCluster("cluster_1");
+  idle_timer->invokeCallback();
+  idle_timer->invokeCallback();
+  EXPECT_EQ(1, thread_local_clusters());
+  EXPECT_EQ(1, evicted.value());
+
+  factory_.tls_.shutdownThread();
+}
+
+// Validate that in lazy mode cluster update callbacks do not keep idle thread local clusters
+// around, but clusters held with a member update callback are kept.
+TEST_F(ClusterManagerImplTest, LazyThreadLocalClustersWithUpdateCallbacks) {
+  const std::string yaml = R"EOF(
+cluster_manager:
+  lazy_thread_local_clusters:
+    idle_timeout: 10s
+static_resources:
+  clusters:
+  - name: cluster_1
+    connect_timeout: 0.250s
+    type: static
+    lb_policy: round_robin
+    load_assignment:
+      cluster_name: cluster_1
+      endpoints:
+      - lb_endpoints:
+        - endpoint:
+            address:
+              socket_address:
+                address: 127.0.0.1
+                port_value: 11001
+  )EOF";
+
+  auto* idle_timer = new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  create(parseBootstrapFromV3Yaml(yaml));
+  NiceMock<MockClusterUpdateCallbacks> callbacks;
+  ClusterUpdateCallbacksHandlePtr callbacks_handle =
+      cluster_manager_->addThreadLocalClusterUpdateCallbacks(callbacks);
+  auto& evicted = factory_.stats_.counter("cluster_manager.thread_local_cluster_evicted");
+
+  // Unused clusters are evicted even though callbacks are registered.
+  ASSERT_NE(nullptr, cluster_manager_->get("cluster_1"));
+  idle_timer->invokeCallback();
+  idle_timer->invokeCallback();
+  EXPECT_EQ(1, evicted.value());
+
+  // A cluster that is held on to is kept until its member update callback is removed.
+  ThreadLocalCluster* cluster = cluster_manager_->get("cluster_1");
+  ASSERT_NE(nullptr, cluster);
+  Common::CallbackHandle* member_update_cb =
+      cluster->prioritySet().addMemberUpdateCb([](const HostVector&, const HostVector&) {});
+  idle_timer->invokeCallback();
+  idle_timer->invokeCallback();
+  idle_timer->invokeCallback();
+  EXPECT_EQ(1, evicted.value());
+  member_update_cb->remove();
+  idle_timer->invokeCallback();
+  EXPECT_EQ(2, evicted.value());
+
+  callbacks_handle.reset();
+  factory_.tls_.shutdownThread();
+}
+
+// Validate that in lazy mode a cluster add which reaches a worker after the worker created its copy
+// of the cluster from a newer snapshot keeps the copy, and still notifies the update callbacks.
+TEST_F(ClusterManagerImplTest, LazyThreadLocalClusterCreatedBeforeAdd) {
+  const std::string yaml = R"EOF(
+cluster_manager:
+  lazy_thread_local_clusters:
+    idle_timeout: 10s
+  )EOF";
+
+  create(parseBootstrapFromV3Yaml(yaml));
+  ReadyWatcher initialized;
+  EXPECT_CALL(initialized, ready());
+  cluster_manager_->setInitializedCb([&]() -> void { initialized.ready(); });
+  NiceMock<MockClusterUpdateCallbacks> callbacks;
+  ClusterUpdateCallbacksHandlePtr callbacks_handle =
+      cluster_manager_->addThreadLocalClusterUpdateCallbacks(callbacks);
+  auto& created = factory_.stats_.counter("cluster_manager.thread_local_cluster_created_on_demand");
+
+  // Hold back the add as if the worker had not run it yet. It is posted for the callbacks, while
+  // the initial membership update is not posted since no thread holds a copy of the cluster yet.
+  Event::PostCb add_post;
+  EXPECT_CALL(factory_.tls_, runOnAllThreads(_)).WillOnce(SaveArg<0>(&add_post));
+  EXPECT_CALL(callbacks, onClusterAddOrUpdate(_)).Times(0);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("fake_cluster"), ""));
+  ASSERT_NE(nullptr, add_post);
+
+  ThreadLocalCluster* cluster = cluster_manager_->get("fake_cluster");
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(1, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_EQ(1, created.value());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(&callbacks));
+
+  EXPECT_CALL(callbacks, onClusterAddOrUpdate(_))
+      .WillOnce(Invoke([cluster](ThreadLocalCluster& added) { EXPECT_EQ(cluster, &added); }));
+  add_post();
+  EXPECT_EQ(cluster, cluster_manager_->get("fake_cluster"));
+  EXPECT_EQ(1, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_EQ(1, created.value());
+
+  callbacks_handle.reset();
+  factory_.tls_.shutdownThread();
+}
+
+// Validate that in lazy mode cluster updates are only posted to the threads while any holds a copy
+// of the cluster.
+TEST_F(ClusterManagerImplTest, LazyThreadLocalClusterUpdatesPostedToCopies) {
+  const std::string yaml = R"EOF(
+cluster_manager:
+  lazy_thread_local_clusters:
+    idle_timeout: 10s
+  )EOF";
+
+  auto* idle_timer = new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  create(parseBootstrapFromV3Yaml(yaml));
+  ReadyWatcher initialized;
+  EXPECT_CALL(initialized, ready());
+  cluster_manager_->setInitializedCb([&]() -> void { initialized.ready(); });
+
+  // Neither the add nor the initial membership update are posted, the copy is created from the
+  // snapshot.
+  EXPECT_CALL(factory_.tls_, runOnAllThreads(_)).Times(0);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("fake_cluster"), ""));
+  ThreadLocalCluster* cluster = cluster_manager_->get("fake_cluster");
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(1, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(&factory_.tls_));
+
+  // Updates reach the copy.
+  auto update_cluster = defaultStaticCluster("fake_cluster");
+  update_cluster.mutable_per_connection_buffer_limit_bytes()->set_value(12345);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(update_cluster, ""));
+  cluster = cluster_manager_->get("fake_cluster");
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(12345, cluster->info()->perConnectionBufferLimitBytes());
+  EXPECT_EQ(1, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+
+  // Once the copy is evicted, the removal is not posted either.
+  idle_timer->invokeCallback();
+  idle_timer->invokeCallback();
+  EXPECT_EQ(1, factory_.stats_.counter("cluster_manager.thread_local_cluster_evicted").value());
+  EXPECT_CALL(factory_.tls_, runOnAllThreads(_)).Times(0);
+  EXPECT_TRUE(cluster_manager_->removeCluster("fake_cluster"));
+  EXPECT_EQ(nullptr, cluster_manager_->get("fake_cluster"));
+
+  factory_.tls_.shutdownThread();
+}
+
 TEST_F(ClusterManagerImplTest, DuplicateCluster) {
   const std::string json = fmt::sprintf(
       "{\"static_resources\":{%s}}",
@@ -46,6 +46,7 @@ public:
         api_(Api::createApiForTest(stats_)), async_client_(new Grpc::MockAsyncClient()),
         grpc_mux_(new Config::GrpcMuxImpl(
             local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+            api_->threadFactory(),
             *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
                 "envoy.service.endpoint.v3.EndpointDiscoveryService.StreamEndpoints"),
             envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, {}, true)) {
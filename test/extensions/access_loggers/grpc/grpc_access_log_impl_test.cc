@@ -309,6 +309,58 @@ http_logs:
   logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
 }
 
+// Test that HTTP and TCP log entries buffered together are sent in a single message.
+TEST_F(GrpcAccessLoggerImplTest, HttpAndTcpEntries) {
+  InSequence s;
+  initLogger(FlushInterval, 1000);
+
+  envoy::data::accesslog::v3::HTTPAccessLogEntry http_entry;
+  http_entry.mutable_request()->set_path("/test/path1");
+  logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(http_entry));
+  envoy::data::accesslog::v3::TCPAccessLogEntry tcp_entry;
+  tcp_entry.mutable_connection_properties()->set_received_bytes(10);
+  logger_->log(envoy::data::accesslog::v3::TCPAccessLogEntry(tcp_entry));
+  http_entry.mutable_request()->set_path("/test/path2");
+  logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(http_entry));
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  expectStreamMessage(stream, R"EOF(
+identifier:
+  node:
+    id: node_name
+    cluster: cluster_name
+    locality:
+      zone: zone_name
+  log_name: test_log_name
+http_logs:
+  log_entry:
+  - request:
+      path: /test/path1
+  - request:
+      path: /test/path2
+tcp_logs:
+  log_entry:
+  - connection_properties:
+      received_bytes: 10
+)EOF");
+  EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+  timer_->invokeCallback();
+
+  // Later messages on the same stream don't repeat the identifier.
+  logger_->log(envoy::data::accesslog::v3::TCPAccessLogEntry(tcp_entry));
+  expectStreamMessage(stream, R"EOF(
+tcp_logs:
+  log_entry:
+  - connection_properties:
+      received_bytes: 10
+)EOF");
+  EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+  timer_->invokeCallback();
+}
+
 // Test that log entries are flushed periodically.
 TEST_F(GrpcAccessLoggerImplTest, Flushing) {
   InSequence s;
@@ -218,6 +218,20 @@ TEST_F(AggregateClusterTest, LoadBalancerTest) {
   }
 }
 
+// Sub-clusters are looked up by name when choosing a host, so a sub-cluster that is gone before the
+// load balancer is refreshed is not used.
+TEST_F(AggregateClusterTest, SubClusterGoneBeforeRefresh) {
+  initialize(default_yaml_config_);
+  EXPECT_CALL(cm_, get(Eq("secondary"))).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(secondary_load_balancer_, chooseHost(_)).Times(0);
+
+  // These pick the priorities of the secondary cluster, see LoadBalancerTest.
+  for (int i = 66; i < 100; ++i) {
+    EXPECT_CALL(random_, random()).WillOnce(Return(i));
+    EXPECT_EQ(nullptr, lb_->chooseHost(nullptr));
+  }
+}
+
 TEST_F(AggregateClusterTest, AllHostAreUnhealthyTest) {
   initialize(default_yaml_config_);
   Upstream::HostSharedPtr host = Upstream::makeTestHost(primary_info_, "tcp://127.0.0.1:80");
@@ -645,6 +645,50 @@ TEST_F(DnsCacheImplTest, MaxHostOverflow) {
   EXPECT_EQ(1, TestUtility::findCounter(store_, "dns_cache.foo.host_overflow")->value());
 }
 
+// Max host eviction of the least recently used host.
+TEST_F(DnsCacheImplTest, MaxHostEviction) {
+  config_.mutable_max_hosts()->set_value(2);
+  config_.set_evict_hosts_on_overflow(true);
+  initialize();
+  InSequence s;
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  const auto resolve_host = [&](const std::string& host, const std::string& address) {
+    EXPECT_CALL(*resolver_, resolve(host, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+    auto result = dns_cache_->loadDnsCacheEntry(host, 80, callbacks);
+    EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result.status_);
+    EXPECT_CALL(update_callbacks_, onDnsHostAddOrUpdate(host, _));
+    EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+    resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+               TestUtility::makeDnsResponse({address}));
+  };
+
+  resolve_host("foo.com", "10.0.0.1");
+  simTime().advanceTimeWait(std::chrono::milliseconds(1000));
+  resolve_host("bar.com", "10.0.0.2");
+  simTime().advanceTimeWait(std::chrono::milliseconds(1000));
+
+  // The cache is full, so the least recently used host is evicted instead of overflowing.
+  EXPECT_CALL(update_callbacks_, onDnsHostRemove("foo.com"));
+  resolve_host("baz.com", "10.0.0.3");
+  EXPECT_EQ(0, TestUtility::findCounter(store_, "dns_cache.foo.host_overflow")->value());
+  EXPECT_EQ(1, TestUtility::findCounter(store_, "dns_cache.foo.host_evicted")->value());
+  checkStats(3 /* attempt */, 3 /* success */, 0 /* failure */, 3 /* address changed */,
+             3 /* added */, 1 /* removed */, 2 /* num hosts */);
+
+  auto hosts = dns_cache_->hosts();
+  EXPECT_EQ(2, hosts.size());
+  EXPECT_EQ(0, hosts.count("foo.com"));
+
+  // The remaining hosts are still served from the cache.
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache,
+            dns_cache_->loadDnsCacheEntry("bar.com", 80, callbacks).status_);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache,
+            dns_cache_->loadDnsCacheEntry("baz.com", 80, callbacks).status_);
+}
+
 TEST_F(DnsCacheImplTest, CircuitBreakersNotInvoked) {
   initialize();
 
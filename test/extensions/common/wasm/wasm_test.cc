@@ -13,6 +13,7 @@
 #include "test/test_common/utility.h"
 #include "test/test_common/wasm_base.h"
 
+#include "absl/strings/ascii.h"
 #include "absl/types/optional.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -961,6 +962,121 @@ TEST_P(WasmCommonTest, RemoteCodeMultipleRetry) {
   dispatcher->clearDeferredDeleteList();
 }
 
+// Remote code is loaded from the code cache directory once the in-memory cache is gone, as it is
+// after a hot restart, and fetched again if the cached file doesn't match its SHA-256.
+TEST_P(WasmCommonTest, RemoteCodeCacheDirectory) {
+  if (GetParam() == "null") {
+    return;
+  }
+  Stats::IsolatedStoreImpl stats_store;
+  Api::ApiPtr api = Api::createApiForTest(stats_store);
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  NiceMock<Init::MockManager> init_manager;
+  NiceMock<Server::MockServerLifecycleNotifier> lifecycle_notifier;
+  Event::DispatcherPtr dispatcher(api->allocateDispatcher("wasm_test"));
+  Config::DataSource::RemoteAsyncDataProviderPtr remote_data_provider;
+  auto scope = Stats::ScopeSharedPtr(stats_store.createScope("wasm."));
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  auto plugin = std::make_shared<Extensions::Common::Wasm::Plugin>(
+      "", "", "", GetParam(), "done", false, envoy::config::core::v3::TrafficDirection::UNSPECIFIED,
+      local_info, nullptr);
+
+  std::string code = TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+      absl::StrCat("{{ test_rundir }}/test/extensions/common/wasm/test_data/test_cpp.wasm")));
+  const std::string cache_directory = TestEnvironment::temporaryPath("wasm_code_cache");
+  TestEnvironment::createPath(cache_directory);
+
+  VmConfig vm_config;
+  vm_config.set_runtime(absl::StrCat("envoy.wasm.runtime.", GetParam()));
+  ProtobufWkt::StringValue vm_configuration_string;
+  vm_configuration_string.set_value("vm_cache");
+  vm_config.mutable_configuration()->PackFrom(vm_configuration_string);
+  std::string sha256 = Extensions::Common::Wasm::sha256(code);
+  std::string sha256Hex =
+      Hex::encode(reinterpret_cast<const uint8_t*>(&*sha256.begin()), sha256.size());
+  vm_config.mutable_code()->mutable_remote()->set_sha256(sha256Hex);
+  vm_config.mutable_code()->mutable_remote()->mutable_http_uri()->set_uri(
+      "http://example.com/test.wasm");
+  vm_config.mutable_code()->mutable_remote()->mutable_http_uri()->set_cluster("example_com");
+  vm_config.mutable_code()->mutable_remote()->mutable_http_uri()->mutable_timeout()->set_seconds(5);
+  vm_config.set_code_cache_directory(cache_directory);
+  const std::string cache_path = absl::StrCat(cache_directory, "/", sha256Hex, ".wasm");
+  NiceMock<Http::MockAsyncClient> client;
+  NiceMock<Http::MockAsyncClientRequest> request(&client);
+
+  EXPECT_CALL(cluster_manager, httpAsyncClientForCluster("example_com"))
+      .WillRepeatedly(ReturnRef(cluster_manager.async_client_));
+  auto expect_fetch = [&]() {
+    EXPECT_CALL(cluster_manager.async_client_, send_(_, _, _))
+        .WillOnce(
+            Invoke([&](Http::RequestMessagePtr&, Http::AsyncClient::Callbacks& callbacks,
+                       const Http::AsyncClient::RequestOptions&) -> Http::AsyncClient::Request* {
+              Http::ResponseMessagePtr response(
+                  new Http::ResponseMessageImpl(Http::ResponseHeaderMapPtr{
+                      new Http::TestResponseHeaderMapImpl{{":status", "200"}}}));
+              response->body().add(code);
+              callbacks.onSuccess(request, std::move(response));
+              return nullptr;
+            }));
+  };
+  auto create_wasm = [&](bool fetched) {
+    WasmHandleSharedPtr wasm_handle;
+    Init::TargetHandlePtr init_target_handle;
+    EXPECT_CALL(init_manager, add(_))
+        .Times(fetched ? 1 : 0)
+        .WillRepeatedly(Invoke([&](const Init::Target& target) {
+          init_target_handle = target.createHandle("test");
+        }));
+    createWasm(vm_config, plugin, scope, cluster_manager, init_manager, *dispatcher, *api,
+               lifecycle_notifier, remote_data_provider,
+               [&wasm_handle](const WasmHandleSharedPtr& w) { wasm_handle = w; });
+    if (fetched) {
+      Init::ExpectableWatcherImpl init_watcher;
+      EXPECT_CALL(init_watcher, ready());
+      init_target_handle->initialize(init_watcher);
+    }
+    EXPECT_NE(wasm_handle, nullptr);
+    remote_data_provider.reset();
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    dispatcher->clearDeferredDeleteList();
+  };
+
+  // The code is fetched and written to the cache directory.
+  expect_fetch();
+  create_wasm(true);
+  EXPECT_EQ(code, TestEnvironment::readFileToStringForTest(cache_path));
+
+  // The code is loaded from the cache directory without being fetched.
+  clearCodeCacheForTesting();
+  create_wasm(false);
+
+  // A corrupted file is ignored, and replaced once the code is fetched again.
+  clearCodeCacheForTesting();
+  TestEnvironment::writeStringToFileForTest(cache_path, "corrupted", true);
+  expect_fetch();
+  create_wasm(true);
+  EXPECT_EQ(code, TestEnvironment::readFileToStringForTest(cache_path));
+
+  // A SHA-256 that isn't 64 lowercase hex digits is never used as a file name, so the code is
+  // fetched even though a matching file exists.
+  clearCodeCacheForTesting();
+  const std::string upper_sha256_hex = absl::AsciiStrToUpper(sha256Hex);
+  TestEnvironment::writeStringToFileForTest(
+      absl::StrCat(cache_directory, "/", upper_sha256_hex, ".wasm"), code, true);
+  vm_config.mutable_code()->mutable_remote()->set_sha256(upper_sha256_hex);
+  WasmHandleSharedPtr wasm_handle;
+  EXPECT_CALL(init_manager, add(_));
+  createWasm(vm_config, plugin, scope, cluster_manager, init_manager, *dispatcher, *api,
+             lifecycle_notifier, remote_data_provider,
+             [&wasm_handle](const WasmHandleSharedPtr& w) { wasm_handle = w; });
+  EXPECT_EQ(wasm_handle, nullptr);
+  remote_data_provider.reset();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  dispatcher->clearDeferredDeleteList();
+
+  TestEnvironment::removePath(cache_directory);
+}
+
 class WasmCommonContextTest
     : public Common::Wasm::WasmTestBase<testing::TestWithParam<std::string>> {
 public:
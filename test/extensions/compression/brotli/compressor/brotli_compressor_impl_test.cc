@@ -0,0 +1,171 @@
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+#include "extensions/compression/brotli/compressor/config.h"
+
+#include "test/test_common/utility.h"
+
+#include "brotli/decode.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+namespace {
+
+// Test helpers
+
+// Decompresses a buffer with the reference streaming API of brotli. The stream doesn't have to be
+// finished, in which case everything flushed so far is decompressed.
+std::string decompress(const Buffer::Instance& compressed) {
+  std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> state(
+      BrotliDecoderCreateInstance(nullptr, nullptr, nullptr), &BrotliDecoderDestroyInstance);
+  const std::string input = compressed.toString();
+  const uint8_t* next_in = reinterpret_cast<const uint8_t*>(input.data());
+  size_t avail_in = input.size();
+  std::string output;
+  uint8_t chunk[4096];
+  BrotliDecoderResult result;
+  size_t avail_out;
+  // Brotli may ask for more input while it still has output pending, if the chunk was filled.
+  do {
+    uint8_t* next_out = chunk;
+    avail_out = sizeof(chunk);
+    result = BrotliDecoderDecompressStream(state.get(), &avail_in, &next_in, &avail_out,
+                                           &next_out, nullptr);
+    EXPECT_NE(BROTLI_DECODER_RESULT_ERROR, result);
+    output.append(reinterpret_cast<const char*>(chunk), sizeof(chunk) - avail_out);
+  } while (result != BROTLI_DECODER_RESULT_ERROR && avail_out == 0);
+  return output;
+}
+
+std::string htmlDocument(uint32_t i) {
+  return fmt::format(R"(<div class="item" id="item-{}"><a href="/items/{}">Item {}</a>)"
+                     R"(<span class="price">{}.99</span></div>)",
+                     i, i, i, i % 100);
+}
+
+class BrotliCompressorImplTest : public testing::Test {
+protected:
+  void drainBuffer(Buffer::OwnedImpl& buffer) { buffer.drain(buffer.length()); }
+
+  std::unique_ptr<BrotliCompressorImpl> createCompressor(bool disable_flush = false) {
+    return std::make_unique<BrotliCompressorImpl>(
+        default_quality, default_window_bits, 0, false, BrotliCompressorImpl::EncoderMode::Default,
+        disable_flush, default_chunk_size);
+  }
+
+  static constexpr uint32_t default_quality{3};
+  static constexpr uint32_t default_window_bits{18};
+  static constexpr uint32_t default_chunk_size{4096};
+  static constexpr uint64_t default_input_size{796};
+  static constexpr uint64_t default_input_round{10};
+};
+
+// Exercises compression with flushes, after each of which the output so far can be decompressed.
+TEST_F(BrotliCompressorImplTest, CompressWithFlushes) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  std::string original_text;
+
+  auto compressor = createCompressor();
+  for (uint64_t i = 0; i < default_input_round; ++i) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * i, i);
+    original_text.append(buffer.toString());
+    compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    accumulation_buffer.add(buffer);
+    drainBuffer(buffer);
+    EXPECT_EQ(original_text, decompress(accumulation_buffer));
+  }
+
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  accumulation_buffer.add(buffer);
+  EXPECT_EQ(original_text, decompress(accumulation_buffer));
+}
+
+// With flushes disabled, small inputs are held by the compressor until the stream is finished,
+// and the output is smaller than with a flush after each input.
+TEST_F(BrotliCompressorImplTest, CompressWithoutFlushes) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  Buffer::OwnedImpl flushed_accumulation_buffer;
+  std::string original_text;
+
+  auto compressor = createCompressor(true);
+  auto flushed_compressor = createCompressor();
+  for (uint32_t i = 0; i < 100; ++i) {
+    const std::string text = htmlDocument(i);
+    original_text.append(text);
+    buffer.add(text);
+    compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    accumulation_buffer.add(buffer);
+    drainBuffer(buffer);
+
+    buffer.add(text);
+    flushed_compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    flushed_accumulation_buffer.add(buffer);
+    drainBuffer(buffer);
+  }
+  EXPECT_LT(decompress(accumulation_buffer).size(), original_text.size());
+
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  accumulation_buffer.add(buffer);
+  flushed_compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  flushed_accumulation_buffer.add(buffer);
+  EXPECT_LT(accumulation_buffer.length(), flushed_accumulation_buffer.length());
+  EXPECT_EQ(original_text, decompress(accumulation_buffer));
+  EXPECT_EQ(original_text, decompress(flushed_accumulation_buffer));
+}
+
+// Exercises compression of an input larger than the output chunk, in a single call.
+TEST_F(BrotliCompressorImplTest, CompressLargeInput) {
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, 16 * default_chunk_size);
+  const std::string original_text = buffer.toString();
+
+  auto compressor = createCompressor();
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_GT(buffer.length(), default_chunk_size);
+  EXPECT_EQ(original_text, decompress(buffer));
+}
+
+// Exercises the quality, window, block, mode and literal context modeling parameters.
+TEST_F(BrotliCompressorImplTest, CompressWithParameters) {
+  std::string original_text;
+  for (uint32_t i = 0; i < 100; ++i) {
+    original_text.append(htmlDocument(i));
+  }
+
+  for (const auto mode :
+       {BrotliCompressorImpl::EncoderMode::Generic, BrotliCompressorImpl::EncoderMode::Text,
+        BrotliCompressorImpl::EncoderMode::Font, BrotliCompressorImpl::EncoderMode::Default}) {
+    Buffer::OwnedImpl buffer(original_text);
+    BrotliCompressorImpl compressor(11, 10, 16, true, mode, false, default_chunk_size);
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    EXPECT_LT(buffer.length(), original_text.size());
+    EXPECT_EQ(original_text, decompress(buffer));
+  }
+}
+
+// Exercises the factory, with its defaults.
+TEST_F(BrotliCompressorImplTest, Factory) {
+  envoy::extensions::compression::brotli::compressor::v3::Brotli config;
+  config.set_encoder_mode(envoy::extensions::compression::brotli::compressor::v3::Brotli::TEXT);
+  BrotliCompressorFactory factory(config);
+  EXPECT_EQ("br", factory.contentEncoding());
+  EXPECT_EQ("brotli.", factory.statsPrefix());
+
+  const std::string original_text = htmlDocument(1);
+  Buffer::OwnedImpl buffer(original_text);
+  factory.createCompressor()->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_EQ(original_text, decompress(buffer));
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,89 @@
+// Compares the speed and the compression ratio of gzip and brotli, at each of their levels, over an
+// HTML page and a JavaScript file, compressed in chunks as the compressor filter does. The HTML
+// page is the Bazel build README rendered as a page of the documentation site, and the JavaScript
+// file is the search script shipped with the documentation.
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/macros.h"
+
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+#include "extensions/compression/gzip/compressor/zlib_compressor_impl.h"
+
+#include "test/test_common/environment.h"
+
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace {
+
+static constexpr uint64_t ChunkSize = 16384;
+
+const std::string& htmlCorpus() {
+  CONSTRUCT_ON_FIRST_USE(std::string,
+                         TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+                             "{{ test_rundir }}/test/extensions/compression/brotli/compressor/"
+                             "test_data/bazel_readme.html")));
+}
+
+const std::string& jsCorpus() {
+  CONSTRUCT_ON_FIRST_USE(std::string,
+                         TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+                             "{{ test_rundir }}/docs/root/_static/searchtools.js")));
+}
+
+// Compresses the corpus in chunks, flushing after each one but the last, and reports the size of
+// the output relative to the input.
+void compressCorpus(Envoy::Compression::Compressor::Compressor& compressor,
+                    const std::string& corpus, benchmark::State& state) {
+  uint64_t compressed_bytes = 0;
+  for (uint64_t offset = 0; offset < corpus.size(); offset += ChunkSize) {
+    Buffer::OwnedImpl buffer(absl::string_view(corpus).substr(offset, ChunkSize));
+    compressor.compress(buffer, offset + ChunkSize < corpus.size()
+                                    ? Envoy::Compression::Compressor::State::Flush
+                                    : Envoy::Compression::Compressor::State::Finish);
+    compressed_bytes += buffer.length();
+  }
+  state.counters["ratio"] = static_cast<double>(compressed_bytes) / corpus.size();
+}
+
+void gzip(benchmark::State& state, const std::string& corpus) {
+  const auto level =
+      static_cast<Gzip::Compressor::ZlibCompressorImpl::CompressionLevel>(state.range(0));
+  for (auto _ : state) {
+    Gzip::Compressor::ZlibCompressorImpl compressor;
+    compressor.init(level, Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                    31, 8);
+    compressCorpus(compressor, corpus, state);
+  }
+  state.SetBytesProcessed(state.iterations() * corpus.size());
+}
+
+void brotli(benchmark::State& state, const std::string& corpus) {
+  for (auto _ : state) {
+    Brotli::Compressor::BrotliCompressorImpl compressor(
+        state.range(0), 18, 0, false, Brotli::Compressor::BrotliCompressorImpl::EncoderMode::Text,
+        false, 4096);
+    compressCorpus(compressor, corpus, state);
+  }
+  state.SetBytesProcessed(state.iterations() * corpus.size());
+}
+
+static void gzipHtml(benchmark::State& state) { gzip(state, htmlCorpus()); }
+BENCHMARK(gzipHtml)->DenseRange(1, 9, 1)->Unit(benchmark::kMillisecond);
+
+static void brotliHtml(benchmark::State& state) { brotli(state, htmlCorpus()); }
+BENCHMARK(brotliHtml)->DenseRange(0, 11, 1)->Unit(benchmark::kMillisecond);
+
+static void gzipJs(benchmark::State& state) { gzip(state, jsCorpus()); }
+BENCHMARK(gzipJs)->DenseRange(1, 9, 1)->Unit(benchmark::kMillisecond);
+
+static void brotliJs(benchmark::State& state) { brotli(state, jsCorpus()); }
+BENCHMARK(brotliJs)->DenseRange(0, 11, 1)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
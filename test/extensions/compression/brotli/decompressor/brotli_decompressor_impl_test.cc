@@ -0,0 +1,131 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+#include "extensions/compression/brotli/decompressor/brotli_decompressor_impl.h"
+#include "extensions/compression/brotli/decompressor/config.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Decompressor {
+namespace {
+
+class BrotliDecompressorImplTest : public testing::Test {
+protected:
+  void drainBuffer(Buffer::OwnedImpl& buffer) { buffer.drain(buffer.length()); }
+
+  std::unique_ptr<Compressor::BrotliCompressorImpl> createCompressor() {
+    return std::make_unique<Compressor::BrotliCompressorImpl>(
+        default_quality, default_window_bits, 0, false,
+        Compressor::BrotliCompressorImpl::EncoderMode::Default, false, default_chunk_size);
+  }
+
+  // Compresses text in a single stream.
+  std::string compress(const std::string& text) {
+    Buffer::OwnedImpl buffer(text);
+    createCompressor()->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    return buffer.toString();
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counterFromString("test." + name).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+
+  static constexpr uint32_t default_quality{3};
+  static constexpr uint32_t default_window_bits{18};
+  static constexpr uint32_t default_chunk_size{4096};
+  static constexpr uint64_t default_input_size{796};
+};
+
+// Exercises decompression of a stream compressed with flushes, fed to the decompressor in pieces.
+TEST_F(BrotliDecompressorImplTest, CompressAndDecompress) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl output_buffer;
+  std::string original_text;
+
+  auto compressor = createCompressor();
+  BrotliDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size, false);
+  for (uint64_t i = 0; i < 30; ++i) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * i, i);
+    original_text.append(buffer.toString());
+    compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    decompressor.decompress(buffer, output_buffer);
+    drainBuffer(buffer);
+    EXPECT_EQ(original_text, output_buffer.toString());
+  }
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  decompressor.decompress(buffer, output_buffer);
+
+  EXPECT_EQ(original_text, output_buffer.toString());
+  EXPECT_FALSE(decompressor.decompression_error_);
+}
+
+// Exercises decompression of highly compressed data, whose output fills many chunks.
+TEST_F(BrotliDecompressorImplTest, DecompressLargeOutput) {
+  const std::string original_text(64 * default_chunk_size, 'a');
+  Buffer::OwnedImpl compressed(compress(original_text));
+  EXPECT_LT(compressed.length(), default_chunk_size);
+
+  Buffer::OwnedImpl output_buffer;
+  BrotliDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size, true);
+  decompressor.decompress(compressed, output_buffer);
+  EXPECT_EQ(original_text, output_buffer.toString());
+  EXPECT_FALSE(decompressor.decompression_error_);
+}
+
+// Exercises the factory.
+TEST_F(BrotliDecompressorImplTest, Factory) {
+  envoy::extensions::compression::brotli::decompressor::v3::Brotli config;
+  BrotliDecompressorFactory factory(config, stats_store_);
+  EXPECT_EQ("br", factory.contentEncoding());
+  EXPECT_EQ("brotli.", factory.statsPrefix());
+
+  const std::string original_text(default_input_size, 'a');
+  Buffer::OwnedImpl input_buffer(compress(original_text));
+  Buffer::OwnedImpl output_buffer;
+  factory.createDecompressor("test.")->decompress(input_buffer, output_buffer);
+  EXPECT_EQ(original_text, output_buffer.toString());
+}
+
+// Data that isn't brotli is an error, after which the rest of the input is ignored.
+TEST_F(BrotliDecompressorImplTest, InvalidInput) {
+  Buffer::OwnedImpl input_buffer;
+  TestUtility::feedBufferWithRandomCharacters(input_buffer, default_input_size);
+
+  Buffer::OwnedImpl output_buffer;
+  BrotliDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size, false);
+  decompressor.decompress(input_buffer, output_buffer);
+  EXPECT_TRUE(decompressor.decompression_error_);
+  EXPECT_EQ(1, counter("brotli_error"));
+
+  Buffer::OwnedImpl valid_input(compress("text"));
+  decompressor.decompress(valid_input, output_buffer);
+  EXPECT_EQ(1, counter("brotli_error"));
+}
+
+// Data after the end of the stream is an error.
+TEST_F(BrotliDecompressorImplTest, TrailingData) {
+  Buffer::OwnedImpl input_buffer(compress("text") + "trailing data");
+
+  Buffer::OwnedImpl output_buffer;
+  BrotliDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size, false);
+  decompressor.decompress(input_buffer, output_buffer);
+  EXPECT_EQ("text", output_buffer.toString());
+  EXPECT_TRUE(decompressor.decompression_error_);
+  EXPECT_EQ(1, counter("brotli_error"));
+}
+
+} // namespace
+} // namespace Decompressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,119 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/common/hex.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/gzip/compressor/config.h"
+#include "extensions/compression/gzip/compressor/zlib_block_compressor_impl.h"
+#include "extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Gzip {
+namespace Compressor {
+namespace {
+
+using Envoy::Compression::Compressor::BlockCompressor;
+using Envoy::Compression::Compressor::State;
+
+class ZlibBlockCompressorImplTest : public testing::Test {
+protected:
+  static std::string generateText(uint64_t size) {
+    std::string text;
+    for (uint32_t i = 0; text.size() < size; ++i) {
+      absl::StrAppend(&text, "{\"id\": ", i, ", \"name\": \"item ", i % 97, "\"},\n");
+    }
+    return text.substr(0, size);
+  }
+
+  // Compresses the blocks in reverse order, as they may complete on a thread pool, then adds them
+  // to the stream in order.
+  std::string compressInBlocks(const std::vector<std::string>& blocks) {
+    ZlibBlockCompressorImpl compressor(ZlibCompressorImpl::CompressionLevel::Standard,
+                                       ZlibCompressorImpl::CompressionStrategy::Standard, 15, 8);
+    std::vector<BlockCompressor::BlockPtr> compressed_blocks(blocks.size());
+    for (size_t i = blocks.size(); i-- > 0;) {
+      compressed_blocks[i] = compressor.compressBlock(
+          blocks[i], i > 0 ? absl::string_view(blocks[i - 1]) : absl::string_view(),
+          i + 1 == blocks.size() ? State::Finish : State::Flush);
+    }
+    Buffer::OwnedImpl output;
+    for (const auto& block : compressed_blocks) {
+      compressor.addBlock(*block, output);
+    }
+    return output.toString();
+  }
+
+  std::string decompress(const std::string& compressed) {
+    Decompressor::ZlibDecompressorImpl decompressor(stats_store_, "test.");
+    decompressor.init(31);
+    Buffer::OwnedImpl input(compressed);
+    Buffer::OwnedImpl output;
+    decompressor.decompress(input, output);
+    EXPECT_EQ(0, decompressor.decompression_error_);
+    return output.toString();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+};
+
+// Test that the blocks form a single gzip stream.
+TEST_F(ZlibBlockCompressorImplTest, CompressInBlocks) {
+  const std::string text = generateText(300000);
+  std::vector<std::string> blocks;
+  for (uint64_t offset = 0; offset < text.size(); offset += 65536) {
+    blocks.push_back(text.substr(offset, 65536));
+  }
+  const std::string compressed = compressInBlocks(blocks);
+  EXPECT_EQ("1f8b08", Hex::encode(reinterpret_cast<const uint8_t*>(compressed.data()), 3));
+  EXPECT_LT(compressed.size(), text.size() / 4);
+  EXPECT_EQ(text, decompress(compressed));
+}
+
+// Test that the last block may be empty.
+TEST_F(ZlibBlockCompressorImplTest, EmptyLastBlock) {
+  const std::string text = generateText(10000);
+  EXPECT_EQ(text, decompress(compressInBlocks({text, ""})));
+  EXPECT_EQ("", decompress(compressInBlocks({""})));
+}
+
+// Test that a block refers to its history instead of repeating it.
+TEST_F(ZlibBlockCompressorImplTest, History) {
+  const std::string text = generateText(20000);
+  const uint64_t size_without_history = compressInBlocks({text}).size();
+  const std::string compressed = compressInBlocks({text, text});
+  EXPECT_LT(compressed.size(), size_without_history + 1000);
+  EXPECT_EQ(text + text, decompress(compressed));
+}
+
+// Test that the factory creates a block compressor with the configured settings.
+TEST(GzipCompressorFactoryTest, CreateBlockCompressor) {
+  envoy::extensions::compression::gzip::compressor::v3::Gzip gzip;
+  gzip.mutable_window_bits()->set_value(9);
+  GzipCompressorFactory factory(gzip);
+  Envoy::Compression::Compressor::BlockCompressorSharedPtr compressor =
+      factory.createBlockCompressor();
+  ASSERT_NE(nullptr, compressor);
+
+  const std::string text(1000, 'a');
+  Buffer::OwnedImpl output;
+  compressor->addBlock(*compressor->compressBlock(text, "", State::Finish), output);
+  Stats::IsolatedStoreImpl stats_store;
+  Decompressor::ZlibDecompressorImpl decompressor(stats_store, "test.");
+  decompressor.init(31);
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(output, decompressed);
+  EXPECT_EQ(text, decompressed.toString());
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Gzip
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
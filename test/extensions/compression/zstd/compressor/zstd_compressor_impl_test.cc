@@ -0,0 +1,151 @@
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/compression/zstd/compressor/config.h"
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+namespace {
+
+// Test helpers
+
+// Decompresses a buffer with the reference streaming API of zstd.
+std::string decompress(const Buffer::Instance& compressed, const ZSTD_DDict* ddict = nullptr) {
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+  if (ddict != nullptr) {
+    EXPECT_FALSE(ZSTD_isError(ZSTD_DCtx_refDDict(dctx.get(), ddict)));
+  }
+  const std::string input = compressed.toString();
+  ZSTD_inBuffer in{input.data(), input.size(), 0};
+  std::string output;
+  char chunk[4096];
+  while (in.pos < in.size) {
+    ZSTD_outBuffer out{chunk, sizeof(chunk), 0};
+    const size_t result = ZSTD_decompressStream(dctx.get(), &out, &in);
+    EXPECT_FALSE(ZSTD_isError(result)) << ZSTD_getErrorName(result);
+    if (ZSTD_isError(result)) {
+      break;
+    }
+    output.append(chunk, out.pos);
+  }
+  return output;
+}
+
+std::string jsonDocument(uint32_t i) {
+  return fmt::format(R"({{"id":{},"user":{{"name":"alice","email":"alice@example.com"}},)"
+                     R"("status":"shipped","region":"us-east-1"}})",
+                     i);
+}
+
+class ZstdCompressorImplTest : public testing::Test {
+protected:
+  void drainBuffer(Buffer::OwnedImpl& buffer) { buffer.drain(buffer.length()); }
+
+  static constexpr uint32_t default_compression_level{3};
+  static constexpr uint32_t default_chunk_size{4096};
+  static constexpr uint64_t default_input_size{796};
+  static constexpr uint64_t default_input_round{10};
+};
+
+// Exercises compression with flushes, after each of which the output so far can be decompressed.
+TEST_F(ZstdCompressorImplTest, CompressWithFlushes) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  std::string original_text;
+
+  ZstdCompressorImpl compressor(default_compression_level, 0, false, default_chunk_size);
+  for (uint64_t i = 0; i < default_input_round; ++i) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * i, i);
+    original_text.append(buffer.toString());
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    accumulation_buffer.add(buffer);
+    drainBuffer(buffer);
+    EXPECT_EQ(original_text, decompress(accumulation_buffer));
+  }
+
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  accumulation_buffer.add(buffer);
+  EXPECT_EQ(original_text, decompress(accumulation_buffer));
+}
+
+// Exercises compression of an input larger than the output chunk, in a single call.
+TEST_F(ZstdCompressorImplTest, CompressLargeInput) {
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, 16 * default_chunk_size);
+  const std::string original_text = buffer.toString();
+
+  ZstdCompressorImpl compressor(default_compression_level, 0, false, default_chunk_size);
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_GT(buffer.length(), default_chunk_size);
+  EXPECT_EQ(original_text, decompress(buffer));
+}
+
+// Exercises the level, window and checksum parameters.
+TEST_F(ZstdCompressorImplTest, CompressWithParameters) {
+  std::string original_text;
+  for (uint32_t i = 0; i < 100; ++i) {
+    original_text.append(jsonDocument(i));
+  }
+
+  Buffer::OwnedImpl buffer(original_text);
+  ZstdCompressorImpl compressor(19, 10, false, default_chunk_size);
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_LT(buffer.length(), original_text.size());
+  EXPECT_EQ(original_text, decompress(buffer));
+
+  // The checksum appends 4 bytes to the frame.
+  Buffer::OwnedImpl checksummed_buffer(original_text);
+  ZstdCompressorImpl checksummed_compressor(19, 10, true, default_chunk_size);
+  checksummed_compressor.compress(checksummed_buffer,
+                                  Envoy::Compression::Compressor::State::Finish);
+  EXPECT_EQ(buffer.length() + 4, checksummed_buffer.length());
+  EXPECT_EQ(original_text, decompress(checksummed_buffer));
+}
+
+// Exercises compression with a dictionary configured in the factory.
+TEST_F(ZstdCompressorImplTest, CompressWithDictionary) {
+  auto api = Api::createApiForTest();
+  const std::string dictionary_path =
+      TestEnvironment::runfilesPath("test/extensions/compression/zstd/test_data/dictionary_1");
+  envoy::extensions::compression::zstd::compressor::v3::Zstd config;
+  config.mutable_dictionary()->set_filename(dictionary_path);
+  ZstdCompressorFactory factory(config, *api);
+  EXPECT_EQ("zstd", factory.contentEncoding());
+  EXPECT_EQ("zstd.", factory.statsPrefix());
+
+  const std::string original_text = jsonDocument(1);
+  Buffer::OwnedImpl buffer(original_text);
+  factory.createCompressor()->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+
+  const std::string compressed = buffer.toString();
+  EXPECT_EQ(1U, ZSTD_getDictID_fromFrame(compressed.data(), compressed.size()));
+
+  const std::string dictionary = api->fileSystem().fileReadToEnd(dictionary_path);
+  std::unique_ptr<ZSTD_DDict, decltype(&ZSTD_freeDDict)> ddict(
+      ZSTD_createDDict(dictionary.data(), dictionary.size()), &ZSTD_freeDDict);
+  EXPECT_EQ(original_text, decompress(buffer, ddict.get()));
+}
+
+// Dictionaries without an ID are rejected, as decompressors couldn't identify them.
+TEST_F(ZstdCompressorImplTest, RawDictionaryRejected) {
+  auto api = Api::createApiForTest();
+  envoy::extensions::compression::zstd::compressor::v3::Zstd config;
+  config.mutable_dictionary()->set_inline_string(jsonDocument(1));
+  EXPECT_THROW_WITH_MESSAGE(ZstdCompressorFactory(config, *api), EnvoyException,
+                            "zstd dictionary has no ID; dictionaries must be trained with zstd");
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
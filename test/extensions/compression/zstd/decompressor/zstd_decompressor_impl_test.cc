@@ -0,0 +1,221 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/zstd/compressor/config.h"
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
+#include "extensions/compression/zstd/decompressor/config.h"
+#include "extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+namespace {
+
+using CompressorConfig = envoy::extensions::compression::zstd::compressor::v3::Zstd;
+using DecompressorConfig = envoy::extensions::compression::zstd::decompressor::v3::Zstd;
+
+std::string dictionaryPath(uint32_t id) {
+  return TestEnvironment::runfilesPath(
+      fmt::format("test/extensions/compression/zstd/test_data/dictionary_{}", id));
+}
+
+class ZstdDecompressorImplTest : public testing::Test {
+protected:
+  void drainBuffer(Buffer::OwnedImpl& buffer) { buffer.drain(buffer.length()); }
+
+  // Compresses text in a single frame, with the dictionary of the given ID if not 0.
+  std::string compress(const std::string& text, uint32_t dictionary_id = 0,
+                       bool enable_checksum = false) {
+    CompressorConfig config;
+    config.set_enable_checksum(enable_checksum);
+    if (dictionary_id != 0) {
+      config.mutable_dictionary()->set_filename(dictionaryPath(dictionary_id));
+    }
+    Compressor::ZstdCompressorFactory factory(config, *api_);
+    Buffer::OwnedImpl buffer(text);
+    factory.createCompressor()->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    return buffer.toString();
+  }
+
+  std::unique_ptr<ZstdDecompressorFactory> createFactory(const std::vector<uint32_t>& ids) {
+    DecompressorConfig config;
+    for (const uint32_t id : ids) {
+      config.add_dictionaries()->set_filename(dictionaryPath(id));
+    }
+    return std::make_unique<ZstdDecompressorFactory>(config, stats_store_, *api_);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counterFromString("test." + name).value();
+  }
+
+  static std::string jsonDocument(uint32_t i) {
+    return fmt::format(R"({{"id":{},"user":{{"name":"bob","email":"bob@example.com"}},)"
+                       R"("status":"pending","region":"eu-west-1"}})",
+                       i);
+  }
+
+  Api::ApiPtr api_{Api::createApiForTest()};
+  Stats::IsolatedStoreImpl stats_store_;
+
+  static constexpr uint32_t default_compression_level{3};
+  static constexpr uint32_t default_chunk_size{4096};
+  static constexpr uint64_t default_input_size{796};
+};
+
+// Exercises decompression of a stream compressed with flushes, fed to the decompressor in pieces.
+TEST_F(ZstdDecompressorImplTest, CompressAndDecompress) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl output_buffer;
+  std::string original_text;
+
+  Compressor::ZstdCompressorImpl compressor(default_compression_level, 0, true,
+                                            default_chunk_size);
+  ZstdDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size);
+  for (uint64_t i = 0; i < 30; ++i) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * i, i);
+    original_text.append(buffer.toString());
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    decompressor.decompress(buffer, output_buffer);
+    drainBuffer(buffer);
+  }
+  compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  decompressor.decompress(buffer, output_buffer);
+
+  EXPECT_EQ(original_text, output_buffer.toString());
+  EXPECT_FALSE(decompressor.decompression_error_);
+}
+
+// Exercises decompression of highly compressed data, whose output fills many chunks.
+TEST_F(ZstdDecompressorImplTest, DecompressLargeOutput) {
+  const std::string original_text(64 * default_chunk_size, 'a');
+  Buffer::OwnedImpl compressed(compress(original_text));
+  EXPECT_LT(compressed.length(), default_chunk_size);
+
+  Buffer::OwnedImpl output_buffer;
+  ZstdDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size);
+  decompressor.decompress(compressed, output_buffer);
+  EXPECT_EQ(original_text, output_buffer.toString());
+}
+
+// Each frame is decompressed with the dictionary it identifies, if any.
+TEST_F(ZstdDecompressorImplTest, DecompressWithDictionaries) {
+  auto factory = createFactory({1, 2});
+  EXPECT_EQ("zstd", factory->contentEncoding());
+  EXPECT_EQ("zstd.", factory->statsPrefix());
+
+  Buffer::OwnedImpl input_buffer;
+  input_buffer.add(compress(jsonDocument(1), 1));
+  input_buffer.add(compress(jsonDocument(2), 2));
+  input_buffer.add(compress(jsonDocument(3)));
+
+  Buffer::OwnedImpl output_buffer;
+  auto decompressor = factory->createDecompressor("test.");
+  decompressor->decompress(input_buffer, output_buffer);
+  EXPECT_EQ(jsonDocument(1) + jsonDocument(2) + jsonDocument(3), output_buffer.toString());
+}
+
+// The dictionary of a frame is found when its header is split across inputs.
+TEST_F(ZstdDecompressorImplTest, DecompressWithDictionariesByteByByte) {
+  auto factory = createFactory({1, 2});
+  const std::string compressed =
+      compress(jsonDocument(1), 1) + compress(jsonDocument(2), 2) + compress(jsonDocument(3));
+
+  Buffer::OwnedImpl output_buffer;
+  auto decompressor = factory->createDecompressor("test.");
+  for (const char c : compressed) {
+    Buffer::OwnedImpl input_buffer(&c, 1);
+    decompressor->decompress(input_buffer, output_buffer);
+  }
+  EXPECT_FALSE(dynamic_cast<ZstdDecompressorImpl&>(*decompressor).decompression_error_);
+  EXPECT_EQ(jsonDocument(1) + jsonDocument(2) + jsonDocument(3), output_buffer.toString());
+  EXPECT_EQ(0, counter("zstd_dictionary_error"));
+}
+
+// A frame compressed with a dictionary that isn't configured is an error.
+TEST_F(ZstdDecompressorImplTest, UnknownDictionary) {
+  auto factory = createFactory({1});
+  Buffer::OwnedImpl input_buffer(compress(jsonDocument(1), 2));
+
+  Buffer::OwnedImpl output_buffer;
+  auto decompressor = factory->createDecompressor("test.");
+  decompressor->decompress(input_buffer, output_buffer);
+  EXPECT_TRUE(dynamic_cast<ZstdDecompressorImpl&>(*decompressor).decompression_error_);
+  EXPECT_EQ(0, output_buffer.length());
+  EXPECT_EQ(1, counter("zstd_dictionary_error"));
+}
+
+// Data that isn't zstd is an error, after which the rest of the input is ignored.
+TEST_F(ZstdDecompressorImplTest, InvalidInput) {
+  Buffer::OwnedImpl input_buffer;
+  TestUtility::feedBufferWithRandomCharacters(input_buffer, default_input_size);
+
+  Buffer::OwnedImpl output_buffer;
+  ZstdDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size);
+  decompressor.decompress(input_buffer, output_buffer);
+  EXPECT_TRUE(decompressor.decompression_error_);
+  EXPECT_EQ(1, counter("zstd_generic_error"));
+
+  Buffer::OwnedImpl valid_input(compress(jsonDocument(1)));
+  decompressor.decompress(valid_input, output_buffer);
+  EXPECT_EQ(0, output_buffer.length());
+  EXPECT_EQ(1, counter("zstd_generic_error"));
+}
+
+// Corrupted data is detected by the checksum.
+TEST_F(ZstdDecompressorImplTest, WrongChecksum) {
+  std::string compressed = compress(jsonDocument(1), 0, true);
+  compressed.back() ^= 0xff;
+  Buffer::OwnedImpl input_buffer(compressed);
+
+  Buffer::OwnedImpl output_buffer;
+  ZstdDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size);
+  decompressor.decompress(input_buffer, output_buffer);
+  EXPECT_TRUE(decompressor.decompression_error_);
+  EXPECT_EQ(1, counter("zstd_checksum_wrong_error"));
+}
+
+// A frame that needs a larger window than the configured maximum is an error.
+TEST_F(ZstdDecompressorImplTest, WindowTooLarge) {
+  // The size of the content isn't known when the frame starts, so the frame keeps the window.
+  Compressor::ZstdCompressorImpl compressor(default_compression_level, DefaultMaxWindowLog + 1,
+                                            false, default_chunk_size);
+  Buffer::OwnedImpl compressed(jsonDocument(1));
+  compressor.compress(compressed, Envoy::Compression::Compressor::State::Flush);
+  Buffer::OwnedImpl end;
+  compressor.compress(end, Envoy::Compression::Compressor::State::Finish);
+  compressed.move(end);
+
+  Buffer::OwnedImpl output_buffer;
+  ZstdDecompressorImpl decompressor(stats_store_, "test.", default_chunk_size);
+  decompressor.decompress(compressed, output_buffer);
+  EXPECT_TRUE(decompressor.decompression_error_);
+  EXPECT_EQ(0, output_buffer.length());
+  EXPECT_EQ(1, counter("zstd_window_too_large_error"));
+
+  ZstdDecompressorImpl larger_window_decompressor(stats_store_, "test.", default_chunk_size,
+                                                  nullptr, DefaultMaxWindowLog + 1);
+  larger_window_decompressor.decompress(compressed, output_buffer);
+  EXPECT_FALSE(larger_window_decompressor.decompression_error_);
+  EXPECT_EQ(jsonDocument(1), output_buffer.toString());
+}
+
+// Two dictionaries with the same ID can't be configured.
+TEST_F(ZstdDecompressorImplTest, DuplicateDictionary) {
+  EXPECT_THROW_WITH_MESSAGE(createFactory({1, 1}), EnvoyException,
+                            "duplicate zstd dictionary ID 1");
+}
+
+} // namespace
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -1,6 +1,8 @@
 #include "extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
 
 #include "test/mocks/event/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -17,20 +19,19 @@ namespace LocalRateLimit {
 class LocalRateLimiterImplTest : public testing::Test {
 public:
   void initialize(const std::chrono::milliseconds fill_interval, const uint32_t max_tokens,
-                  const uint32_t tokens_per_fill) {
-
-    fill_timer_ = new Event::MockTimer(&dispatcher_);
-    EXPECT_CALL(*fill_timer_, enableTimer(_, nullptr));
-    EXPECT_CALL(*fill_timer_, disableTimer());
+                  const uint32_t tokens_per_fill, const uint32_t max_descriptors = 0) {
+    // The bucket is filled lazily, without a timer.
+    EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
 
     rate_limiter_ = std::make_shared<LocalRateLimiterImpl>(fill_interval, max_tokens,
-                                                           tokens_per_fill, dispatcher_);
+                                                           tokens_per_fill, dispatcher_,
+                                                           max_descriptors);
   }
 
   Thread::ThreadSynchronizer& synchronizer() { return rate_limiter_->synchronizer_; }
 
+  Event::SimulatedTimeSystem time_system_;
   NiceMock<Event::MockDispatcher> dispatcher_;
-  Event::MockTimer* fill_timer_{};
   std::shared_ptr<LocalRateLimiterImpl> rate_limiter_;
 };
 
@@ -43,30 +44,28 @@ TEST_F(LocalRateLimiterImplTest, TooFastFillRate) {
 
 // Verify various token bucket CAS edge cases.
 TEST_F(LocalRateLimiterImplTest, CasEdgeCases) {
-  // This tests the case in which an allowed check races with the fill timer.
+  // This tests the case in which two allowed checks race on a fill, which is only added once.
   {
     initialize(std::chrono::milliseconds(50), 1, 1);
 
+    // 1 -> 0 tokens
+    EXPECT_TRUE(rate_limiter_->requestAllowed());
+    time_system_.advanceTimeWait(std::chrono::milliseconds(50));
+
     synchronizer().enable();
 
-    // Start a thread and start the fill callback. This will wait pre-CAS.
-    synchronizer().waitOn("on_fill_timer_pre_cas");
-    std::thread t1([&] {
-      EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(50), nullptr));
-      fill_timer_->invokeCallback();
-    });
+    // Start a thread that sees the fill and take its token. This will wait pre-CAS.
+    synchronizer().waitOn("allowed_pre_cas");
+    std::thread t1([&] { EXPECT_FALSE(rate_limiter_->requestAllowed()); });
     // Wait until the thread is actually waiting.
-    synchronizer().barrierOn("on_fill_timer_pre_cas");
+    synchronizer().barrierOn("allowed_pre_cas");
 
-    // This should succeed.
+    // This should succeed, and cause a CAS failure and the loop to repeat on the other thread,
+    // which must not add the fill again.
     EXPECT_TRUE(rate_limiter_->requestAllowed());
-
-    // Now signal the thread to continue which should cause a CAS failure and the loop to repeat.
-    synchronizer().signal("on_fill_timer_pre_cas");
+    synchronizer().signal("allowed_pre_cas");
     t1.join();
 
-    // 1 -> 0 tokens
-    EXPECT_TRUE(rate_limiter_->requestAllowed());
     EXPECT_FALSE(rate_limiter_->requestAllowed());
   }
 
@@ -99,20 +98,17 @@ TEST_F(LocalRateLimiterImplTest, TokenBucket) {
   EXPECT_FALSE(rate_limiter_->requestAllowed());
 
   // 0 -> 1 tokens
-  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(200), nullptr));
-  fill_timer_->invokeCallback();
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
 
   // 1 -> 0 tokens
   EXPECT_TRUE(rate_limiter_->requestAllowed());
   EXPECT_FALSE(rate_limiter_->requestAllowed());
 
   // 0 -> 1 tokens
-  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(200), nullptr));
-  fill_timer_->invokeCallback();
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
 
   // 1 -> 1 tokens
-  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(200), nullptr));
-  fill_timer_->invokeCallback();
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
 
   // 1 -> 0 tokens
   EXPECT_TRUE(rate_limiter_->requestAllowed());
@@ -129,15 +125,13 @@ TEST_F(LocalRateLimiterImplTest, TokenBucketMultipleTokensPerFill) {
   EXPECT_FALSE(rate_limiter_->requestAllowed());
 
   // 0 -> 2 tokens
-  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(200), nullptr));
-  fill_timer_->invokeCallback();
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
 
   // 2 -> 1 tokens
   EXPECT_TRUE(rate_limiter_->requestAllowed());
 
   // 1 -> 2 tokens
-  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(200), nullptr));
-  fill_timer_->invokeCallback();
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
 
   // 2 -> 0 tokens
   EXPECT_TRUE(rate_limiter_->requestAllowed());
@@ -155,14 +149,99 @@ TEST_F(LocalRateLimiterImplTest, TokenBucketMaxTokensGreaterThanTokensPerFill) {
   EXPECT_FALSE(rate_limiter_->requestAllowed());
 
   // 0 -> 1 tokens
-  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(200), nullptr));
-  fill_timer_->invokeCallback();
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
 
   // 1 -> 0 tokens
   EXPECT_TRUE(rate_limiter_->requestAllowed());
   EXPECT_FALSE(rate_limiter_->requestAllowed());
 }
 
+// Fills missed while nobody asked for a token are added at once, up to max tokens.
+TEST_F(LocalRateLimiterImplTest, TokenBucketMissedFills) {
+  initialize(std::chrono::milliseconds(200), 3, 1);
+
+  // 3 -> 0 tokens
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(rate_limiter_->requestAllowed());
+  }
+  EXPECT_FALSE(rate_limiter_->requestAllowed());
+
+  // 0 -> 2 tokens
+  time_system_.advanceTimeWait(std::chrono::milliseconds(450));
+
+  // 2 -> 0 tokens
+  EXPECT_TRUE(rate_limiter_->requestAllowed());
+  EXPECT_TRUE(rate_limiter_->requestAllowed());
+  EXPECT_FALSE(rate_limiter_->requestAllowed());
+
+  // Fills stay aligned to the creation of the bucket: 0 -> 1 tokens.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(150));
+  EXPECT_TRUE(rate_limiter_->requestAllowed());
+  EXPECT_FALSE(rate_limiter_->requestAllowed());
+
+  // 0 -> 3 tokens
+  time_system_.advanceTimeWait(std::chrono::seconds(100));
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(rate_limiter_->requestAllowed());
+  }
+  EXPECT_FALSE(rate_limiter_->requestAllowed());
+}
+
+// Tokens are split across shards, but a thread takes tokens from other shards once its own shard
+// is empty, so the bucket holds as many tokens as configured.
+TEST_F(LocalRateLimiterImplTest, Shards) {
+  initialize(std::chrono::milliseconds(200), 40, 20);
+
+  std::thread t1([&] {
+    for (int i = 0; i < 30; i++) {
+      EXPECT_TRUE(rate_limiter_->requestAllowed());
+    }
+  });
+  t1.join();
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(rate_limiter_->requestAllowed());
+  }
+  EXPECT_FALSE(rate_limiter_->requestAllowed());
+
+  // 0 -> 20 tokens
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
+  for (int i = 0; i < 20; i++) {
+    EXPECT_TRUE(rate_limiter_->requestAllowed());
+  }
+  EXPECT_FALSE(rate_limiter_->requestAllowed());
+}
+
+// Each descriptor has its own bucket.
+TEST_F(LocalRateLimiterImplTest, Descriptors) {
+  initialize(std::chrono::milliseconds(200), 1, 1, 100);
+
+  EXPECT_TRUE(rate_limiter_->requestAllowed("a"));
+  EXPECT_FALSE(rate_limiter_->requestAllowed("a"));
+  EXPECT_TRUE(rate_limiter_->requestAllowed("b"));
+  EXPECT_FALSE(rate_limiter_->requestAllowed("b"));
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
+  EXPECT_TRUE(rate_limiter_->requestAllowed("a"));
+  EXPECT_FALSE(rate_limiter_->requestAllowed("a"));
+
+  // A new descriptor gets a full bucket.
+  EXPECT_TRUE(rate_limiter_->requestAllowed("c"));
+  EXPECT_FALSE(rate_limiter_->requestAllowed("c"));
+}
+
+// The least recently seen descriptors are dropped.
+TEST_F(LocalRateLimiterImplTest, DescriptorEviction) {
+  initialize(std::chrono::milliseconds(200), 1, 1, 1);
+
+  EXPECT_TRUE(rate_limiter_->requestAllowed("a"));
+  EXPECT_FALSE(rate_limiter_->requestAllowed("a"));
+
+  // "b" replaces "a", which then gets a full bucket again.
+  EXPECT_TRUE(rate_limiter_->requestAllowed("b"));
+  EXPECT_TRUE(rate_limiter_->requestAllowed("a"));
+  EXPECT_FALSE(rate_limiter_->requestAllowed("a"));
+}
+
 } // Namespace LocalRateLimit
 } // namespace Common
 } // namespace Filters
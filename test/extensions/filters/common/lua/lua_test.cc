@@ -159,6 +159,80 @@ TEST_F(LuaTest, MarkDead) {
   lua_gc(cr1->luaState(), LUA_GCCOLLECT, 0);
 }
 
+// The Lua thread of a coroutine that ran to completion is reused by the next coroutine, but not
+// the thread of a coroutine that failed or that is still yielded.
+TEST_F(LuaTest, CoroutineReuse) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(object)
+      object:testCall()
+      setfenv(0, {})
+    end
+
+    function yieldMe()
+      coroutine.yield()
+    end
+
+    function failMe()
+      error("failed")
+    end
+  )EOF"};
+
+  setup(SCRIPT);
+  const int call_me = state_->getGlobalRef(state_->registerGlobal("callMe"));
+  const int yield_me = state_->getGlobalRef(state_->registerGlobal("yieldMe"));
+  const int fail_me = state_->getGlobalRef(state_->registerGlobal("failMe"));
+
+  CoroutinePtr cr1(state_->createCoroutine());
+  lua_State* thread = cr1->luaState();
+  // Stop the GC so that the memory of the threads that are not kept can't be reused by new ones.
+  lua_gc(thread, LUA_GCSTOP, 0);
+  LuaRef<TestObject> ref1(TestObject::create(cr1->luaState()), true);
+  EXPECT_CALL(*ref1.get(), doTestCall(_));
+  cr1->start(call_me, 1, yield_callback_);
+  EXPECT_EQ(cr1->state(), Coroutine::State::Finished);
+  cr1.reset();
+
+  // The thread is reused with an empty stack and the globals of the state, even though the script
+  // replaced its environment.
+  CoroutinePtr cr2(state_->createCoroutine());
+  EXPECT_EQ(thread, cr2->luaState());
+  EXPECT_EQ(0, lua_gettop(cr2->luaState()));
+  lua_getglobal(cr2->luaState(), "callMe");
+  EXPECT_TRUE(lua_isfunction(cr2->luaState(), -1));
+  lua_pop(cr2->luaState(), 1);
+  LuaRef<TestObject> ref2(TestObject::create(cr2->luaState()), true);
+  EXPECT_CALL(*ref2.get(), doTestCall(_));
+  cr2->start(call_me, 1, yield_callback_);
+  EXPECT_EQ(cr2->state(), Coroutine::State::Finished);
+
+  // A coroutine created while the thread is in use gets a new thread.
+  CoroutinePtr cr3(state_->createCoroutine());
+  EXPECT_NE(thread, cr3->luaState());
+  EXPECT_CALL(on_yield_, ready());
+  cr3->start(yield_me, 0, yield_callback_);
+  EXPECT_EQ(cr3->state(), Coroutine::State::Yielded);
+  lua_State* yielded_thread = cr3->luaState();
+  cr3.reset();
+  cr2.reset();
+
+  CoroutinePtr cr4(state_->createCoroutine());
+  EXPECT_EQ(thread, cr4->luaState());
+  EXPECT_THROW_WITH_MESSAGE(cr4->start(fail_me, 0, yield_callback_), LuaException,
+                            "[string \"...\"]:12: failed");
+  cr4.reset();
+
+  // Neither the yielded nor the failed thread were kept.
+  CoroutinePtr cr5(state_->createCoroutine());
+  EXPECT_NE(thread, cr5->luaState());
+  EXPECT_NE(yielded_thread, cr5->luaState());
+
+  EXPECT_CALL(*ref1.get(), onDestroy());
+  EXPECT_CALL(*ref2.get(), onDestroy());
+  ref1.reset();
+  ref2.reset();
+  lua_gc(cr5->luaState(), LUA_GCCOLLECT, 0);
+}
+
 class ThreadSafeTest : public testing::Test {
 public:
   ThreadSafeTest()
@@ -0,0 +1,264 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/config/ratelimit/v3/rls.pb.h"
+#include "envoy/service/ratelimit/v3/rls.pb.h"
+
+#include "common/grpc/common.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "extensions/filters/common/ratelimit/quota_lease_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+namespace {
+
+class MockRequestCallbacks : public RequestCallbacks {
+public:
+  void complete(LimitStatus status, DescriptorStatusListPtr&&, Http::ResponseHeaderMapPtr&&,
+                Http::RequestHeaderMapPtr&&) override {
+    complete_(status);
+  }
+
+  MOCK_METHOD(void, complete_, (LimitStatus status));
+};
+
+class QuotaLeasesTest : public testing::Test {
+public:
+  QuotaLeasesTest() {
+    auto* async_client_factory = new Grpc::MockAsyncClientFactory();
+    EXPECT_CALL(*async_client_factory, create()).WillOnce(Invoke([this] {
+      return Grpc::RawAsyncClientPtr{async_client_};
+    }));
+    cleanup_timer_ = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+
+    envoy::config::ratelimit::v3::RateLimitServiceConfig::QuotaLeases config;
+    config.set_lease_size(4);
+    config.mutable_lease_duration()->set_seconds(1);
+    quota_leases_ = std::make_shared<QuotaLeases>(
+        config, tls_, Grpc::AsyncClientFactoryPtr{async_client_factory},
+        std::chrono::milliseconds(20), envoy::config::core::v3::ApiVersion::V3);
+  }
+
+  // Expects a lease to be fetched, and keeps the callbacks to complete the fetch with.
+  void expectFetch() {
+    envoy::service::ratelimit::v3::RateLimitRequest request;
+    GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}});
+    request.set_hits_addend(4);
+    EXPECT_CALL(*async_client_,
+                sendRaw(_, "ShouldRateLimit", Grpc::ProtoBufferEq(request), _, _, _))
+        .WillOnce(Invoke([this](absl::string_view, absl::string_view, Buffer::InstancePtr&&,
+                                Grpc::RawAsyncRequestCallbacks& callbacks, Tracing::Span&,
+                                const Http::AsyncClient::RequestOptions&) -> Grpc::AsyncRequest* {
+          fetch_callbacks_ = &callbacks;
+          return &async_request_;
+        }));
+  }
+
+  void completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::Code code) {
+    envoy::service::ratelimit::v3::RateLimitResponse response;
+    response.set_overall_code(code);
+    Grpc::RawAsyncRequestCallbacks* callbacks = fetch_callbacks_;
+    fetch_callbacks_ = nullptr;
+    callbacks->onSuccessRaw(Grpc::Common::serializeMessage(response),
+                            Tracing::NullSpan::instance());
+  }
+
+  void limit(Client& client, MockRequestCallbacks& callbacks) {
+    client.limit(callbacks, "foo", {{{{"foo", "bar"}}}}, Tracing::NullSpan::instance(),
+                 stream_info_);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Grpc::MockAsyncClient* async_client_{new Grpc::MockAsyncClient()};
+  Grpc::MockAsyncRequest async_request_;
+  Event::MockTimer* cleanup_timer_;
+  QuotaLeasesSharedPtr quota_leases_;
+  Grpc::RawAsyncRequestCallbacks* fetch_callbacks_{};
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+};
+
+// The first request waits for a lease, and the following ones are decided locally until half of
+// the lease is used, at which point it is renewed in the background.
+TEST_F(QuotaLeasesTest, LeaseAndRenew) {
+  LeasedClientImpl client(*quota_leases_);
+  MockRequestCallbacks callbacks;
+
+  expectFetch();
+  limit(client, callbacks);
+
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  // The second request leaves half of the lease.
+  expectFetch();
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  limit(client, callbacks);
+
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  limit(client, callbacks);
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  // The renewed lease replaces the hit left, so the second request leaves half of it again.
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  limit(client, callbacks);
+  expectFetch();
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  limit(client, callbacks);
+}
+
+// A refused lease makes requests over limit until it expires.
+TEST_F(QuotaLeasesTest, OverLimitUntilExpiry) {
+  LeasedClientImpl client(*quota_leases_);
+  MockRequestCallbacks callbacks;
+
+  expectFetch();
+  limit(client, callbacks);
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OverLimit));
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT);
+
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OverLimit));
+  limit(client, callbacks);
+
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  expectFetch();
+  limit(client, callbacks);
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+}
+
+// Requests waiting for a lease that fails are completed with an error.
+TEST_F(QuotaLeasesTest, FetchFailure) {
+  LeasedClientImpl client1(*quota_leases_);
+  LeasedClientImpl client2(*quota_leases_);
+  MockRequestCallbacks callbacks1;
+  MockRequestCallbacks callbacks2;
+
+  expectFetch();
+  limit(client1, callbacks1);
+  limit(client2, callbacks2);
+
+  EXPECT_CALL(callbacks1, complete_(LimitStatus::Error));
+  EXPECT_CALL(callbacks2, complete_(LimitStatus::Error));
+  fetch_callbacks_->onFailure(Grpc::Status::Unavailable, "", Tracing::NullSpan::instance());
+}
+
+// Waiters beyond the hits granted by a lease wait for the next one.
+TEST_F(QuotaLeasesTest, MoreWaitersThanHits) {
+  std::vector<std::unique_ptr<LeasedClientImpl>> clients;
+  std::vector<std::unique_ptr<MockRequestCallbacks>> callbacks;
+  expectFetch();
+  for (int i = 0; i < 5; i++) {
+    clients.push_back(std::make_unique<LeasedClientImpl>(*quota_leases_));
+    callbacks.push_back(std::make_unique<MockRequestCallbacks>());
+    limit(*clients.back(), *callbacks.back());
+  }
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_CALL(*callbacks[i], complete_(LimitStatus::OK));
+  }
+  expectFetch();
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  EXPECT_CALL(*callbacks[4], complete_(LimitStatus::OK));
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+}
+
+// A cancelled request is not completed, and the fetch outlives it.
+TEST_F(QuotaLeasesTest, Cancel) {
+  LeasedClientImpl client(*quota_leases_);
+  MockRequestCallbacks callbacks;
+
+  expectFetch();
+  limit(client, callbacks);
+  client.cancel();
+
+  EXPECT_CALL(callbacks, complete_(_)).Times(0);
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+}
+
+// Expired leases are forgotten, and an outstanding fetch is cancelled with its worker's leases.
+TEST_F(QuotaLeasesTest, Cleanup) {
+  LeasedClientImpl client(*quota_leases_);
+  MockRequestCallbacks callbacks;
+
+  expectFetch();
+  limit(client, callbacks);
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK));
+  completeFetch(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_CALL(*cleanup_timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  cleanup_timer_->invokeCallback();
+
+  // The lease is fetched again from scratch.
+  expectFetch();
+  limit(client, callbacks);
+  client.cancel();
+
+  EXPECT_CALL(async_request_, cancel());
+  tls_.shutdownThread();
+}
+
+// Destroying the configuration destroys the leases of the workers, and with them any outstanding
+// fetch, while its clients may live on with the filters using them. Requests waiting for a lease
+// are completed with an error.
+TEST_F(QuotaLeasesTest, ConfigDestroyedBeforeClient) {
+  LeasedClientImpl client1(*quota_leases_);
+  LeasedClientImpl client2(*quota_leases_);
+  MockRequestCallbacks callbacks1;
+  MockRequestCallbacks callbacks2;
+
+  expectFetch();
+  limit(client1, callbacks1);
+  limit(client2, callbacks2);
+
+  EXPECT_CALL(async_request_, cancel());
+  EXPECT_CALL(callbacks1, complete_(LimitStatus::Error));
+  EXPECT_CALL(callbacks2, complete_(LimitStatus::Error));
+  quota_leases_.reset();
+
+  EXPECT_CALL(callbacks1, complete_(LimitStatus::Error));
+  limit(client1, callbacks1);
+}
+
+// A request completed as the leases are destroyed may make another one, which fails.
+TEST_F(QuotaLeasesTest, RequestMadeAsLeasesAreDestroyed) {
+  LeasedClientImpl client(*quota_leases_);
+  MockRequestCallbacks callbacks;
+
+  expectFetch();
+  limit(client, callbacks);
+
+  EXPECT_CALL(async_request_, cancel());
+  EXPECT_CALL(callbacks, complete_(LimitStatus::Error))
+      .WillOnce(Invoke([&](LimitStatus) -> void { limit(client, callbacks); }))
+      .WillOnce(testing::Return());
+  quota_leases_.reset();
+}
+
+} // namespace
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -2,6 +2,7 @@
 #include "envoy/config/rbac/v3/rbac.pb.h"
 #include "envoy/config/rbac/v3/rbac.pb.validate.h"
 
+#include "common/network/address_impl.h"
 #include "common/network/utility.h"
 
 #include "extensions/filters/common/rbac/engine_impl.h"
@@ -453,6 +454,97 @@ TEST(RoleBasedAccessControlEngineImpl, LogIfMatched) {
   checkEngine(engine, true, RBAC::LogResult::No, info, conn, headers);
 }
 
+// With enough policies, the policies that can't match are ruled out by an index. The effective
+// policy is still the first matching one in name order.
+TEST(RoleBasedAccessControlEngineImpl, IndexedPolicies) {
+  envoy::config::rbac::v3::RBAC rbac;
+  TestUtility::loadFromYaml(R"EOF(
+action: ALLOW
+policies:
+  a-source:
+    permissions: [{any: true}]
+    principals: [{source_ip: {address_prefix: 10.0.0.0, prefix_len: 8}}]
+  b-header:
+    permissions: [{any: true}]
+    principals: [{header: {name: x-team, exact_match: blue}}]
+  c-regex:
+    permissions:
+    - header: {name: x-user, safe_regex_match: {google_re2: {}, regex: "admin-[0-9]+"}}
+    principals: [{any: true}]
+  d-path:
+    permissions: [{url_path: {path: {exact: /admin}}}]
+    principals: [{any: true}]
+  e-port:
+    permissions:
+    - and_rules:
+        rules:
+        - destination_port: 8443
+        - header: {name: x-tls, present_match: true}
+    principals: [{not_id: {source_ip: {address_prefix: 192.168.0.0, prefix_len: 16}}}]
+  f-unindexed:
+    permissions: [{any: true}]
+    principals: [{header: {name: x-fallback, present_match: true}}]
+)EOF",
+                            rbac);
+  RBAC::RoleBasedAccessControlEngineImpl engine(rbac);
+
+  NiceMock<Envoy::Network::MockConnection> conn;
+  NiceMock<StreamInfo::MockStreamInfo> info;
+  const auto check = [&](const Envoy::Http::RequestHeaderMap& headers,
+                         const std::string& expected_policy_id) {
+    std::string effective_policy_id;
+    EXPECT_EQ(!expected_policy_id.empty(),
+              engine.handleAction(conn, headers, info, &effective_policy_id));
+    EXPECT_EQ(expected_policy_id, effective_policy_id);
+  };
+
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-team", "blue"}}, "a-source");
+
+  conn.remote_address_ = Envoy::Network::Utility::parseInternetAddress("192.168.1.1", 1234);
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-team", "blue"}}, "b-header");
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-team", "red"}, {"x-user", "admin-12"}},
+        "c-regex");
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-user", "admin-x"}}, "");
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-user", "admin-x"}, {":path", "/admin?x=1"}},
+        "d-path");
+
+  info.downstream_local_address_ = Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 8443);
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-tls", "1"}}, "");
+  conn.remote_address_ = Envoy::Network::Utility::parseInternetAddress("::1", 1234);
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-tls", "1"}}, "e-port");
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-tls", "1"}, {"x-team", "blue"}}, "b-header");
+
+  conn.remote_address_ = std::make_shared<Envoy::Network::Address::PipeInstance>("/foo");
+  check(Envoy::Http::TestRequestHeaderMapImpl{}, "");
+  check(Envoy::Http::TestRequestHeaderMapImpl{{"x-fallback", "1"}}, "f-unindexed");
+}
+
+TEST(RoleBasedAccessControlEngineImpl, DecisionDependsOnlyOnConnection) {
+  envoy::config::rbac::v3::Policy policy;
+  policy.add_permissions()->set_destination_port(123);
+  policy.add_principals()->set_any(true);
+
+  envoy::config::rbac::v3::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+  (*rbac.mutable_policies())["foo"] = policy;
+  EXPECT_TRUE(RBAC::RoleBasedAccessControlEngineImpl(rbac).decisionDependsOnlyOnConnection());
+
+  envoy::config::rbac::v3::Policy metadata_policy;
+  metadata_policy.add_permissions()->set_any(true);
+  metadata_policy.add_principals()->mutable_not_id()->mutable_metadata()->set_filter("foo");
+  (*rbac.mutable_policies())["bar"] = metadata_policy;
+  EXPECT_FALSE(RBAC::RoleBasedAccessControlEngineImpl(rbac).decisionDependsOnlyOnConnection());
+
+  rbac.mutable_policies()->erase("bar");
+  policy.mutable_condition()->MergeFrom(
+      TestUtility::parseYaml<google::api::expr::v1alpha1::Expr>(R"EOF(
+    const_expr:
+      bool_value: true
+  )EOF"));
+  (*rbac.mutable_policies())["foo"] = policy;
+  EXPECT_FALSE(RBAC::RoleBasedAccessControlEngineImpl(rbac).decisionDependsOnlyOnConnection());
+}
+
 } // namespace
 } // namespace RBAC
 } // namespace Common
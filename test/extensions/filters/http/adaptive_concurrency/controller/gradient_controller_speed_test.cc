@@ -0,0 +1,99 @@
+// Measures the throughput of a gradient controller shared by several workers, each of which asks
+// for a forwarding decision and records the latency of the request, as the adaptive concurrency
+// filter does.
+
+#include <chrono>
+#include <memory>
+
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.validate.h"
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/controller/gradient_controller.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace Controller {
+namespace {
+
+// The limit is high enough for every request to be forwarded, so that the benchmark measures the
+// cost of the decision and of the sample rather than the cost of blocking.
+const std::string ControllerYaml = R"EOF(
+sample_aggregate_percentile:
+  value: 50
+concurrency_limit_params:
+  max_concurrency_limit: 100000
+  concurrency_update_interval: 0.1s
+min_rtt_calc_params:
+  jitter:
+    value: 0.0
+  interval: 3600s
+  request_count: 50
+  min_concurrency: 100000
+)EOF";
+
+class ControllerPerf {
+public:
+  ControllerPerf()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {
+    envoy::extensions::filters::http::adaptive_concurrency::v3::GradientControllerConfig proto;
+    TestUtility::loadFromYamlAndValidate(ControllerYaml, proto);
+    controller_ = std::make_unique<GradientController>(
+        GradientControllerConfig(proto, runtime_), *dispatcher_, runtime_, "test_prefix.", store_,
+        random_, api_->timeSource());
+
+    // Get the minRTT measurement out of the way, so that the samples are taken for the sample
+    // window as they mostly are in production.
+    for (uint32_t i = 0; i < proto.min_rtt_calc_params().request_count().value(); ++i) {
+      request();
+    }
+  }
+
+  void request() {
+    const MonotonicTime start = api_->timeSource().monotonicTime();
+    if (controller_->forwardingDecision() == RequestForwardingAction::Forward) {
+      controller_->recordLatencySample(start);
+    }
+  }
+
+private:
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  testing::NiceMock<Random::MockRandomGenerator> random_;
+  Stats::IsolatedStoreImpl store_;
+  std::unique_ptr<GradientController> controller_;
+};
+
+std::unique_ptr<ControllerPerf> perf;
+
+static void gradientControllerRequests(benchmark::State& state) {
+  // The workers only start their iterations once the first one has created the controller.
+  if (state.thread_index == 0) {
+    perf = std::make_unique<ControllerPerf>();
+  }
+  for (auto _ : state) {
+    perf->request();
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index == 0) {
+    perf.reset();
+  }
+}
+BENCHMARK(gradientControllerRequests)->ThreadRange(1, 32)->UseRealTime();
+
+} // namespace
+} // namespace Controller
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,7 @@
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <vector>
 
 #include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
 #include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.validate.h"
@@ -786,6 +788,88 @@ min_rtt_calc_params:
   }
 }
 
+// Verify that the latency samples recorded by several workers are all aggregated in the sample
+// window.
+TEST_F(GradientControllerTest, SamplesFromMultipleThreads) {
+  const std::string yaml = R"EOF(
+sample_aggregate_percentile:
+  value: 50
+concurrency_limit_params:
+  max_concurrency_limit:
+  concurrency_update_interval: 0.1s
+min_rtt_calc_params:
+  jitter:
+    value: 0.0
+  interval: 30s
+  request_count: 5
+  buffer:
+    value: 0
+  min_concurrency: 100
+)EOF";
+
+  auto controller = makeController(yaml);
+  advancePastMinRTTStage(controller, yaml, std::chrono::milliseconds(5));
+  verifyMinRTTInactive();
+
+  // Each worker records samples of a different latency, so that the median is only 8ms if the
+  // samples of all of the workers are aggregated.
+  std::vector<Thread::ThreadPtr> threads;
+  for (int t = 0; t < 5; ++t) {
+    threads.push_back(api_->threadFactory().createThread([this, &controller, t]() {
+      for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(RequestForwardingAction::Forward, controller->forwardingDecision());
+        sampleLatency(controller, std::chrono::milliseconds(6 + t));
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  time_system_.advanceTimeAndRun(std::chrono::milliseconds(101), *dispatcher_,
+                                 Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(8, stats_.gauge("test_prefix.sample_rtt_msecs", Stats::Gauge::ImportMode::NeverImport)
+                   .value());
+}
+
+// Verify that concurrent forwarding decisions never admit more requests than the limit.
+TEST_F(GradientControllerTest, ConcurrentForwardingDecisions) {
+  const std::string yaml = R"EOF(
+sample_aggregate_percentile:
+  value: 50
+concurrency_limit_params:
+  max_concurrency_limit:
+  concurrency_update_interval: 0.1s
+min_rtt_calc_params:
+  jitter:
+    value: 0.0
+  interval: 30s
+  request_count: 5
+  min_concurrency: 50
+)EOF";
+
+  auto controller = makeController(yaml);
+  EXPECT_EQ(controller->concurrencyLimit(), 50);
+
+  std::atomic<uint32_t> forwarded{0};
+  std::vector<Thread::ThreadPtr> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.push_back(api_->threadFactory().createThread([&controller, &forwarded]() {
+      for (int i = 0; i < 1000; ++i) {
+        if (controller->forwardingDecision() == RequestForwardingAction::Forward) {
+          ++forwarded;
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  EXPECT_EQ(50, forwarded.load());
+  EXPECT_EQ(8 * 1000 - 50, stats_.counter("test_prefix.rq_blocked").value());
+}
+
 } // namespace
 } // namespace Controller
 } // namespace AdaptiveConcurrency
@@ -799,6 +799,106 @@ TEST_F(VaryHeaderTest, PossibleVariedHeadersMultiHeaders) {
   EXPECT_FALSE(result->get(Http::LowerCaseString("width")));
 }
 
+class AcceptEncodingVaryHeaderTest : public testing::Test {
+protected:
+  AcceptEncodingVaryHeaderTest() : vary_allow_list_(allowedVaryHeaders(), contentEncodings()) {}
+
+  static Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher> allowedVaryHeaders() {
+    Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher> allow_list;
+    allow_list.Add()->set_exact("accept-encoding");
+    allow_list.Add()->set_exact("accept");
+    return allow_list;
+  }
+
+  static Protobuf::RepeatedPtrField<std::string> contentEncodings() {
+    Protobuf::RepeatedPtrField<std::string> content_encodings;
+    *content_encodings.Add() = "br";
+    *content_encodings.Add() = "gzip";
+    return content_encodings;
+  }
+
+  std::string normalize(absl::string_view accept_encoding) {
+    return vary_allow_list_.normalizeAcceptEncoding({accept_encoding});
+  }
+
+  VaryHeader vary_allow_list_;
+};
+
+TEST_F(AcceptEncodingVaryHeaderTest, NormalizeAcceptEncoding) {
+  // Unknown codings are dropped, and codings are ranked by q-value, then by position.
+  EXPECT_EQ("gzip,br", normalize("gzip, deflate, br"));
+  EXPECT_EQ("gzip,br", normalize("br;q=0.9, gzip"));
+  EXPECT_EQ("br,gzip", normalize("br, gzip"));
+  EXPECT_EQ("gzip", normalize("gzip"));
+  EXPECT_EQ("gzip", normalize("GZIP, gzip"));
+  // Only the highest q-value of a coding counts.
+  EXPECT_EQ("br,gzip", normalize("gzip;q=0.5, br;q=0.8, gzip;q=0.6"));
+  EXPECT_EQ("gzip,br", normalize("gzip;q=0.5, br;q=0.8, gzip;Q=1"));
+}
+
+TEST_F(AcceptEncodingVaryHeaderTest, NormalizeAcceptEncodingIdentity) {
+  EXPECT_EQ("", normalize(""));
+  EXPECT_EQ("", normalize("deflate"));
+  EXPECT_EQ("identity", normalize("identity"));
+  EXPECT_EQ("identity,gzip", normalize("identity;q=0.5, gzip;q=0.5"));
+  EXPECT_EQ("gzip,identity", normalize("gzip;q=0.5, identity;q=0.5"));
+  // Unlike the compression codings, identity is not accepted by the wildcard.
+  EXPECT_EQ("br,gzip", normalize("*"));
+}
+
+TEST_F(AcceptEncodingVaryHeaderTest, NormalizeAcceptEncodingWildcard) {
+  // Codings accepted by the wildcard are ranked in the configured order.
+  EXPECT_EQ("br,gzip", normalize("deflate, *"));
+  EXPECT_EQ("gzip,br", normalize("gzip, *;q=0.5"));
+  EXPECT_EQ("br", normalize("gzip;q=0, *"));
+  EXPECT_EQ("gzip", normalize("gzip, *;q=0"));
+}
+
+TEST_F(AcceptEncodingVaryHeaderTest, NormalizeAcceptEncodingRefused) {
+  EXPECT_EQ("br", normalize("gzip;q=0, br"));
+  // A coding refused anywhere in the header is never used.
+  EXPECT_EQ("br", normalize("gzip, br;q=0.5, gzip;q=0"));
+  // Codings with an invalid q-value are ignored.
+  EXPECT_EQ("br", normalize("gzip;q=invalid, br;q=0.5"));
+}
+
+TEST_F(AcceptEncodingVaryHeaderTest, NormalizeAcceptEncodingMultipleHeaders) {
+  EXPECT_EQ("gzip,br", vary_allow_list_.normalizeAcceptEncoding({"gzip", "br;q=0.5"}));
+}
+
+TEST_F(AcceptEncodingVaryHeaderTest, PossibleVariedHeadersNormalized) {
+  Http::TestRequestHeaderMapImpl request_headers1{{"accept-encoding", "gzip, deflate, br"},
+                                                  {"accept", "text/html"}};
+  Http::TestRequestHeaderMapImpl request_headers2{{"accept-encoding", "br;q=0.9"},
+                                                  {"accept-encoding", "gzip"},
+                                                  {"accept", "text/html"}};
+  Http::TestResponseHeaderMapImpl response_headers{{"vary", "accept-encoding, accept"}};
+
+  Http::RequestHeaderMapPtr varied_headers1 =
+      vary_allow_list_.possibleVariedHeaders(request_headers1);
+  Http::RequestHeaderMapPtr varied_headers2 =
+      vary_allow_list_.possibleVariedHeaders(request_headers2);
+  EXPECT_EQ("gzip,br", varied_headers1->get(Http::LowerCaseString("accept-encoding"))
+                           ->value()
+                           .getStringView());
+  EXPECT_EQ("text/html",
+            varied_headers1->get(Http::LowerCaseString("accept"))->value().getStringView());
+  EXPECT_EQ(VaryHeader::createVaryKey(response_headers.get(Http::Headers::get().Vary),
+                                      *varied_headers1),
+            VaryHeader::createVaryKey(response_headers.get(Http::Headers::get().Vary),
+                                      *varied_headers2));
+
+  // Requests that don't accept any of the encodings share the variant of requests without an
+  // accept-encoding header.
+  Http::TestRequestHeaderMapImpl request_headers3{{"accept-encoding", "deflate"},
+                                                  {"accept", "text/html"}};
+  Http::TestRequestHeaderMapImpl request_headers4{{"accept", "text/html"}};
+  EXPECT_EQ(VaryHeader::createVaryKey(response_headers.get(Http::Headers::get().Vary),
+                                      *vary_allow_list_.possibleVariedHeaders(request_headers3)),
+            VaryHeader::createVaryKey(response_headers.get(Http::Headers::get().Vary),
+                                      *vary_allow_list_.possibleVariedHeaders(request_headers4)));
+}
+
 } // namespace
 } // namespace Cache
 } // namespace HttpFilters
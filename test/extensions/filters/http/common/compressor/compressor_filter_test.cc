@@ -4,15 +4,22 @@
 
 #include "common/protobuf/utility.h"
 
+#include "extensions/compression/gzip/compressor/zlib_block_compressor_impl.h"
+#include "extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
 #include "extensions/filters/http/common/compressor/compressor.h"
 
 #include "test/mocks/compression/compressor/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/protobuf/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -22,6 +29,8 @@ namespace Common {
 namespace Compressors {
 
 using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
 using testing::Return;
 
 class TestCompressorFilterConfig : public CompressorFilterConfig {
@@ -34,7 +43,7 @@ public:
                                compressor_name) {}
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor() override {
-    auto compressor = std::make_unique<Compression::Compressor::MockCompressor>();
+    auto compressor = std::make_unique<Envoy::Compression::Compressor::MockCompressor>();
     EXPECT_CALL(*compressor, compress(_, _)).Times(expected_compress_calls_);
     return compressor;
   }
@@ -716,6 +725,209 @@ TEST(LegacyTest, GzipStats) {
   EXPECT_EQ(2, stats.counter("test.gzip.compressed").value());
 }
 
+class TestParallelCompressorFilterConfig : public TestCompressorFilterConfig {
+public:
+  TestParallelCompressorFilterConfig(
+      const envoy::extensions::filters::http::compressor::v3::Compressor& compressor,
+      Stats::Scope& scope, Runtime::Loader& runtime)
+      : TestCompressorFilterConfig(compressor, "test.", scope, runtime, "test"),
+        parallel_compression_(compressor.parallel_compression(), Thread::threadFactoryForTest(),
+                              main_thread_dispatcher_) {}
+
+  Envoy::Compression::Compressor::BlockCompressorSharedPtr makeBlockCompressor() override {
+    return std::make_shared<Extensions::Compression::Gzip::Compressor::ZlibBlockCompressorImpl>(
+        Extensions::Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+        Extensions::Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::
+            Standard,
+        15, 8);
+  }
+  ParallelCompressionConfig* parallelCompression() override { return &parallel_compression_; }
+
+private:
+  NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
+  ParallelCompressionConfig parallel_compression_;
+};
+
+class ParallelCompressorFilterTest : public testing::Test {
+public:
+  ParallelCompressorFilterTest() {
+    ON_CALL(runtime_.snapshot_, featureEnabled("test.filter_enabled", 100))
+        .WillByDefault(Return(true));
+    envoy::extensions::filters::http::compressor::v3::Compressor compressor;
+    TestUtility::loadFromJson(R"EOF(
+{
+  "parallel_compression": {
+    "threads": 2,
+    "min_content_length": 65536,
+    "block_size": 32768,
+    "max_pending_blocks": 2
+  }
+}
+)EOF",
+                              compressor);
+    config_ = std::make_shared<TestParallelCompressorFilterConfig>(compressor, stats_, runtime_);
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+
+    // The blocks compressed on the pool are handed back to the worker through its dispatcher.
+    EXPECT_CALL(encoder_callbacks_.dispatcher_, post(_))
+        .WillRepeatedly(Invoke([this](std::function<void()> callback) {
+          absl::MutexLock lock(&mutex_);
+          posted_callbacks_.push_back(callback);
+        }));
+    ON_CALL(encoder_callbacks_, injectEncodedDataToFilterChain(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool end_stream) {
+          EXPECT_FALSE(end_stream_);
+          output_.move(data);
+          end_stream_ = end_stream;
+        }));
+
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "get"},
+                                                   {"accept-encoding", "test"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->decodeHeaders(request_headers, false));
+  }
+
+  // Waits for the pool to compress the given number of blocks, then runs their callbacks on this
+  // thread, in reverse order so that the blocks have to be put back in order.
+  void runCompressedBlocks(size_t count) {
+    std::vector<std::function<void()>> callbacks;
+    {
+      absl::MutexLock lock(&mutex_);
+      expected_callbacks_ = count;
+      mutex_.Await(absl::Condition(this, &ParallelCompressorFilterTest::hasExpectedCallbacks));
+      callbacks.swap(posted_callbacks_);
+    }
+    EXPECT_EQ(count, callbacks.size());
+    for (auto it = callbacks.rbegin(); it != callbacks.rend(); ++it) {
+      (*it)();
+    }
+  }
+
+  std::string decompressOutput() {
+    Extensions::Compression::Gzip::Decompressor::ZlibDecompressorImpl decompressor(stats_,
+                                                                                   "test.");
+    decompressor.init(31);
+    Buffer::OwnedImpl decompressed;
+    decompressor.decompress(output_, decompressed);
+    EXPECT_EQ(0, decompressor.decompression_error_);
+    return decompressed.toString();
+  }
+
+  void doResponse(bool with_trailers) {
+    Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "100000"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ("", headers.get_("content-length"));
+    EXPECT_EQ("test", headers.get_("content-encoding"));
+    EXPECT_EQ(1, stats_.counter("test.test.compressed_in_parallel").value());
+
+    std::string body;
+    for (uint32_t i = 0; body.size() < 100000; ++i) {
+      absl::StrAppend(&body, "line ", i % 1000, " of the response body\n");
+    }
+    body.resize(100000);
+
+    // The body is compressed in 4 blocks of 32KiB, the last one being shorter. The filter asks the
+    // upstream to pause once 2 of them are pending.
+    EXPECT_CALL(encoder_callbacks_, onEncoderFilterAboveWriteBufferHighWatermark());
+    EXPECT_CALL(encoder_callbacks_, onEncoderFilterBelowWriteBufferLowWatermark());
+    Buffer::OwnedImpl data1(body.substr(0, 50000));
+    EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(data1, false));
+    EXPECT_EQ(0, data1.length());
+    Buffer::OwnedImpl data2(body.substr(50000));
+    EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer,
+              filter_->encodeData(data2, !with_trailers));
+    if (with_trailers) {
+      Http::TestResponseTrailerMapImpl trailers;
+      EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->encodeTrailers(trailers));
+      EXPECT_CALL(encoder_callbacks_, continueEncoding());
+    }
+
+    runCompressedBlocks(4);
+    EXPECT_EQ(!with_trailers, end_stream_);
+    EXPECT_EQ(100000, stats_.counter("test.test.total_uncompressed_bytes").value());
+    EXPECT_EQ(output_.length(), stats_.counter("test.test.total_compressed_bytes").value());
+    EXPECT_EQ(body, decompressOutput());
+  }
+
+  bool hasExpectedCallbacks() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return posted_callbacks_.size() >= expected_callbacks_;
+  }
+
+  absl::Mutex mutex_;
+  std::vector<std::function<void()>> posted_callbacks_ ABSL_GUARDED_BY(mutex_);
+  size_t expected_callbacks_ ABSL_GUARDED_BY(mutex_){};
+  Buffer::OwnedImpl output_;
+  bool end_stream_{};
+  Stats::TestUtil::TestStore stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  std::shared_ptr<TestParallelCompressorFilterConfig> config_;
+  std::unique_ptr<CompressorFilter> filter_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+};
+
+TEST_F(ParallelCompressorFilterTest, CompressInBlocks) { doResponse(false); }
+
+TEST_F(ParallelCompressorFilterTest, CompressInBlocksWithTrailers) { doResponse(true); }
+
+// Blocks compressed after the filter is destroyed are dropped.
+TEST_F(ParallelCompressorFilterTest, DestroyedWhileCompressing) {
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "100000"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  Buffer::OwnedImpl data(std::string(100000, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(data, true));
+
+  EXPECT_CALL(encoder_callbacks_, injectEncodedDataToFilterChain(_, _)).Times(0);
+  filter_->onDestroy();
+  runCompressedBlocks(4);
+}
+
+// Responses shorter than min_content_length, or without a content length, are compressed inline.
+TEST_F(ParallelCompressorFilterTest, CompressInline) {
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "1000"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ("test", headers.get_("content-encoding"));
+  EXPECT_EQ(0, stats_.counter("test.test.compressed_in_parallel").value());
+  Buffer::OwnedImpl data(std::string(1000, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+}
+
+// A config destroyed off the main thread, with the last filter using it, leaves the destruction of
+// its pool to the main thread rather than waiting for the pool's blocks.
+TEST(ParallelCompressionConfigTest, DestroyedOffMainThread) {
+  envoy::extensions::filters::http::compressor::v3::Compressor::ParallelCompression config;
+  config.set_threads(1);
+  NiceMock<Event::MockDispatcher> main_thread_dispatcher;
+  auto parallel_compression = std::make_unique<ParallelCompressionConfig>(
+      config, Thread::threadFactoryForTest(), main_thread_dispatcher);
+
+  absl::Notification block_started;
+  absl::Notification release_block;
+  bool block_done = false;
+  parallel_compression->pool().post([&]() {
+    block_started.Notify();
+    release_block.WaitForNotification();
+    block_done = true;
+  });
+  block_started.WaitForNotification();
+
+  std::function<void()> destroy_pool;
+  EXPECT_CALL(main_thread_dispatcher, isThreadSafe()).WillOnce(Return(false));
+  EXPECT_CALL(main_thread_dispatcher, post(_)).WillOnce(Invoke([&](std::function<void()> cb) {
+    destroy_pool = std::move(cb);
+  }));
+  parallel_compression.reset();
+  EXPECT_FALSE(block_done);
+
+  // The main thread runs the posted callback, after which the pool is destroyed with it.
+  release_block.Notify();
+  destroy_pool();
+  destroy_pool = nullptr;
+  EXPECT_TRUE(block_done);
+}
+
 } // namespace Compressors
 } // namespace Common
 } // namespace HttpFilters
@@ -1,8 +1,11 @@
 #include "extensions/filters/http/compressor/compressor_filter.h"
 
 #include "test/mocks/compression/compressor/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
 
@@ -13,18 +16,75 @@ namespace Compressor {
 namespace {
 
 using testing::NiceMock;
+using testing::Return;
 
 TEST(CompressorFilterConfigTests, MakeCompressorTest) {
   const envoy::extensions::filters::http::compressor::v3::Compressor compressor_cfg;
   NiceMock<Runtime::MockLoader> runtime;
   Stats::TestUtil::TestStore stats;
+  NiceMock<Event::MockDispatcher> dispatcher;
   auto compressor_factory(std::make_unique<Compression::Compressor::MockCompressorFactory>());
   EXPECT_CALL(*compressor_factory, createCompressor()).Times(1);
   EXPECT_CALL(*compressor_factory, statsPrefix()).Times(1);
   EXPECT_CALL(*compressor_factory, contentEncoding()).Times(1);
   CompressorFilterConfig config(compressor_cfg, "test.compressor.", stats, runtime,
-                                std::move(compressor_factory));
+                                std::move(compressor_factory), Thread::threadFactoryForTest(),
+                                dispatcher);
   Envoy::Compression::Compressor::CompressorPtr compressor = config.makeCompressor();
+  EXPECT_EQ(nullptr, config.parallelCompression());
+  EXPECT_EQ(nullptr, config.makeBlockCompressor());
+}
+
+TEST(CompressorFilterConfigTests, ParallelCompressionTest) {
+  envoy::extensions::filters::http::compressor::v3::Compressor compressor_cfg;
+  TestUtility::loadFromJson(R"EOF(
+{
+  "parallel_compression": {
+    "threads": 1
+  }
+}
+)EOF",
+                            compressor_cfg);
+  NiceMock<Runtime::MockLoader> runtime;
+  Stats::TestUtil::TestStore stats;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  auto compressor_factory(
+      std::make_unique<NiceMock<Compression::Compressor::MockCompressorFactory>>());
+  EXPECT_CALL(*compressor_factory, createBlockCompressor())
+      .WillRepeatedly(Return(std::make_shared<Compression::Compressor::MockBlockCompressor>()));
+  CompressorFilterConfig config(compressor_cfg, "test.compressor.", stats, runtime,
+                                std::move(compressor_factory), Thread::threadFactoryForTest(),
+                                dispatcher);
+  ASSERT_NE(nullptr, config.parallelCompression());
+  EXPECT_EQ(1024 * 1024, config.parallelCompression()->minContentLength());
+  EXPECT_EQ(128 * 1024, config.parallelCompression()->blockSize());
+  EXPECT_EQ(4, config.parallelCompression()->maxPendingBlocks());
+  EXPECT_NE(nullptr, config.makeBlockCompressor());
+}
+
+TEST(CompressorFilterConfigTests, ParallelCompressionNotSupportedTest) {
+  envoy::extensions::filters::http::compressor::v3::Compressor compressor_cfg;
+  TestUtility::loadFromJson(R"EOF(
+{
+  "compressor_library": {
+    "name": "mock"
+  },
+  "parallel_compression": {
+    "threads": 1
+  }
+}
+)EOF",
+                            compressor_cfg);
+  NiceMock<Runtime::MockLoader> runtime;
+  Stats::TestUtil::TestStore stats;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  auto compressor_factory(
+      std::make_unique<NiceMock<Compression::Compressor::MockCompressorFactory>>());
+  EXPECT_THROW_WITH_MESSAGE(
+      CompressorFilterConfig(compressor_cfg, "test.compressor.", stats, runtime,
+                             std::move(compressor_factory), Thread::threadFactoryForTest(),
+                             dispatcher),
+      EnvoyException, "Compressor library 'mock' can't compress in parallel");
 }
 
 } // namespace
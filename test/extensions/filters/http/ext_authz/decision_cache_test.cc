@@ -0,0 +1,238 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/filters/http/ext_authz/v3/ext_authz.pb.h"
+
+#include "extensions/filters/http/ext_authz/decision_cache.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+namespace {
+
+using Filters::Common::ExtAuthz::CheckStatus;
+using Filters::Common::ExtAuthz::Response;
+
+class MockWaiter : public DecisionCache::Waiter {
+public:
+  MOCK_METHOD(void, onDecision, (const DecisionCache::Decision& decision));
+};
+
+class DecisionCacheTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::extensions::filters::http::ext_authz::v3::DecisionCache config;
+    TestUtility::loadFromYaml(yaml, config);
+    cache_ = std::make_unique<DecisionCache>(config);
+  }
+
+  DecisionCache::LookupStatus lookup(const std::string& key) {
+    decision_.reset();
+    return cache_->lookup(key, now_, decision_, waiter_, dispatcher_);
+  }
+
+  static Response response(CheckStatus status) {
+    Response response{};
+    response.status = status;
+    return response;
+  }
+
+  std::unique_ptr<DecisionCache> cache_;
+  MonotonicTime now_{std::chrono::seconds(1000)};
+  DecisionCache::Decision decision_;
+  std::shared_ptr<MockWaiter> waiter_{std::make_shared<NiceMock<MockWaiter>>()};
+  NiceMock<Event::MockDispatcher> dispatcher_;
+};
+
+// Verifies that the key is made of the configured headers, path segments and metadata only.
+TEST_F(DecisionCacheTest, Key) {
+  initialize(R"EOF(
+  headers: ["authorization", ":method"]
+  path_segments: 2
+  metadata:
+  - key: envoy.filters.http.jwt_authn
+    path:
+    - key: sub
+  ttl: 10s
+  )EOF");
+
+  envoy::config::core::v3::Metadata metadata;
+  TestUtility::loadFromYaml(R"EOF(
+  filter_metadata:
+    envoy.filters.http.jwt_authn:
+      sub: alice
+  )EOF",
+                            metadata);
+
+  Http::TestRequestHeaderMapImpl headers{{":method", "GET"},
+                                         {":path", "/api/v1/users/1?verbose"},
+                                         {"authorization", "Bearer token"},
+                                         {"x-request-id", "1"}};
+  const std::string key = cache_->key(headers, metadata);
+
+  // Headers that aren't part of the key, and the end of the path, don't change it.
+  Http::TestRequestHeaderMapImpl same_headers{{":method", "GET"},
+                                              {":path", "/api/v1/groups"},
+                                              {"authorization", "Bearer token"},
+                                              {"x-request-id", "2"}};
+  EXPECT_EQ(key, cache_->key(same_headers, metadata));
+
+  Http::TestRequestHeaderMapImpl other_path{
+      {":method", "GET"}, {":path", "/api/v2/users/1"}, {"authorization", "Bearer token"}};
+  EXPECT_NE(key, cache_->key(other_path, metadata));
+
+  Http::TestRequestHeaderMapImpl other_method{
+      {":method", "POST"}, {":path", "/api/v1/users/1"}, {"authorization", "Bearer token"}};
+  EXPECT_NE(key, cache_->key(other_method, metadata));
+
+  // A missing header doesn't match an empty one.
+  Http::TestRequestHeaderMapImpl no_authorization{{":method", "GET"}, {":path", "/api/v1"}};
+  Http::TestRequestHeaderMapImpl empty_authorization{
+      {":method", "GET"}, {":path", "/api/v1"}, {"authorization", ""}};
+  EXPECT_NE(cache_->key(no_authorization, metadata), cache_->key(empty_authorization, metadata));
+
+  EXPECT_NE(key, cache_->key(headers, envoy::config::core::v3::Metadata()));
+}
+
+// Verifies that every value of a repeated header is part of the key.
+TEST_F(DecisionCacheTest, KeyRepeatedHeader) {
+  initialize(R"EOF(
+  headers: ["authorization"]
+  ttl: 10s
+  )EOF");
+
+  const envoy::config::core::v3::Metadata metadata;
+  Http::TestRequestHeaderMapImpl headers{{"authorization", "Bearer token"},
+                                         {"authorization", "Bearer other"}};
+  const std::string key = cache_->key(headers, metadata);
+  EXPECT_EQ(key, cache_->key(Http::TestRequestHeaderMapImpl{{"authorization", "Bearer token"},
+                                                            {"authorization", "Bearer other"}},
+                             metadata));
+
+  EXPECT_NE(key, cache_->key(Http::TestRequestHeaderMapImpl{{"authorization", "Bearer token"}},
+                             metadata));
+  EXPECT_NE(key, cache_->key(Http::TestRequestHeaderMapImpl{{"authorization", "Bearer token"},
+                                                            {"authorization", "Bearer third"}},
+                             metadata));
+  EXPECT_NE(key, cache_->key(Http::TestRequestHeaderMapImpl{{"authorization", "Bearer token"},
+                                                            {"authorization", "Bearer other"},
+                                                            {"authorization", ""}},
+                             metadata));
+}
+
+// Verifies that a decision is cached for its TTL, and that concurrent misses are coalesced.
+TEST_F(DecisionCacheTest, HitMissAndExpiry) {
+  initialize("ttl: 10s");
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  EXPECT_EQ(DecisionCache::LookupStatus::Pending, lookup("a"));
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("b"));
+
+  EXPECT_CALL(*waiter_, onDecision(_)).WillOnce(Invoke([](const DecisionCache::Decision& decision) {
+    ASSERT_NE(nullptr, decision);
+    EXPECT_EQ(CheckStatus::Denied, decision->status);
+  }));
+  cache_->insert("a", now_, response(CheckStatus::Denied));
+  EXPECT_EQ(1, cache_->size());
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Hit, lookup("a"));
+  ASSERT_NE(nullptr, decision_);
+  EXPECT_EQ(CheckStatus::Denied, decision_->status);
+
+  now_ += std::chrono::seconds(10);
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  EXPECT_EQ(0, cache_->size());
+}
+
+// Verifies that errors and decisions with a TTL of 0 aren't cached, and that the waiters are told
+// to call the service themselves.
+TEST_F(DecisionCacheTest, NotCached) {
+  initialize(R"EOF(
+  ttl: 10s
+  ttl_metadata_field: ttl
+  )EOF");
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  EXPECT_EQ(DecisionCache::LookupStatus::Pending, lookup("a"));
+  EXPECT_CALL(*waiter_, onDecision(testing::IsNull()));
+  cache_->insert("a", now_, response(CheckStatus::Error));
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  Response ok = response(CheckStatus::OK);
+  (*ok.dynamic_metadata.mutable_fields())["ttl"].set_number_value(0);
+  cache_->insert("a", now_, ok);
+  EXPECT_EQ(0, cache_->size());
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  EXPECT_EQ(DecisionCache::LookupStatus::Pending, lookup("a"));
+  EXPECT_CALL(*waiter_, onDecision(testing::IsNull()));
+  cache_->cancel("a");
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+}
+
+// Verifies that the TTL returned by the authorization service overrides the configured one.
+TEST_F(DecisionCacheTest, TtlFromMetadata) {
+  initialize(R"EOF(
+  ttl: 10s
+  ttl_metadata_field: ttl
+  )EOF");
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  Response ok = response(CheckStatus::OK);
+  (*ok.dynamic_metadata.mutable_fields())["ttl"].set_number_value(60);
+  cache_->insert("a", now_, ok);
+
+  now_ += std::chrono::seconds(30);
+  EXPECT_EQ(DecisionCache::LookupStatus::Hit, lookup("a"));
+  now_ += std::chrono::seconds(30);
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+}
+
+// Verifies that a waiter destroyed before the decision is complete isn't called.
+TEST_F(DecisionCacheTest, WaiterDestroyed) {
+  initialize("ttl: 10s");
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  EXPECT_EQ(DecisionCache::LookupStatus::Pending, lookup("a"));
+  EXPECT_CALL(*waiter_, onDecision(_)).Times(0);
+  std::weak_ptr<MockWaiter> weak_waiter = waiter_;
+  waiter_ = std::make_shared<NiceMock<MockWaiter>>();
+  EXPECT_TRUE(weak_waiter.expired());
+  cache_->insert("a", now_, response(CheckStatus::OK));
+}
+
+// Verifies that the least recently used decisions are evicted once the cache is full.
+TEST_F(DecisionCacheTest, Eviction) {
+  // With a single entry, the cache has a single shard.
+  initialize(R"EOF(
+  ttl: 10s
+  max_entries: 1
+  )EOF");
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+  cache_->insert("a", now_, response(CheckStatus::OK));
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("b"));
+  cache_->insert("b", now_, response(CheckStatus::OK));
+  EXPECT_EQ(1, cache_->size());
+
+  EXPECT_EQ(DecisionCache::LookupStatus::Hit, lookup("b"));
+  EXPECT_EQ(DecisionCache::LookupStatus::Miss, lookup("a"));
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -2043,6 +2043,62 @@ TEST_P(HttpFilterTestParam, DisableRequestBodyBufferingOnRoute) {
   EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data_, false));
 }
 
+// Verifies that a request waits for the decision of a concurrent request with the same cache key,
+// and that a later request uses the cached decision without calling the authorization service.
+TEST_F(HttpFilterTest, DecisionCache) {
+  initialize(R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  decision_cache:
+    headers: ["authorization"]
+    ttl: 60s
+  )EOF");
+  request_headers_.addCopy(Http::LowerCaseString("authorization"), "Bearer token");
+
+  prepareCheck();
+  EXPECT_CALL(*client_, check(_, _, _, testing::A<Tracing::Span&>(), _))
+      .WillOnce(
+          WithArgs<0>(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks) -> void {
+            request_callbacks_ = &callbacks;
+          })));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            filter_->decodeHeaders(request_headers_, true));
+  EXPECT_EQ(1U, config_->stats().decision_cache_miss_.value());
+
+  // A concurrent request with the same key waits for the decision of the first one.
+  auto* waiting_client = new Filters::Common::ExtAuthz::MockClient();
+  Filter waiting_filter(config_, Filters::Common::ExtAuthz::ClientPtr{waiting_client});
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiting_callbacks;
+  waiting_filter.setDecoderFilterCallbacks(waiting_callbacks);
+  Http::TestRequestHeaderMapImpl waiting_headers{{"authorization", "Bearer token"}};
+  EXPECT_CALL(*waiting_client, check(_, _, _, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            waiting_filter.decodeHeaders(waiting_headers, true));
+  EXPECT_EQ(1U, config_->stats().decision_cache_coalesced_.value());
+
+  EXPECT_CALL(waiting_callbacks, continueDecoding());
+  EXPECT_CALL(filter_callbacks_, continueDecoding());
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::OK;
+  response.headers_to_set = Http::HeaderVector{{Http::LowerCaseString{"x-user"}, "alice"}};
+  request_callbacks_->onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+  EXPECT_EQ("alice", waiting_headers.get_("x-user"));
+  EXPECT_EQ(2U, config_->stats().ok_.value());
+
+  // A later request with the same key is allowed without calling the authorization service.
+  auto* cached_client = new Filters::Common::ExtAuthz::MockClient();
+  Filter cached_filter(config_, Filters::Common::ExtAuthz::ClientPtr{cached_client});
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> cached_callbacks;
+  cached_filter.setDecoderFilterCallbacks(cached_callbacks);
+  Http::TestRequestHeaderMapImpl cached_headers{{"authorization", "Bearer token"}};
+  EXPECT_CALL(*cached_client, check(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(cached_callbacks, continueDecoding()).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, cached_filter.decodeHeaders(cached_headers, true));
+  EXPECT_EQ("alice", cached_headers.get_("x-user"));
+  EXPECT_EQ(1U, config_->stats().decision_cache_hit_.value());
+}
+
 } // namespace
 } // namespace ExtAuthz
 } // namespace HttpFilters
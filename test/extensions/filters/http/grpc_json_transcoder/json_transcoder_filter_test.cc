@@ -917,6 +917,153 @@ TEST_F(GrpcJsonTranscoderFilterTest, TranscodingStreamPostWithHttpBody) {
   EXPECT_THAT(request, ProtoEq(expected_request));
 }
 
+// Verifies that an HttpBody request with a content-length is forwarded as it arrives.
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyAndContentLength) {
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "POST"},
+                                                 {":path", "/postBody?arg=hi"},
+                                                 {"content-type", "text/plain"},
+                                                 {"content-length", "12"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  EXPECT_EQ("/bookstore.Bookstore/PostBody", request_headers.get_(":path"));
+  EXPECT_FALSE(request_headers.has("content-length"));
+
+  EXPECT_CALL(decoder_callbacks_, addDecodedData(_, _)).Times(0);
+  Buffer::OwnedImpl forwarded;
+  Buffer::OwnedImpl buffer;
+  buffer.add("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, false));
+  EXPECT_GT(buffer.length(), 5);
+  forwarded.move(buffer);
+  buffer.add(" ");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, false));
+  EXPECT_EQ(1, buffer.length());
+  forwarded.move(buffer);
+  buffer.add("world!");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, true));
+  forwarded.move(buffer);
+
+  Grpc::Decoder decoder;
+  std::vector<Grpc::Frame> frames;
+  decoder.decode(forwarded, frames);
+  ASSERT_EQ(frames.size(), 1);
+  EXPECT_EQ(0, forwarded.length());
+
+  bookstore::EchoBodyRequest expected_request;
+  expected_request.set_arg("hi");
+  expected_request.mutable_nested()->mutable_content()->set_content_type("text/plain");
+  expected_request.mutable_nested()->mutable_content()->set_data("hello world!");
+
+  bookstore::EchoBodyRequest request;
+  request.ParseFromString(frames[0].data_->toString());
+  EXPECT_THAT(request, ProtoEq(expected_request));
+}
+
+// Verifies that the stream is reset if a forwarded HttpBody request doesn't match its
+// content-length.
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyShorterThanContentLength) {
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "POST"},
+                                                 {":path", "/postBody?arg=hi"},
+                                                 {"content-type", "text/plain"},
+                                                 {"content-length", "12"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl buffer;
+  buffer.add("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, false));
+  buffer.drain(buffer.length());
+  buffer.add(" world");
+  EXPECT_CALL(decoder_callbacks_, resetStream());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.decodeData(buffer, true));
+  EXPECT_EQ(0, buffer.length());
+}
+
+// Verifies that an HttpBody request too large for the length of a gRPC message is buffered rather
+// than forwarded with a truncated length.
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyTooLargeForGrpcMessage) {
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "POST"},
+                                                 {":path", "/postBody?arg=hi"},
+                                                 {"content-type", "text/plain"},
+                                                 {"content-length", "4294967296"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  EXPECT_FALSE(request_headers.has("content-length"));
+
+  Buffer::OwnedImpl buffer;
+  buffer.add("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_.decodeData(buffer, false));
+}
+
+class GrpcJsonTranscoderFilterMaxRequestBodySizeTest : public GrpcJsonTranscoderFilterTest {
+public:
+  GrpcJsonTranscoderFilterMaxRequestBodySizeTest()
+      : GrpcJsonTranscoderFilterTest(makeProtoConfig()) {}
+
+private:
+  const envoy::extensions::filters::http::grpc_json_transcoder::v3::GrpcJsonTranscoder
+  makeProtoConfig() {
+    auto proto_config = bookstoreProtoConfig();
+    proto_config.mutable_max_request_body_size()->set_value(32);
+    return proto_config;
+  }
+};
+
+// Verifies that only the part of a streaming JSON request belonging to the message being
+// transcoded counts towards the maximum size.
+TEST_F(GrpcJsonTranscoderFilterMaxRequestBodySizeTest, StreamingJsonRequest) {
+  Http::TestRequestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "POST"}, {":path", "/bulk/shelves"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  // Each complete message is forwarded as soon as it is read.
+  for (int i = 0; i < 4; ++i) {
+    Buffer::OwnedImpl request_data{i == 0 ? "[{\"theme\": \"Children\"},"
+                                          : "{\"theme\": \"Children\"},"};
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, false));
+
+    Grpc::Decoder decoder;
+    std::vector<Grpc::Frame> frames;
+    decoder.decode(request_data, frames);
+    EXPECT_EQ(1, frames.size());
+  }
+
+  Buffer::OwnedImpl request_data{"{\"theme\": \""};
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, false));
+  request_data.add(std::string(32, 'a'));
+  EXPECT_CALL(decoder_callbacks_, sendLocalReply(Http::Code::PayloadTooLarge, _, _, _,
+                                                 "grpc_json_transcode_request_body_too_large"));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer,
+            filter_.decodeData(request_data, false));
+}
+
+// Verifies that a buffered HttpBody request can't exceed the maximum size.
+TEST_F(GrpcJsonTranscoderFilterMaxRequestBodySizeTest, BufferedHttpBodyRequest) {
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":path", "/postBody?arg=hi"}, {"content-type", "text/plain"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl buffer{std::string(32, 'a')};
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_.decodeData(buffer, false));
+  buffer.add("a");
+  EXPECT_CALL(decoder_callbacks_, sendLocalReply(Http::Code::PayloadTooLarge, _, _, _,
+                                                 "grpc_json_transcode_request_body_too_large"));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.decodeData(buffer, false));
+}
+
+// Verifies that an HttpBody request whose content-length exceeds the maximum size is rejected
+// before it is forwarded.
+TEST_F(GrpcJsonTranscoderFilterMaxRequestBodySizeTest, StreamedHttpBodyRequest) {
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "POST"},
+                                                 {":path", "/postBody?arg=hi"},
+                                                 {"content-type", "text/plain"},
+                                                 {"content-length", "33"}};
+  EXPECT_CALL(decoder_callbacks_, sendLocalReply(Http::Code::PayloadTooLarge, _, _, _,
+                                                 "grpc_json_transcode_request_body_too_large"));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_.decodeHeaders(request_headers, false));
+}
+
 TEST_F(GrpcJsonTranscoderFilterTest, TranscodingStreamWithHttpBodyAsOutput) {
   Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/indexStream"}};
 
@@ -1,6 +1,7 @@
 #include "envoy/config/core/v3/http_uri.pb.h"
 #include "envoy/extensions/filters/http/jwt_authn/v3/config.pb.h"
 
+#include "common/common/thread_pool.h"
 #include "common/http/message_impl.h"
 #include "common/protobuf/utility.h"
 
@@ -12,8 +13,10 @@
 #include "test/extensions/filters/http/jwt_authn/mock.h"
 #include "test/extensions/filters/http/jwt_authn/test_common.h"
 #include "test/mocks/server/factory_context.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
+#include "absl/synchronization/notification.h"
 #include "gtest/gtest.h"
 
 using envoy::extensions::filters::http::jwt_authn::v3::JwtAuthentication;
@@ -50,7 +53,8 @@ public:
         check_audience, provider, allow_failed, allow_missing,
         filter_config_->getCache().getJwksCache(), filter_config_->cm(),
         [this](Upstream::ClusterManager&) { return std::move(fetcher_); },
-        filter_config_->timeSource());
+        filter_config_->timeSource(), filter_config_->stats(), mock_factory_ctx_.dispatcher_,
+        verify_pool_.get());
     jwks_ = Jwks::createFrom(PublicKey, Jwks::JWKS);
     EXPECT_TRUE(jwks_->getStatus() == Status::Ok);
   }
@@ -88,6 +92,7 @@ public:
   std::string out_name_;
   ProtobufWkt::Struct out_payload_;
   NiceMock<Tracing::MockSpan> parent_span_;
+  Thread::ThreadPoolPtr verify_pool_;
 };
 
 // This test validates a good JWT authentication with a remote Jwks.
@@ -111,6 +116,110 @@ TEST_F(AuthenticatorTest, TestOkJWTandCache) {
   }
 }
 
+// This test verifies verified tokens are cached, and that the cache is cleared when the remote Jwks
+// is fetched again.
+TEST_F(AuthenticatorTest, TestJwtCache) {
+  auto& provider0 = (*proto_config_.mutable_providers())[std::string(ProviderName)];
+  provider0.mutable_jwt_cache_config()->set_jwt_cache_size(10);
+  createAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _, _))
+      .WillOnce(Invoke([this](const envoy::config::core::v3::HttpUri&, Tracing::Span&,
+                              JwksFetcher::JwksReceiver& receiver) {
+        receiver.onJwksSuccess(std::move(jwks_));
+      }));
+
+  for (int i = 0; i < 3; i++) {
+    Http::TestRequestHeaderMapImpl headers{{"Authorization", "Bearer " + std::string(GoodToken)}};
+
+    expectVerifyStatus(Status::Ok, headers);
+
+    EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+    EXPECT_FALSE(headers.has(Http::CustomHeaders::get().Authorization));
+  }
+  EXPECT_EQ(1U, mock_factory_ctx_.scope_.counterFromString("jwt_authn.jwt_cache_miss").value());
+  EXPECT_EQ(2U, mock_factory_ctx_.scope_.counterFromString("jwt_authn.jwt_cache_hit").value());
+
+  // A token signed with an unknown key is not cached.
+  for (int i = 0; i < 2; i++) {
+    Http::TestRequestHeaderMapImpl headers{
+        {"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+    expectVerifyStatus(Status::JwtVerificationFail, headers);
+  }
+  EXPECT_EQ(3U, mock_factory_ctx_.scope_.counterFromString("jwt_authn.jwt_cache_miss").value());
+
+  // Replacing the keys clears the cache.
+  filter_config_->getCache().getJwksCache().findByProvider(ProviderName)->setRemoteJwks(
+      Jwks::createFrom(PublicKey, Jwks::JWKS));
+  Http::TestRequestHeaderMapImpl headers{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  EXPECT_EQ(4U, mock_factory_ctx_.scope_.counterFromString("jwt_authn.jwt_cache_miss").value());
+}
+
+// This test verifies the signature is verified on the verify pool, and that the verification
+// completes on the dispatcher of the worker.
+TEST_F(AuthenticatorTest, TestVerifyOnPool) {
+  verify_pool_ = std::make_unique<Thread::ThreadPool>(Thread::threadFactoryForTest(), 1, "test");
+  createAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _, _))
+      .WillOnce(Invoke([this](const envoy::config::core::v3::HttpUri&, Tracing::Span&,
+                              JwksFetcher::JwksReceiver& receiver) {
+        receiver.onJwksSuccess(std::move(jwks_));
+      }));
+
+  absl::Notification posted;
+  Event::PostCb verified;
+  EXPECT_CALL(mock_factory_ctx_.dispatcher_, post(_)).WillOnce(Invoke([&](Event::PostCb cb) {
+    verified = std::move(cb);
+    posted.Notify();
+  }));
+
+  Http::TestRequestHeaderMapImpl headers{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  initTokenExtractor();
+  auto tokens = extractor_->extract(headers);
+  bool done = false;
+  auth_->verify(headers, parent_span_, std::move(tokens), nullptr, [&done](const Status& status) {
+    EXPECT_EQ(status, Status::Ok);
+    done = true;
+  });
+
+  posted.WaitForNotification();
+  EXPECT_FALSE(done);
+  verified();
+  EXPECT_TRUE(done);
+  EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+  EXPECT_FALSE(headers.has(Http::CustomHeaders::get().Authorization));
+}
+
+// This test verifies a verification on the verify pool is ignored once the authenticator is
+// destroyed.
+TEST_F(AuthenticatorTest, TestOnDestroyWhileVerifyingOnPool) {
+  verify_pool_ = std::make_unique<Thread::ThreadPool>(Thread::threadFactoryForTest(), 1, "test");
+  createAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _, _))
+      .WillOnce(Invoke([this](const envoy::config::core::v3::HttpUri&, Tracing::Span&,
+                              JwksFetcher::JwksReceiver& receiver) {
+        receiver.onJwksSuccess(std::move(jwks_));
+      }));
+
+  absl::Notification posted;
+  Event::PostCb verified;
+  EXPECT_CALL(mock_factory_ctx_.dispatcher_, post(_)).WillOnce(Invoke([&](Event::PostCb cb) {
+    verified = std::move(cb);
+    posted.Notify();
+  }));
+
+  Http::TestRequestHeaderMapImpl headers{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  initTokenExtractor();
+  auto tokens = extractor_->extract(headers);
+  auth_->verify(headers, parent_span_, std::move(tokens), nullptr,
+                [](const Status&) { FAIL(); });
+
+  posted.WaitForNotification();
+  auth_->onDestroy();
+  auth_.reset();
+  verified();
+}
+
 // This test verifies the Jwt is forwarded if "forward" flag is set.
 TEST_F(AuthenticatorTest, TestForwardJwt) {
   // Config forward_jwt flag
@@ -0,0 +1,83 @@
+#include "extensions/filters/http/jwt_authn/jwt_cache.h"
+
+#include "gtest/gtest.h"
+
+using ::google::jwt_verify::Jwt;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+std::shared_ptr<const Jwt> makeJwt(uint64_t exp) {
+  auto jwt = std::make_shared<Jwt>();
+  jwt->exp_ = exp;
+  return jwt;
+}
+
+// Test a disabled cache
+TEST(JwtCacheTest, TestDisabled) {
+  JwtCache cache(0);
+  EXPECT_FALSE(cache.enabled());
+  cache.insert("token", makeJwt(0));
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.lookup("token", 0), nullptr);
+}
+
+// Test lookup and insert
+TEST(JwtCacheTest, TestLookup) {
+  JwtCache cache(10);
+  EXPECT_TRUE(cache.enabled());
+  EXPECT_EQ(cache.lookup("token", 0), nullptr);
+
+  const auto jwt = makeJwt(0);
+  cache.insert("token", jwt);
+  EXPECT_EQ(cache.lookup("token", 0), jwt);
+  EXPECT_EQ(cache.lookup("other_token", 0), nullptr);
+
+  // A cached token is not replaced.
+  cache.insert("token", makeJwt(0));
+  EXPECT_EQ(cache.lookup("token", 0), jwt);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+// Test the least recently used token is evicted when the cache is full
+TEST(JwtCacheTest, TestEviction) {
+  JwtCache cache(2);
+  cache.insert("token1", makeJwt(0));
+  cache.insert("token2", makeJwt(0));
+  // token1 becomes the most recently used token.
+  EXPECT_NE(cache.lookup("token1", 0), nullptr);
+
+  cache.insert("token3", makeJwt(0));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_NE(cache.lookup("token1", 0), nullptr);
+  EXPECT_EQ(cache.lookup("token2", 0), nullptr);
+  EXPECT_NE(cache.lookup("token3", 0), nullptr);
+}
+
+// Test an expired token is removed
+TEST(JwtCacheTest, TestExpired) {
+  JwtCache cache(10);
+  cache.insert("token", makeJwt(100));
+  EXPECT_NE(cache.lookup("token", 100), nullptr);
+  EXPECT_EQ(cache.lookup("token", 101), nullptr);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+// Test clear
+TEST(JwtCacheTest, TestClear) {
+  JwtCache cache(10);
+  cache.insert("token1", makeJwt(0));
+  cache.insert("token2", makeJwt(0));
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.lookup("token1", 0), nullptr);
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
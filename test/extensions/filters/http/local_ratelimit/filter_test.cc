@@ -1,5 +1,7 @@
 #include "envoy/extensions/filters/http/local_ratelimit/v3/local_rate_limit.pb.h"
 
+#include "common/network/address_impl.h"
+
 #include "extensions/filters/http/local_ratelimit/local_ratelimit.h"
 
 #include "test/mocks/http/mocks.h"
@@ -140,6 +142,68 @@ TEST_F(FilterTest, RequestRateLimitedButNotEnforced) {
   EXPECT_EQ(1U, findCounter("test.http_local_rate_limit.rate_limited"));
 }
 
+static const std::string descriptor_config_yaml = R"(
+stat_prefix: test
+token_bucket:
+  max_tokens: 1
+  tokens_per_fill: 1
+  fill_interval: 1000s
+filter_enabled:
+  runtime_key: test_enabled
+  default_value:
+    numerator: 100
+    denominator: HUNDRED
+filter_enforced:
+  runtime_key: test_enforced
+  default_value:
+    numerator: 100
+    denominator: HUNDRED
+descriptor_buckets:
+  {}
+  max_buckets: 1
+  )";
+
+// Each value of the descriptor header gets its own bucket, and the least recently seen buckets are
+// dropped once there are too many.
+TEST_F(FilterTest, RequestHeaderDescriptor) {
+  setup(fmt::format(descriptor_config_yaml, "request_header: x-client"), true, false);
+
+  Http::TestRequestHeaderMapImpl headers_a{{"x-client", "a"}};
+  Http::TestRequestHeaderMapImpl headers_b{{"x-client", "b"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_a, false));
+  EXPECT_EQ(1U, findCounter("test.http_local_rate_limit.ok"));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_a, false));
+  EXPECT_EQ(1U, findCounter("test.http_local_rate_limit.rate_limited"));
+
+  // The bucket of "b" replaces the one of "a", which starts over with a full bucket.
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_b, false));
+  EXPECT_EQ(2U, findCounter("test.http_local_rate_limit.ok"));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_a, false));
+  EXPECT_EQ(3U, findCounter("test.http_local_rate_limit.ok"));
+
+  // Requests without the header share a bucket.
+  Http::TestRequestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_EQ(4U, findCounter("test.http_local_rate_limit.ok"));
+  EXPECT_EQ(2U, findCounter("test.http_local_rate_limit.rate_limited"));
+}
+
+TEST_F(FilterTest, RemoteAddressDescriptor) {
+  setup(fmt::format(descriptor_config_yaml, "remote_address: true"), true, false);
+
+  Http::TestRequestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_EQ(1U, findCounter("test.http_local_rate_limit.ok"));
+  EXPECT_EQ(1U, findCounter("test.http_local_rate_limit.rate_limited"));
+
+  decoder_callbacks_.stream_info_.downstream_remote_address_ =
+      std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1", 1234);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_EQ(2U, findCounter("test.http_local_rate_limit.ok"));
+}
+
 } // namespace LocalRateLimitFilter
 } // namespace HttpFilters
 } // namespace Extensions
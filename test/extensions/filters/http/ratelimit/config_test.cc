@@ -52,6 +52,59 @@ TEST(RateLimitFilterConfigTest, RatelimitCorrectProto) {
   cb(filter_callback);
 }
 
+// With quota leases, the gRPC client is created once per worker when the configuration is loaded,
+// and not for every filter.
+TEST(RateLimitFilterConfigTest, RatelimitQuotaLeases) {
+  const std::string yaml = R"EOF(
+  domain: test
+  timeout: 2s
+  rate_limit_service:
+    grpc_service:
+      envoy_grpc:
+        cluster_name: ratelimit_cluster
+    quota_leases:
+      lease_size: 10
+      lease_duration: 2s
+  )EOF";
+
+  envoy::extensions::filters::http::ratelimit::v3::RateLimit proto_config{};
+  TestUtility::loadFromYamlAndValidate(yaml, proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  EXPECT_CALL(context.cluster_manager_.async_client_manager_, factoryForGrpcService(_, _, _))
+      .WillOnce(Invoke([](const envoy::config::core::v3::GrpcService&, Stats::Scope&, bool) {
+        auto async_client_factory = std::make_unique<Grpc::MockAsyncClientFactory>();
+        EXPECT_CALL(*async_client_factory, create()).WillOnce(Invoke([] {
+          return std::make_unique<NiceMock<Grpc::MockAsyncClient>>();
+        }));
+        return async_client_factory;
+      }));
+
+  RateLimitFilterConfig factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_)).Times(2);
+  cb(filter_callback);
+  cb(filter_callback);
+}
+
+TEST(RateLimitFilterConfigTest, RatelimitQuotaLeasesTooSmall) {
+  const std::string yaml = R"EOF(
+  domain: test
+  rate_limit_service:
+    grpc_service:
+      envoy_grpc:
+        cluster_name: ratelimit_cluster
+    quota_leases:
+      lease_size: 1
+  )EOF";
+
+  envoy::extensions::filters::http::ratelimit::v3::RateLimit proto_config{};
+  EXPECT_THROW_WITH_REGEX(TestUtility::loadFromYamlAndValidate(yaml, proto_config),
+                          ProtoValidationException, "LeaseSize: value must be greater than");
+}
+
 TEST(RateLimitFilterConfigTest, RateLimitFilterEmptyProto) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
   NiceMock<Server::MockInstance> instance;
@@ -1,4 +1,5 @@
 // NOLINT(namespace-envoy)
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -52,6 +53,10 @@ FilterDataStatus BodyContext::onBody(WasmBufferType type, size_t buffer_length,
     auto body = getBufferBytes(type, 0, buffer_length);
     logError("onBody " + std::string(body->view()));
 
+  } else if (body_op_ == "PeekBody") {
+    auto body = getBufferBytes(type, 0, std::min<size_t>(buffer_length, 16));
+    logError("onBody " + std::string(body->view()));
+
   } else if (body_op_ == "PrependAndAppendToBody") {
     setBuffer(WasmBufferType::HttpRequestBody, 0, 0, "prepend.");
     getBufferStatus(WasmBufferType::HttpRequestBody, &size, &flags);
@@ -66,6 +71,12 @@ FilterDataStatus BodyContext::onBody(WasmBufferType type, size_t buffer_length,
     auto replaced = getBufferBytes(WasmBufferType::HttpRequestBody, 0, size);
     logError("onBody " + std::string(replaced->view()));
     return FilterDataStatus::StopIterationAndWatermark;
+  } else if (body_op_ == "ReplaceBodyRange") {
+    setBuffer(WasmBufferType::HttpRequestBody, 1, 3, "ipp");
+    getBufferStatus(WasmBufferType::HttpRequestBody, &size, &flags);
+    auto replaced = getBufferBytes(WasmBufferType::HttpRequestBody, 0, size);
+    logError("onBody " + std::string(replaced->view()));
+
   } else if (body_op_ == "RemoveBody") {
     setBuffer(WasmBufferType::HttpRequestBody, 0, buffer_length, "");
     getBufferStatus(WasmBufferType::HttpRequestBody, &size, &flags);
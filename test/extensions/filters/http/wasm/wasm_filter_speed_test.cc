@@ -0,0 +1,85 @@
+// Measures the per-request overhead of a Wasm HTTP filter running in the null VM, which calls
+// the same host functions as a Wasm module without the cost of the VM itself. Each request
+// replaces the request headers in one call and then reads, peeks at or edits a body made of 16KiB
+// slices.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "test/test_common/wasm_base.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Wasm {
+namespace {
+
+using Envoy::Extensions::Common::Wasm::Context;
+using Envoy::Extensions::Common::Wasm::Plugin;
+using proxy_wasm::ContextBase;
+
+static constexpr uint64_t SliceSize = 16384;
+
+class WasmFilterPerf : public Common::Wasm::WasmHttpFilterTestBase<> {
+public:
+  WasmFilterPerf() {
+    Logger::Registry::getLog(Logger::Id::wasm).set_level(spdlog::level::off);
+    setupBase("null", "HttpWasmTestCpp",
+              [](Common::Wasm::Wasm* wasm, const std::shared_ptr<Plugin>& plugin) -> ContextBase* {
+                return new Context(wasm, plugin);
+              },
+              "body");
+  }
+
+  void request(const std::string& operation, uint64_t body_size) {
+    setupFilterBase<Context>("body");
+    Http::TestRequestHeaderMapImpl request_headers{
+        {":path", "/"}, {":method", "POST"}, {"x-test-operation", operation}};
+    context_->decodeHeaders(request_headers, false);
+    // The slices of the body refer to the same data, so that building the body costs little.
+    std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments;
+    Buffer::OwnedImpl body;
+    for (uint64_t size = 0; size < body_size; size += SliceSize) {
+      fragments.push_back(std::make_unique<Buffer::BufferFragmentImpl>(
+          slice_.data(), std::min(SliceSize, body_size - size), nullptr));
+      body.addBufferFragment(*fragments.back());
+    }
+    context_->decodeData(body, true);
+    context_->onDestroy();
+  }
+
+  // testing::Test
+  void TestBody() override {}
+
+private:
+  const std::string slice_ = std::string(SliceSize, 'a');
+};
+
+void bmWasmFilterRequest(benchmark::State& state, const std::string& operation) {
+  WasmFilterPerf perf;
+  for (auto _ : state) {
+    perf.request(operation, state.range(0));
+  }
+}
+
+BENCHMARK_CAPTURE(bmWasmFilterRequest, ReadBody, std::string("ReadBody"))
+    ->Arg(SliceSize)
+    ->Arg(64 * SliceSize);
+BENCHMARK_CAPTURE(bmWasmFilterRequest, PeekBody, std::string("PeekBody"))
+    ->Arg(SliceSize)
+    ->Arg(64 * SliceSize);
+BENCHMARK_CAPTURE(bmWasmFilterRequest, ReplaceBodyRange, std::string("ReplaceBodyRange"))
+    ->Arg(SliceSize)
+    ->Arg(64 * SliceSize);
+
+} // namespace
+} // namespace Wasm
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -300,6 +300,38 @@ TEST_P(WasmHttpFilterTest, BodyRequestReadBody) {
   filter().onDestroy();
 }
 
+// Script that reads the beginning of the body.
+TEST_P(WasmHttpFilterTest, BodyRequestPeekBody) {
+  if (std::get<1>(GetParam()) == "rust") {
+    return;
+  }
+  setupTest("body");
+  setupFilter("body");
+  EXPECT_CALL(filter(), log_(spdlog::level::err, Eq(absl::string_view("onBody hello world, thi"))));
+  Http::TestRequestHeaderMapImpl request_headers{{":path", "/"}, {"x-test-operation", "PeekBody"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter().decodeHeaders(request_headers, false));
+  Buffer::OwnedImpl data("hello world, this body is longer than what is read");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter().decodeData(data, true));
+  filter().onDestroy();
+}
+
+// Script that replaces a range in the middle of the body.
+TEST_P(WasmHttpFilterTest, BodyRequestReplaceBodyRange) {
+  if (std::get<1>(GetParam()) == "rust") {
+    return;
+  }
+  setupTest("body");
+  setupFilter("body");
+  EXPECT_CALL(filter(), log_(spdlog::level::err, Eq(absl::string_view("onBody hippo"))));
+  Http::TestRequestHeaderMapImpl request_headers{{":path", "/"},
+                                                 {"x-test-operation", "ReplaceBodyRange"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter().decodeHeaders(request_headers, false));
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter().decodeData(data, true));
+  EXPECT_EQ("hippo", data.toString());
+  filter().onDestroy();
+}
+
 // Script that prepends and appends to the body.
 TEST_P(WasmHttpFilterTest, BodyRequestPrependAndAppendToBody) {
   setupTest("body");
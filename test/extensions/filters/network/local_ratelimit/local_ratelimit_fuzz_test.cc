@@ -11,6 +11,7 @@
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -50,10 +51,10 @@ DEFINE_PROTO_FUZZER(
     ENVOY_LOG_MISC(debug, "In fill_interval, nanos should not be negative!");
     return;
   }
+  static Event::SimulatedTimeSystem time_system;
   static NiceMock<Event::MockDispatcher> dispatcher;
   Stats::IsolatedStoreImpl stats_store;
   static NiceMock<Runtime::MockLoader> runtime;
-  Event::MockTimer* fill_timer = new Event::MockTimer(&dispatcher);
   envoy::extensions::filters::network::local_ratelimit::v3::LocalRateLimit proto_config =
       input.config();
   ConfigSharedPtr config = nullptr;
@@ -82,8 +83,7 @@ DEFINE_PROTO_FUZZER(
       break;
     }
     case envoy::extensions::filters::network::local_ratelimit::Action::kRefill: {
-      EXPECT_CALL(*fill_timer, enableTimer(fill_interval, nullptr));
-      fill_timer->invokeCallback();
+      time_system.advanceTimeWait(fill_interval);
       break;
     }
     default:
@@ -91,11 +91,7 @@ DEFINE_PROTO_FUZZER(
       PANIC("A case is missing for an action");
     }
   }
-} // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
-  // Silence clang-tidy here because it thinks there is a memory leak for "fill_timer"
-  // However, ownership of each MockTimer instance is transferred to the (caller of) dispatcher's
-  // createTimer_(), so to avoid destructing it twice, the MockTimer must have been dynamically
-  // allocated and must not be deleted by it's creator. See test/mocks/event/mocks.cc for detail.
+}
 } // namespace LocalRateLimitFilter
 } // namespace NetworkFilters
 } // namespace Extensions
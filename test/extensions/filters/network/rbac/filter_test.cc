@@ -143,6 +143,26 @@ TEST_F(RoleBasedAccessControlNetworkFilterTest, AllowedWithContinuousEnforcement
   EXPECT_EQ(2U, config_->stats().shadow_denied_.value());
 }
 
+// The policies only depend on the connection, so their decisions are not evaluated again.
+TEST_F(RoleBasedAccessControlNetworkFilterTest, ContinuousEnforcementReusesDecision) {
+  config_ = setupConfig(true, true /* continuous enforcement */);
+  filter_ = std::make_unique<RoleBasedAccessControlFilter>(config_);
+  filter_->initializeReadFilterCallbacks(callbacks_);
+  setDestinationPort(123);
+
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onData(data_, false));
+
+  // A port matching the shadow policy instead would change both decisions if they were evaluated
+  // again.
+  setDestinationPort(456);
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onData(data_, false));
+  EXPECT_EQ(2U, config_->stats().allowed_.value());
+  EXPECT_EQ(0U, config_->stats().denied_.value());
+  EXPECT_EQ(0U, config_->stats().shadow_allowed_.value());
+  EXPECT_EQ(2U, config_->stats().shadow_denied_.value());
+}
+
 TEST_F(RoleBasedAccessControlNetworkFilterTest, RequestedServerName) {
   setDestinationPort(999);
   setRequestedServerName("www.cncf.io");
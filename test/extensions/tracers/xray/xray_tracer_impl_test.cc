@@ -36,6 +36,8 @@ TEST_F(XRayDriverTest, XRayTraceHeaderNotSampled) {
   XRayConfiguration config{"" /*daemon_endpoint*/, "test_segment_name", "" /*sampling_rules*/,
                            "" /*origin*/, aws_metadata_};
   Driver driver(config, context_);
+  // X-Ray doesn't record the spans of traces that aren't sampled, so they can't be tail sampled.
+  EXPECT_FALSE(driver.supportsTailSampling());
 
   Tracing::Decision tracing_decision{Tracing::Reason::Sampling, false /*sampled*/};
   Envoy::SystemTime start_time;
@@ -12,6 +12,8 @@
 #include "absl/strings/str_format.h"
 #include "gtest/gtest.h"
 
+#include "zipkin.pb.h"
+
 using testing::HasSubstr;
 
 namespace Envoy {
@@ -401,6 +403,43 @@ TEST(ZipkinSpanBufferTest, SerializeSpan) {
             serializedMessageToJson<zipkin::proto3::ListOfSpans>(buffer6.serialize()));
 }
 
+// Strings set by users, e.g. tag values taken from request headers, are escaped.
+TEST(ZipkinSpanBufferTest, SerializeEscapedStrings) {
+  Span span = createSpan({"cs"}, IpType::V4);
+  span.setName("name \"with\" quotes");
+  BinaryAnnotation tag;
+  tag.setKey("key\\with\\backslashes");
+  tag.setValue("value\nwith\tcontrol\x01"
+               "characters");
+  span.setBinaryAnnotations({tag});
+
+  SpanBuffer json_buffer(envoy::config::trace::v3::ZipkinConfig::HTTP_JSON, true, 2);
+  json_buffer.addSpan(Span(span));
+  EXPECT_THAT(wrapAsObject("[{"
+                           R"("traceId":"0000000000000001",)"
+                           R"("id":"0000000000000001",)"
+                           R"("kind":"CLIENT",)"
+                           R"("name":"name \"with\" quotes",)"
+                           R"("timestamp":DEFAULT_TEST_TIMESTAMP,)"
+                           R"("duration":DEFAULT_TEST_DURATION,)"
+                           R"("localEndpoint":{)"
+                           R"("serviceName":"service1",)"
+                           R"("ipv4":"1.2.3.4",)"
+                           R"("port":8080},)"
+                           R"("tags":{)"
+                           R"("key\\with\\backslashes":"value\nwith\tcontrol\u0001characters"})"
+                           "}]"),
+              JsonStringEq(wrapAsObject(json_buffer.serialize())));
+
+  SpanBuffer proto_buffer(envoy::config::trace::v3::ZipkinConfig::HTTP_PROTO, true, 2);
+  proto_buffer.addSpan(Span(span));
+  zipkin::proto3::ListOfSpans spans;
+  ASSERT_TRUE(spans.ParseFromString(proto_buffer.serialize()));
+  ASSERT_EQ(1, spans.spans_size());
+  EXPECT_EQ("name \"with\" quotes", spans.spans(0).name());
+  EXPECT_EQ(tag.value(), spans.spans(0).tags().at(tag.key()));
+}
+
 TEST(ZipkinSpanBufferTest, TestSerializeTimestampInTheFuture) {
   ProtobufWkt::Struct objectWithScientificNotation;
   auto* objectWithScientificNotationFields = objectWithScientificNotation.mutable_fields();
@@ -9,6 +9,7 @@
 
 #include "test/mocks/common.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
@@ -16,6 +17,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::NiceMock;
 using testing::Return;
 
@@ -365,6 +367,76 @@ TEST_F(ZipkinTracerTest, SpanSampledPropagatedToChild) {
   EXPECT_FALSE(child_span2->sampled());
 }
 
+// Spans that are not sampled, but may be when their request completes, are held until it does.
+TEST_F(ZipkinTracerTest, TailSampling) {
+  Network::Address::InstanceConstSharedPtr addr =
+      Network::Utility::parseInternetAddressAndPort("127.0.0.1:9000");
+  NiceMock<Random::MockRandomGenerator> random_generator;
+  Tracer tracer("my_service_name", addr, random_generator, false, true, time_system_);
+  SystemTime timestamp = time_system_.systemTime();
+  NiceMock<Tracing::MockConfig> config;
+
+  TestReporterImpl* reporter_object = new TestReporterImpl(135);
+  tracer.setReporter(ReporterPtr(reporter_object));
+  NiceMock<Stats::MockIsolatedStatsStore> stats_store;
+  ZipkinTracerStats stats{ZIPKIN_TRACER_STATS(POOL_COUNTER_PREFIX(stats_store, "tracing.zipkin."))};
+  NiceMock<Runtime::MockLoader> runtime;
+  tracer.enableTailSampling(runtime, stats);
+
+  const auto start_trace = [&](uint64_t trace_id) {
+    ON_CALL(random_generator, random()).WillByDefault(Return(trace_id));
+    SpanPtr root_span = tracer.startSpan(config, "root_span", timestamp);
+    root_span->setSampled(false);
+    root_span->setTailSampling(true);
+    tracer.startTailSampledTrace(root_span->traceId());
+    return root_span;
+  };
+  const auto finish_child = [&](const Span& parent) {
+    SpanPtr child_span = tracer.startSpan(config, "child_span", timestamp, SpanContext(parent));
+    child_span->setTailSampling(parent.tailSampling());
+    child_span->finish();
+  };
+
+  // A trace that is not sampled when its request completes is dropped.
+  SpanPtr root_span = start_trace(1);
+  finish_child(*root_span);
+  root_span->finish();
+  tracer.finishTailSampledTrace(1, false);
+  EXPECT_EQ(0ULL, reporter_object->reportedSpans().size());
+
+  // Spans finishing after the request completed are not held.
+  finish_child(*root_span);
+  EXPECT_EQ(0ULL, reporter_object->reportedSpans().size());
+
+  // A trace that is sampled when its request completes is reported whole.
+  root_span = start_trace(2);
+  finish_child(*root_span);
+  finish_child(*root_span);
+  root_span->setSampled(true);
+  root_span->finish();
+  tracer.finishTailSampledTrace(2, true);
+  ASSERT_EQ(3ULL, reporter_object->reportedSpans().size());
+  EXPECT_EQ("root_span", reporter_object->reportedSpans()[0].name());
+  for (const Span& span : reporter_object->reportedSpans()) {
+    EXPECT_EQ(2ULL, span.traceId());
+    EXPECT_TRUE(span.sampled());
+  }
+  EXPECT_EQ(2UL, stats.spans_tail_sampled_.value());
+
+  // Spans beyond the limit of held spans are dropped.
+  EXPECT_CALL(runtime.snapshot_, getInteger("tracing.zipkin.max_tail_sampling_spans", _))
+      .WillRepeatedly(Return(1));
+  root_span = start_trace(3);
+  finish_child(*root_span);
+  finish_child(*root_span);
+  EXPECT_EQ(1UL, stats.spans_tail_dropped_.value());
+  root_span->setSampled(true);
+  root_span->finish();
+  tracer.finishTailSampledTrace(3, true);
+  EXPECT_EQ(5ULL, reporter_object->reportedSpans().size());
+  EXPECT_EQ(3UL, stats.spans_tail_sampled_.value());
+}
+
 TEST_F(ZipkinTracerTest, RootSpan128bitTraceId) {
   Network::Address::InstanceConstSharedPtr addr =
       Network::Utility::parseInternetAddressAndPort("127.0.0.1:9000");
@@ -187,6 +187,7 @@ TEST_F(ZipkinDriverTest, InitializeDriver) {
     TestUtility::loadFromYaml(yaml_string, zipkin_config);
 
     setup(zipkin_config, true);
+    EXPECT_TRUE(driver_->supportsTailSampling());
   }
 }
 
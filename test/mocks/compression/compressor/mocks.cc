@@ -9,6 +9,9 @@ namespace Compressor {
 MockCompressor::MockCompressor() = default;
 MockCompressor::~MockCompressor() = default;
 
+MockBlockCompressor::MockBlockCompressor() = default;
+MockBlockCompressor::~MockBlockCompressor() = default;
+
 MockCompressorFactory::MockCompressorFactory() {
   ON_CALL(*this, statsPrefix()).WillByDefault(ReturnRef(stats_prefix_));
   ON_CALL(*this, contentEncoding()).WillByDefault(ReturnRef(content_encoding_));
@@ -18,6 +18,17 @@ public:
   MOCK_METHOD(void, compress, (Buffer::Instance & buffer, State state));
 };
 
+class MockBlockCompressor : public BlockCompressor {
+public:
+  MockBlockCompressor();
+  ~MockBlockCompressor() override;
+
+  // Compressor::BlockCompressor
+  MOCK_METHOD(BlockPtr, compressBlock,
+              (absl::string_view input, absl::string_view history, State state), (const));
+  MOCK_METHOD(void, addBlock, (const Block& block, Buffer::Instance& output));
+};
+
 class MockCompressorFactory : public CompressorFactory {
 public:
   MockCompressorFactory();
@@ -27,6 +38,7 @@ public:
   MOCK_METHOD(CompressorPtr, createCompressor, ());
   MOCK_METHOD(const std::string&, statsPrefix, (), (const));
   MOCK_METHOD(const std::string&, contentEncoding, (), (const));
+  MOCK_METHOD(BlockCompressorSharedPtr, createBlockCompressor, ());
 
   const std::string stats_prefix_{"mock"};
   const std::string content_encoding_{"mock"};
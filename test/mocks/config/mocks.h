@@ -40,6 +40,8 @@ public:
   ~MockOpaqueResourceDecoder() override;
 
   MOCK_METHOD(ProtobufTypes::MessagePtr, decodeResource, (const ProtobufWkt::Any& resource));
+  MOCK_METHOD(ProtobufTypes::MessagePtr, parseResource, (const ProtobufWkt::Any& resource));
+  MOCK_METHOD(void, finishResource, (const Protobuf::Message& resource));
   MOCK_METHOD(std::string, resourceName, (const Protobuf::Message& resource));
 };
 
@@ -64,6 +64,7 @@ public:
               (const Config& config, Http::HeaderMap& request_headers,
                const StreamInfo::StreamInfo& stream_info,
                const Tracing::Decision tracing_decision));
+  MOCK_METHOD(bool, supportsTailSampling, (), (const));
 };
 
 class MockDriver : public Driver {
@@ -82,6 +83,7 @@ public:
               (const Config& config, Http::HeaderMap& request_headers,
                const std::string& operation_name, SystemTime start_time,
                const Tracing::Decision tracing_decision));
+  MOCK_METHOD(bool, supportsTailSampling, (), (const));
 };
 
 class MockHttpTracerManager : public HttpTracerManager {
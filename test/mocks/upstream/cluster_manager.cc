@@ -3,6 +3,8 @@
 #include <chrono>
 #include <functional>
 
+#include "common/protobuf/utility.h"
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -10,6 +12,7 @@ namespace Envoy {
 namespace Upstream {
 using ::testing::_;
 using ::testing::Eq;
+using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::ReturnRef;
 MockClusterManager::MockClusterManager(TimeSource&) : MockClusterManager() {}
@@ -28,6 +31,15 @@ MockClusterManager::MockClusterManager() {
   ON_CALL(*this, get(_)).WillByDefault(Return(&thread_local_cluster_));
   ON_CALL(*this, get(Eq(""))).WillByDefault(Return(nullptr));
   ON_CALL(*this, subscriptionFactory()).WillByDefault(ReturnRef(subscription_factory_));
+  ON_CALL(*this, hashClusters(_))
+      .WillByDefault(
+          Invoke([](const std::vector<const envoy::config::cluster::v3::Cluster*>& clusters) {
+            std::vector<uint64_t> hashes;
+            for (const auto* cluster : clusters) {
+              hashes.push_back(MessageUtil::hash(*cluster));
+            }
+            return hashes;
+          }));
 }
 
 MockClusterManager::~MockClusterManager() = default;
@@ -38,6 +38,11 @@ public:
   MOCK_METHOD(bool, addOrUpdateCluster,
               (const envoy::config::cluster::v3::Cluster& cluster,
                const std::string& version_info));
+  MOCK_METHOD(bool, addOrUpdateCluster,
+              (const envoy::config::cluster::v3::Cluster& cluster, const std::string& version_info,
+               uint64_t config_hash));
+  MOCK_METHOD(std::vector<uint64_t>, hashClusters,
+              (const std::vector<const envoy::config::cluster::v3::Cluster*>& clusters));
   MOCK_METHOD(void, setPrimaryClustersInitializedCb, (PrimaryClustersReadyCallback));
   MOCK_METHOD(void, setInitializedCb, (InitializationCompleteCallback));
   MOCK_METHOD(void, initializeSecondaryClusters,